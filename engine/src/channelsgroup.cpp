@@ -128,6 +128,7 @@ QString ChannelsGroup::name() const
 void ChannelsGroup::resetChannels()
 {
     m_channels.clear();
+    emit changed(this->id());
 }
 
 bool ChannelsGroup::addChannel(quint32 fxid, quint32 channel)
@@ -136,6 +137,7 @@ bool ChannelsGroup::addChannel(quint32 fxid, quint32 channel)
         return false;
 
     m_channels.append(SceneValue(fxid, channel, 0));
+    emit changed(this->id());
 
     return true;
 }
@@ -199,15 +201,23 @@ QString ChannelsGroup::status(Doc *doc) const
 void ChannelsGroup::setInputSource(QSharedPointer<QLCInputSource> const& source)
 {
     if (!m_input.isNull() && m_input->isValid())
+    {
         disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
                 this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+        m_doc->inputOutputMap()->unsubscribeInputChannel(m_input->universe(), m_input->channel());
+    }
 
     m_input = source;
 
     // Connect when the first valid input source is set
     if (!source.isNull() && source->isValid())
+    {
         connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
                 this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+        m_doc->inputOutputMap()->subscribeInputChannel(source->universe(), source->channel());
+    }
+
+    emit changed(this->id());
 }
 
 QSharedPointer<QLCInputSource> const& ChannelsGroup::inputSource() const
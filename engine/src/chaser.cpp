@@ -59,10 +59,6 @@ Chaser::Chaser(Doc *doc)
 {
     setName(tr("New Chaser"));
 
-    // Listen to member Function removals
-    connect(doc, SIGNAL(functionRemoved(quint32)),
-            this, SLOT(slotFunctionRemoved(quint32)));
-
     m_startupAction.m_action = ChaserNoAction;
     m_startupAction.m_masterIntensity = 1.0;
     m_startupAction.m_stepIntensity = 1.0;
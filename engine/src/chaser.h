@@ -146,7 +146,7 @@ public:
 
 public slots:
     /**
-     * Catches Doc::functionRemoved() so that destroyed members can be
+     * Called by Doc when a member function is removed, so that it can be
      * removed immediately. This method removes all occurrences of the
      * given function ID, while removeStep() only removes one function ID
      * at the given index.
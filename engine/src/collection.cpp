@@ -44,10 +44,6 @@ Collection::Collection(Doc* doc)
 #endif
 {
     setName(tr("New Collection"));
-
-    // Listen to member Function removals
-    connect(doc, SIGNAL(functionRemoved(quint32)),
-            this, SLOT(slotFunctionRemoved(quint32)));
 }
 
 Collection::~Collection()
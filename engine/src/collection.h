@@ -98,8 +98,7 @@ signals:
     void functionsChanged();
 
 public slots:
-    /** Catches Doc::functionRemoved() so that destroyed members can be
-        removed immediately. */
+    /** @reimp */
     void slotFunctionRemoved(quint32 function);
 
 protected:
@@ -39,12 +39,15 @@
 #include "rgbscriptscache.h"
 #include "channelsgroup.h"
 #include "scriptwrapper.h"
+#include "docsnapshot.h"
 #include "collection.h"
 #include "function.h"
 #include "universe.h"
+#include "rgbmatrix.h"
 #include "sequence.h"
 #include "fixture.h"
 #include "chaser.h"
+#include "script.h"
 #include "scene.h"
 #include "show.h"
 #include "efx.h"
@@ -141,6 +144,13 @@ void Doc::clearContents()
         delete func;
     }
 
+    m_dependencies.clear();
+    m_functionUsers.clear();
+    m_fixtureUsers.clear();
+    m_fixtureGroupUsers.clear();
+    m_dirtyDependencies.clear();
+    m_volatileDependencies.clear();
+
     // Delete all palettes
     QListIterator <quint32> palIt(m_palettes.keys());
     while (palIt.hasNext() == true)
@@ -451,7 +461,7 @@ bool Doc::addFixture(Fixture* fixture, quint32 id)
     }
 
     // Add the fixture channels capabilities to the universe they belong
-    QList<Universe *> universes = inputOutputMap()->claimUniverses();
+    QList<Universe *> universes = inputOutputMap()->claimUniverses(true);
 
     QList<int> forcedHTP = fixture->forcedHTPChannels();
     QList<int> forcedLTP = fixture->forcedLTPChannels();
@@ -503,6 +513,15 @@ bool Doc::deleteFixture(quint32 id)
         if (m_monitorProps != NULL)
             m_monitorProps->removeFixture(id);
 
+        /* Notify only the functions using the fixture */
+        foreach (quint32 fid, fixtureUsers(id))
+        {
+            Function *func = function(fid);
+            if (func != NULL)
+                func->slotFixtureRemoved(id);
+            m_dirtyDependencies.insert(fid);
+        }
+
         emit fixtureRemoved(id);
         setModified();
         delete fxi;
@@ -600,7 +619,7 @@ bool Doc::updateFixtureChannelCapabilities(quint32 id, QList<int> forcedHTP, QLi
 
     Fixture* fixture = m_fixtures[id];
     // get exclusive access to the universes list
-    QList<Universe *> universes = inputOutputMap()->claimUniverses();
+    QList<Universe *> universes = inputOutputMap()->claimUniverses(true);
     Universe *universe = universes.at(fixture->universe());
     quint32 fxAddress = fixture->address();
 
@@ -766,6 +785,15 @@ bool Doc::deleteFixtureGroup(quint32 id)
         FixtureGroup* grp = m_fixtureGroups.take(id);
         Q_ASSERT(grp != NULL);
 
+        /* Notify only the functions using the group */
+        foreach (quint32 fid, fixtureGroupUsers(id))
+        {
+            Function *func = function(fid);
+            if (func != NULL)
+                func->slotFixtureGroupRemoved(id);
+            m_dirtyDependencies.insert(fid);
+        }
+
         emit fixtureGroupRemoved(id);
         setModified();
         delete grp;
@@ -828,6 +856,10 @@ bool Doc::addChannelsGroup(ChannelsGroup *grp, quint32 id)
      if (m_orderedGroups.contains(id) == false)
         m_orderedGroups.append(id);
 
+     /* Patch channels group change signals thru Doc */
+     connect(grp, SIGNAL(changed(quint32)),
+             this, SLOT(slotChannelsGroupChanged(quint32)));
+
      emit channelsGroupAdded(id);
      setModified();
 
@@ -907,6 +939,12 @@ quint32 Doc::createChannelsGroupId()
     return m_latestChannelsGroupId;
 }
 
+void Doc::slotChannelsGroupChanged(quint32 id)
+{
+    setModified();
+    emit channelsGroupChanged(id);
+}
+
 /*********************************************************************
  * Palettes
  *********************************************************************/
@@ -929,6 +967,10 @@ bool Doc::addPalette(QLCPalette *palette, quint32 id)
         palette->setID(id);
         m_palettes[id] = palette;
 
+        /* Patch palette change signals thru Doc */
+        connect(palette, SIGNAL(changed(quint32)),
+                this, SLOT(slotPaletteChanged(quint32)));
+
         emit paletteAdded(id);
         setModified();
     }
@@ -980,6 +1022,12 @@ quint32 Doc::createPaletteId()
     return m_latestPaletteId;
 }
 
+void Doc::slotPaletteChanged(quint32 id)
+{
+    setModified();
+    emit paletteChanged(id);
+}
+
 /*****************************************************************************
  * Functions
  *****************************************************************************/
@@ -1020,13 +1068,10 @@ bool Doc::addFunction(Function* func, quint32 id)
         connect(func, SIGNAL(nameChanged(quint32)),
                 this, SLOT(slotFunctionNameChanged(quint32)));
 
-        // Make the function listen to fixture removals
-        connect(this, SIGNAL(fixtureRemoved(quint32)),
-                func, SLOT(slotFixtureRemoved(quint32)));
-
         // Place the function in the map and assign it the new ID
         m_functions[id] = func;
         func->setID(id);
+        updateDependencies(id);
         emit functionAdded(id);
         setModified();
 
@@ -1060,6 +1105,16 @@ bool Doc::deleteFunction(quint32 id)
         if (m_startupFunctionId == id)
             m_startupFunctionId = Function::invalidId();
 
+        /* Notify only the functions using the removed one */
+        foreach (quint32 fid, functionUsers(id))
+        {
+            Function *user = function(fid);
+            if (user != NULL)
+                user->slotFunctionRemoved(id);
+            m_dirtyDependencies.insert(fid);
+        }
+        removeDependencies(id);
+
         emit functionRemoved(id);
         setModified();
         delete func;
@@ -1107,9 +1162,10 @@ QList<quint32> Doc::getUsage(quint32 fid)
 {
     QList<quint32> usageList;
 
-    foreach (Function *f, m_functions)
+    foreach (quint32 userId, functionUsers(fid))
     {
-        if (f->id() == fid)
+        Function *f = function(userId);
+        if (f == NULL || f->id() == fid)
             continue;
 
         switch(f->type())
@@ -1194,6 +1250,7 @@ QList<quint32> Doc::getUsage(quint32 fid)
 
 void Doc::slotFunctionChanged(quint32 fid)
 {
+    m_dirtyDependencies.insert(fid);
     setModified();
     emit functionChanged(fid);
 }
@@ -1204,6 +1261,189 @@ void Doc::slotFunctionNameChanged(quint32 fid)
     emit functionNameChanged(fid);
 }
 
+/*********************************************************************
+ * Dependencies
+ *********************************************************************/
+
+/** Return the IDs in $index using $id, in ascending order */
+static QList<quint32> sortedUsers(const QHash<quint32, QSet<quint32> > &index, quint32 id)
+{
+    QList<quint32> users;
+    QHash<quint32, QSet<quint32> >::const_iterator it = index.constFind(id);
+    if (it == index.constEnd())
+        return users;
+
+    foreach (quint32 fid, it.value())
+        users.append(fid);
+    std::sort(users.begin(), users.end());
+
+    return users;
+}
+
+/** Add or remove function $fid as a user of all the $ids in $index */
+static void indexUser(QHash<quint32, QSet<quint32> > &index, const QSet<quint32> &ids,
+                      quint32 fid, bool add)
+{
+    foreach (quint32 id, ids)
+    {
+        if (add)
+        {
+            index[id].insert(fid);
+            continue;
+        }
+
+        QHash<quint32, QSet<quint32> >::iterator it = index.find(id);
+        if (it == index.end())
+            continue;
+        it.value().remove(fid);
+        if (it.value().isEmpty())
+            index.erase(it);
+    }
+}
+
+QList<quint32> Doc::functionUsers(quint32 fid)
+{
+    refreshDependencies();
+    return sortedUsers(m_functionUsers, fid);
+}
+
+QList<quint32> Doc::fixtureUsers(quint32 fxi_id)
+{
+    refreshDependencies();
+    return sortedUsers(m_fixtureUsers, fxi_id);
+}
+
+QList<quint32> Doc::fixtureGroupUsers(quint32 id)
+{
+    refreshDependencies();
+    return sortedUsers(m_fixtureGroupUsers, id);
+}
+
+Doc::FunctionDependencies Doc::collectDependencies(Function *function) const
+{
+    FunctionDependencies deps;
+
+    switch (function->type())
+    {
+        case Function::CollectionType:
+        {
+            Collection *c = qobject_cast<Collection *>(function);
+            foreach (quint32 fid, c->functions())
+                deps.functions.insert(fid);
+        }
+        break;
+        case Function::ChaserType:
+        case Function::SequenceType:
+        {
+            Chaser *c = qobject_cast<Chaser *>(function);
+            for (int i = 0; i < c->stepsCount(); i++)
+                deps.functions.insert(c->stepAt(i)->fid);
+
+            Sequence *s = qobject_cast<Sequence *>(function);
+            if (s != NULL)
+                deps.functions.insert(s->boundSceneID());
+        }
+        break;
+        case Function::ScriptType:
+        {
+            Script *s = qobject_cast<Script *>(function);
+            // both lists hold ID/line number pairs
+            QList<quint32> l = s->functionList();
+            for (int i = 0; i < l.count(); i += 2)
+                deps.functions.insert(l.at(i));
+            l = s->fixtureList();
+            for (int i = 0; i < l.count(); i += 2)
+                deps.fixtures.insert(l.at(i));
+        }
+        break;
+        case Function::ShowType:
+        {
+            Show *s = qobject_cast<Show *>(function);
+            foreach (Track *t, s->tracks())
+            {
+                foreach (ShowFunction *sf, t->showFunctions())
+                    deps.functions.insert(sf->functionID());
+            }
+        }
+        break;
+        case Function::SceneType:
+        {
+            Scene *s = qobject_cast<Scene *>(function);
+            foreach (quint32 fxi, s->components())
+                deps.fixtures.insert(fxi);
+            foreach (quint32 fxi, s->fixtures())
+                deps.fixtures.insert(fxi);
+            foreach (quint32 grp, s->fixtureGroups())
+                deps.fixtureGroups.insert(grp);
+        }
+        break;
+        case Function::EFXType:
+        {
+            foreach (quint32 fxi, function->components())
+                deps.fixtures.insert(fxi);
+        }
+        break;
+        case Function::RGBMatrixType:
+        {
+            RGBMatrix *m = qobject_cast<RGBMatrix *>(function);
+            deps.fixtureGroups.insert(m->fixtureGroup());
+        }
+        break;
+        default:
+        break;
+    }
+
+    deps.functions.remove(Function::invalidId());
+    deps.fixtures.remove(Fixture::invalidId());
+    deps.fixtureGroups.remove(FixtureGroup::invalidId());
+
+    return deps;
+}
+
+void Doc::updateDependencies(quint32 fid)
+{
+    removeDependencies(fid);
+
+    Function *func = function(fid);
+    if (func == NULL)
+        return;
+
+    FunctionDependencies deps = collectDependencies(func);
+    indexUser(m_functionUsers, deps.functions, fid, true);
+    indexUser(m_fixtureUsers, deps.fixtures, fid, true);
+    indexUser(m_fixtureGroupUsers, deps.fixtureGroups, fid, true);
+    m_dependencies[fid] = deps;
+
+    if (func->type() == Function::ShowType)
+        m_volatileDependencies.insert(fid);
+}
+
+void Doc::removeDependencies(quint32 fid)
+{
+    QHash<quint32, FunctionDependencies>::iterator it = m_dependencies.find(fid);
+    if (it == m_dependencies.end())
+        return;
+
+    indexUser(m_functionUsers, it.value().functions, fid, false);
+    indexUser(m_fixtureUsers, it.value().fixtures, fid, false);
+    indexUser(m_fixtureGroupUsers, it.value().fixtureGroups, fid, false);
+    m_dependencies.erase(it);
+    m_volatileDependencies.remove(fid);
+}
+
+void Doc::refreshDependencies()
+{
+    m_dirtyDependencies.unite(m_volatileDependencies);
+    if (m_dirtyDependencies.isEmpty())
+        return;
+
+    QSet<quint32> dirty = m_dirtyDependencies;
+    m_dirtyDependencies.clear();
+
+    foreach (quint32 fid, dirty)
+        updateDependencies(fid);
+}
+
 /*********************************************************************
  * Monitor Properties
  *********************************************************************/
@@ -1211,7 +1451,11 @@ void Doc::slotFunctionNameChanged(quint32 fid)
 MonitorProperties *Doc::monitorProperties()
 {
     if (m_monitorProps == NULL)
+    {
         m_monitorProps = new MonitorProperties();
+        connect(m_monitorProps, SIGNAL(changed()),
+                this, SIGNAL(monitorPropertiesChanged()));
+    }
 
     return m_monitorProps;
 }
@@ -1241,49 +1485,7 @@ bool Doc::loadXML(QXmlStreamReader &doc)
     }
 
     while (doc.readNextStartElement())
-    {
-        //qDebug() << "Doc tag:" << doc.name();
-        if (doc.name() == KXMLFixture)
-        {
-            Fixture::loader(doc, this);
-        }
-        else if (doc.name() == KXMLQLCFixtureGroup)
-        {
-            FixtureGroup::loader(doc, this);
-        }
-        else if (doc.name() == KXMLQLCChannelsGroup)
-        {
-            ChannelsGroup::loader(doc, this);
-        }
-        else if (doc.name() == KXMLQLCPalette)
-        {
-            QLCPalette::loader(doc, this);
-            doc.skipCurrentElement();
-        }
-        else if (doc.name() == KXMLQLCFunction)
-        {
-            //qDebug() << doc.attributes().value("Name").toString();
-            Function::loader(doc, this);
-        }
-        else if (doc.name() == KXMLQLCBus)
-        {
-            /* LEGACY */
-            Bus::instance()->loadXML(doc);
-        }
-        else if (doc.name() == KXMLIOMap)
-        {
-            m_ioMap->loadXML(doc);
-        }
-        else if (doc.name() == KXMLQLCMonitorProperties)
-        {
-            monitorProperties()->loadXML(doc, this);
-        }
-        else
-        {
-            qWarning() << Q_FUNC_INFO << "Unknown engine tag:" << doc.name();
-            doc.skipCurrentElement();
-        }
-    }
+        loadXMLElement(doc);
 
     postLoad();
 
@@ -1359,6 +1561,157 @@ bool Doc::saveXML(QXmlStreamWriter *doc)
     return true;
 }
 
+void Doc::loadXMLElement(QXmlStreamReader &doc)
+{
+    //qDebug() << "Doc tag:" << doc.name();
+    if (doc.name() == KXMLFixture)
+    {
+        Fixture::loader(doc, this);
+    }
+    else if (doc.name() == KXMLQLCFixtureGroup)
+    {
+        FixtureGroup::loader(doc, this);
+    }
+    else if (doc.name() == KXMLQLCChannelsGroup)
+    {
+        ChannelsGroup::loader(doc, this);
+    }
+    else if (doc.name() == KXMLQLCPalette)
+    {
+        QLCPalette::loader(doc, this);
+        doc.skipCurrentElement();
+    }
+    else if (doc.name() == KXMLQLCFunction)
+    {
+        //qDebug() << doc.attributes().value("Name").toString();
+        Function::loader(doc, this);
+    }
+    else if (doc.name() == KXMLQLCBus)
+    {
+        /* LEGACY */
+        Bus::instance()->loadXML(doc);
+    }
+    else if (doc.name() == KXMLIOMap)
+    {
+        m_ioMap->loadXML(doc);
+    }
+    else if (doc.name() == KXMLQLCMonitorProperties)
+    {
+        monitorProperties()->loadXML(doc, this);
+    }
+    else
+    {
+        qWarning() << Q_FUNC_INFO << "Unknown engine tag:" << doc.name();
+        doc.skipCurrentElement();
+    }
+}
+
+bool Doc::loadSnapshot(const DocSnapshot &snapshot)
+{
+    if (snapshot.isValid() == false)
+        return false;
+
+    clearErrorLog();
+
+    m_loadStatus = Loading;
+    emit loading();
+
+    if (snapshot.startupFunction() != Function::invalidId())
+        setStartupFunction(snapshot.startupFunction());
+
+    for (int i = 0; i < snapshot.recordCount(); i++)
+    {
+        QXmlStreamReader doc(snapshot.recordXML(i));
+        if (doc.readNextStartElement() == false)
+            continue;
+
+        loadXMLElement(doc);
+
+        /* Scene values are not in the XML element. Set them while the
+           Scene is silent, otherwise every value would be notified */
+        quint32 sceneID = snapshot.recordSceneID(i);
+        if (sceneID != Function::invalidId())
+        {
+            Scene *scene = qobject_cast<Scene *>(function(sceneID));
+            if (scene != NULL)
+            {
+                scene->blockSignals(true);
+                if (snapshot.loadRecordValues(i, scene) == false)
+                    qWarning() << Q_FUNC_INFO << "Corrupted values for scene" << sceneID;
+                scene->blockSignals(false);
+
+                /* The values bring in fixtures that the index has not seen */
+                m_dirtyDependencies.insert(sceneID);
+            }
+        }
+    }
+
+    postLoad();
+
+    m_loadStatus = Loaded;
+    emit loaded();
+
+    return true;
+}
+
+bool Doc::saveSnapshot(DocSnapshot *snapshot)
+{
+    Q_ASSERT(snapshot != NULL);
+
+    snapshot->setStartupFunction(startupFunction());
+
+    m_ioMap->saveXML(snapshot->beginRecord());
+    snapshot->endRecord();
+
+    foreach (Fixture *fxi, fixtures())
+    {
+        fxi->saveXML(snapshot->beginRecord());
+        snapshot->endRecord();
+    }
+
+    foreach (FixtureGroup *grp, fixtureGroups())
+    {
+        grp->saveXML(snapshot->beginRecord());
+        snapshot->endRecord();
+    }
+
+    foreach (ChannelsGroup *grp, channelsGroups())
+    {
+        grp->saveXML(snapshot->beginRecord());
+        snapshot->endRecord();
+    }
+
+    foreach (QLCPalette *palette, palettes())
+    {
+        palette->saveXML(snapshot->beginRecord());
+        snapshot->endRecord();
+    }
+
+    foreach (Function *func, functions())
+    {
+        /* Scene values are stored in binary form by the snapshot */
+        Scene *scene = qobject_cast<Scene *>(func);
+        if (scene != NULL)
+        {
+            scene->saveXML(snapshot->beginRecord(), false);
+            snapshot->endRecord(scene);
+        }
+        else
+        {
+            func->saveXML(snapshot->beginRecord());
+            snapshot->endRecord();
+        }
+    }
+
+    if (m_monitorProps != NULL)
+    {
+        m_monitorProps->saveXML(snapshot->beginRecord(), this);
+        snapshot->endRecord();
+    }
+
+    return true;
+}
+
 void Doc::appendToErrorLog(QString error)
 {
     if (m_errorLog.contains(error))
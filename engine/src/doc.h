@@ -24,7 +24,9 @@
 #include <QObject>
 #include <QList>
 #include <QFile>
+#include <QHash>
 #include <QMap>
+#include <QSet>
 
 #include "qlcfixturedefcache.h"
 #include "qlcmodifierscache.h"
@@ -42,6 +44,7 @@ class AudioCapture;
 class RGBScriptsCache;
 class AudioPluginCache;
 class MonitorProperties;
+class DocSnapshot;
 
 /** @addtogroup engine Engine
  * @{
@@ -420,6 +423,13 @@ signals:
     /** Signal that a channels group has been removed */
     void channelsGroupRemoved(quint32 chgrp_id);
 
+    /** Signal that the properties of a channels group have changed */
+    void channelsGroupChanged(quint32 chgrp_id);
+
+private slots:
+    /** Catch channels group property changes */
+    void slotChannelsGroupChanged(quint32 id);
+
 private:
     /** Channel Groups */
     QMap <quint32,ChannelsGroup*> m_channelsGroups;
@@ -461,6 +471,13 @@ signals:
     /** Inform the listeners that a new palette has been removed */
     void paletteRemoved(quint32 id);
 
+    /** Inform the listeners that a palette has changed */
+    void paletteChanged(quint32 id);
+
+private slots:
+    /** Catch palette property changes */
+    void slotPaletteChanged(quint32 id);
+
 private:
     /** Palettes */
     QMap <quint32,QLCPalette*> m_palettes;
@@ -537,7 +554,7 @@ public:
 
     /**
      * Find the usage of a Function with the specified $fid
-     * within Doc
+     * within Doc. Only the functions using it are visited.
      *
      * @param fid the Function ID to look up for
      * @return a list of Function IDs and, if available, the step position
@@ -590,6 +607,58 @@ protected:
     /** Startup function ID */
     quint32 m_startupFunctionId;
 
+    /*********************************************************************
+     * Dependencies
+     *********************************************************************/
+public:
+    /** Get the IDs of the functions using the function $fid,
+     *  e.g. the Chasers having it as a step */
+    QList<quint32> functionUsers(quint32 fid);
+
+    /** Get the IDs of the functions using the fixture $fxi_id */
+    QList<quint32> fixtureUsers(quint32 fxi_id);
+
+    /** Get the IDs of the functions using the fixture group $id */
+    QList<quint32> fixtureGroupUsers(quint32 id);
+
+private:
+    /** The IDs of what a function refers to */
+    struct FunctionDependencies
+    {
+        QSet<quint32> functions;
+        QSet<quint32> fixtures;
+        QSet<quint32> fixtureGroups;
+    };
+
+    /** Collect the references of $function */
+    FunctionDependencies collectDependencies(Function *function) const;
+
+    /** Replace the index entries of function $fid with its current references */
+    void updateDependencies(quint32 fid);
+
+    /** Remove the index entries of function $fid */
+    void removeDependencies(quint32 fid);
+
+    /** Update the functions changed since the last query */
+    void refreshDependencies();
+
+private:
+    /** Function ID -> what it refers to */
+    QHash<quint32, FunctionDependencies> m_dependencies;
+
+    /** Reverse index: function/fixture/fixture group ID -> IDs of the
+     *  functions referring to it */
+    QHash<quint32, QSet<quint32> > m_functionUsers;
+    QHash<quint32, QSet<quint32> > m_fixtureUsers;
+    QHash<quint32, QSet<quint32> > m_fixtureGroupUsers;
+
+    /** Functions changed since their index entries were updated */
+    QSet<quint32> m_dirtyDependencies;
+
+    /** Functions whose references can change without a changed() signal
+     *  (Shows, through their tracks), updated at every query */
+    QSet<quint32> m_volatileDependencies;
+
     /*********************************************************************
      * Monitor Properties
      *********************************************************************/
@@ -597,6 +666,10 @@ public:
     /** Returns a reference to the monitor properties instance */
     MonitorProperties *monitorProperties();
 
+signals:
+    /** Inform the listeners that the monitor properties have changed */
+    void monitorPropertiesChanged();
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -618,6 +691,24 @@ public:
      */
     bool saveXML(QXmlStreamWriter *doc);
 
+    /**
+     * Load contents from a binary snapshot, as an alternative to
+     * loadXML() when the snapshot matches the workspace file.
+     *
+     * @param snapshot An opened snapshot
+     * @return true if successful, otherwise false
+     */
+    bool loadSnapshot(const DocSnapshot &snapshot);
+
+    /**
+     * Add the contents to a binary snapshot. The records are written
+     * in the same order as saveXML() does.
+     *
+     * @param snapshot The snapshot to save to
+     * @return true if successful, otherwise false
+     */
+    bool saveSnapshot(DocSnapshot *snapshot);
+
     /**
      * Append a message to the Doc error log. This can be used to display
      * errors once a project is loaded.
@@ -635,6 +726,9 @@ public:
     QString errorLog();
 
 private:
+    /** Load the Engine child element the reader is positioned on */
+    void loadXMLElement(QXmlStreamReader &doc);
+
     /**
      * Calls postLoad() for each Function after everything has been loaded
      * to do post-load cleanup & mappings.
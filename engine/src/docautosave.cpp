@@ -0,0 +1,700 @@
+/*
+  Q Light Controller Plus
+  docautosave.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamWriter>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QRunnable>
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+
+#include "monitorproperties.h"
+#include "inputoutputmap.h"
+#include "channelsgroup.h"
+#include "fixturegroup.h"
+#include "docautosave.h"
+#include "qlcpalette.h"
+#include "function.h"
+#include "universe.h"
+#include "qlcfile.h"
+#include "fixture.h"
+#include "doc.h"
+
+#define KXMLQLCWorkspace "Workspace"
+
+#define AUTOSAVE_BASE_MAGIC     0x514C4342 // QLCB
+#define AUTOSAVE_JOURNAL_MAGIC  0x514C434A // QLCJ
+#define AUTOSAVE_STREAM_VERSION QDataStream::Qt_5_0
+
+#define DEFAULT_INTERVAL        5000
+#define DEFAULT_COMPACT_ENTRIES 256
+#define SLICE_BUDGET_MS         1
+#define SLICE_INTERVAL_MS       20
+
+static QString journalPath(const QString& path)
+{
+    return path + ".journal";
+}
+
+/*****************************************************************************
+ * Background writers
+ *****************************************************************************/
+
+/** Append entries to the journal */
+class AutosaveJournalWriter : public QRunnable
+{
+public:
+    AutosaveJournalWriter(const QString& path, quint32 generation,
+                          const QList<QPair<quint64, QByteArray> >& entries)
+        : m_path(path)
+        , m_generation(generation)
+        , m_entries(entries)
+    {
+    }
+
+    void run()
+    {
+        QFile file(journalPath(m_path));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Append) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Unable to write" << file.fileName();
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(AUTOSAVE_STREAM_VERSION);
+
+        if (file.size() == 0)
+            stream << quint32(AUTOSAVE_JOURNAL_MAGIC) << m_generation;
+
+        for (int i = 0; i < m_entries.count(); i++)
+            stream << m_entries.at(i).first << m_entries.at(i).second;
+
+        file.close();
+    }
+
+private:
+    QString m_path;
+    quint32 m_generation;
+    QList<QPair<quint64, QByteArray> > m_entries;
+};
+
+/** Write the whole set of records as the new base and empty the journal */
+class AutosaveBaseWriter : public QRunnable
+{
+public:
+    AutosaveBaseWriter(const QString& path, quint32 generation,
+                       const QMap<quint64, QByteArray>& records)
+        : m_path(path)
+        , m_generation(generation)
+        , m_records(records)
+    {
+    }
+
+    void run()
+    {
+        QString tempPath = m_path + ".temp";
+        QFile file(tempPath);
+        if (file.open(QIODevice::WriteOnly) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Unable to write" << tempPath;
+            return;
+        }
+
+        QDataStream stream(&file);
+        stream.setVersion(AUTOSAVE_STREAM_VERSION);
+        stream << quint32(AUTOSAVE_BASE_MAGIC) << m_generation << m_records;
+        file.close();
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            qWarning() << Q_FUNC_INFO << "Error writing" << tempPath;
+            file.remove();
+            return;
+        }
+
+        QFile::remove(m_path);
+        if (file.rename(m_path) == false)
+        {
+            qWarning() << Q_FUNC_INFO << "Could not rename" << tempPath << "to" << m_path;
+            return;
+        }
+
+        /* The base now contains everything: start a new journal */
+        QFile journal(journalPath(m_path));
+        if (journal.open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+            return;
+
+        QDataStream jstream(&journal);
+        jstream.setVersion(AUTOSAVE_STREAM_VERSION);
+        jstream << quint32(AUTOSAVE_JOURNAL_MAGIC) << m_generation;
+        journal.close();
+    }
+
+private:
+    QString m_path;
+    quint32 m_generation;
+    QMap<quint64, QByteArray> m_records;
+};
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+DocAutosave::DocAutosave(Doc *doc, QObject *parent)
+    : QObject(parent)
+    , m_doc(doc)
+    , m_enabled(false)
+    , m_loading(false)
+    , m_interval(DEFAULT_INTERVAL)
+    , m_compactThreshold(DEFAULT_COMPACT_ENTRIES)
+    , m_journalEntries(0)
+    , m_needsCompaction(true)
+    /* Never reuse the generation of a previous session */
+    , m_generation(quint32(QDateTime::currentMSecsSinceEpoch() / 1000))
+{
+    Q_ASSERT(doc != NULL);
+
+    m_pool.setMaxThreadCount(1);
+
+    m_timer.setSingleShot(true);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(slotTimeout()));
+
+    connect(m_doc, SIGNAL(fixtureAdded(quint32)), this, SLOT(slotFixtureChanged(quint32)));
+    connect(m_doc, SIGNAL(fixtureRemoved(quint32)), this, SLOT(slotFixtureChanged(quint32)));
+    connect(m_doc, SIGNAL(fixtureChanged(quint32)), this, SLOT(slotFixtureChanged(quint32)));
+
+    connect(m_doc, SIGNAL(fixtureGroupAdded(quint32)), this, SLOT(slotFixtureGroupChanged(quint32)));
+    connect(m_doc, SIGNAL(fixtureGroupRemoved(quint32)), this, SLOT(slotFixtureGroupChanged(quint32)));
+    connect(m_doc, SIGNAL(fixtureGroupChanged(quint32)), this, SLOT(slotFixtureGroupChanged(quint32)));
+
+    connect(m_doc, SIGNAL(channelsGroupAdded(quint32)), this, SLOT(slotChannelsGroupChanged(quint32)));
+    connect(m_doc, SIGNAL(channelsGroupRemoved(quint32)), this, SLOT(slotChannelsGroupChanged(quint32)));
+    connect(m_doc, SIGNAL(channelsGroupChanged(quint32)), this, SLOT(slotChannelsGroupChanged(quint32)));
+
+    connect(m_doc, SIGNAL(paletteAdded(quint32)), this, SLOT(slotPaletteChanged(quint32)));
+    connect(m_doc, SIGNAL(paletteRemoved(quint32)), this, SLOT(slotPaletteChanged(quint32)));
+    connect(m_doc, SIGNAL(paletteChanged(quint32)), this, SLOT(slotPaletteChanged(quint32)));
+
+    connect(m_doc, SIGNAL(functionAdded(quint32)), this, SLOT(slotFunctionChanged(quint32)));
+    connect(m_doc, SIGNAL(functionRemoved(quint32)), this, SLOT(slotFunctionChanged(quint32)));
+    connect(m_doc, SIGNAL(functionChanged(quint32)), this, SLOT(slotFunctionChanged(quint32)));
+    connect(m_doc, SIGNAL(functionNameChanged(quint32)), this, SLOT(slotFunctionChanged(quint32)));
+
+    connect(m_doc, SIGNAL(monitorPropertiesChanged()), this, SLOT(slotMonitorChanged()));
+
+    InputOutputMap *ioMap = m_doc->inputOutputMap();
+    connect(ioMap, SIGNAL(universeAdded(quint32)), this, SLOT(slotUniverseAdded()));
+    connect(ioMap, SIGNAL(universeRemoved(quint32)), this, SLOT(slotIOMapChanged()));
+    connect(ioMap, SIGNAL(profileChanged(quint32,QString)), this, SLOT(slotIOMapChanged()));
+    connect(ioMap, SIGNAL(pluginConfigurationChanged(QString,bool)), this, SLOT(slotIOMapChanged()));
+    connectUniverses();
+
+    connect(m_doc, SIGNAL(modified(bool)), this, SLOT(slotModified(bool)));
+
+    connect(m_doc, SIGNAL(loading()), this, SLOT(slotLoading()));
+    connect(m_doc, SIGNAL(loaded()), this, SLOT(slotLoaded()));
+    connect(m_doc, SIGNAL(cleared()), this, SLOT(slotCleared()));
+}
+
+DocAutosave::~DocAutosave()
+{
+    m_timer.stop();
+    m_pool.waitForDone();
+}
+
+void DocAutosave::setPath(const QString &path)
+{
+    m_pool.waitForDone();
+    m_path = path;
+    m_needsCompaction = true;
+}
+
+QString DocAutosave::path() const
+{
+    return m_path;
+}
+
+void DocAutosave::setInterval(int ms)
+{
+    m_interval = ms;
+}
+
+int DocAutosave::interval() const
+{
+    return m_interval;
+}
+
+void DocAutosave::setCompactThreshold(int entries)
+{
+    m_compactThreshold = entries;
+}
+
+void DocAutosave::setEnabled(bool enable)
+{
+    if (enable == m_enabled)
+        return;
+
+    m_enabled = enable;
+
+    if (enable == true)
+    {
+        m_needsCompaction = true;
+        markAllDirty();
+    }
+    else
+    {
+        m_timer.stop();
+        m_dirty.clear();
+        m_entries.clear();
+    }
+}
+
+bool DocAutosave::isEnabled() const
+{
+    return m_enabled;
+}
+
+int DocAutosave::sliceBudget()
+{
+    return SLICE_BUDGET_MS;
+}
+
+/*****************************************************************************
+ * Records
+ *****************************************************************************/
+
+quint64 DocAutosave::recordKey(Section section, quint32 id)
+{
+    return (quint64(section) << 32) | id;
+}
+
+void DocAutosave::markDirty(Section section, quint32 id)
+{
+    if (m_enabled == false || m_loading == true)
+        return;
+
+    m_dirty.insert(recordKey(section, id));
+
+    if (m_timer.isActive() == false)
+        m_timer.start(m_interval);
+}
+
+void DocAutosave::markAllDirty()
+{
+    markDirty(EngineSection, 0);
+    markDirty(IOMapSection, 0);
+    markDirty(MonitorSection, 0);
+
+    foreach (Fixture *fxi, m_doc->fixtures())
+        markDirty(FixtureSection, fxi->id());
+    foreach (FixtureGroup *grp, m_doc->fixtureGroups())
+        markDirty(FixtureGroupSection, grp->id());
+    foreach (ChannelsGroup *grp, m_doc->channelsGroups())
+        markDirty(ChannelsGroupSection, grp->id());
+    foreach (QLCPalette *palette, m_doc->palettes())
+        markDirty(PaletteSection, palette->id());
+    foreach (Function *func, m_doc->functions())
+        markDirty(FunctionSection, func->id());
+
+    markWorkspaceDirty();
+
+    /* Catch the objects removed meanwhile */
+    foreach (quint64 key, m_records.keys())
+        m_dirty.insert(key);
+}
+
+void DocAutosave::markWorkspaceDirty()
+{
+    for (int i = 0; i < workspaceSections(); i++)
+        markDirty(WorkspaceSection, i);
+}
+
+void DocAutosave::connectUniverses()
+{
+    foreach (Universe *uni, m_doc->inputOutputMap()->universes())
+    {
+        connect(uni, SIGNAL(nameChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+        connect(uni, SIGNAL(passthroughChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+        connect(uni, SIGNAL(inputPatchChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+        connect(uni, SIGNAL(outputPatchChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+        connect(uni, SIGNAL(outputPatchesCountChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+        connect(uni, SIGNAL(hasFeedbacksChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+        connect(uni, SIGNAL(feedbackIntervalChanged()), this, SLOT(slotIOMapChanged()), Qt::UniqueConnection);
+    }
+}
+
+int DocAutosave::workspaceSections() const
+{
+    return 0;
+}
+
+bool DocAutosave::saveWorkspaceSection(int index, QXmlStreamWriter *doc)
+{
+    Q_UNUSED(index);
+    Q_UNUSED(doc);
+    return false;
+}
+
+bool DocAutosave::serialize(quint64 key, QByteArray &data)
+{
+    Section section = Section(key >> 32);
+    quint32 id = quint32(key & 0xFFFFFFFF);
+
+    if (section == EngineSection)
+    {
+        data = QByteArray::number(m_doc->startupFunction());
+        return true;
+    }
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter doc(&buffer);
+    doc.setAutoFormatting(true);
+    doc.setCodec("UTF-8");
+
+    switch (section)
+    {
+        case IOMapSection:
+            m_doc->inputOutputMap()->saveXML(&doc);
+        break;
+        case FixtureSection:
+        {
+            Fixture *fxi = m_doc->fixture(id);
+            if (fxi == NULL)
+                return false;
+            fxi->saveXML(&doc);
+        }
+        break;
+        case FixtureGroupSection:
+        {
+            FixtureGroup *grp = m_doc->fixtureGroup(id);
+            if (grp == NULL)
+                return false;
+            grp->saveXML(&doc);
+        }
+        break;
+        case ChannelsGroupSection:
+        {
+            ChannelsGroup *grp = m_doc->channelsGroup(id);
+            if (grp == NULL)
+                return false;
+            grp->saveXML(&doc);
+        }
+        break;
+        case PaletteSection:
+        {
+            QLCPalette *palette = m_doc->palette(id);
+            if (palette == NULL)
+                return false;
+            palette->saveXML(&doc);
+        }
+        break;
+        case FunctionSection:
+        {
+            Function *func = m_doc->function(id);
+            if (func == NULL)
+                return false;
+            func->saveXML(&doc);
+        }
+        break;
+        case MonitorSection:
+            m_doc->monitorProperties()->saveXML(&doc, m_doc);
+        break;
+        case WorkspaceSection:
+            if (int(id) >= workspaceSections())
+                return false;
+            return saveWorkspaceSection(int(id), &doc);
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+void DocAutosave::clearRecords()
+{
+    m_timer.stop();
+    m_records.clear();
+    m_dirty.clear();
+    m_entries.clear();
+}
+
+/*****************************************************************************
+ * Saving
+ *****************************************************************************/
+
+void DocAutosave::process(bool sliced)
+{
+    if (m_enabled == false || m_loading == true || m_path.isEmpty())
+        return;
+
+    QElapsedTimer slice;
+    slice.start();
+
+    QSet<quint64>::iterator it = m_dirty.begin();
+    while (it != m_dirty.end())
+    {
+        if (sliced && slice.nsecsElapsed() >= qint64(SLICE_BUDGET_MS) * 1000000)
+            break;
+
+        quint64 key = *it;
+        it = m_dirty.erase(it);
+
+        QByteArray data;
+        if (serialize(key, data) == true)
+        {
+            if (m_records.value(key) == data)
+                continue;
+            m_records[key] = data;
+        }
+        else if (m_records.remove(key) == 0)
+        {
+            continue;
+        }
+
+        m_entries.append(qMakePair(key, data));
+    }
+
+    if (m_needsCompaction || m_journalEntries + m_entries.count() >= m_compactThreshold)
+    {
+        /* Compact only when the records are complete, otherwise
+           the base would miss what's still dirty */
+        if (m_dirty.isEmpty())
+        {
+            m_generation++;
+            m_pool.start(new AutosaveBaseWriter(m_path, m_generation, m_records));
+            m_entries.clear();
+            m_journalEntries = 0;
+            m_needsCompaction = false;
+        }
+    }
+    else if (m_entries.isEmpty() == false)
+    {
+        m_pool.start(new AutosaveJournalWriter(m_path, m_generation, m_entries));
+        m_journalEntries += m_entries.count();
+        m_entries.clear();
+    }
+
+    if (m_dirty.isEmpty() == false)
+        m_timer.start(SLICE_INTERVAL_MS);
+}
+
+void DocAutosave::flush()
+{
+    m_timer.stop();
+    process(false);
+    m_pool.waitForDone();
+}
+
+void DocAutosave::discard()
+{
+    m_pool.waitForDone();
+
+    QFile::remove(m_path);
+    QFile::remove(journalPath(m_path));
+
+    m_entries.clear();
+    m_journalEntries = 0;
+    m_needsCompaction = true;
+}
+
+void DocAutosave::slotTimeout()
+{
+    process(true);
+}
+
+/*****************************************************************************
+ * Doc changes
+ *****************************************************************************/
+
+void DocAutosave::slotFixtureChanged(quint32 id)
+{
+    markDirty(FixtureSection, id);
+}
+
+void DocAutosave::slotFixtureGroupChanged(quint32 id)
+{
+    markDirty(FixtureGroupSection, id);
+}
+
+void DocAutosave::slotChannelsGroupChanged(quint32 id)
+{
+    markDirty(ChannelsGroupSection, id);
+}
+
+void DocAutosave::slotPaletteChanged(quint32 id)
+{
+    markDirty(PaletteSection, id);
+}
+
+void DocAutosave::slotFunctionChanged(quint32 id)
+{
+    markDirty(FunctionSection, id);
+}
+
+void DocAutosave::slotIOMapChanged()
+{
+    markDirty(IOMapSection, 0);
+}
+
+void DocAutosave::slotUniverseAdded()
+{
+    connectUniverses();
+    markDirty(IOMapSection, 0);
+}
+
+void DocAutosave::slotMonitorChanged()
+{
+    markDirty(MonitorSection, 0);
+}
+
+void DocAutosave::slotModified(bool state)
+{
+    if (state == false)
+        return;
+
+    /* The startup function and the application sections have no
+       change notification of their own */
+    markDirty(EngineSection, 0);
+    markWorkspaceDirty();
+}
+
+void DocAutosave::slotLoading()
+{
+    m_loading = true;
+    m_timer.stop();
+}
+
+void DocAutosave::slotLoaded()
+{
+    m_loading = false;
+    connectUniverses();
+
+    if (m_enabled == true)
+    {
+        m_needsCompaction = true;
+        markAllDirty();
+    }
+}
+
+void DocAutosave::slotCleared()
+{
+    clearRecords();
+    discard();
+}
+
+/*****************************************************************************
+ * Restore
+ *****************************************************************************/
+
+bool DocAutosave::exists(const QString &path)
+{
+    return QFile::exists(path);
+}
+
+bool DocAutosave::restore(const QString &path, QByteArray &xml)
+{
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(AUTOSAVE_STREAM_VERSION);
+
+    quint32 magic = 0, generation = 0;
+    QMap<quint64, QByteArray> records;
+    stream >> magic >> generation >> records;
+    file.close();
+
+    if (magic != AUTOSAVE_BASE_MAGIC || stream.status() != QDataStream::Ok)
+    {
+        qWarning() << Q_FUNC_INFO << path << "is not a valid autosave";
+        return false;
+    }
+
+    /* Replay the journal, if it has been written after the base. An entry
+       interrupted by a crash is the end of the journal */
+    QFile journal(journalPath(path));
+    if (journal.open(QIODevice::ReadOnly) == true)
+    {
+        QDataStream jstream(&journal);
+        jstream.setVersion(AUTOSAVE_STREAM_VERSION);
+
+        quint32 jmagic = 0, jgeneration = 0;
+        jstream >> jmagic >> jgeneration;
+
+        if (jmagic == AUTOSAVE_JOURNAL_MAGIC && jgeneration == generation)
+        {
+            while (jstream.atEnd() == false)
+            {
+                quint64 key;
+                QByteArray data;
+                jstream >> key >> data;
+                if (jstream.status() != QDataStream::Ok)
+                    break;
+
+                if (data.isEmpty())
+                    records.remove(key);
+                else
+                    records[key] = data;
+            }
+        }
+        journal.close();
+    }
+
+    QBuffer buffer(&xml);
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter doc(&buffer);
+    doc.setCodec("UTF-8");
+    doc.writeStartDocument();
+    doc.writeDTD(QString("<!DOCTYPE %1>").arg(KXMLQLCWorkspace));
+    doc.writeStartElement(KXMLQLCWorkspace);
+    doc.writeAttribute("xmlns", QString("%1%2").arg(KXMLQLCplusNamespace).arg(KXMLQLCWorkspace));
+    doc.writeStartElement(KXMLQLCEngine);
+
+    QMap<quint64, QByteArray>::const_iterator it = records.constBegin();
+    if (it != records.constEnd() && it.key() == recordKey(EngineSection, 0))
+    {
+        quint32 startup = it.value().toUInt();
+        if (startup != Function::invalidId())
+            doc.writeAttribute(KXMLQLCStartupFunction, QString::number(startup));
+        ++it;
+    }
+
+    /* The records are complete XML elements: close the Engine start
+       tag and copy them verbatim */
+    doc.writeCharacters("");
+    quint64 workspaceKey = recordKey(WorkspaceSection, 0);
+    for (; it != records.constEnd() && it.key() < workspaceKey; ++it)
+        buffer.write(it.value());
+
+    doc.writeEndElement(); // close KXMLQLCEngine
+
+    /* The application sections follow the Engine */
+    for (; it != records.constEnd(); ++it)
+        buffer.write(it.value());
+
+    doc.writeEndElement(); // close KXMLQLCWorkspace
+    doc.writeEndDocument();
+
+    return true;
+}
@@ -0,0 +1,193 @@
+/*
+  Q Light Controller Plus
+  docautosave.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DOCAUTOSAVE_H
+#define DOCAUTOSAVE_H
+
+#include <QThreadPool>
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QPair>
+#include <QList>
+#include <QMap>
+#include <QSet>
+
+class QXmlStreamWriter;
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * Incremental autosave of the engine contents, done in the background.
+ *
+ * Every object of the Doc (fixtures, groups, palettes, functions...) is kept
+ * as an XML record, serialized on the main thread only when the object
+ * changes. Serializing is done in slices that never take more than
+ * DocAutosave::sliceBudget() milliseconds, so big changes (e.g. loading
+ * a project) are spread over several timer ticks.
+ *
+ * The changed records are appended to a journal by a background thread.
+ * Every once in a while the journal is compacted: the whole set of records,
+ * which is implicitly shared and therefore copied for free, is written as
+ * the autosave base and the journal is emptied. Base and journal carry a
+ * generation number, so that a journal older than the base is never
+ * replayed after a crash in the middle of a compaction.
+ *
+ * The application can add its own workspace sections (e.g. the Virtual
+ * Console) by reimplementing workspaceSections() and saveWorkspaceSection().
+ * They have no change notification of their own, so they're serialized
+ * again on every Doc modification.
+ *
+ * restore() rebuilds a workspace XML document from the base and the journal.
+ */
+class DocAutosave : public QObject
+{
+    Q_OBJECT
+
+public:
+    DocAutosave(Doc *doc, QObject *parent = 0);
+    ~DocAutosave();
+
+    /** Set the autosave base file path. The journal is $path.journal */
+    void setPath(const QString& path);
+    QString path() const;
+
+    /** Set the time to wait, after a change, before saving it */
+    void setInterval(int ms);
+    int interval() const;
+
+    /** Set the number of journal entries that triggers a compaction */
+    void setCompactThreshold(int entries);
+
+    /** Start or stop tracking the Doc changes */
+    void setEnabled(bool enable);
+    bool isEnabled() const;
+
+    /** Maximum time, in milliseconds, spent serializing on each tick */
+    static int sliceBudget();
+
+    /** Serialize and write everything that is pending, then wait for
+     *  the background writes to complete */
+    void flush();
+
+    /** Remove the autosave files, e.g. after a successful save */
+    void discard();
+
+    /** Check if there is something to restore at $path */
+    static bool exists(const QString& path);
+
+    /**
+     * Rebuild the workspace saved at $path, applying its journal.
+     *
+     * @param path The autosave base file path
+     * @param xml The workspace XML document, filled on success
+     * @return true on success, false if nothing could be restored
+     */
+    static bool restore(const QString& path, QByteArray &xml);
+
+protected:
+    /** Number of the application sections saved after the Engine */
+    virtual int workspaceSections() const;
+
+    /** Write the application section $index into $doc */
+    virtual bool saveWorkspaceSection(int index, QXmlStreamWriter *doc);
+
+private:
+    enum Section
+    {
+        EngineSection = 0,
+        IOMapSection,
+        FixtureSection,
+        FixtureGroupSection,
+        ChannelsGroupSection,
+        PaletteSection,
+        FunctionSection,
+        MonitorSection,
+        WorkspaceSection
+    };
+
+    /** Records are sorted like Doc::saveXML() writes them */
+    static quint64 recordKey(Section section, quint32 id);
+
+    void markDirty(Section section, quint32 id);
+    void markAllDirty();
+    void markWorkspaceDirty();
+
+    /** Follow the changes of the universes saved in the IO map */
+    void connectUniverses();
+
+    /** Serialize the object identified by $key into $data.
+     *  Return false if the object does not exist anymore */
+    bool serialize(quint64 key, QByteArray &data);
+
+    void clearRecords();
+
+    /** Serialize the dirty objects, within the slice budget if
+     *  $sliced is true, and queue the file writes */
+    void process(bool sliced);
+
+private slots:
+    void slotTimeout();
+
+    void slotFixtureChanged(quint32 id);
+    void slotFixtureGroupChanged(quint32 id);
+    void slotChannelsGroupChanged(quint32 id);
+    void slotPaletteChanged(quint32 id);
+    void slotFunctionChanged(quint32 id);
+    void slotIOMapChanged();
+    void slotUniverseAdded();
+    void slotMonitorChanged();
+    void slotModified(bool state);
+
+    void slotLoading();
+    void slotLoaded();
+    void slotCleared();
+
+private:
+    Doc *m_doc;
+    QString m_path;
+    bool m_enabled;
+    bool m_loading;
+    int m_interval;
+    int m_compactThreshold;
+    QTimer m_timer;
+
+    /** The latest serialized state of every object */
+    QMap<quint64, QByteArray> m_records;
+
+    /** The objects changed since they've been last serialized */
+    QSet<quint64> m_dirty;
+
+    /** Pending journal entries. An empty record means removed */
+    QList<QPair<quint64, QByteArray> > m_entries;
+    int m_journalEntries;
+    bool m_needsCompaction;
+    quint32 m_generation;
+
+    /** Single thread pool, to write the files in order */
+    QThreadPool m_pool;
+};
+
+/** @} */
+
+#endif
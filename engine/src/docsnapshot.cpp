@@ -0,0 +1,387 @@
+/*
+  Q Light Controller Plus
+  docsnapshot.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCryptographicHash>
+#include <QXmlStreamWriter>
+#include <QtEndian>
+#include <QFileInfo>
+#include <QDebug>
+#include <QHash>
+#include <QDir>
+#include <climits>
+#include <cstring>
+
+#include "docsnapshot.h"
+#include "scenevalue.h"
+#include "function.h"
+#include "qlcfile.h"
+#include "scene.h"
+
+#define SNAPSHOT_MAGIC      "QLC+SNAP"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION    1
+#define SNAPSHOT_HASH_SIZE  20
+#define SNAPSHOT_HEADER_SIZE (SNAPSHOT_MAGIC_SIZE + 2 * 4 + SNAPSHOT_HASH_SIZE + 3 * 4)
+#define RECORD_HEADER_SIZE  (3 * 4)
+
+static void appendUInt32(QByteArray& data, quint32 value)
+{
+    uchar buf[4];
+    qToLittleEndian<quint32>(value, buf);
+    data.append((const char *)buf, 4);
+}
+
+static quint32 readUInt32(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+static int paddedLength(int length)
+{
+    return (length + 3) & ~3;
+}
+
+DocSnapshot::DocSnapshot()
+    : m_startupFunction(Function::invalidId())
+    , m_recordWriter(NULL)
+    , m_recordCount(0)
+    , m_data(NULL)
+    , m_workspaceData(NULL)
+    , m_workspaceLength(0)
+{
+}
+
+DocSnapshot::~DocSnapshot()
+{
+    delete m_recordWriter;
+    close();
+}
+
+QString DocSnapshot::snapshotPath(const QString& workspacePath)
+{
+    QFileInfo fi(workspacePath);
+    return fi.absoluteDir().absoluteFilePath(fi.completeBaseName() + KExtSnapshot);
+}
+
+QByteArray DocSnapshot::workspaceHash(const QString& workspacePath)
+{
+    QFile file(workspacePath);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (file.atEnd() == false)
+        hash.addData(file.read(1 << 20));
+
+    return hash.result();
+}
+
+/*********************************************************************
+ * Saving
+ *********************************************************************/
+
+void DocSnapshot::setStartupFunction(quint32 id)
+{
+    m_startupFunction = id;
+}
+
+QXmlStreamWriter *DocSnapshot::beginRecord()
+{
+    Q_ASSERT(m_recordWriter == NULL);
+
+    m_recordBuffer.close();
+    m_recordBuffer.setData(QByteArray());
+    m_recordBuffer.open(QIODevice::WriteOnly);
+
+    m_recordWriter = new QXmlStreamWriter(&m_recordBuffer);
+    m_recordWriter->setCodec("UTF-8");
+
+    return m_recordWriter;
+}
+
+void DocSnapshot::endRecord(const Scene *scene)
+{
+    Q_ASSERT(m_recordWriter != NULL);
+
+    delete m_recordWriter;
+    m_recordWriter = NULL;
+    m_recordBuffer.close();
+
+    const QByteArray &xml = m_recordBuffer.data();
+    QByteArray values;
+
+    if (scene != NULL)
+    {
+        // values() is sorted by fixture and channel. Group them by fixture
+        // and write them in the order fixtures have been added, like saveXML does
+        QHash<quint32, QList<SceneValue> > fixtureValues;
+        foreach (SceneValue scv, scene->values())
+            fixtureValues[scv.fxi].append(scv);
+
+        foreach (quint32 fxId, scene->fixtures())
+        {
+            QList<SceneValue> list = fixtureValues.value(fxId);
+
+            appendUInt32(values, fxId);
+            appendUInt32(values, list.count());
+            foreach (SceneValue scv, list)
+            {
+                appendUInt32(values, scv.channel);
+                // a hidden Scene is saved with zero values, see Scene::saveXML
+                appendUInt32(values, scene->isVisible() ? scv.value : 0);
+            }
+        }
+    }
+
+    appendUInt32(m_records, scene != NULL ? scene->id() : Function::invalidId());
+    appendUInt32(m_records, xml.size());
+    appendUInt32(m_records, values.size());
+    m_records.append(xml);
+    m_records.append(QByteArray(paddedLength(xml.size()) - xml.size(), '\0'));
+    m_records.append(values);
+
+    m_recordCount++;
+}
+
+void DocSnapshot::setWorkspaceXML(const QByteArray &xml)
+{
+    m_workspaceXML = xml;
+}
+
+bool DocSnapshot::save(const QString &workspacePath)
+{
+    QByteArray hash = workspaceHash(workspacePath);
+    if (hash.size() != SNAPSHOT_HASH_SIZE)
+        return false;
+
+    QByteArray header(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    appendUInt32(header, SNAPSHOT_VERSION);
+    appendUInt32(header, m_startupFunction);
+    header.append(hash);
+    appendUInt32(header, m_recordCount);
+    appendUInt32(header, m_records.size());
+    appendUInt32(header, m_workspaceXML.size());
+
+    QString path = snapshotPath(workspacePath);
+    QString tempPath = path + ".temp";
+
+    QFile file(tempPath);
+    if (file.open(QIODevice::WriteOnly) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to write" << tempPath;
+        return false;
+    }
+
+    if (file.write(header) != header.size() ||
+        file.write(m_records) != m_records.size() ||
+        file.write(m_workspaceXML) != m_workspaceXML.size())
+    {
+        qWarning() << Q_FUNC_INFO << "Error writing" << tempPath;
+        file.close();
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    QFile::remove(path);
+    if (file.rename(path) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Could not rename" << tempPath << "to" << path;
+        return false;
+    }
+
+    return true;
+}
+
+/*********************************************************************
+ * Loading
+ *********************************************************************/
+
+bool DocSnapshot::open(const QString &workspacePath)
+{
+    close();
+
+    m_file.setFileName(snapshotPath(workspacePath));
+    if (m_file.exists() == false || m_file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    qint64 size = m_file.size();
+    if (size < SNAPSHOT_HEADER_SIZE || size > INT_MAX)
+    {
+        close();
+        return false;
+    }
+
+    const uchar *data = m_file.map(0, size);
+    if (data == NULL)
+    {
+        close();
+        return false;
+    }
+    m_data = data;
+
+    const uchar *pos = data + SNAPSHOT_MAGIC_SIZE;
+    if (memcmp(data, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0 ||
+        readUInt32(pos) != SNAPSHOT_VERSION)
+    {
+        qDebug() << Q_FUNC_INFO << m_file.fileName() << "has an unsupported format";
+        close();
+        return false;
+    }
+
+    m_startupFunction = readUInt32(pos + 4);
+    pos += 8;
+
+    QByteArray hash((const char *)pos, SNAPSHOT_HASH_SIZE);
+    if (hash != workspaceHash(workspacePath))
+    {
+        qDebug() << Q_FUNC_INFO << m_file.fileName() << "does not match" << workspacePath;
+        close();
+        return false;
+    }
+    pos += SNAPSHOT_HASH_SIZE;
+
+    quint32 recordCount = readUInt32(pos);
+    quint32 recordsLength = readUInt32(pos + 4);
+    quint32 workspaceLength = readUInt32(pos + 8);
+    pos += 12;
+
+    if (quint64(SNAPSHOT_HEADER_SIZE) + recordsLength + workspaceLength != quint64(size))
+    {
+        qWarning() << Q_FUNC_INFO << m_file.fileName() << "is truncated";
+        close();
+        return false;
+    }
+
+    /* Build the records index, checking that each one lies within the records area */
+    const uchar *recordsEnd = pos + recordsLength;
+    m_recordIndex.reserve(recordCount);
+
+    for (quint32 i = 0; i < recordCount; i++)
+    {
+        if (recordsEnd - pos < RECORD_HEADER_SIZE)
+            break;
+
+        Record rec;
+        rec.sceneID = readUInt32(pos);
+        quint32 xmlLength = readUInt32(pos + 4);
+        quint32 valuesLength = readUInt32(pos + 8);
+        pos += RECORD_HEADER_SIZE;
+
+        if (quint64(paddedLength(xmlLength)) + valuesLength > quint64(recordsEnd - pos))
+            break;
+
+        rec.xml = pos;
+        rec.xmlLength = xmlLength;
+        pos += paddedLength(xmlLength);
+        rec.values = pos;
+        rec.valuesLength = valuesLength;
+        pos += valuesLength;
+
+        m_recordIndex.append(rec);
+    }
+
+    if (m_recordIndex.count() != int(recordCount) || pos != recordsEnd)
+    {
+        qWarning() << Q_FUNC_INFO << m_file.fileName() << "is corrupted";
+        close();
+        return false;
+    }
+
+    m_workspaceData = pos;
+    m_workspaceLength = workspaceLength;
+
+    return true;
+}
+
+void DocSnapshot::close()
+{
+    if (m_data != NULL)
+        m_file.unmap(const_cast<uchar *>(m_data));
+    if (m_file.isOpen())
+        m_file.close();
+
+    m_data = NULL;
+    m_recordIndex.clear();
+    m_workspaceData = NULL;
+    m_workspaceLength = 0;
+}
+
+bool DocSnapshot::isValid() const
+{
+    return m_data != NULL;
+}
+
+quint32 DocSnapshot::startupFunction() const
+{
+    return m_startupFunction;
+}
+
+int DocSnapshot::recordCount() const
+{
+    return m_recordIndex.count();
+}
+
+QByteArray DocSnapshot::recordXML(int index) const
+{
+    if (index < 0 || index >= m_recordIndex.count())
+        return QByteArray();
+
+    const Record &rec = m_recordIndex.at(index);
+    return QByteArray::fromRawData((const char *)rec.xml, rec.xmlLength);
+}
+
+quint32 DocSnapshot::recordSceneID(int index) const
+{
+    if (index < 0 || index >= m_recordIndex.count())
+        return Function::invalidId();
+
+    return m_recordIndex.at(index).sceneID;
+}
+
+bool DocSnapshot::loadRecordValues(int index, Scene *scene) const
+{
+    if (scene == NULL || index < 0 || index >= m_recordIndex.count())
+        return false;
+
+    const Record &rec = m_recordIndex.at(index);
+    const uchar *pos = rec.values;
+    const uchar *end = rec.values + rec.valuesLength;
+
+    while (end - pos >= 8)
+    {
+        quint32 fxId = readUInt32(pos);
+        quint32 count = readUInt32(pos + 4);
+        pos += 8;
+
+        if (quint64(count) * 8 > quint64(end - pos))
+            return false;
+
+        scene->addFixture(fxId);
+        for (quint32 i = 0; i < count; i++, pos += 8)
+            scene->setValue(SceneValue(fxId, readUInt32(pos), uchar(readUInt32(pos + 4))));
+    }
+
+    return pos == end;
+}
+
+QByteArray DocSnapshot::workspaceXML() const
+{
+    return QByteArray::fromRawData((const char *)m_workspaceData, m_workspaceLength);
+}
@@ -0,0 +1,164 @@
+/*
+  Q Light Controller Plus
+  docsnapshot.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DOCSNAPSHOT_H
+#define DOCSNAPSHOT_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QBuffer>
+#include <QString>
+#include <QFile>
+
+class QXmlStreamWriter;
+class Scene;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * A binary snapshot of a workspace, saved next to the .qxw file to speed up
+ * loading large projects.
+ *
+ * The snapshot holds one record for each object of the engine (fixtures,
+ * groups, palettes, functions...). A record is the XML element of the object
+ * except for Scenes, whose channel values are stored as a packed binary
+ * array, since they make the bulk of a big project. The rest of the
+ * workspace (Virtual Console, Simple Desk) is stored as an XML document
+ * without the Engine element.
+ *
+ * The file is memory mapped when loading. It is versioned and carries the
+ * SHA-1 hash of the workspace file it has been written for, so that a stale
+ * snapshot (e.g. the .qxw has been edited by hand) is never used.
+ *
+ * Layout, all integers are 32 bit little endian and 4 bytes aligned:
+ * @code
+ * header:  magic[8] version startupFunction sha1[20]
+ *          recordCount recordsLength workspaceLength
+ * record:  sceneID xmlLength valuesLength xml[padded] values
+ * values:  { fixtureID count { channel value } * count } * N
+ * @endcode
+ */
+class DocSnapshot
+{
+public:
+    DocSnapshot();
+    ~DocSnapshot();
+
+    /** Get the path of the snapshot belonging to $workspacePath */
+    static QString snapshotPath(const QString& workspacePath);
+
+    /** Get the hash of the contents of $workspacePath */
+    static QByteArray workspaceHash(const QString& workspacePath);
+
+    /*********************************************************************
+     * Saving
+     *********************************************************************/
+public:
+    /** Set the ID of the workspace startup function */
+    void setStartupFunction(quint32 id);
+
+    /**
+     * Start a new record. The returned writer must be used to save
+     * exactly one XML element and is valid until endRecord().
+     */
+    QXmlStreamWriter *beginRecord();
+
+    /**
+     * Close the record started with beginRecord(). If $scene is not NULL
+     * its values are appended to the record in binary form, so the Scene
+     * must have been saved without them.
+     */
+    void endRecord(const Scene *scene = NULL);
+
+    /** Set the workspace XML document, without the Engine element */
+    void setWorkspaceXML(const QByteArray& xml);
+
+    /**
+     * Write the snapshot of $workspacePath, which must have been
+     * already saved, since its hash is stored in the snapshot.
+     */
+    bool save(const QString& workspacePath);
+
+private:
+    quint32 m_startupFunction;
+    QBuffer m_recordBuffer;
+    QXmlStreamWriter *m_recordWriter;
+    QByteArray m_records;
+    quint32 m_recordCount;
+    QByteArray m_workspaceXML;
+
+    /*********************************************************************
+     * Loading
+     *********************************************************************/
+public:
+    /**
+     * Map the snapshot of $workspacePath. This fails if the snapshot
+     * does not exist, has a different version or does not match the
+     * current contents of the workspace file.
+     */
+    bool open(const QString& workspacePath);
+
+    /** Unmap the snapshot file */
+    void close();
+
+    /** Check if a snapshot has been successfully opened */
+    bool isValid() const;
+
+    /** Get the ID of the workspace startup function */
+    quint32 startupFunction() const;
+
+    /** Get the number of engine records */
+    int recordCount() const;
+
+    /** Get the XML element of the record at $index. The data is
+     *  not copied and it is valid until the snapshot is closed. */
+    QByteArray recordXML(int index) const;
+
+    /** Get the ID of the Scene whose values are stored in the record
+     *  at $index, or Function::invalidId() if there are none */
+    quint32 recordSceneID(int index) const;
+
+    /** Set the values stored in the record at $index to $scene */
+    bool loadRecordValues(int index, Scene *scene) const;
+
+    /** Get the workspace XML document, without the Engine element */
+    QByteArray workspaceXML() const;
+
+private:
+    typedef struct
+    {
+        quint32 sceneID;
+        const uchar *xml;
+        int xmlLength;
+        const uchar *values;
+        int valuesLength;
+    } Record;
+
+    QFile m_file;
+    const uchar *m_data;
+    QVector<Record> m_recordIndex;
+    const uchar *m_workspaceData;
+    int m_workspaceLength;
+};
+
+/** @} */
+
+#endif
@@ -1089,6 +1089,11 @@ void EFX::write(MasterTimer *timer, QList<Universe*> universes)
     //m_fader->write(universes);
 }
 
+bool EFX::supportsParallelWrite() const
+{
+    return true;
+}
+
 void EFX::postRun(MasterTimer *timer, QList<Universe *> universes)
 {
     /* Reset all fixtures */
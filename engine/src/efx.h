@@ -563,6 +563,9 @@ public:
     /** @reimp */
     void write(MasterTimer* timer, QList<Universe *> universes);
 
+    /** @reimp */
+    bool supportsParallelWrite() const;
+
     /** @reimp */
     void postRun(MasterTimer* timer, QList<Universe*> universes);
 
@@ -849,6 +849,16 @@ void Function::slotFixtureRemoved(quint32 fid)
     Q_UNUSED(fid);
 }
 
+void Function::slotFixtureGroupRemoved(quint32 id)
+{
+    Q_UNUSED(id);
+}
+
+void Function::slotFunctionRemoved(quint32 fid)
+{
+    Q_UNUSED(fid);
+}
+
 /*****************************************************************************
  * Load & Save
  *****************************************************************************/
@@ -1014,6 +1024,11 @@ void Function::write(MasterTimer *timer, QList<Universe *> universes)
     Q_UNUSED(universes);
 }
 
+bool Function::supportsParallelWrite() const
+{
+    return false;
+}
+
 void Function::postRun(MasterTimer *timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
@@ -572,9 +572,15 @@ private:
      * Fixtures
      *********************************************************************/
 public slots:
-    /** Slot that captures Doc::fixtureRemoved signals */
+    /** Called by Doc when a fixture used by this function is removed */
     virtual void slotFixtureRemoved(quint32 fxi_id);
 
+    /** Called by Doc when a fixture group used by this function is removed */
+    virtual void slotFixtureGroupRemoved(quint32 id);
+
+    /** Called by Doc when a function used by this function is removed */
+    virtual void slotFunctionRemoved(quint32 fid);
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -682,6 +688,15 @@ public:
      */
     virtual void write(MasterTimer* timer, QList<Universe*> universes);
 
+    /**
+     * Return true if write() only changes this function and its own
+     * faders, without starting, stopping or adjusting other functions.
+     * When the MasterTimer parallel write mode is enabled, write() of
+     * such functions is called concurrently with other functions.
+     * The default implementation returns false.
+     */
+    virtual bool supportsParallelWrite() const;
+
     /**
      * Called by MasterTimer when the function is stopped. No more write()
      * calls will arrive to the function after this call. The function may
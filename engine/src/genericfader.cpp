@@ -36,6 +36,7 @@ GenericFader::GenericFader(QObject *parent)
     , m_deleteRequest(false)
     , m_blendMode(Universe::NormalBlend)
     , m_monitoring(false)
+    , m_capacityHint(0)
 {
 }
 
@@ -114,6 +115,7 @@ void GenericFader::remove(FadeChannel *ch)
 
 void GenericFader::removeAll()
 {
+    m_capacityHint = qMax(m_capacityHint, m_channels.count());
     m_channels.clear();
 }
 
@@ -130,16 +132,20 @@ void GenericFader::requestDelete()
 FadeChannel *GenericFader::getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel)
 {
     FadeChannel fc(doc, fixtureID, channel);
+    return getChannelFader(fc, universe);
+}
+
+FadeChannel *GenericFader::getChannelFader(const FadeChannel &fc, Universe *universe)
+{
     quint32 hash = channelHash(fc.fixture(), fc.channel());
     QHash<quint32,FadeChannel>::iterator channelIterator = m_channels.find(hash);
     if (channelIterator != m_channels.end())
         return &channelIterator.value();
 
-    fc.setCurrent(universe->preGMValue(fc.address()));
-
-    m_channels[hash] = fc;
+    channelIterator = m_channels.insert(hash, fc);
+    channelIterator.value().setCurrent(universe->preGMValue(fc.address()));
     //qDebug() << "Added new fader with hash" << hash;
-    return &m_channels[hash];
+    return &channelIterator.value();
 }
 
 const QHash<quint32, FadeChannel> &GenericFader::channels() const
@@ -317,3 +323,92 @@ void GenericFader::resetCrossfade()
         fc.removeFlag(FadeChannel::CrossFade);
     }
 }
+
+void GenericFader::recycle()
+{
+    removeAll();
+    m_channels.reserve(m_capacityHint);
+    m_capacityHint = 0;
+
+    // nobody should receive the signals of a previous use
+    disconnect();
+
+    m_name.clear();
+    m_fid = Function::invalidId();
+    m_priority = Universe::Auto;
+    m_intensity = 1.0;
+    m_parentIntensity = 1.0;
+    m_paused = false;
+    m_enabled = true;
+    m_fadeOut = false;
+    m_deleteRequest = false;
+    m_blendMode = Universe::NormalBlend;
+    m_monitoring = false;
+}
+
+/****************************************************************************
+ * GenericFaderPool
+ ****************************************************************************/
+
+/** Maximum number of faders kept for reuse */
+#define MAX_POOL_SIZE 64
+
+GenericFaderPool::GenericFaderPool()
+    : m_allocated(0)
+    , m_recycled(0)
+{
+}
+
+GenericFaderPool::~GenericFaderPool()
+{
+    qDeleteAll(m_free);
+}
+
+GenericFader *GenericFaderPool::acquire()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_free.isEmpty() == false)
+    {
+        m_recycled++;
+        return m_free.takeLast();
+    }
+
+    m_allocated++;
+    return new GenericFader();
+}
+
+void GenericFaderPool::release(GenericFader *fader)
+{
+    if (fader == NULL)
+        return;
+
+    fader->recycle();
+
+    QMutexLocker locker(&m_mutex);
+    if (m_free.count() >= MAX_POOL_SIZE)
+    {
+        delete fader;
+        return;
+    }
+
+    m_free.append(fader);
+}
+
+int GenericFaderPool::freeCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_free.count();
+}
+
+quint64 GenericFaderPool::allocatedCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_allocated;
+}
+
+quint64 GenericFaderPool::recycledCount()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_recycled;
+}
@@ -21,11 +21,13 @@
 #define GENERICFADER
 
 #include <QObject>
+#include <QMutex>
 #include <QList>
 #include <QHash>
 
 #include "universe.h"
 
+class GenericFaderPool;
 class FadeChannel;
 
 /** @addtogroup engine Engine
@@ -90,6 +92,10 @@ public:
      *  Also, new channels will have a start value set depending on their type */
     FadeChannel *getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel);
 
+    /** Same as the above, but using $fc as an already resolved template.
+     *  This spares the Fixture lookups to callers that cache their channels */
+    FadeChannel *getChannelFader(const FadeChannel& fc, Universe *universe);
+
     /** Get all channels in a non-modifiable hashmap */
     const QHash <quint32,FadeChannel>& channels() const;
 
@@ -144,6 +150,13 @@ signals:
      *  Data is preGM and includes the whole universe */
     void preWriteData(quint32 index, const QByteArray& universeData);
 
+private:
+    /** Reset this fader to its initial state, to be used again.
+     *  The channels storage is reserved as big as the last use */
+    void recycle();
+
+    friend class GenericFaderPool;
+
 private:
     QString m_name;
     quint32 m_fid;
@@ -157,6 +170,45 @@ private:
     bool m_deleteRequest;
     Universe::BlendMode m_blendMode;
     bool m_monitoring;
+
+    /** The highest number of channels of the last use */
+    int m_capacityHint;
+};
+
+/**
+ * A pool of GenericFader objects, owned by a Universe.
+ *
+ * Functions request and dismiss faders at each step, so instead of being
+ * deleted, faders that are no longer referenced come back to the pool and
+ * are handed out again by the next request.
+ * Faders can be released by any thread, so the pool is thread safe.
+ */
+class GenericFaderPool
+{
+public:
+    GenericFaderPool();
+    ~GenericFaderPool();
+
+    /** Get a fader ready to be used, recycled if possible */
+    GenericFader *acquire();
+
+    /** Give back a fader that is not referenced anymore */
+    void release(GenericFader *fader);
+
+    /** Number of faders waiting to be used again */
+    int freeCount();
+
+    /** Number of faders allocated by this pool */
+    quint64 allocatedCount();
+
+    /** Number of faders handed out again instead of being allocated */
+    quint64 recycledCount();
+
+private:
+    QMutex m_mutex;
+    QList<GenericFader *> m_free;
+    quint64 m_allocated;
+    quint64 m_recycled;
 };
 
 /** @} */
@@ -46,9 +46,21 @@
 InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
   : QObject(doc)
   , m_blackout(false)
-  , m_universeChanged(false)
+  , m_universeChanged(0)
+  , m_universeLock(QReadWriteLock::Recursive)
+  , m_universeLockWaits(0)
+  , m_universeLockWaitTime(0)
+  , m_frameUniverses(0)
+  , m_frameDumped(0)
+  , m_frameTime(new QElapsedTimer())
+  , m_frameSkew(0)
+  , m_maxFrameSkew(0)
+  , m_inputMonitors(0)
+  , m_feedbackQueued(false)
+  , m_feedbackTime(new QElapsedTimer())
   , m_beatTime(new QElapsedTimer())
 {
+    m_feedbackTime->start();
     m_grandMaster = new GrandMaster(this);
     for (quint32 i = 0; i < universes; i++)
         addUniverse();
@@ -56,12 +68,16 @@ InputOutputMap::InputOutputMap(Doc *doc, quint32 universes)
     connect(doc->ioPluginCache(), SIGNAL(pluginConfigurationChanged(QLCIOPlugin*)),
             this, SLOT(slotPluginConfigurationChanged(QLCIOPlugin*)));
     connect(doc->masterTimer(), SIGNAL(beat()), this, SLOT(slotMasterTimerBeat()));
+    connect(this, SIGNAL(feedbackPending()), this, SLOT(slotSendFeedback()),
+            Qt::QueuedConnection);
 }
 
 InputOutputMap::~InputOutputMap()
 {
     removeAllUniverses();
     delete m_grandMaster;
+    delete m_frameTime;
+    delete m_feedbackTime;
     delete m_beatTime;
 }
 
@@ -124,6 +140,25 @@ bool InputOutputMap::blackout() const
  * Universes
  *****************************************************************************/
 
+/** Keep the universes locked for the lifetime of the locker */
+class UniverseListLocker
+{
+public:
+    UniverseListLocker(InputOutputMap *map, bool write = false)
+        : m_map(map)
+    {
+        m_map->lockUniverses(write);
+    }
+
+    ~UniverseListLocker()
+    {
+        m_map->m_universeLock.unlock();
+    }
+
+private:
+    InputOutputMap *m_map;
+};
+
 quint32 InputOutputMap::invalidUniverse()
 {
     return UINT_MAX;
@@ -132,7 +167,7 @@ quint32 InputOutputMap::invalidUniverse()
 bool InputOutputMap::addUniverse(quint32 id)
 {
     {
-        QMutexLocker locker(&m_universeMutex);
+        UniverseListLocker locker(this, true);
         Universe *uni = NULL;
 
         if (id == InputOutputMap::invalidUniverse())
@@ -156,6 +191,7 @@ bool InputOutputMap::addUniverse(quint32 id)
                 uni = new Universe(universesCount(), m_grandMaster);
                 connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
                 connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
+                connect(uni, SIGNAL(outputDumped()), this, SLOT(slotUniverseOutputDumped()), Qt::DirectConnection);
                 m_universeArray.append(uni);
             }
         }
@@ -163,6 +199,7 @@ bool InputOutputMap::addUniverse(quint32 id)
         uni = new Universe(id, m_grandMaster);
         connect(doc()->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
         connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
+        connect(uni, SIGNAL(outputDumped()), this, SLOT(slotUniverseOutputDumped()), Qt::DirectConnection);
         m_universeArray.append(uni);
     }
 
@@ -173,7 +210,7 @@ bool InputOutputMap::addUniverse(quint32 id)
 bool InputOutputMap::removeUniverse(int index)
 {
     {
-        QMutexLocker locker(&m_universeMutex);
+        UniverseListLocker locker(this, true);
 
         if (index < 0 || index >= m_universeArray.count())
             return false;
@@ -194,7 +231,7 @@ bool InputOutputMap::removeUniverse(int index)
 
 bool InputOutputMap::removeAllUniverses()
 {
-    QMutexLocker locker(&m_universeMutex);
+    UniverseListLocker locker(this, true);
     qDeleteAll(m_universeArray);
     m_universeArray.clear();
     return true;
@@ -203,7 +240,7 @@ bool InputOutputMap::removeAllUniverses()
 void InputOutputMap::startUniverses()
 {
     foreach (Universe *uni, m_universeArray)
-        uni->start();
+        uni->startThread();
 }
 
 quint32 InputOutputMap::getUniverseID(int index)
@@ -289,22 +326,22 @@ Universe *InputOutputMap::universe(quint32 id)
     return NULL;
 }
 
-QList<Universe*> InputOutputMap::claimUniverses()
+QList<Universe*> InputOutputMap::claimUniverses(bool exclusive)
 {
-    m_universeMutex.lock();
+    lockUniverses(exclusive);
     return m_universeArray;
 }
 
 void InputOutputMap::releaseUniverses(bool changed)
 {
-    m_universeChanged = changed;
-    m_universeMutex.unlock();
+    m_universeChanged.storeRelease(changed ? 1 : 0);
+    m_universeLock.unlock();
 }
 
 void InputOutputMap::resetUniverses()
 {
     {
-        QMutexLocker locker(&m_universeMutex);
+        UniverseListLocker locker(this, true);
         for (int i = 0; i < m_universeArray.size(); i++)
             m_universeArray.at(i)->reset();
     }
@@ -315,6 +352,112 @@ void InputOutputMap::resetUniverses()
     setGrandMasterChannelMode(GrandMaster::Intensity);
 }
 
+/*********************************************************************
+ * Lock statistics
+ *********************************************************************/
+
+quint64 InputOutputMap::universeLockWaits() const
+{
+    QMutexLocker locker(const_cast<QMutex*>(&m_lockStatsMutex));
+    return m_universeLockWaits;
+}
+
+qint64 InputOutputMap::universeLockWaitTime() const
+{
+    QMutexLocker locker(const_cast<QMutex*>(&m_lockStatsMutex));
+    return m_universeLockWaitTime;
+}
+
+void InputOutputMap::lockUniverses(bool write)
+{
+    if (write ? m_universeLock.tryLockForWrite() : m_universeLock.tryLockForRead())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if (write)
+        m_universeLock.lockForWrite();
+    else
+        m_universeLock.lockForRead();
+
+    QMutexLocker locker(&m_lockStatsMutex);
+    m_universeLockWaits++;
+    m_universeLockWaitTime += timer.nsecsElapsed() / 1000;
+}
+
+/*********************************************************************
+ * Frame commit
+ *********************************************************************/
+
+void InputOutputMap::beginFrame(const QList<Universe *> &universes)
+{
+    int count = 0;
+    foreach (Universe *universe, universes)
+    {
+        if (universe->outputPatchesCount() > 0)
+            count++;
+    }
+
+    bool late = false;
+    {
+        QMutexLocker locker(&m_frameMutex);
+        late = m_frameDumped > 0;
+        m_frameDumped = 0;
+        m_frameUniverses = count;
+    }
+
+    if (late)
+        commitFrame(true);
+}
+
+qint64 InputOutputMap::frameSkew() const
+{
+    QMutexLocker locker(const_cast<QMutex*>(&m_frameMutex));
+    return m_frameSkew;
+}
+
+qint64 InputOutputMap::maxFrameSkew() const
+{
+    QMutexLocker locker(const_cast<QMutex*>(&m_frameMutex));
+    return m_maxFrameSkew;
+}
+
+void InputOutputMap::commitFrame(bool late)
+{
+    if (late)
+        qDebug() << "[IOMAP] Committing an incomplete frame";
+
+    foreach (QLCIOPlugin *plugin, doc()->ioPluginCache()->plugins())
+    {
+        if (plugin->capabilities() & QLCIOPlugin::Output)
+            plugin->commitFrame();
+    }
+}
+
+void InputOutputMap::slotUniverseOutputDumped()
+{
+    {
+        QMutexLocker locker(&m_frameMutex);
+
+        if (m_frameUniverses == 0)
+            return;
+
+        if (m_frameDumped == 0)
+            m_frameTime->restart();
+
+        if (++m_frameDumped < m_frameUniverses)
+            return;
+
+        m_frameSkew = m_frameTime->nsecsElapsed() / 1000;
+        if (m_frameSkew > m_maxFrameSkew)
+            m_maxFrameSkew = m_frameSkew;
+        m_frameDumped = 0;
+    }
+
+    commitFrame(false);
+}
+
 /*********************************************************************
  * Grand Master
  *********************************************************************/
@@ -326,7 +469,7 @@ void InputOutputMap::setGrandMasterChannelMode(GrandMaster::ChannelMode mode)
     if(m_grandMaster->channelMode() != mode)
     {
         m_grandMaster->setChannelMode(mode);
-        m_universeChanged = true;
+        m_universeChanged.storeRelease(1);
     }
 }
 
@@ -344,7 +487,7 @@ void InputOutputMap::setGrandMasterValueMode(GrandMaster::ValueMode mode)
     if(m_grandMaster->valueMode() != mode)
     {
         m_grandMaster->setValueMode(mode);
-        m_universeChanged = true;
+        m_universeChanged.storeRelease(1);
     }
 
     emit grandMasterValueModeChanged(mode);
@@ -364,10 +507,10 @@ void InputOutputMap::setGrandMasterValue(uchar value)
     if (m_grandMaster->value() != value)
     {
         m_grandMaster->setValue(value);
-        m_universeChanged = true;
+        m_universeChanged.storeRelease(1);
     }
 
-    if (m_universeChanged == true)
+    if (m_universeChanged.loadAcquire() == 1)
         emit grandMasterValueChanged(value);
 }
 
@@ -384,7 +527,7 @@ uchar InputOutputMap::grandMasterValue()
 
 void InputOutputMap::flushInputs()
 {
-    QMutexLocker locker(&m_universeMutex);
+    UniverseListLocker locker(this);
     foreach (Universe *universe, m_universeArray)
         universe->flushInput();
 }
@@ -400,7 +543,7 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
         return false;
     }
 
-    QMutexLocker locker(&m_universeMutex);
+    UniverseListLocker locker(this);
     InputPatch *currInPatch = m_universeArray.at(universe)->inputPatch();
     QLCInputProfile *currProfile = NULL;
     if (currInPatch != NULL)
@@ -439,6 +582,7 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
         ip = m_universeArray.at(universe)->inputPatch();
         if (ip != NULL)
         {
+            applyInputSubscriptions(universe);
             connect(ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                     this, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)));
             if (ip->pluginName() == "MIDI")
@@ -488,7 +632,7 @@ bool InputOutputMap::setOutputPatch(quint32 universe, const QString &pluginName,
         return false;
     }
 
-    QMutexLocker locker(&m_universeMutex);
+    UniverseListLocker locker(this);
     QLCIOPlugin *plugin = doc()->ioPluginCache()->plugin(pluginName);
 
     if (!outputUID.isEmpty())
@@ -589,6 +733,80 @@ quint32 InputOutputMap::outputMapping(const QString &pluginName, quint32 output)
     return QLCIOPlugin::invalidLine();
 }
 
+/*****************************************************************************
+ * Input subscriptions
+ *****************************************************************************/
+
+void InputOutputMap::subscribeInputChannel(quint32 universe, quint32 channel)
+{
+    channel &= 0xFFFF;
+    int &count = m_inputSubscriptions[(quint64(universe) << 32) | channel];
+    if (count++ > 0)
+        return;
+
+    UniverseListLocker locker(this);
+    if (universe < quint32(m_universeArray.count()))
+    {
+        InputPatch *ip = m_universeArray.at(universe)->inputPatch();
+        if (ip != NULL)
+            ip->setChannelSubscribed(channel, true);
+    }
+}
+
+void InputOutputMap::unsubscribeInputChannel(quint32 universe, quint32 channel)
+{
+    channel &= 0xFFFF;
+    QHash<quint64, int>::iterator it = m_inputSubscriptions.find((quint64(universe) << 32) | channel);
+    if (it == m_inputSubscriptions.end())
+        return;
+
+    if (--it.value() > 0)
+        return;
+
+    m_inputSubscriptions.erase(it);
+
+    UniverseListLocker locker(this);
+    if (universe < quint32(m_universeArray.count()))
+    {
+        InputPatch *ip = m_universeArray.at(universe)->inputPatch();
+        if (ip != NULL)
+            ip->setChannelSubscribed(channel, false);
+    }
+}
+
+void InputOutputMap::setInputMonitor(bool enable)
+{
+    if (enable)
+        m_inputMonitors++;
+    else if (m_inputMonitors > 0)
+        m_inputMonitors--;
+
+    UniverseListLocker locker(this);
+    foreach (Universe *universe, m_universeArray)
+    {
+        InputPatch *ip = universe->inputPatch();
+        if (ip != NULL)
+            ip->setMonitored(m_inputMonitors > 0);
+    }
+}
+
+void InputOutputMap::applyInputSubscriptions(quint32 universe)
+{
+    InputPatch *ip = m_universeArray.at(universe)->inputPatch();
+    if (ip == NULL)
+        return;
+
+    ip->setMonitored(m_inputMonitors > 0);
+
+    QHashIterator<quint64, int> it(m_inputSubscriptions);
+    while (it.hasNext())
+    {
+        it.next();
+        if (quint32(it.key() >> 32) == universe)
+            ip->setChannelSubscribed(quint32(it.key() & 0xFFFFFFFF), true);
+    }
+}
+
 /*****************************************************************************
  * Plugins
  *****************************************************************************/
@@ -724,20 +942,21 @@ bool InputOutputMap::sendFeedBack(quint32 universe, quint32 channel, uchar value
 
     OutputPatch* patch = m_universeArray.at(universe)->feedbackPatch();
 
-    if (patch != NULL && patch->isPatched())
-    {
-        patch->plugin()->sendFeedBack(universe, patch->output(), channel, value, key);
-        return true;
-    }
-    else
-    {
+    if (patch == NULL || patch->isPatched() == false)
         return false;
-    }
+
+    QMutexLocker locker(&m_feedbackMutex);
+    PluginFeedbackValue &fb = m_pendingFeedback[universe][channel];
+    fb.channel = channel;
+    fb.value = value;
+    fb.key = key;
+
+    return true;
 }
 
 void InputOutputMap::slotPluginConfigurationChanged(QLCIOPlugin* plugin)
 {
-    QMutexLocker locker(&m_universeMutex);
+    UniverseListLocker locker(this);
     bool success = true;
     for (quint32 i = 0; i < universesCount(); i++)
     {
@@ -766,6 +985,76 @@ void InputOutputMap::slotPluginConfigurationChanged(QLCIOPlugin* plugin)
     emit pluginConfigurationChanged(plugin->name(), success);
 }
 
+/*****************************************************************************
+ * Feedback
+ *****************************************************************************/
+
+void InputOutputMap::flushFeedback()
+{
+    {
+        QMutexLocker locker(&m_feedbackMutex);
+        if (m_pendingFeedback.isEmpty() || m_feedbackQueued == true)
+            return;
+        m_feedbackQueued = true;
+    }
+
+    emit feedbackPending();
+}
+
+void InputOutputMap::setFeedbackInterval(quint32 universe, uint ms)
+{
+    if (universe >= universesCount())
+        return;
+
+    m_universeArray.at(universe)->setFeedbackInterval(ms);
+}
+
+uint InputOutputMap::feedbackInterval(quint32 universe) const
+{
+    if (universe >= universesCount())
+        return 0;
+
+    return m_universeArray.at(universe)->feedbackInterval();
+}
+
+void InputOutputMap::slotSendFeedback()
+{
+    QHash<quint32, QMap<quint32, PluginFeedbackValue> > frames;
+
+    {
+        QMutexLocker locker(&m_feedbackMutex);
+        m_feedbackQueued = false;
+
+        qint64 now = m_feedbackTime->elapsed();
+        QMutableHashIterator<quint32, QMap<quint32, PluginFeedbackValue> > it(m_pendingFeedback);
+        while (it.hasNext())
+        {
+            it.next();
+            uint interval = feedbackInterval(it.key());
+            // a rate limited line keeps collecting until its interval elapses
+            if (interval > 0 && m_feedbackSent.contains(it.key()) &&
+                now - m_feedbackSent.value(it.key()) < qint64(interval))
+                continue;
+
+            m_feedbackSent[it.key()] = now;
+            frames[it.key()] = it.value();
+            it.remove();
+        }
+    }
+
+    QHashIterator<quint32, QMap<quint32, PluginFeedbackValue> > it(frames);
+    while (it.hasNext())
+    {
+        it.next();
+        if (it.key() >= universesCount())
+            continue;
+
+        OutputPatch* patch = m_universeArray.at(it.key())->feedbackPatch();
+        if (patch != NULL && patch->isPatched())
+            patch->plugin()->sendFeedBackFrame(it.key(), patch->output(), it.value().values());
+    }
+}
+
 /*****************************************************************************
  * Profiles
  *****************************************************************************/
@@ -775,28 +1064,36 @@ void InputOutputMap::loadProfiles(const QDir& dir)
     if (dir.exists() == false || dir.isReadable() == false)
         return;
 
-    /* Go thru all found file entries and attempt to load an input
-       profile from each of them. */
+    /* Go thru all found file entries and remember the name of the
+       input profile found in each of them. Profiles are parsed on demand. */
     QStringListIterator it(dir.entryList());
     while (it.hasNext() == true)
     {
-        QLCInputProfile* prof;
-        QString path;
+        QString path = dir.absoluteFilePath(it.next());
+        QString name = QLCInputProfile::nameFromFile(path);
 
-        path = dir.absoluteFilePath(it.next());
-        prof = QLCInputProfile::loader(path);
-        if (prof != NULL)
+        if (name.isEmpty())
         {
-            /* Check for duplicates */
-            if (profile(prof->name()) == NULL)
-                addProfile(prof);
-            else
-                delete prof;
+            qWarning() << Q_FUNC_INFO << "Unable to find an input profile from" << path;
+            continue;
         }
-        else
+
+        /* Check for duplicates */
+        if (m_profilePaths.contains(name))
+            continue;
+
+        bool loaded = false;
+        foreach (QLCInputProfile *prof, m_profiles)
         {
-            qWarning() << Q_FUNC_INFO << "Unable to find an input profile from" << path;
+            if (prof->name() == name)
+            {
+                loaded = true;
+                break;
+            }
         }
+
+        if (loaded == false)
+            m_profilePaths.insert(name, path);
     }
 }
 
@@ -806,6 +1103,7 @@ QStringList InputOutputMap::profileNames()
     QListIterator <QLCInputProfile*> it(m_profiles);
     while (it.hasNext() == true)
         list << it.next()->name();
+    list << m_profilePaths.keys();
     return list;
 }
 
@@ -819,7 +1117,28 @@ QLCInputProfile* InputOutputMap::profile(const QString& name)
             return profile;
     }
 
-    return NULL;
+    if (m_profilePaths.contains(name) == false)
+        return NULL;
+
+    /* First request of this profile: load it now */
+    QString path = m_profilePaths.take(name);
+    QLCInputProfile* prof = QLCInputProfile::loader(path);
+    if (prof == NULL)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to load input profile from" << path;
+        return NULL;
+    }
+
+    if (prof->name() != name)
+    {
+        qWarning() << Q_FUNC_INFO << "Unexpected input profile name in" << path;
+        delete prof;
+        return NULL;
+    }
+
+    addProfile(prof);
+
+    return prof;
 }
 
 bool InputOutputMap::addProfile(QLCInputProfile* profile)
@@ -840,6 +1159,9 @@ bool InputOutputMap::addProfile(QLCInputProfile* profile)
 
 bool InputOutputMap::removeProfile(const QString& name)
 {
+    if (m_profilePaths.remove(name) > 0)
+        return true;
+
     QMutableListIterator <QLCInputProfile*> it(m_profiles);
     while (it.hasNext() == true)
     {
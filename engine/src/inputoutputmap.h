@@ -20,19 +20,23 @@
 #ifndef INPUTOUTPUTMAP_H
 #define INPUTOUTPUTMAP_H
 
+#include <QReadWriteLock>
+#include <QAtomicInt>
 #include <QSharedPointer>
 #include <QObject>
 #include <QMutex>
+#include <QHash>
+#include <QMap>
 #include <QDir>
 
 #include "qlcinputprofile.h"
+#include "qlcioplugin.h"
 #include "grandmaster.h"
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
 class QLCInputSource;
 class QElapsedTimer;
-class QLCIOPlugin;
 class OutputPatch;
 class InputPatch;
 class Universe;
@@ -50,6 +54,7 @@ class InputOutputMap : public QObject
     Q_DISABLE_COPY(InputOutputMap)
 
     friend class InputPatch;
+    friend class UniverseListLocker;
 
     /*********************************************************************
      * Initialization
@@ -156,7 +161,8 @@ public:
     bool removeAllUniverses();
 
     /**
-     * Start all the Universe threads
+     * Allow the Universe threads to run. Only the threads of the
+     * universes in use are started, the others stay dormant
      */
     void startUniverses();
 
@@ -241,13 +247,23 @@ public:
     Universe *universe(quint32 id);
 
     /**
-     * Claim access to a universe. This is declared virtual to make
-     * unit testing a bit easier.
+     * Claim access to the universes. The returned list is a snapshot
+     * that stays valid until releaseUniverses() is called: universes
+     * can't be added or removed meanwhile, but any number of threads
+     * can claim the universes and change their patches at the same time.
+     *
+     * The master timer tick writes the channel values with a shared claim.
+     * Anything else changing the channels state (capabilities, defaults,
+     * modifiers, faders, resets) must claim the universes exclusively,
+     * to never run concurrently with the tick.
+     * This is declared virtual to make unit testing a bit easier.
+     *
+     * @param exclusive Set to true to exclude any other claim
      */
-    virtual QList<Universe*> claimUniverses();
+    virtual QList<Universe*> claimUniverses(bool exclusive = false);
 
     /**
-     * Release access to a universe. This is declared virtual to make
+     * Release access to the universes. This is declared virtual to make
      * unit testing a bit easier.
      *
      * @param changed Set to true if DMX values were changed
@@ -268,11 +284,81 @@ private:
     /** The values of all universes */
     QList<Universe *> m_universeArray;
 
-    /** When true, universes are dumped. Otherwise not. */
-    bool m_universeChanged;
+    /** When true, universes are dumped. Otherwise not. It is atomic
+     *  since several threads can release the universes at once */
+    QAtomicInt m_universeChanged;
+
+    /** Lock guarding m_universeArray. It is locked for writing only to
+     *  add or remove universes, everything else is a reader */
+    QReadWriteLock m_universeLock;
+
+    /*********************************************************************
+     * Lock statistics
+     *********************************************************************/
+public:
+    /** Number of times the universes lock was not immediately available */
+    quint64 universeLockWaits() const;
+
+    /** Total time spent waiting for the universes lock, in microseconds */
+    qint64 universeLockWaitTime() const;
+
+private:
+    /** Lock the universes for reading or writing, measuring the contention */
+    void lockUniverses(bool write);
+
+private:
+    /** Mutex guarding the lock statistics */
+    QMutex m_lockStatsMutex;
+
+    quint64 m_universeLockWaits;
+    qint64 m_universeLockWaitTime;
+
+    /*********************************************************************
+     * Frame commit
+     *********************************************************************/
+public:
+    /**
+     * Start a new output frame. Every universe with at least one output
+     * patch is expected to write its output once in this frame: when
+     * they all did, the frame is committed, meaning that every output
+     * plugin is asked to send its synchronization packets.
+     * If the previous frame is still incomplete, it is committed now.
+     *
+     * @param universes The universes list, claimed by the caller
+     */
+    void beginFrame(const QList<Universe *>& universes);
+
+    /** Time, in microseconds, elapsed between the first and the last
+     *  universe output of the last committed frame */
+    qint64 frameSkew() const;
+
+    /** The biggest frame skew measured so far, in microseconds */
+    qint64 maxFrameSkew() const;
+
+private:
+    /** Ask the output plugins to commit the frame. $late is true
+     *  when not all the universes have written their output */
+    void commitFrame(bool late);
+
+private slots:
+    /** Called directly by the universe threads, after writing their output */
+    void slotUniverseOutputDumped();
+
+private:
+    /** Mutex guarding the frame commit variables */
+    QMutex m_frameMutex;
+
+    /** Number of universes expected to write their output in the current frame */
+    int m_frameUniverses;
+
+    /** Number of universes that wrote their output in the current frame */
+    int m_frameDumped;
+
+    /** Measures the time between the first and the last universe output */
+    QElapsedTimer *m_frameTime;
 
-    /** Mutex guarding m_universeArray */
-    QMutex m_universeMutex;
+    qint64 m_frameSkew;
+    qint64 m_maxFrameSkew;
 
     /*********************************************************************
      * Grand Master
@@ -413,6 +499,33 @@ public:
      */
     quint32 outputMapping(const QString& pluginName, quint32 output) const;
 
+    /*********************************************************************
+     * Input subscriptions
+     *********************************************************************/
+public:
+    /**
+     * Plugins delivering whole input frames (e.g. Loopback) don't notify
+     * every changed channel: inputValueChanged() is emitted only for the
+     * channels of the input profile and the channels subscribed here.
+     * Subscriptions are reference counted and survive input repatching.
+     * The upper 16 bits of $channel (the page) are ignored.
+     */
+    void subscribeInputChannel(quint32 universe, quint32 channel);
+    void unsubscribeInputChannel(quint32 universe, quint32 channel);
+
+    /** Emit inputValueChanged() for all the channels of the frames as
+     *  well, e.g. while detecting an input channel. Reference counted */
+    void setInputMonitor(bool enable);
+
+private:
+    /** Apply the current subscriptions to the input patch of $universe */
+    void applyInputSubscriptions(quint32 universe);
+
+private:
+    /** (universe << 32 | channel) -> number of subscriptions */
+    QHash<quint64, int> m_inputSubscriptions;
+    int m_inputMonitors;
+
     /*********************************************************************
      * Plugins
      *********************************************************************/
@@ -498,6 +611,10 @@ public:
     /**
      * Send feedback value to the input profile e.g. to move a motorized
      * sliders & knobs, set indicator leds etc.
+     * The value is sent at the next MasterTimer tick, unless superseded
+     * by another value of the same channel in the meantime.
+     *
+     * @return true if the universe has a feedback line
      */
     bool sendFeedBack(quint32 universe, quint32 channel, uchar value, const QString& key = 0);
 
@@ -515,11 +632,57 @@ signals:
     /** Everyone interested in input data should connect to this signal */
     void inputValueChanged(quint32 universe, quint32 channel, uchar value, const QString& key = 0);
 
+    /*************************************************************************
+     * Feedback
+     *************************************************************************/
+public:
+    /**
+     * Send the feedback collected since the last tick, with a single
+     * QLCIOPlugin::sendFeedBackFrame() call per feedback line. Called by
+     * MasterTimer at every tick: plugins are still called in the thread
+     * of the InputOutputMap.
+     */
+    void flushFeedback();
+
+    /**
+     * Set the minimum time between two feedback frames sent to the
+     * feedback line of $universe, to avoid flooding slow devices.
+     * Values keep being collected in the meantime. The interval is
+     * stored and saved by the Universe, with its feedback patch.
+     *
+     * @param universe The universe index
+     * @param ms The minimum interval in milliseconds, 0 to send at every tick
+     */
+    void setFeedbackInterval(quint32 universe, uint ms);
+    uint feedbackInterval(quint32 universe) const;
+
+signals:
+    /** Emitted by flushFeedback() when there is feedback to send */
+    void feedbackPending();
+
+private slots:
+    void slotSendFeedback();
+
+private:
+    QMutex m_feedbackMutex;
+    /** Universe -> channel -> last feedback value, not sent yet */
+    QHash<quint32, QMap<quint32, PluginFeedbackValue> > m_pendingFeedback;
+    /** True when slotSendFeedback() has been queued and hasn't run yet */
+    bool m_feedbackQueued;
+
+    /** Universe -> time of the last feedback frame, on m_feedbackTime */
+    QHash<quint32, qint64> m_feedbackSent;
+    QElapsedTimer *m_feedbackTime;
+
     /*************************************************************************
      * Input profiles
      *************************************************************************/
 public:
-    /** Load all input profiles from the given directory using QDir filters */
+    /**
+     * Find all input profiles in the given directory using QDir filters.
+     * Only the profile names are read here: a profile is fully loaded
+     * the first time it is requested with profile().
+     */
     void loadProfiles(const QDir& dir);
 
     /** Get a list of available profile names */
@@ -565,9 +728,12 @@ public:
     static QDir userProfileDirectory();
 
 private:
-    /** List that contains all available profiles */
+    /** List that contains all loaded profiles */
     QList <QLCInputProfile*> m_profiles;
 
+    /** Profiles found by loadProfiles() but not loaded yet (name => path) */
+    QMap <QString, QString> m_profilePaths;
+
     /*********************************************************************
      * Beats
      *********************************************************************/
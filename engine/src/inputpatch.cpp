@@ -31,6 +31,10 @@
 
 #define GRACE_MS 1
 
+/** Input channels are numbered with 16 bits by the plugins
+ *  (e.g. MIDI in omni mode), so the dense buffer covers them all */
+#define KInputBufferSize 0x10000
+
 /*****************************************************************************
  * Initialization
  *****************************************************************************/
@@ -44,6 +48,9 @@ InputPatch::InputPatch(QObject *parent)
     , m_nextPageCh(USHRT_MAX)
     , m_prevPageCh(USHRT_MAX)
     , m_pageSetCh(USHRT_MAX)
+    , m_inputValues(KInputBufferSize, 0)
+    , m_inputChanged(KInputBufferSize / 64, 0)
+    , m_monitored(false)
 {
 
 }
@@ -57,6 +64,9 @@ InputPatch::InputPatch(quint32 inputUniverse, QObject* parent)
     , m_nextPageCh(USHRT_MAX)
     , m_prevPageCh(USHRT_MAX)
     , m_pageSetCh(USHRT_MAX)
+    , m_inputValues(KInputBufferSize, 0)
+    , m_inputChanged(KInputBufferSize / 64, 0)
+    , m_monitored(false)
 {
 
 }
@@ -83,12 +93,15 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         disconnect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                    this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        disconnect(m_plugin, SIGNAL(frameChanged(quint32,quint32,QByteArray,QBitArray)),
+                   this, SLOT(slotFrameChanged(quint32,quint32,QByteArray,QBitArray)));
         m_plugin->closeInput(m_pluginLine, m_universe);
     }
 
     m_plugin = plugin;
     m_pluginLine = input;
     m_profile = profile;
+    updateProfileChannels();
 
     if (m_plugin != NULL)
     {
@@ -104,6 +117,10 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         connect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                 this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        // frames are buffered right away, without a round trip through the event loop
+        connect(m_plugin, SIGNAL(frameChanged(quint32,quint32,QByteArray,QBitArray)),
+                this, SLOT(slotFrameChanged(quint32,quint32,QByteArray,QBitArray)),
+                Qt::DirectConnection);
         result = m_plugin->openInput(m_pluginLine, m_universe);
 
         if (m_profile != NULL)
@@ -118,6 +135,7 @@ bool InputPatch::set(QLCInputProfile *profile)
         return false;
 
     m_profile = profile;
+    updateProfileChannels();
 
     if (m_profile != NULL)
         setProfilePageControls();
@@ -217,31 +235,64 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
 {
     // In case we have several lines connected to the same plugin, emit only
     // such values that belong to this particular patch.
-    if (input == m_pluginLine)
+    if (input != m_pluginLine)
+        return;
+
+    if (universe != UINT_MAX && universe != m_universe)
+        return;
+
+    QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+
+    if (key.isEmpty() == false || channel >= KInputBufferSize)
+    {
+        bufferKeyedValue(channel, value, key);
+        return;
+    }
+
+    int word = int(channel >> 6);
+    quint64 bit = Q_UINT64_C(1) << (channel & 63);
+    uchar *values = reinterpret_cast<uchar *>(m_inputValues.data());
+
+    if (m_inputChanged[word] & bit)
+    {
+        uchar curValue = values[channel];
+        if (curValue == value)
+            return;
+
+        // Every ON/OFF changes must pass through
+        if (curValue == 0 || value == 0)
+            emit inputValueChanged(m_universe, channel, curValue);
+    }
+    else
+    {
+        if (m_inputChanged[word] == 0)
+            m_inputChangedWords.append(word);
+        m_inputChanged[word] |= bit;
+    }
+
+    values[channel] = value;
+}
+
+void InputPatch::bufferKeyedValue(quint32 channel, uchar value, const QString &key)
+{
+    InputValue val(value, key);
+    if (m_keyedInputBuffer.contains(channel))
     {
-        if (universe == UINT_MAX || universe == m_universe)
+        InputValue const& curVal = m_keyedInputBuffer.value(channel);
+        if (curVal.value != val.value)
         {
-            QMutexLocker inputBufferLocker(&m_inputBufferMutex);
-            InputValue val(value, key);
-            if (m_inputBuffer.contains(channel))
+            // Every ON/OFF changes must pass through
+            if (curVal.value == 0 || val.value == 0)
             {
-                InputValue const& curVal = m_inputBuffer.value(channel);
-                if (curVal.value != val.value)
-                {
-                    // Every ON/OFF changes must pass through
-                    if (curVal.value == 0 || val.value == 0)
-                    {
-                        emit inputValueChanged(m_universe, channel, curVal.value, curVal.key);
-                    }
-                    m_inputBuffer.insert(channel, val);
-                }
-            }
-            else
-            {
-                m_inputBuffer.insert(channel, val);
+                emit inputValueChanged(m_universe, channel, curVal.value, curVal.key);
             }
+            m_keyedInputBuffer.insert(channel, val);
         }
     }
+    else
+    {
+        m_keyedInputBuffer.insert(channel, val);
+    }
 }
 
 void InputPatch::setProfilePageControls()
@@ -279,15 +330,124 @@ void InputPatch::setProfilePageControls()
     }
 }
 
-void InputPatch::flush(quint32 universe)
+void InputPatch::flush(quint32 universe, QByteArray *frameValues, QBitArray *frameChanged)
 {
     if (universe == UINT_MAX || universe == m_universe)
     {
         QMutexLocker inputBufferLocker(&m_inputBufferMutex);
-        for (QHash<quint32, InputValue>::const_iterator it = m_inputBuffer.begin(); it != m_inputBuffer.end(); ++it)
+
+        // walk only the words of the changed bitset with channels set
+        std::sort(m_inputChangedWords.begin(), m_inputChangedWords.end());
+        const uchar *inputValues = reinterpret_cast<const uchar *>(m_inputValues.constData());
+        foreach (int word, m_inputChangedWords)
+        {
+            quint64 bits = m_inputChanged[word];
+            m_inputChanged[word] = 0;
+
+            for (quint32 channel = quint32(word) << 6; bits != 0; channel++, bits >>= 1)
+            {
+                if (bits & 1)
+                    emit inputValueChanged(m_universe, channel, inputValues[channel]);
+            }
+        }
+        m_inputChangedWords.clear();
+
+        for (QHash<quint32, InputValue>::const_iterator it = m_keyedInputBuffer.begin(); it != m_keyedInputBuffer.end(); ++it)
         {
             emit inputValueChanged(m_universe, it.key(), it.value().value, it.value().key);
         }
-        m_inputBuffer.clear();
+        m_keyedInputBuffer.clear();
+
+        if (m_frameDirty.isEmpty())
+            return;
+
+        int size = qMin(m_frameDirty.size(), m_frameValues.size());
+        if (frameValues != NULL)
+        {
+            size = qMin(size, frameValues->size());
+            if (frameChanged != NULL)
+                frameChanged->fill(false, size);
+        }
+
+        const uchar *values = reinterpret_cast<const uchar *>(m_frameValues.constData());
+        for (int i = 0; i < size; i++)
+        {
+            if (m_frameDirty.testBit(i) == false)
+                continue;
+
+            if (frameValues != NULL)
+            {
+                (*frameValues)[i] = char(values[i]);
+                if (frameChanged != NULL)
+                    frameChanged->setBit(i);
+            }
+
+            if (m_monitored ||
+                (i < m_subscribedChannels.size() && m_subscribedChannels.testBit(i)) ||
+                (i < m_profileChannels.size() && m_profileChannels.testBit(i)))
+                emit inputValueChanged(m_universe, i, values[i]);
+        }
+        m_frameDirty.clear();
+    }
+}
+
+void InputPatch::slotFrameChanged(quint32 universe, quint32 input,
+                                  const QByteArray &values, const QBitArray &dirty)
+{
+    if (input != m_pluginLine)
+        return;
+
+    if (universe != UINT_MAX && universe != m_universe)
+        return;
+
+    QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+    m_frameValues = values;
+    // frames received within the same tick accumulate their changes
+    m_frameDirty |= dirty;
+}
+
+/*****************************************************************************
+ * Frames
+ *****************************************************************************/
+
+void InputPatch::setChannelSubscribed(quint32 channel, bool subscribed)
+{
+    QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+    if (channel >= quint32(m_subscribedChannels.size()))
+    {
+        if (subscribed == false)
+            return;
+        m_subscribedChannels.resize(channel + 1);
+    }
+    m_subscribedChannels.setBit(channel, subscribed);
+}
+
+bool InputPatch::isChannelSubscribed(quint32 channel)
+{
+    QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+    return channel < quint32(m_subscribedChannels.size()) && m_subscribedChannels.testBit(channel);
+}
+
+void InputPatch::setMonitored(bool monitored)
+{
+    QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+    m_monitored = monitored;
+}
+
+void InputPatch::updateProfileChannels()
+{
+    QBitArray channels;
+
+    if (m_profile != NULL)
+    {
+        foreach (quint32 channel, m_profile->channels().keys())
+        {
+            if (channel >= quint32(channels.size()))
+                channels.resize(channel + 1);
+            channels.setBit(channel);
+        }
     }
+
+    QMutexLocker inputBufferLocker(&m_inputBufferMutex);
+    m_profileChannels = channels;
 }
@@ -20,6 +20,9 @@
 #ifndef INPUTPATCH_H
 #define INPUTPATCH_H
 
+#include <QByteArray>
+#include <QBitArray>
+#include <QVector>
 #include <QObject>
 #include <QMap>
 #include <QMutex>
@@ -135,6 +138,10 @@ private slots:
     void slotValueChanged(quint32 universe, quint32 input,
                           quint32 channel, uchar value, const QString& key = 0);
 
+    /** Called in the plugin thread by plugins delivering whole frames */
+    void slotFrameChanged(quint32 universe, quint32 input,
+                          const QByteArray& values, const QBitArray& dirty);
+
 private:
     /** The reference of the plugin associated by this Input patch */
     QLCIOPlugin* m_plugin;
@@ -155,7 +162,13 @@ private:
     ushort m_nextPageCh, m_prevPageCh, m_pageSetCh;
 
 public:
-    void flush(quint32 universe);
+    /**
+     * Emit inputValueChanged() for the values received since the last flush.
+     * Whole frames are notified only for the subscribed channels, and
+     * their changed channels are copied into $frameValues when it is not
+     * NULL, setting the corresponding bits of $frameChanged.
+     */
+    void flush(quint32 universe, QByteArray *frameValues = NULL, QBitArray *frameChanged = NULL);
 
     struct InputValue
     {
@@ -168,8 +181,49 @@ public:
         QString key;
     };
 
+private:
+    /** Buffer a keyed value, or one out of the dense buffer range */
+    void bufferKeyedValue(quint32 channel, uchar value, const QString& key);
+
+private:
     QMutex m_inputBufferMutex;
-    QHash<quint32, InputValue> m_inputBuffer;
+
+    /** The last value of every channel, valid only when its bit
+     *  is set in m_inputChanged. Preallocated to KInputBufferSize */
+    QByteArray m_inputValues;
+    /** One bit per channel received since the last flush */
+    QVector<quint64> m_inputChanged;
+    /** Index of the m_inputChanged words with at least one bit set */
+    QVector<int> m_inputChangedWords;
+
+    /** Values received with a key (e.g. OSC paths) since the last flush */
+    QHash<quint32, InputValue> m_keyedInputBuffer;
+
+    /************************************************************************
+     * Frames
+     ************************************************************************/
+public:
+    /** Emit the changes of $channel received through whole frames */
+    void setChannelSubscribed(quint32 channel, bool subscribed);
+    bool isChannelSubscribed(quint32 channel);
+
+    /** Emit all the changes received through whole frames, e.g.
+     *  while the user is detecting an input channel */
+    void setMonitored(bool monitored);
+
+private:
+    /** Cache the channels of the input profile, which are always subscribed */
+    void updateProfileChannels();
+
+private:
+    /** The last frame received, shared with the plugin */
+    QByteArray m_frameValues;
+    /** The channels changed by the frames received since the last flush */
+    QBitArray m_frameDirty;
+
+    QBitArray m_subscribedChannels;
+    QBitArray m_profileChannels;
+    bool m_monitored;
 };
 
 /** @} */
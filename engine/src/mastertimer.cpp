@@ -19,7 +19,10 @@
 */
 
 #include <QDebug>
+#include <QRunnable>
 #include <QSettings>
+#include <QSemaphore>
+#include <QThread>
 #include <QElapsedTimer>
 #include <QMutexLocker>
 
@@ -41,6 +44,7 @@
 #include "doc.h"
 
 #define MASTERTIMER_FREQUENCY "mastertimer/frequency"
+#define MASTERTIMER_PARALLEL "mastertimer/parallel"
 #define LATE_TO_BEAT_THRESHOLD 25
 
 /** The timer tick frequency in Hertz */
@@ -61,6 +65,7 @@ MasterTimer::MasterTimer(Doc* doc)
     : QObject(doc)
     , d_ptr(new MasterTimerPrivate(this))
     , m_stopAllFunctions(false)
+    , m_parallelWrite(false)
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
     , m_dmxSourceListMutex(QMutex::Recursive)
 #endif
@@ -80,6 +85,13 @@ MasterTimer::MasterTimer(Doc* doc)
         s_frequency = var.toUInt();
 
     s_tick = uint(double(1000) / double(s_frequency));
+
+    var = settings.value(MASTERTIMER_PARALLEL);
+    if (var.isValid() == true)
+        m_parallelWrite = var.toBool();
+
+    // the timer thread writes functions too
+    m_writePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
 }
 
 MasterTimer::~MasterTimer()
@@ -151,7 +163,9 @@ void MasterTimer::timerTick()
     timerTickFunctions(universes);
     timerTickDMXSources(universes);
 
+    doc->inputOutputMap()->beginFrame(universes);
     doc->inputOutputMap()->releaseUniverses();
+    doc->inputOutputMap()->flushFeedback();
 
     m_beatRequested = false;
 
@@ -207,7 +221,7 @@ void MasterTimer::fadeAndStopAll(int timeout)
         Doc *doc = qobject_cast<Doc*> (parent());
         Q_ASSERT(doc != NULL);
 
-        QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
+        QList<Universe *> universes = doc->inputOutputMap()->claimUniverses(true);
         foreach (Universe *universe, universes)
         {
             foreach (QSharedPointer<GenericFader> fader, universe->faders())
@@ -228,12 +242,25 @@ int MasterTimer::runningFunctions() const
     return m_functionList.size();
 }
 
+void MasterTimer::setParallelWrite(bool enable)
+{
+    m_parallelWrite = enable;
+}
+
+bool MasterTimer::parallelWrite() const
+{
+    return m_parallelWrite;
+}
+
 void MasterTimer::timerTickFunctions(QList<Universe *> universes)
 {
     // List of m_functionList indices that should be removed at the end of this
     // function. The functions at the indices have been stopped.
     QList<int> removeList;
 
+    // Functions to be written concurrently, in parallel write mode
+    QList<Function *> parallelList;
+
     bool functionListHasChanged = false;
     bool stoppedAFunction = true;
     bool firstIteration = true;
@@ -253,7 +280,12 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                 if (function->stopped() == false && m_stopAllFunctions == false)
                 {
                     if (firstIteration)
-                        function->write(this, universes);
+                    {
+                        if (m_parallelWrite && function->supportsParallelWrite())
+                            parallelList << function;
+                        else
+                            function->write(this, universes);
+                    }
                 }
                 else
                 {
@@ -282,6 +314,14 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
         while (it.hasPrevious() == true)
             m_functionList.removeAt(it.previous());
 
+        // The functions stopped meanwhile will get their postRun
+        // on the next round, after their last write
+        if (parallelList.isEmpty() == false)
+        {
+            writeParallel(parallelList, universes);
+            parallelList.clear();
+        }
+
         firstIteration = false;
     }
 
@@ -317,6 +357,54 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
         emit functionListChanged();
 }
 
+/** Call write() of the functions not taken yet by the other runnables */
+class FunctionWriteRunnable : public QRunnable
+{
+public:
+    FunctionWriteRunnable(MasterTimer *timer, const QList<Function *>& functions,
+                          const QList<Universe *>& universes,
+                          QAtomicInt *next, QSemaphore *done)
+        : m_timer(timer)
+        , m_functions(functions)
+        , m_universes(universes)
+        , m_next(next)
+        , m_done(done)
+    {
+    }
+
+    void run()
+    {
+        int index;
+        while ((index = m_next->fetchAndAddOrdered(1)) < m_functions.count())
+            m_functions.at(index)->write(m_timer, m_universes);
+
+        if (m_done != NULL)
+            m_done->release();
+    }
+
+private:
+    MasterTimer *m_timer;
+    QList<Function *> m_functions;
+    QList<Universe *> m_universes;
+    QAtomicInt *m_next;
+    QSemaphore *m_done;
+};
+
+void MasterTimer::writeParallel(const QList<Function *>& functions, const QList<Universe *>& universes)
+{
+    QAtomicInt next(0);
+    QSemaphore done;
+
+    int workers = qMin(m_writePool.maxThreadCount(), functions.count() - 1);
+    for (int i = 0; i < workers; i++)
+        m_writePool.start(new FunctionWriteRunnable(this, functions, universes, &next, &done));
+
+    FunctionWriteRunnable local(this, functions, universes, &next, NULL);
+    local.run();
+
+    done.acquire(workers);
+}
+
 /****************************************************************************
  * DMX Sources
  ****************************************************************************/
@@ -21,6 +21,7 @@
 #ifndef MASTERTIMER_H
 #define MASTERTIMER_H
 
+#include <QThreadPool>
 #include <QHash>
 #include <QObject>
 #include <QMutex>
@@ -107,6 +108,15 @@ public:
     /** Get the number of currently running functions */
     int runningFunctions() const;
 
+    /**
+     * Enable or disable the parallel write mode. When enabled, the
+     * write() calls of the running functions supporting it are spread
+     * over a thread pool. Starting, stopping and the functions that
+     * don't support it are still handled serially, in the same order.
+     */
+    void setParallelWrite(bool enable);
+    bool parallelWrite() const;
+
 signals:
     /** Tells that the list of running functions has changed */
     void functionListChanged();
@@ -118,6 +128,10 @@ private:
     /** Execute one timer tick for each registered Function */
     void timerTickFunctions(QList<Universe *> universes);
 
+    /** Call write() of $functions on the thread pool and on the
+     *  calling thread, and wait until they are all done */
+    void writeParallel(const QList<Function *>& functions, const QList<Universe *>& universes);
+
 private:
     /** List of currently running functions */
     QList <Function*> m_functionList;
@@ -129,6 +143,12 @@ private:
     /** Flag for stopping all functions */
     bool m_stopAllFunctions;
 
+    /** Flag for the parallel write mode */
+    bool m_parallelWrite;
+
+    /** The threads writing functions in parallel write mode */
+    QThreadPool m_writePool;
+
     /*************************************************************************
      * DMX Sources
      *************************************************************************/
@@ -96,6 +96,7 @@ void MonitorProperties::reset()
     m_fixtureItems.clear();
     m_genericItems.clear();
     m_commonBackgroundImage = QString();
+    emit changed();
 }
 
 /********************************************************************
@@ -162,6 +163,7 @@ void MonitorProperties::setPointOfView(MonitorProperties::PointOfView pov)
         }
     }
     m_pointOfView = pov;
+    emit changed();
 }
 
 /********************************************************************
@@ -171,7 +173,10 @@ void MonitorProperties::setPointOfView(MonitorProperties::PointOfView pov)
 void MonitorProperties::removeFixture(quint32 fid)
 {
     if (m_fixtureItems.contains(fid))
+    {
         m_fixtureItems.take(fid);
+        emit changed();
+    }
 }
 
 void MonitorProperties::removeFixture(quint32 fid, quint16 head, quint16 linked)
@@ -184,11 +189,13 @@ void MonitorProperties::removeFixture(quint32 fid, quint16 head, quint16 linked)
     if (m_fixtureItems[fid].m_subItems.count() == 0)
     {
         m_fixtureItems.take(fid);
+        emit changed();
         return;
     }
 
     quint32 subID = fixtureSubID(head, linked);
     m_fixtureItems[fid].m_subItems.remove(subID);
+    emit changed();
 }
 
 quint32 MonitorProperties::fixtureSubID(quint32 headIndex, quint32 linkedIndex) const
@@ -230,6 +237,7 @@ void MonitorProperties::setFixturePosition(quint32 fid, quint16 head, quint16 li
         quint32 subID = fixtureSubID(head, linked);
         m_fixtureItems[fid].m_subItems[subID].m_position = pos;
     }
+    emit changed();
 }
 
 QVector3D MonitorProperties::fixturePosition(quint32 fid, quint16 head, quint16 linked) const
@@ -256,6 +264,7 @@ void MonitorProperties::setFixtureRotation(quint32 fid, quint16 head, quint16 li
         quint32 subID = fixtureSubID(head, linked);
         m_fixtureItems[fid].m_subItems[subID].m_rotation = degrees;
     }
+    emit changed();
 }
 
 QVector3D MonitorProperties::fixtureRotation(quint32 fid, quint16 head, quint16 linked) const
@@ -283,6 +292,7 @@ void MonitorProperties::setFixtureGelColor(quint32 fid, quint16 head, quint16 li
         quint32 subID = fixtureSubID(head, linked);
         m_fixtureItems[fid].m_subItems[subID].m_color = col;
     }
+    emit changed();
 }
 
 QColor MonitorProperties::fixtureGelColor(quint32 fid, quint16 head, quint16 linked) const
@@ -309,6 +319,7 @@ void MonitorProperties::setFixtureResource(quint32 fid, quint16 head, quint16 li
         quint32 subID = fixtureSubID(head, linked);
         m_fixtureItems[fid].m_subItems[subID].m_resource = resource;
     }
+    emit changed();
 }
 
 QString MonitorProperties::fixtureResource(quint32 fid, quint16 head, quint16 linked) const
@@ -335,6 +346,7 @@ void MonitorProperties::setFixtureFlags(quint32 fid, quint16 head, quint16 linke
         quint32 subID = fixtureSubID(head, linked);
         m_fixtureItems[fid].m_subItems[subID].m_flags = flags;
     }
+    emit changed();
 }
 
 quint32 MonitorProperties::fixtureFlags(quint32 fid, quint16 head, quint16 linked) const
@@ -374,6 +386,7 @@ void MonitorProperties::setFixtureItem(quint32 fid, quint16 head, quint16 linked
         quint32 subID = fixtureSubID(head, linked);
         m_fixtureItems[fid].m_subItems[subID] = props;
     }
+    emit changed();
 }
 
 QList<quint32> MonitorProperties::fixtureIDList(quint32 fid) const
@@ -408,6 +421,7 @@ QString MonitorProperties::itemResource(quint32 itemID)
 void MonitorProperties::setItemResource(quint32 itemID, QString resource)
 {
     m_genericItems[itemID].m_resource = resource;
+    emit changed();
 }
 
 QVector3D MonitorProperties::itemPosition(quint32 itemID)
@@ -418,6 +432,7 @@ QVector3D MonitorProperties::itemPosition(quint32 itemID)
 void MonitorProperties::setItemPosition(quint32 itemID, QVector3D pos)
 {
     m_genericItems[itemID].m_position = pos;
+    emit changed();
 }
 
 QVector3D MonitorProperties::itemRotation(quint32 itemID)
@@ -428,6 +443,7 @@ QVector3D MonitorProperties::itemRotation(quint32 itemID)
 void MonitorProperties::setItemRotation(quint32 itemID, QVector3D rot)
 {
     m_genericItems[itemID].m_rotation = rot;
+    emit changed();
 }
 
 QVector3D MonitorProperties::itemScale(quint32 itemID)
@@ -441,6 +457,7 @@ QVector3D MonitorProperties::itemScale(quint32 itemID)
 void MonitorProperties::setItemScale(quint32 itemID, QVector3D scale)
 {
     m_genericItems[itemID].m_scale = scale;
+    emit changed();
 }
 
 quint32 MonitorProperties::itemFlags(quint32 itemID)
@@ -451,6 +468,7 @@ quint32 MonitorProperties::itemFlags(quint32 itemID)
 void MonitorProperties::setItemFlags(quint32 itemID, quint32 flags)
 {
     m_genericItems[itemID].m_flags = flags;
+    emit changed();
 }
 
 /********************************************************************
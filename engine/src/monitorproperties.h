@@ -67,24 +67,28 @@ public:
     enum ValueStyle { DMXValues, PercentageValues };
 
     /** Get/Set the font used by the Monitor dialog UI */
-    inline void setFont(QFont font) { m_font = font; }
+    inline void setFont(QFont font) { m_font = font; emit changed(); }
     inline QFont font() const { return m_font; }
 
     /** Get/Set how to display the monitor */
-    inline void setDisplayMode(DisplayMode mode) { m_displayMode = mode; }
+    inline void setDisplayMode(DisplayMode mode) { m_displayMode = mode; emit changed(); }
     inline DisplayMode displayMode() const { return m_displayMode; }
 
     /** Get/Set how to show DMX channel indices in DMX display mode */
-    inline void setChannelStyle(ChannelStyle style) { m_channelStyle = style; }
+    inline void setChannelStyle(ChannelStyle style) { m_channelStyle = style; emit changed(); }
     inline ChannelStyle channelStyle() const { return m_channelStyle; }
 
     /** Get/Set how to show DMX channel values in DMX display mode */
-    inline void setValueStyle(ValueStyle style) { m_valueStyle = style; }
+    inline void setValueStyle(ValueStyle style) { m_valueStyle = style; emit changed(); }
     inline ValueStyle valueStyle() const { return m_valueStyle; }
 
     /** Reset all the Monitor properties */
     void reset();
 
+signals:
+    /** Emitted whenever any of the Monitor properties is changed */
+    void changed();
+
 private:
     QFont m_font;
     DisplayMode m_displayMode;
@@ -106,11 +110,11 @@ public:
     enum StageType { StageSimple, StageBox, StageRock, StageTheatre };
 
     /** Get/Set the size of the grid in 2D display mode */
-    inline void setGridSize(QVector3D size) { m_gridSize = size; }
+    inline void setGridSize(QVector3D size) { m_gridSize = size; emit changed(); }
     inline QVector3D gridSize() const { return m_gridSize; }
 
     /** Get/Set the grid measurement units to use in 2D display mode */
-    inline void setGridUnits(GridUnits units) { m_gridUnits = units; }
+    inline void setGridUnits(GridUnits units) { m_gridUnits = units; emit changed(); }
     inline GridUnits gridUnits() const { return m_gridUnits; }
 
     /** Get/Set the point of view to render the 2D preview */
@@ -118,7 +122,7 @@ public:
     inline PointOfView pointOfView() const { return m_pointOfView; }
 
     /** Get/Set the type of stage to render in the 3D preview */
-    inline void setStageType(StageType type) { m_stageType = type; }
+    inline void setStageType(StageType type) { m_stageType = type; emit changed(); }
     inline StageType stageType() const { return m_stageType; }
 
 private:
@@ -146,7 +150,7 @@ public:
      ********************************************************************/
 public:
     /** Get/Set the Fixture labels visibility status */
-    inline void setLabelsVisible(bool visible) { m_showLabels = visible; }
+    inline void setLabelsVisible(bool visible) { m_showLabels = visible; emit changed(); }
     inline bool labelsVisible() const { return m_showLabels; }
 
     /** Remove a Fixture entry from the Monitor map */
@@ -186,7 +190,7 @@ public:
 
     /** Get/Set all the Fixture item properties of a Fixture with ID $fid */
     inline FixturePreviewItem fixtureProperties(quint32 fid) const { return m_fixtureItems[fid]; }
-    inline void setFixtureProperties(quint32 fid, FixturePreviewItem props) { m_fixtureItems[fid] = props; }
+    inline void setFixtureProperties(quint32 fid, FixturePreviewItem props) { m_fixtureItems[fid] = props; emit changed(); }
 
     /** Get/Set a single Fixture item property with the given $fid, $head and $linked index */
     PreviewItem fixtureItem(quint32 fid, quint16 head, quint16 linked) const;
@@ -210,7 +214,7 @@ public:
     inline bool containsItem(quint32 itemID) { return m_genericItems.contains(itemID); }
 
     /** Remove an existing item from the generic items map */
-    inline void removeItem(quint32 itemID) { m_genericItems.take(itemID); }
+    inline void removeItem(quint32 itemID) { m_genericItems.take(itemID); emit changed(); }
 
     /** Returns a list of all the generic item IDs */
     QList<quint32> genericItemsID();
@@ -243,17 +247,17 @@ private:
      ********************************************************************/
 public:
     /** Get/Set a background image to be displayed in 2D mode */
-    inline void setCommonBackgroundImage(QString filename) { m_commonBackgroundImage = filename; }
+    inline void setCommonBackgroundImage(QString filename) { m_commonBackgroundImage = filename; emit changed(); }
     inline QString commonBackgroundImage() const { return m_commonBackgroundImage; }
 
     /** Set a picture found at $path to be displayed when $fid is started */
-    void setCustomBackgroundItem(quint32 fid, QString path) { m_customBackgroundImages[fid] = path; }
+    void setCustomBackgroundItem(quint32 fid, QString path) { m_customBackgroundImages[fid] = path; emit changed(); }
 
     /** Helper method to set a whole list of custom pictures mapped by Function IDs */
-    void setCustomBackgroundList(QMap<quint32, QString>list) { m_customBackgroundImages = list; }
+    void setCustomBackgroundList(QMap<quint32, QString>list) { m_customBackgroundImages = list; emit changed(); }
 
     /** Reset any previously set background pictures list */
-    void resetCustomBackgroundList() { m_customBackgroundImages.clear(); }
+    void resetCustomBackgroundList() { m_customBackgroundImages.clear(); emit changed(); }
 
     /** Returns the map of custom background pictures organized as Function ID/Picture path */
     QMap<quint32, QString> customBackgroundList() const { return m_customBackgroundImages; }
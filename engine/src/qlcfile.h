@@ -42,6 +42,7 @@ class QString;
 #define KExtFixture          ".qxf"  // 'Q'LC+ 'X'ml 'F'ixture
 #define KExtFixtureList      ".qxfl" // 'Q'LC+ 'X'ml 'F'ixture 'L'ist
 #define KExtWorkspace        ".qxw"  // 'Q'LC+ 'X'ml 'W'orkspace
+#define KExtSnapshot         ".qxs"  // 'Q'LC+ 'X'ml workspace 'S'napshot
 #define KExtInputProfile     ".qxi"  // 'Q'LC+ 'X'ml 'I'nput profile
 #define KExtModifierTemplate ".qxmt" // 'Q'LC+ 'X'ml 'M'odifier 'T'emplate
 
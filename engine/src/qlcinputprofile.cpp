@@ -325,6 +325,49 @@ QLCInputProfile* QLCInputProfile::loader(const QString& path)
     return profile;
 }
 
+QString QLCInputProfile::nameFromFile(const QString& path)
+{
+    QXmlStreamReader *doc = QLCFile::getXMLReader(path);
+    if (doc == NULL || doc->device() == NULL || doc->hasError())
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to read input profile from" << path;
+        return QString();
+    }
+
+    QString manufacturer, model;
+    bool found = false;
+
+    if (doc->readNextStartElement() && doc->name() == KXMLQLCInputProfile)
+    {
+        /* Manufacturer and model come before the channels:
+           stop reading as soon as both are known */
+        while (doc->readNextStartElement())
+        {
+            if (doc->name() == KXMLQLCInputProfileManufacturer)
+                manufacturer = doc->readElementText();
+            else if (doc->name() == KXMLQLCInputProfileModel)
+                model = doc->readElementText();
+            else if (doc->name() == KXMLQLCInputChannel)
+                break;
+            else
+                doc->skipCurrentElement();
+
+            if (manufacturer.isEmpty() == false && model.isEmpty() == false)
+            {
+                found = true;
+                break;
+            }
+        }
+    }
+
+    QLCFile::releaseXMLReader(doc);
+
+    if (found == false)
+        return QString();
+
+    return QString("%1 %2").arg(manufacturer).arg(model);
+}
+
 bool QLCInputProfile::loadXML(QXmlStreamReader& doc)
 {
     if (doc.readNextStartElement() == false)
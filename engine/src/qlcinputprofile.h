@@ -190,6 +190,11 @@ public:
     /** Load an input profile from the given path */
     static QLCInputProfile* loader(const QString& path);
 
+    /** Read only the name (manufacturer - model) of the input profile
+        stored in the given path, without loading its channels.
+        Returns an empty string if the file is not a valid profile. */
+    static QString nameFromFile(const QString& path);
+
     /** Save an input profile into a given file name */
     bool saveXML(const QString& fileName);
 
@@ -154,6 +154,7 @@ void QLCPalette::setName(const QString &name)
 
     m_name = QString(name);
     emit nameChanged();
+    emit changed(m_id);
 }
 
 QVariant QLCPalette::value() const
@@ -214,6 +215,7 @@ void QLCPalette::setValue(QVariant val)
 {
     m_values.clear();
     m_values.append(val);
+    emit changed(m_id);
 }
 
 void QLCPalette::setValue(QVariant val1, QVariant val2)
@@ -221,6 +223,7 @@ void QLCPalette::setValue(QVariant val1, QVariant val2)
     m_values.clear();
     m_values.append(val1);
     m_values.append(val2);
+    emit changed(m_id);
 }
 
 QVariantList QLCPalette::values() const
@@ -231,11 +234,13 @@ QVariantList QLCPalette::values() const
 void QLCPalette::setValues(QVariantList values)
 {
     m_values = values;
+    emit changed(m_id);
 }
 
 void QLCPalette::resetValues()
 {
     m_values.clear();
+    emit changed(m_id);
 }
 
 QList<SceneValue> QLCPalette::valuesFromFixtures(Doc *doc, QList<quint32> fixtures)
@@ -449,6 +454,7 @@ void QLCPalette::setFanningType(QLCPalette::FanningType type)
     m_fanningType = type;
 
     emit fanningTypeChanged();
+    emit changed(m_id);
 }
 
 QString QLCPalette::fanningTypeToString(QLCPalette::FanningType type)
@@ -494,6 +500,7 @@ void QLCPalette::setFanningLayout(QLCPalette::FanningLayout layout)
     m_fanningLayout = layout;
 
     emit fanningLayoutChanged();
+    emit changed(m_id);
 }
 
 QString QLCPalette::fanningLayoutToString(QLCPalette::FanningLayout layout)
@@ -539,6 +546,7 @@ void QLCPalette::setFanningAmount(int amount)
     m_fanningAmount = amount;
 
     emit fanningAmountChanged();
+    emit changed(m_id);
 }
 
 QVariant QLCPalette::fanningValue() const
@@ -554,6 +562,7 @@ void QLCPalette::setFanningValue(QVariant value)
     m_fanningValue = value;
 
     emit fanningValueChanged();
+    emit changed(m_id);
 }
 
 /************************************************************************
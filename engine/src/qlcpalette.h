@@ -140,6 +140,9 @@ protected:
 signals:
     void nameChanged();
 
+    /** Emitted whenever any property of the palette is changed */
+    void changed(quint32 id);
+
 private:
     quint32 m_id;
     PaletteType m_type;
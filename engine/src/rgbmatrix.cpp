@@ -185,12 +185,27 @@ quint32 RGBMatrix::fixtureGroup() const
 
 void RGBMatrix::setFixtureGroup(quint32 id)
 {
+    bool changedGroup = (id != m_fixtureGroupID);
+
     m_fixtureGroupID = id;
     {
         QMutexLocker algoLocker(&m_algorithmMutex);
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
     }
     m_stepsCount = stepsCount();
+
+    if (changedGroup)
+        emit changed(this->id());
+}
+
+void RGBMatrix::slotFixtureGroupRemoved(quint32 id)
+{
+    if (id != m_fixtureGroupID)
+        return;
+
+    // The group is being deleted: don't keep a pointer to it
+    QMutexLocker algoLocker(&m_algorithmMutex);
+    m_group = NULL;
 }
 
 QList<quint32> RGBMatrix::components()
@@ -625,6 +640,11 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
     }
 }
 
+bool RGBMatrix::supportsParallelWrite() const
+{
+    return true;
+}
+
 void RGBMatrix::postRun(MasterTimer *timer, QList<Universe *> universes)
 {
     uint fadeout = overrideFadeOutSpeed() == defaultSpeed() ? fadeOutSpeed() : overrideFadeOutSpeed();
@@ -149,6 +149,10 @@ public:
     /** @reimp */
     QList<quint32> components();
 
+public slots:
+    /** @reimp */
+    void slotFixtureGroupRemoved(quint32 id);
+
 private:
     quint32 m_fixtureGroupID;
     FixtureGroup *m_group;
@@ -238,6 +242,9 @@ public:
     /** @reimp */
     void write(MasterTimer *timer, QList<Universe*> universes);
 
+    /** @reimp */
+    bool supportsParallelWrite() const;
+
     /** @reimp */
     void postRun(MasterTimer *timer, QList<Universe*> universes);
 
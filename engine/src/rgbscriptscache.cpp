@@ -17,7 +17,10 @@
   limitations under the License.
 */
 
+#include <QRegularExpression>
+#include <QTextStream>
 #include <QDebug>
+#include <QFile>
 #include <QDir>
 
 #include "rgbscriptscache.h"
@@ -37,8 +40,13 @@ RGBScriptsCache::RGBScriptsCache(Doc* doc)
 
 QStringList RGBScriptsCache::names() const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList names;
 
+    /* The full list is requested: evaluate all the pending scripts */
+    foreach (QString fileName, m_pendingMap.keys())
+        loadPending(fileName);
+
     QListIterator <RGBScript*> it(m_scriptsMap.values());
     while (it.hasNext() == true)
         names << it.next()->name();
@@ -48,6 +56,10 @@ QStringList RGBScriptsCache::names() const
 
 RGBScript const& RGBScriptsCache::script(QString name) const
 {
+    /* The returned scripts are never deleted, so they
+     * can be used after the mutex has been released */
+    QMutexLocker locker(&m_mutex);
+
     QListIterator <RGBScript*> it(m_scriptsMap.values());
     while (it.hasNext() == true)
     {
@@ -56,6 +68,27 @@ RGBScript const& RGBScriptsCache::script(QString name) const
             return *script;
     }
 
+    /* Evaluate the pending scripts with a matching name first, then
+       the ones whose name couldn't be found without evaluating them */
+    QMapIterator <QString, PendingScript> pit(m_pendingMap);
+    while (pit.hasNext() == true)
+    {
+        pit.next();
+        if (pit.value().name == name)
+        {
+            RGBScript* script = loadPending(pit.key());
+            if (script != NULL && script->name() == name)
+                return *script;
+        }
+    }
+
+    foreach (QString fileName, m_pendingMap.keys())
+    {
+        RGBScript* script = loadPending(fileName);
+        if (script != NULL && script->name() == name)
+            return *script;
+    }
+
     Q_ASSERT(m_dummyScript != NULL);
     return *m_dummyScript;
 }
@@ -67,6 +100,8 @@ bool RGBScriptsCache::load(const QDir& dir)
     if (dir.exists() == false || dir.isReadable() == false)
         return false;
 
+    QMutexLocker locker(&m_mutex);
+
     foreach (QString file, dir.entryList())
     {
         if (!file.toLower().endsWith(".js"))
@@ -74,19 +109,23 @@ bool RGBScriptsCache::load(const QDir& dir)
             qDebug() << "    " << file << " skipped (special file or does not end on *.js)";
             continue;
         }
-        if (!m_scriptsMap.contains(file))
+        if (!m_scriptsMap.contains(file) && !m_pendingMap.contains(file))
         {
-            RGBScript* script = new RGBScript(m_doc);
-            if (script->load(dir, file))
-            {
-                qDebug() << "    " << file << " loaded";
-                m_scriptsMap.insert(file, script);
-            }
-            else
+            QFile scriptFile(dir.absoluteFilePath(file));
+            if (scriptFile.open(QIODevice::ReadOnly) == false)
             {
                 qDebug() << "    " << file << " loading failed";
-                delete script;
+                continue;
             }
+
+            QTextStream stream(&scriptFile);
+            PendingScript pending;
+            pending.path = dir.absolutePath();
+            pending.name = scanName(stream.readAll());
+            scriptFile.close();
+
+            qDebug() << "    " << file << " found";
+            m_pendingMap.insert(file, pending);
         }
         else
         {
@@ -96,6 +135,38 @@ bool RGBScriptsCache::load(const QDir& dir)
     return true;
 }
 
+QString RGBScriptsCache::scanName(const QString& contents)
+{
+    /* Scripts declare their name as algo.name = "Name"; */
+    QRegularExpression re("algo\\.name\\s*=\\s*[\"']([^\"']+)[\"']");
+    QRegularExpressionMatch match = re.match(contents);
+    if (match.hasMatch())
+        return match.captured(1);
+
+    return QString();
+}
+
+RGBScript* RGBScriptsCache::loadPending(const QString& fileName) const
+{
+    if (m_pendingMap.contains(fileName) == false)
+        return NULL;
+
+    PendingScript pending = m_pendingMap.take(fileName);
+    RGBScript* script = new RGBScript(m_doc);
+
+    if (script->load(QDir(pending.path), fileName) == false)
+    {
+        qDebug() << "    " << fileName << " loading failed";
+        delete script;
+        return NULL;
+    }
+
+    qDebug() << "    " << fileName << " loaded";
+    m_scriptsMap.insert(fileName, script);
+
+    return script;
+}
+
 QDir RGBScriptsCache::systemScriptsDirectory()
 {
     return QLCFile::systemDirectory(QString(RGBSCRIPTDIR), QString(".js"));
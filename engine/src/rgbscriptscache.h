@@ -20,6 +20,7 @@
 #ifndef RGBSCRIPTSCACHE_H
 #define RGBSCRIPTSCACHE_H
 
+#include <QMutex>
 #include <QMap>
 
 class RGBScript;
@@ -50,6 +51,12 @@ public:
      * Returns true even if $dir doesn't contain any script,
      * if it is still accessible (and exists).
      *
+     * Scripts are only scanned for their name here. They are evaluated
+     * the first time they are requested with script() or names(), so
+     * this method doesn't need the script engine and can be called
+     * from any thread. The cache is guarded by a mutex, so it can be
+     * queried from any thread while scripts are being evaluated.
+     *
      * @param dir The directory to load scripts from.
      * @return true, if the path could be accessed, otherwise false.
      */
@@ -74,9 +81,27 @@ public:
     static QDir userScriptsDirectory();
 
 private:
+    /** Extract the script name from the contents of a script, without
+     *  evaluating it. Returns an empty string if the name is not found */
+    static QString scanName(const QString& contents);
+
+    /** Evaluate the pending script $fileName and move it to m_scriptsMap.
+     *  Returns the evaluated script or NULL if it failed to load.
+     *  The caller must hold m_mutex */
+    RGBScript* loadPending(const QString& fileName) const;
+
+private:
+    typedef struct
+    {
+        QString path;
+        QString name;
+    } PendingScript;
+
     Doc* m_doc;
-    QMap<QString, RGBScript*> m_scriptsMap; //! One instance of each script, filename-based map
+    mutable QMap<QString, RGBScript*> m_scriptsMap; //! One instance of each script, filename-based map
+    mutable QMap<QString, PendingScript> m_pendingMap; //! Scripts found but not yet evaluated, filename-based map
     RGBScript* m_dummyScript; //! Dummy empty script
+    mutable QMutex m_mutex; //! Guards the maps, which change while scripts are evaluated
 };
 
 /** @} */
@@ -358,7 +358,10 @@ void Scene::slotFixtureRemoved(quint32 fxi_id)
 void Scene::addFixture(quint32 fixtureId)
 {
     if (m_fixtures.contains(fixtureId) == false)
+    {
         m_fixtures.append(fixtureId);
+        emit changed(this->id());
+    }
 }
 
 bool Scene::removeFixture(quint32 fixtureId)
@@ -378,7 +381,10 @@ QList<quint32> Scene::fixtures() const
 void Scene::addFixtureGroup(quint32 id)
 {
     if (m_fixtureGroups.contains(id) == false)
+    {
         m_fixtureGroups.append(id);
+        emit changed(this->id());
+    }
 }
 
 bool Scene::removeFixtureGroup(quint32 id)
@@ -416,6 +422,11 @@ QList<quint32> Scene::palettes() const
  *****************************************************************************/
 
 bool Scene::saveXML(QXmlStreamWriter *doc)
+{
+    return saveXML(doc, true);
+}
+
+bool Scene::saveXML(QXmlStreamWriter *doc, bool saveValues)
 {
     Q_ASSERT(doc != NULL);
 
@@ -443,38 +454,41 @@ bool Scene::saveXML(QXmlStreamWriter *doc)
         doc->writeTextElement(KXMLQLCSceneChannelGroupsValues, chanGroupsIDs);
     }
 
-    /* Scene contents */
-    // make a copy of the Scene values cause we need to empty it in the process
-    QList<SceneValue> values = m_values.keys();
-
-    // loop through the Scene Fixtures in the order they've been added
-    foreach (quint32 fxId, m_fixtures)
+    /* Scene contents, unless stored elsewhere */
+    if (saveValues)
     {
-        QStringList currFixValues;
-        bool found = false;
+        // make a copy of the Scene values cause we need to empty it in the process
+        QList<SceneValue> values = m_values.keys();
 
-        // look for the values that match the current Fixture ID
-        for (int j = 0; j < values.count(); j++)
+        // loop through the Scene Fixtures in the order they've been added
+        foreach (quint32 fxId, m_fixtures)
         {
-            SceneValue scv = values.at(j);
-            if (scv.fxi != fxId)
+            QStringList currFixValues;
+            bool found = false;
+
+            // look for the values that match the current Fixture ID
+            for (int j = 0; j < values.count(); j++)
             {
-                if (found == true)
-                    break;
-                else
-                    continue;
+                SceneValue scv = values.at(j);
+                if (scv.fxi != fxId)
+                {
+                    if (found == true)
+                        break;
+                    else
+                        continue;
+                }
+
+                found = true;
+                currFixValues.append(QString::number(scv.channel));
+                // IMPORTANT: if a Scene is hidden, so used as a container by some Sequences,
+                // it must be saved with values set to zero
+                currFixValues.append(QString::number(isVisible() ? scv.value : 0));
+                values.removeAt(j);
+                j--;
             }
 
-            found = true;
-            currFixValues.append(QString::number(scv.channel));
-            // IMPORTANT: if a Scene is hidden, so used as a container by some Sequences,
-            // it must be saved with values set to zero
-            currFixValues.append(QString::number(isVisible() ? scv.value : 0));
-            values.removeAt(j);
-            j--;
+            saveXMLFixtureValues(doc, fxId, currFixValues);
         }
-
-        saveXMLFixtureValues(doc, fxId, currFixValues);
     }
 
     /* Save referenced Fixture Groups */
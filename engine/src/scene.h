@@ -231,6 +231,12 @@ public:
     /** @reimp */
     bool saveXML(QXmlStreamWriter *doc);
 
+    /**
+     * Save the Scene, optionally without its fixture values. Those are
+     * stored separately by the binary project snapshot.
+     */
+    bool saveXML(QXmlStreamWriter *doc, bool saveValues);
+
     /** @reimp */
     bool loadXML(QXmlStreamReader &root);
 
@@ -169,6 +169,8 @@ bool Script::setData(const QString& str)
         }
     }
 
+    emit changed(this->id());
+
     return true;
 }
 
@@ -177,6 +179,8 @@ bool Script::appendData(const QString &str)
     m_data.append(str + QString("\n"));
     m_lines << tokenizeLine(str + QString("\n"));
 
+    emit changed(this->id());
+
     return true;
 }
 
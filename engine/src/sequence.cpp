@@ -81,7 +81,11 @@ bool Sequence::copyFrom(const Function *function)
 
 void Sequence::setBoundSceneID(quint32 sceneID)
 {
+    if (sceneID == m_boundSceneID)
+        return;
+
     m_boundSceneID = sceneID;
+    emit changed(this->id());
 }
 
 quint32 Sequence::boundSceneID() const
@@ -76,6 +76,8 @@ HEADERS += bus.h \
            cue.h \
            cuestack.h \
            doc.h \
+           docautosave.h \
+           docsnapshot.h \
            dmxdumpfactoryproperties.h \
            dmxsource.h \
            efx.h \
@@ -113,6 +115,7 @@ HEADERS += bus.h \
            show.h \
            showfunction.h \
            showrunner.h \
+           startuptasks.h \
            track.h \
            universe.h
 
@@ -157,6 +160,8 @@ SOURCES += bus.cpp \
            cue.cpp \
            cuestack.cpp \
            doc.cpp \
+           docautosave.cpp \
+           docsnapshot.cpp \
            dmxdumpfactoryproperties.cpp \
            efx.cpp \
            efxfixture.cpp \
@@ -191,6 +196,7 @@ SOURCES += bus.cpp \
            show.cpp \
            showfunction.cpp \
            showrunner.cpp \
+           startuptasks.cpp \
            track.cpp \
            universe.cpp
 
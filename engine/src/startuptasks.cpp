@@ -0,0 +1,159 @@
+/*
+  Q Light Controller Plus
+  startuptasks.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTextStream>
+#include <QRunnable>
+#include <QDebug>
+
+#include "qlcfixturedefcache.h"
+#include "qlcmodifierscache.h"
+#include "rgbscriptscache.h"
+#include "inputoutputmap.h"
+#include "startuptasks.h"
+#include "doc.h"
+
+class StartupTaskRunnable : public QRunnable
+{
+public:
+    StartupTaskRunnable(StartupTasks *tasks, StartupTasks::Task task)
+        : m_tasks(tasks)
+        , m_task(task)
+    {
+    }
+
+    void run()
+    {
+        m_tasks->runTask(m_task);
+    }
+
+private:
+    StartupTasks *m_tasks;
+    StartupTasks::Task m_task;
+};
+
+StartupTasks::StartupTasks(Doc *doc, bool profile)
+    : m_doc(doc)
+    , m_profile(profile)
+    , m_stageStart(0)
+{
+    Q_ASSERT(m_doc != NULL);
+    m_clock.start();
+}
+
+StartupTasks::~StartupTasks()
+{
+    waitForFinished();
+}
+
+void StartupTasks::startCacheLoaders()
+{
+    /* The slowest tasks first */
+    m_pool.start(new StartupTaskRunnable(this, FixtureDefinitions));
+    m_pool.start(new StartupTaskRunnable(this, InputProfiles));
+    m_pool.start(new StartupTaskRunnable(this, ChannelModifiers));
+    m_pool.start(new StartupTaskRunnable(this, RGBScripts));
+}
+
+void StartupTasks::waitForFinished()
+{
+    m_pool.waitForDone();
+}
+
+void StartupTasks::beginStage(const QString& name)
+{
+    m_stageName = name;
+    m_stageStart = m_clock.elapsed();
+}
+
+void StartupTasks::endStage()
+{
+    if (m_stageName.isEmpty())
+        return;
+
+    addTiming(m_stageName, m_stageStart, true);
+    m_stageName.clear();
+}
+
+void StartupTasks::runTask(Task task)
+{
+    qint64 start = m_clock.elapsed();
+    QString name;
+
+    switch (task)
+    {
+        case FixtureDefinitions:
+            name = "Fixture definitions";
+            /* Load user fixtures first so that they override system fixtures */
+            m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
+            m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
+        break;
+        case ChannelModifiers:
+            name = "Channel modifiers";
+            m_doc->modifiersCache()->load(QLCModifiersCache::systemTemplateDirectory(), true);
+            m_doc->modifiersCache()->load(QLCModifiersCache::userTemplateDirectory());
+        break;
+        case RGBScripts:
+            name = "RGB scripts";
+            m_doc->rgbScriptsCache()->load(RGBScriptsCache::systemScriptsDirectory());
+            m_doc->rgbScriptsCache()->load(RGBScriptsCache::userScriptsDirectory());
+        break;
+        case InputProfiles:
+            name = "Input profiles";
+            m_doc->inputOutputMap()->loadProfiles(InputOutputMap::userProfileDirectory());
+            m_doc->inputOutputMap()->loadProfiles(InputOutputMap::systemProfileDirectory());
+        break;
+    }
+
+    addTiming(name, start, false);
+}
+
+void StartupTasks::addTiming(const QString& name, qint64 start, bool mainThread)
+{
+    StageTiming timing;
+    timing.name = name;
+    timing.start = start;
+    timing.elapsed = m_clock.elapsed() - start;
+    timing.mainThread = mainThread;
+
+    qDebug() << "[StartupTasks]" << name << "took" << timing.elapsed << "ms";
+
+    QMutexLocker locker(&m_timingsMutex);
+    m_timings.append(timing);
+}
+
+void StartupTasks::printReport()
+{
+    if (m_profile == false)
+        return;
+
+    QTextStream out(stdout);
+    QMutexLocker locker(&m_timingsMutex);
+
+    out << "Startup profile (" << m_pool.maxThreadCount() << " worker threads):" << "\n";
+    foreach (StageTiming timing, m_timings)
+    {
+        out << QString("  %1 %2 ms (started at %3 ms, %4)")
+               .arg(timing.name, -24)
+               .arg(timing.elapsed, 6)
+               .arg(timing.start)
+               .arg(timing.mainThread ? "main thread" : "worker thread") << "\n";
+    }
+    out << QString("  %1 %2 ms").arg("Total", -24).arg(m_clock.elapsed(), 6) << "\n";
+    out.flush();
+}
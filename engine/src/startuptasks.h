@@ -0,0 +1,103 @@
+/*
+  Q Light Controller Plus
+  startuptasks.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef STARTUPTASKS_H
+#define STARTUPTASKS_H
+
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QString>
+#include <QMutex>
+#include <QList>
+
+class Doc;
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/**
+ * Runs the independent stages of the application startup concurrently.
+ *
+ * The caches that only parse files (fixture definitions, channel modifiers,
+ * RGB scripts and input profiles) are loaded on a private thread pool by
+ * startCacheLoaders(). Stages that must run on the main thread, like the
+ * plugins loading, can be wrapped in beginStage()/endStage() to be part of
+ * the timing report. waitForFinished() must be called before anything
+ * uses the caches.
+ */
+class StartupTasks
+{
+public:
+    StartupTasks(Doc *doc, bool profile = false);
+    ~StartupTasks();
+
+    enum Task
+    {
+        FixtureDefinitions,
+        ChannelModifiers,
+        RGBScripts,
+        InputProfiles
+    };
+
+    /** Start loading the Doc caches on the thread pool */
+    void startCacheLoaders();
+
+    /** Wait for all the tasks started by startCacheLoaders() */
+    void waitForFinished();
+
+    /** Time a stage run on the calling thread */
+    void beginStage(const QString& name);
+    void endStage();
+
+    /** Print the time spent in each stage on stdout,
+     *  if profiling has been enabled */
+    void printReport();
+
+    /** Run the given task on the calling thread */
+    void runTask(Task task);
+
+private:
+    void addTiming(const QString& name, qint64 start, bool mainThread);
+
+private:
+    Doc *m_doc;
+    bool m_profile;
+    QThreadPool m_pool;
+    QElapsedTimer m_clock;
+
+    typedef struct
+    {
+        QString name;
+        qint64 start;
+        qint64 elapsed;
+        bool mainThread;
+    } StageTiming;
+
+    /** Protects m_timings, written by the worker threads */
+    QMutex m_timingsMutex;
+    QList<StageTiming> m_timings;
+
+    QString m_stageName;
+    qint64 m_stageStart;
+};
+
+/** @} */
+
+#endif
@@ -42,6 +42,35 @@
 #define KXMLUniverseAdditiveBlend "Additive"
 #define KXMLUniverseSubtractiveBlend "Subtractive"
 
+/** Number of ticks without anything to process before a universe
+ *  stops its thread and releases its unused buffers */
+#define UNIVERSE_IDLE_TICKS 100
+
+/* Zero filled buffers shared by all the universes. They are implicitly
+ * shared, so a universe gets its own copy the first time it writes one */
+static const QByteArray& sharedZeroValues()
+{
+    static const QByteArray zeroValues(UNIVERSE_SIZE, char(0));
+    return zeroValues;
+}
+
+static const QVector<short>& sharedRelativeValues()
+{
+    static const QVector<short> relativeValues(UNIVERSE_SIZE, 0);
+    return relativeValues;
+}
+
+static const QVector<ChannelModifier*>& sharedModifiers()
+{
+    static const QVector<ChannelModifier*> modifiers(UNIVERSE_SIZE, NULL);
+    return modifiers;
+}
+
+static bool isShared(const QByteArray& values)
+{
+    return values.constData() == sharedZeroValues().constData();
+}
+
 Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     : QThread(parent)
     , m_id(id)
@@ -50,38 +79,41 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_monitor(false)
     , m_inputPatch(NULL)
     , m_fbPatch(NULL)
-    , m_channelsMask(new QByteArray(UNIVERSE_SIZE, char(0)))
-    , m_modifiedZeroValues(new QByteArray(UNIVERSE_SIZE, char(0)))
+    , m_feedbackInterval(0)
+    , m_channelsMask(new QByteArray(sharedZeroValues()))
+    , m_modifiers(sharedModifiers())
+    , m_modifiedZeroValues(new QByteArray(sharedZeroValues()))
+    , m_running(false)
+    , m_threadEnabled(false)
+    , m_idleTicks(0)
     , m_usedChannels(0)
     , m_totalChannels(0)
     , m_totalChannelsChanged(false)
     , m_intensityChannelsChanged(false)
-    , m_preGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
-    , m_postGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
-    , m_lastPostGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
+    , m_preGMValues(new QByteArray(sharedZeroValues()))
+    , m_postGMValues(new QByteArray(sharedZeroValues()))
+    , m_lastPostGMValues(new QByteArray(sharedZeroValues()))
     , m_passthroughValues()
+    , m_relativeValues(sharedRelativeValues())
 {
-    m_relativeValues.fill(0, UNIVERSE_SIZE);
-    m_modifiers.fill(NULL, UNIVERSE_SIZE);
-
     m_name = QString("Universe %1").arg(id + 1);
 
+    m_faderPool = QSharedPointer<GenericFaderPool>(new GenericFaderPool());
+
     connect(m_grandMaster, SIGNAL(valueChanged(uchar)),
             this, SLOT(slotGMValueChanged()));
 }
 
 Universe::~Universe()
 {
-    if (isRunning() == true)
     {
-        // isRunning is inconsistent with m_running,
-        // so double check if the thread is really in the run loop
-        while (m_running == false)
-            usleep(10000);
-
+        QMutexLocker locker(&m_threadMutex);
+        // m_running is set before the thread is started,
+        // so there is no need to wait for it to enter the run loop
+        m_threadEnabled = false;
         m_running = false;
-        wait(1000);
     }
+    wait(1000);
 
     delete m_inputPatch;
     int opCount = m_outputPatchList.count();
@@ -160,6 +192,9 @@ void Universe::setPassthrough(bool enable)
 
     connectInputPatch();
 
+    if (enable)
+        wake();
+
     emit passthroughChanged();
 }
 
@@ -202,12 +237,40 @@ void Universe::slotGMValueChanged()
  * Faders
  ************************************************************************/
 
+/** Deleter of the requested faders: give them back to the pool
+ *  of their Universe, or delete them if it doesn't exist anymore */
+class GenericFaderRecycler
+{
+public:
+    GenericFaderRecycler(const QSharedPointer<GenericFaderPool>& pool)
+        : m_pool(pool)
+    {
+    }
+
+    void operator()(GenericFader *fader)
+    {
+        QSharedPointer<GenericFaderPool> pool = m_pool.toStrongRef();
+        if (pool.isNull())
+            delete fader;
+        else
+            pool->release(fader);
+    }
+
+private:
+    QWeakPointer<GenericFaderPool> m_pool;
+};
+
 QSharedPointer<GenericFader> Universe::requestFader(Universe::FaderPriority priority)
 {
     int insertPos = 0;
-    QSharedPointer<GenericFader> fader = QSharedPointer<GenericFader>(new GenericFader());
+    QSharedPointer<GenericFader> fader(m_faderPool->acquire(), GenericFaderRecycler(m_faderPool));
     fader->setPriority(priority);
 
+    wake();
+
+    // functions might request faders concurrently, in parallel write mode
+    QMutexLocker locker(&m_fadersMutex);
+
     if (m_faders.isEmpty())
     {
         m_faders.append(fader);
@@ -234,6 +297,7 @@ QSharedPointer<GenericFader> Universe::requestFader(Universe::FaderPriority prio
 
 void Universe::dismissFader(QSharedPointer<GenericFader> fader)
 {
+    QMutexLocker locker(&m_fadersMutex);
     int index = m_faders.indexOf(fader);
     if (index >= 0)
     {
@@ -288,7 +352,9 @@ void Universe::setFaderPause(quint32 functionID, bool enable)
 
 void Universe::tick()
 {
-    m_semaphore.release(1);
+    // dormant universes don't accumulate ticks
+    if (m_running)
+        m_semaphore.release(1);
 }
 
 void Universe::processFaders()
@@ -324,13 +390,18 @@ void Universe::processFaders()
     const QByteArray postGM = m_postGMValues->mid(0, m_usedChannels);
     dumpOutput(postGM);
 
+    if (m_outputPatchList.count())
+        emit outputDumped();
+
     if (hasChanged())
+    {
+        m_idleTicks = 0;
         emit universeWritten(id(), postGM);
+    }
 }
 
 void Universe::run()
 {
-    m_running = true;
     int timeout = int(MasterTimer::tick()) * 2;
 
     qDebug() << "Universe thread started" << id();
@@ -347,28 +418,142 @@ void Universe::run()
             qDebug() << "<<<<<<<< UNIVERSE TICK - id" << id() << "faders:" << m_faders.count();
 #endif
         processFaders();
+
+        if (isIdle() == false)
+        {
+            m_idleTicks = 0;
+            continue;
+        }
+
+        QMutexLocker locker(&m_threadMutex);
+        // wake() resets the counter while holding the mutex,
+        // so the universe can't go dormant right after being woken up
+        if (++m_idleTicks < UNIVERSE_IDLE_TICKS || isIdle() == false)
+            continue;
+
+        reclaim();
+        m_running = false;
     }
 
     qDebug() << "Universe thread stopped" << id();
 }
 
+/************************************************************************
+ * Dormancy
+ ************************************************************************/
+
+void Universe::startThread()
+{
+    {
+        QMutexLocker locker(&m_threadMutex);
+        m_threadEnabled = true;
+    }
+
+    if (isIdle() == false)
+        wake();
+}
+
+bool Universe::isDormant() const
+{
+    return m_running == false;
+}
+
+void Universe::wake()
+{
+    QMutexLocker locker(&m_threadMutex);
+
+    m_idleTicks = 0;
+
+    if (m_threadEnabled == false || m_running == true)
+        return;
+
+    // the buffers given back before going dormant are not in use anymore
+    m_retiredValues.clear();
+    m_retiredRelativeValues.clear();
+
+    // the thread might still be leaving the run loop
+    wait();
+
+    m_running = true;
+    start();
+}
+
+bool Universe::isIdle() const
+{
+    return m_faders.isEmpty() && m_passthrough == false &&
+           m_inputPatch == NULL && m_outputPatchList.isEmpty() && m_fbPatch == NULL;
+}
+
+void Universe::reclaim()
+{
+    const QByteArray& zeroValues = sharedZeroValues();
+    QList<QByteArray*> buffers;
+    buffers << m_preGMValues.data() << m_postGMValues.data() << m_lastPostGMValues.data()
+            << m_channelsMask.data() << m_modifiedZeroValues.data();
+
+    foreach (QByteArray *values, buffers)
+    {
+        if (isShared(*values) || *values != zeroValues)
+            continue;
+
+        m_retiredValues.append(*values);
+        *values = zeroValues;
+    }
+
+    if (m_relativeValues.constData() != sharedRelativeValues().constData())
+    {
+        m_retiredRelativeValues = m_relativeValues;
+        m_relativeValues = sharedRelativeValues();
+    }
+
+    qDebug() << "Universe" << id() << "is dormant, using" << memoryUsage() << "bytes";
+}
+
+int Universe::memoryUsage() const
+{
+    int bytes = 0;
+
+    QList<const QByteArray*> buffers;
+    buffers << m_preGMValues.data() << m_postGMValues.data() << m_lastPostGMValues.data()
+            << m_channelsMask.data() << m_modifiedZeroValues.data() << m_passthroughValues.data();
+
+    foreach (const QByteArray *values, buffers)
+    {
+        if (values != NULL && isShared(*values) == false)
+            bytes += values->capacity();
+    }
+
+    if (m_relativeValues.constData() != sharedRelativeValues().constData())
+        bytes += m_relativeValues.capacity() * int(sizeof(short));
+
+    if (m_modifiers.constData() != sharedModifiers().constData())
+        bytes += m_modifiers.capacity() * int(sizeof(ChannelModifier*));
+
+    return bytes;
+}
+
 /************************************************************************
  * Values
  ************************************************************************/
 
 void Universe::reset()
 {
-    m_preGMValues->fill(0);
+    // don't race with reclaim(), and don't allocate the shared buffers
+    QMutexLocker locker(&m_threadMutex);
+
+    if (isShared(*m_preGMValues) == false)
+        m_preGMValues->fill(0);
     if (m_passthrough)
     {
         (*m_postGMValues) = (*m_passthroughValues);
     }
-    else
+    else if (isShared(*m_postGMValues) == false)
     {
         m_postGMValues->fill(0);
     }
     zeroRelativeValues();
-    m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    if (m_modifiers.constData() != sharedModifiers().constData())
+        m_modifiers.fill(NULL, UNIVERSE_SIZE);
     m_passthrough = false; // not releasing m_passthroughValues, see comment in setPassthrough
 }
 
@@ -380,9 +565,12 @@ void Universe::reset(int address, int range)
     if (address + range > UNIVERSE_SIZE)
        range = UNIVERSE_SIZE - address;
 
-    memset(m_preGMValues->data() + address, 0, range * sizeof(*m_preGMValues->data()));
-    memset(m_relativeValues.data() + address, 0, range * sizeof(*m_relativeValues.data()));
-    memcpy(m_postGMValues->data() + address, m_modifiedZeroValues->data() + address, range * sizeof(*m_postGMValues->data()));
+    if (isShared(*m_preGMValues) == false)
+        memset(m_preGMValues->data() + address, 0, range * sizeof(*m_preGMValues->data()));
+    if (m_relativeValues.constData() != sharedRelativeValues().constData())
+        memset(m_relativeValues.data() + address, 0, range * sizeof(*m_relativeValues.data()));
+    if (isShared(*m_postGMValues) == false || isShared(*m_modifiedZeroValues) == false)
+        memcpy(m_postGMValues->data() + address, m_modifiedZeroValues->constData() + address, range * sizeof(*m_postGMValues->data()));
 
     applyPassthroughValues(address, range);
 }
@@ -440,6 +628,9 @@ const QByteArray* Universe::postGMValues() const
 
 void Universe::zeroRelativeValues()
 {
+    if (m_relativeValues.constData() == sharedRelativeValues().constData())
+        return;
+
     memset(m_relativeValues.data(), 0, UNIVERSE_SIZE * sizeof(*m_relativeValues.data()));
 }
 
@@ -492,9 +683,9 @@ uchar Universe::preGMValue(int address) const
 
 uchar Universe::applyRelative(int channel, uchar value)
 {
-    if (m_relativeValues[channel] != 0)
+    if (m_relativeValues.at(channel) != 0)
     {
-        int val = m_relativeValues[channel] + value;
+        int val = m_relativeValues.at(channel) + value;
         return CLAMP(val, 0, (int)UCHAR_MAX);
     }
 
@@ -580,16 +771,25 @@ bool Universe::setInputPatch(QLCIOPlugin *plugin,
         if (plugin == NULL || input == QLCIOPlugin::invalidLine())
             return true;
 
-        m_inputPatch = new InputPatch(m_id, this);
+        InputPatch *patch = new InputPatch(m_id, this);
+        {
+            QMutexLocker locker(&m_patchMutex);
+            m_inputPatch = patch;
+        }
         connectInputPatch();
+        wake();
     }
     else
     {
         if (input == QLCIOPlugin::invalidLine())
         {
             disconnectInputPatch();
-            delete m_inputPatch;
-            m_inputPatch = NULL;
+            InputPatch *patch = m_inputPatch;
+            {
+                QMutexLocker locker(&m_patchMutex);
+                m_inputPatch = NULL;
+            }
+            delete patch;
             emit inputPatchChanged();
             return true;
         }
@@ -597,7 +797,11 @@ bool Universe::setInputPatch(QLCIOPlugin *plugin,
 
     if (m_inputPatch != NULL)
     {
-        bool result = m_inputPatch->set(plugin, input, profile);
+        bool result;
+        {
+            QMutexLocker locker(&m_patchMutex);
+            result = m_inputPatch->set(plugin, input, profile);
+        }
         emit inputPatchChanged();
         return result;
     }
@@ -619,14 +823,21 @@ bool Universe::setOutputPatch(QLCIOPlugin *plugin, quint32 output, int index)
         if (plugin == NULL || output == QLCIOPlugin::invalidLine())
         {
             // need to delete an existing patch
-            OutputPatch *patch = m_outputPatchList.takeAt(index);
+            OutputPatch *patch;
+            {
+                QMutexLocker locker(&m_patchMutex);
+                patch = m_outputPatchList.takeAt(index);
+            }
             delete patch;
             emit outputPatchesCountChanged();
             return true;
         }
 
-        OutputPatch *patch = m_outputPatchList.at(index);
-        bool result = patch->set(plugin, output);
+        bool result;
+        {
+            QMutexLocker locker(&m_patchMutex);
+            result = m_outputPatchList.at(index)->set(plugin, output);
+        }
         emit outputPatchChanged();
         return result;
     }
@@ -638,7 +849,11 @@ bool Universe::setOutputPatch(QLCIOPlugin *plugin, quint32 output, int index)
         // add a new patch
         OutputPatch *patch = new OutputPatch(m_id, this);
         bool result = patch->set(plugin, output);
-        m_outputPatchList.append(patch);
+        {
+            QMutexLocker locker(&m_patchMutex);
+            m_outputPatchList.append(patch);
+        }
+        wake();
         emit outputPatchesCountChanged();
         return result;
     }
@@ -655,13 +870,18 @@ bool Universe::setFeedbackPatch(QLCIOPlugin *plugin, quint32 output)
             return false;
 
         m_fbPatch = new OutputPatch(m_id, this);
+        wake();
     }
     else
     {
         if (plugin == NULL || output == QLCIOPlugin::invalidLine())
         {
-            delete m_fbPatch;
-            m_fbPatch = NULL;
+            OutputPatch *patch = m_fbPatch;
+            {
+                QMutexLocker locker(&m_patchMutex);
+                m_fbPatch = NULL;
+            }
+            delete patch;
             emit hasFeedbacksChanged();
             return true;
         }
@@ -681,6 +901,20 @@ bool Universe::hasFeedbacks() const
     return m_fbPatch != NULL ? true : false;
 }
 
+void Universe::setFeedbackInterval(uint ms)
+{
+    if (ms == m_feedbackInterval)
+        return;
+
+    m_feedbackInterval = ms;
+    emit feedbackIntervalChanged();
+}
+
+uint Universe::feedbackInterval() const
+{
+    return m_feedbackInterval;
+}
+
 InputPatch *Universe::inputPatch() const
 {
     return m_inputPatch;
@@ -706,6 +940,8 @@ OutputPatch *Universe::feedbackPatch() const
 
 void Universe::dumpOutput(const QByteArray &data)
 {
+    QMutexLocker locker(&m_patchMutex);
+
     if (m_outputPatchList.count() == 0)
         return;
 
@@ -734,10 +970,31 @@ const QByteArray& Universe::blackoutData()
 
 void Universe::flushInput()
 {
+    QMutexLocker locker(&m_patchMutex);
+
     if (m_inputPatch == NULL)
         return;
 
-    m_inputPatch->flush(m_id);
+    if (m_passthrough == false)
+    {
+        m_inputPatch->flush(m_id);
+        return;
+    }
+
+    // whole input frames are merged here, without per channel notifications
+    QBitArray changed;
+    m_inputPatch->flush(m_id, m_passthroughValues.data(), &changed);
+
+    for (int i = 0; i < changed.size(); i++)
+    {
+        if (changed.testBit(i) == false)
+            continue;
+
+        if (i >= m_usedChannels)
+            m_usedChannels = i + 1;
+
+        updatePostGMValue(i);
+    }
 }
 
 void Universe::slotInputValueChanged(quint32 universe, quint32 channel, uchar value, const QString &key)
@@ -798,6 +1055,8 @@ void Universe::setChannelCapability(ushort channel, QLCChannel::Group group, Cha
     if (channel >= (ushort)m_channelsMask->count())
         return;
 
+    wake();
+
     if (Utils::vectorRemove(m_intensityChannels, channel))
         m_intensityChannelsChanged = true;
     Utils::vectorRemove(m_nonIntensityChannels, channel);
@@ -857,6 +1116,8 @@ uchar Universe::channelCapabilities(ushort channel)
 
 void Universe::setChannelDefaultValue(ushort channel, uchar value)
 {
+    wake();
+
     if (channel >= m_totalChannels)
     {
         m_totalChannels = channel + 1;
@@ -875,6 +1136,8 @@ void Universe::setChannelModifier(ushort channel, ChannelModifier *modifier)
     if (channel >= (ushort)m_modifiers.count())
         return;
 
+    wake();
+
     m_modifiers[channel] = modifier;
 
     if (modifier != NULL)
@@ -1133,6 +1396,10 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
                 outputUID = pAttrs.value(KXMLQLCUniverseLineUID).toString();
             if (pAttrs.hasAttribute(KXMLQLCUniverseLine))
                 output = pAttrs.value(KXMLQLCUniverseLine).toString().toUInt();
+            if (pAttrs.hasAttribute(KXMLQLCUniverseFeedbackInterval))
+                setFeedbackInterval(pAttrs.value(KXMLQLCUniverseFeedbackInterval).toString().toUInt());
+            else
+                setFeedbackInterval(0);
 
             // apply the parameters just loaded
             ioMap->setOutputPatch(index, plugin, outputUID, output, true);
@@ -1219,7 +1486,7 @@ bool Universe::saveXML(QXmlStreamWriter *doc) const
     if (feedbackPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseFeedbackPatch, feedbackPatch()->pluginName(), feedbackPatch()->outputName(),
-            feedbackPatch()->output(), "", feedbackPatch()->getPluginParameters());
+            feedbackPatch()->output(), "", feedbackPatch()->getPluginParameters(), feedbackInterval());
     }
 
     /* End the <Universe> tag */
@@ -1235,7 +1502,8 @@ void Universe::savePatchXML(
     const QString &lineName,
     quint32 line,
     QString profileName,
-    QMap<QString, QVariant> parameters) const
+    QMap<QString, QVariant> parameters,
+    uint interval) const
 {
     // sanity check: don't save invalid data
     if (pluginName.isEmpty() || pluginName == KInputNone || line == QLCIOPlugin::invalidLine())
@@ -1247,6 +1515,8 @@ void Universe::savePatchXML(
     doc->writeAttribute(KXMLQLCUniverseLine, QString::number(line));
     if (!profileName.isEmpty() && profileName != KInputNone)
         doc->writeAttribute(KXMLQLCUniverseProfileName, profileName);
+    if (interval > 0)
+        doc->writeAttribute(KXMLQLCUniverseFeedbackInterval, QString::number(interval));
 
     savePluginParametersXML(doc, parameters);
     doc->writeEndElement();
@@ -23,6 +23,7 @@
 
 #include <QScopedPointer>
 #include <QSemaphore>
+#include <QMutex>
 #include <QByteArray>
 #include <QThread>
 #include <QSet>
@@ -32,6 +33,7 @@
 class QXmlStreamReader;
 class QLCInputProfile;
 class ChannelModifier;
+class GenericFaderPool;
 class InputOutputMap;
 class GenericFader;
 class QLCIOPlugin;
@@ -59,6 +61,7 @@ class Doc;
 #define KXMLQLCUniverseLine "Line"
 #define KXMLQLCUniverseLineUID "UID"
 #define KXMLQLCUniverseProfileName "Profile"
+#define KXMLQLCUniverseFeedbackInterval "Interval"
 #define KXMLQLCUniversePluginParameters "PluginParameters"
 
 /** Universe class contains input/output data for one DMX universe
@@ -211,6 +214,15 @@ public:
     /** Flag that indicates if this Universe has a patched feedback line */
     bool hasFeedbacks() const;
 
+    /**
+     * Set the minimum time between two feedback frames sent to the
+     * feedback line, to avoid flooding slow devices.
+     *
+     * @param ms The minimum interval in milliseconds, 0 to send at every tick
+     */
+    void setFeedbackInterval(uint ms);
+    uint feedbackInterval() const;
+
     /**
      * Get the reference to the input plugin associated to this universe.
      * If not present NULL is returned.
@@ -270,6 +282,9 @@ signals:
     /** Notify the listeners that a feedback line has been patched/unpatched */
     void hasFeedbacksChanged();
 
+    /** Notify the listeners that the feedback interval has changed */
+    void feedbackIntervalChanged();
+
 private:
     /** Reference to the input patch associated to this universe. */
     InputPatch *m_inputPatch;
@@ -280,6 +295,13 @@ private:
     /** Reference to the feedback patch associated to this universe. */
     OutputPatch *m_fbPatch;
 
+    /** Minimum time between two feedback frames, in milliseconds */
+    uint m_feedbackInterval;
+
+    /** Guards the patches against the universe thread while they are
+     *  changed, so that patching doesn't need to lock every universe */
+    QMutex m_patchMutex;
+
 private:
     // Connect to inputPatch's valueChanged signal
     void connectInputPatch();
@@ -348,7 +370,9 @@ public:
      *  this Universe. The caller is in charge of adding/removing
      *  FadeChannels and eventually dismiss a fader when no longer needed.
      *  If a fade out transition is needed, this Universe
-     *  is in charge of completing it and dismissing the fader. */
+     *  is in charge of completing it and dismissing the fader.
+     *  Faders come from a pool and go back to it when they are
+     *  no longer referenced. */
     QSharedPointer<GenericFader> requestFader(FaderPriority priority = Auto);
 
     /** Dismiss a fader requested with requestFader, which is no longer needed */
@@ -373,9 +397,57 @@ protected:
     /** DMX writer thread worker method */
     void run();
 
+    /************************************************************************
+     * Dormancy
+     ************************************************************************/
+public:
+    /**
+     * Allow the universe thread to run, and start it if the universe
+     * is in use. Universes nothing refers to stay dormant, without
+     * a thread, until a fixture, fader, patch or passthrough wakes them up.
+     */
+    void startThread();
+
+    /** Returns true if the universe thread is not running */
+    bool isDormant() const;
+
+    /** Returns the number of bytes allocated for the universe channels.
+     *  The buffers are shared by all the universes until written */
+    int memoryUsage() const;
+
+protected:
+    /** Bring the universe out of dormancy, starting its thread if allowed */
+    void wake();
+
+    /** Returns true if the universe thread has nothing to process */
+    bool isIdle() const;
+
+    /** Give the buffers left zero filled back to the shared ones.
+     *  Called by the universe thread before going dormant */
+    void reclaim();
+
+protected:
+    /** Protects the thread start and stop */
+    QMutex m_threadMutex;
+
+    /** Set by startThread(), when the universe thread may run */
+    bool m_threadEnabled;
+
+    /** Number of consecutive ticks without anything to process */
+    int m_idleTicks;
+
+    /** Buffers replaced by reclaim(), kept until the next wake up
+     *  since other threads might still be reading them */
+    QList<QByteArray> m_retiredValues;
+    QVector<short> m_retiredRelativeValues;
+
 signals:
     void universeWritten(quint32 universeID, const QByteArray& universeData);
 
+    /** Emitted by the universe thread each time the output
+     *  patches have been written, changed or not */
+    void outputDumped();
+
 protected:
     QSemaphore m_semaphore;
 
@@ -386,6 +458,13 @@ protected:
      *  the Universe values. The order is very important ! */
     QList<QSharedPointer<GenericFader> > m_faders;
 
+    /** Guards the changes of m_faders made by the functions */
+    QMutex m_fadersMutex;
+
+    /** The faders ready to be reused. Faders hold a weak reference to
+     *  it, since they can outlive this Universe */
+    QSharedPointer<GenericFaderPool> m_faderPool;
+
     /************************************************************************
      * Values
      ************************************************************************/
@@ -602,7 +681,8 @@ public:
         QString const & pluginName, const QString &lineName,
         quint32 line,
         QString profileName,
-        QMap<QString, QVariant>parameters) const;
+        QMap<QString, QVariant>parameters,
+        uint interval = 0) const;
 
     /**
      * Save a plugin custom parameters (if available) into a tag nested
@@ -66,10 +66,6 @@ Video::Video(Doc* doc)
     registerAttribute(tr("Y Position"), Function::LastWins, -100.0, 100.0, 0.0);
     registerAttribute(tr("Width scale"), Function::LastWins, 0, 1000.0, 100.0);
     registerAttribute(tr("Height scale"), Function::LastWins, 0, 1000.0, 100.0);
-
-    // Listen to member Function removals
-    connect(doc, SIGNAL(functionRemoved(quint32)),
-            this, SLOT(slotFunctionRemoved(quint32)));
 }
 
 Video::~Video()
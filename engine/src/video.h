@@ -81,8 +81,7 @@ public:
     bool copyFrom(const Function* function);
 
 public slots:
-    /** Catches Doc::functionRemoved() so that destroyed members can be
-        removed immediately. */
+    /** @reimp */
     void slotFunctionRemoved(quint32 function);
 
     /*********************************************************************
@@ -35,6 +35,7 @@
 #include "collection.h"
 #include "qlcchannel.h"
 #include "sequence.h"
+#include "rgbmatrix.h"
 #include "qlcfile.h"
 #include "fixture.h"
 #include "chaser.h"
@@ -955,6 +956,82 @@ void Doc_Test::usage()
     QVERIFY(byType.at(4) == s5);
 }
 
+void Doc_Test::dependencies()
+{
+    Fixture* f1 = new Fixture(m_doc);
+    f1->setChannels(5);
+    f1->setAddress(m_currentAddr);
+    m_doc->addFixture(f1);
+    m_currentAddr += f1->channels();
+
+    Fixture* f2 = new Fixture(m_doc);
+    f2->setChannels(5);
+    f2->setAddress(m_currentAddr);
+    m_doc->addFixture(f2);
+    m_currentAddr += f2->channels();
+
+    FixtureGroup* grp = new FixtureGroup(m_doc);
+    QVERIFY(m_doc->addFixtureGroup(grp) == true);
+
+    Scene *s1 = new Scene(m_doc);
+    s1->setValue(f1->id(), 0, 255);
+    m_doc->addFunction(s1);
+
+    Scene *s2 = new Scene(m_doc);
+    s2->setValue(f1->id(), 1, 127);
+    s2->setValue(f2->id(), 1, 127);
+    m_doc->addFunction(s2);
+
+    Chaser *c1 = new Chaser(m_doc);
+    c1->addStep(ChaserStep(s1->id()));
+    c1->addStep(ChaserStep(s2->id()));
+    m_doc->addFunction(c1);
+
+    Collection *col1 = new Collection(m_doc);
+    col1->addFunction(s2->id());
+    m_doc->addFunction(col1);
+
+    RGBMatrix *mtx = new RGBMatrix(m_doc);
+    mtx->setFixtureGroup(grp->id());
+    m_doc->addFunction(mtx);
+
+    QCOMPARE(m_doc->functionUsers(s1->id()), QList<quint32>() << c1->id());
+    QCOMPARE(m_doc->functionUsers(s2->id()), QList<quint32>() << c1->id() << col1->id());
+    QCOMPARE(m_doc->functionUsers(c1->id()).count(), 0);
+    QCOMPARE(m_doc->fixtureUsers(f1->id()), QList<quint32>() << s1->id() << s2->id());
+    QCOMPARE(m_doc->fixtureUsers(f2->id()), QList<quint32>() << s2->id());
+    QCOMPARE(m_doc->fixtureGroupUsers(grp->id()), QList<quint32>() << mtx->id());
+
+    /* edits are indexed */
+    c1->removeStep(0);
+    col1->addFunction(s1->id());
+    QCOMPARE(m_doc->functionUsers(s1->id()), QList<quint32>() << col1->id());
+    s1->setValue(f2->id(), 0, 10);
+    QCOMPARE(m_doc->fixtureUsers(f2->id()), QList<quint32>() << s1->id() << s2->id());
+
+    /* removals reach the functions using the removed item */
+    QVERIFY(m_doc->deleteFunction(s2->id()) == true);
+    QCOMPARE(c1->stepsCount(), 0);
+    QCOMPARE(col1->functions(), QList<quint32>() << s1->id());
+    QCOMPARE(m_doc->functionUsers(s2->id()).count(), 0);
+    QCOMPARE(m_doc->fixtureUsers(f1->id()), QList<quint32>() << s1->id());
+
+    QVERIFY(m_doc->deleteFixture(f2->id()) == true);
+    QCOMPARE(s1->components(), QList<quint32>() << f1->id());
+    QCOMPARE(m_doc->fixtureUsers(f2->id()).count(), 0);
+
+    quint32 grpId = grp->id();
+    QVERIFY(m_doc->deleteFixtureGroup(grpId) == true);
+    QVERIFY(mtx->m_group == NULL);
+    QCOMPARE(mtx->fixtureGroup(), grpId);
+
+    /* the functions removed with the contents are dropped from the index */
+    m_doc->clearContents();
+    QVERIFY(m_doc->m_dependencies.isEmpty());
+    QVERIFY(m_doc->m_functionUsers.isEmpty());
+    QVERIFY(m_doc->m_fixtureUsers.isEmpty());
+}
+
 void Doc_Test::load()
 {
     QBuffer buffer;
@@ -60,6 +60,7 @@ private slots:
     void deleteFunction();
     void function();
     void usage();
+    void dependencies();
 
     void load();
     void loadWrongRoot();
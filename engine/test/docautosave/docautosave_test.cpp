@@ -0,0 +1,525 @@
+/*
+  Q Light Controller Plus - Unit test
+  docautosave_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QtTest>
+
+#define private public
+#include "docautosave.h"
+#undef private
+
+#include "docautosave_test.h"
+#include "channelsgroup.h"
+#include "qlcpalette.h"
+#include "fixture.h"
+#include "chaser.h"
+#include "scene.h"
+#include "bus.h"
+#include "doc.h"
+
+/** Each dimmer pack is patched right after the previous one */
+#define DIMMERS         3
+#define DIMMER_CHANNELS 6
+
+/** Save an application section with the number of times it's been saved */
+class WorkspaceAutosave : public DocAutosave
+{
+public:
+    WorkspaceAutosave(Doc *doc)
+        : DocAutosave(doc)
+        , m_saved(0)
+    {
+    }
+
+    int workspaceSections() const
+    {
+        return 1;
+    }
+
+    bool saveWorkspaceSection(int index, QXmlStreamWriter *doc)
+    {
+        Q_UNUSED(index);
+        m_saved++;
+        doc->writeTextElement("TestSection", QString::number(m_saved));
+        return true;
+    }
+
+    int m_saved;
+};
+
+void DocAutosave_Test::initTestCase()
+{
+    Bus::init(this);
+    m_dir = new QTemporaryDir();
+    QVERIFY(m_dir->isValid() == true);
+    m_path = m_dir->path() + "/autosave.qxa";
+}
+
+void DocAutosave_Test::cleanupTestCase()
+{
+    delete m_dir;
+}
+
+void DocAutosave_Test::init()
+{
+    m_doc = new Doc(this);
+}
+
+void DocAutosave_Test::cleanup()
+{
+    delete m_doc;
+    QFile::remove(m_path);
+    QFile::remove(journalPath());
+}
+
+QString DocAutosave_Test::journalPath() const
+{
+    return m_path + ".journal";
+}
+
+void DocAutosave_Test::populate(int scenes)
+{
+    for (int i = 0; i < DIMMERS; i++)
+    {
+        Fixture *fxi = new Fixture(m_doc);
+        fxi->setName(QString("Dimmer pack %1").arg(i));
+        fxi->setChannels(DIMMER_CHANNELS);
+        fxi->setAddress(i * DIMMER_CHANNELS);
+        fxi->setUniverse(0);
+        m_doc->addFixture(fxi);
+    }
+
+    /* Every scene drives a single dimmer pack, with levels derived
+     * from the scene index to tell restored scenes apart */
+    for (int s = 0; s < scenes; s++)
+    {
+        Scene *scene = new Scene(m_doc);
+        scene->setName(QString("Scene %1").arg(s));
+        for (quint32 ch = 0; ch < DIMMER_CHANNELS; ch++)
+            scene->setValue(quint32(s % DIMMERS), ch, uchar((s * 10 + ch) % 256));
+        m_doc->addFunction(scene);
+    }
+}
+
+Doc *DocAutosave_Test::restore()
+{
+    QByteArray xml;
+    if (DocAutosave::restore(m_path, xml) == false)
+        return NULL;
+
+    QXmlStreamReader doc(xml);
+    if (doc.readNextStartElement() == false || doc.name() != "Workspace")
+        return NULL;
+    if (doc.readNextStartElement() == false)
+        return NULL;
+
+    Doc *restored = new Doc(this);
+    if (restored->loadXML(doc) == false)
+    {
+        delete restored;
+        return NULL;
+    }
+
+    return restored;
+}
+
+void DocAutosave_Test::disabled()
+{
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    QVERIFY(autosave.isEnabled() == false);
+
+    populate(2);
+    QVERIFY(autosave.m_dirty.isEmpty() == true);
+    QVERIFY(autosave.m_timer.isActive() == false);
+
+    autosave.flush();
+    QVERIFY(QFile::exists(m_path) == false);
+    QVERIFY(DocAutosave::exists(m_path) == false);
+}
+
+void DocAutosave_Test::fullSave()
+{
+    populate(10);
+    m_doc->setStartupFunction(3);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    QVERIFY(autosave.m_dirty.isEmpty() == false);
+    QVERIFY(autosave.m_timer.isActive() == true);
+
+    autosave.flush();
+    QVERIFY(autosave.m_dirty.isEmpty() == true);
+    QVERIFY(DocAutosave::exists(m_path) == true);
+    QVERIFY(QFile::exists(journalPath()) == true);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(restored->fixtures().size(), DIMMERS);
+    QCOMPARE(restored->functions().size(), 10);
+    QCOMPARE(restored->startupFunction(), quint32(3));
+
+    Scene *scene = qobject_cast<Scene *>(restored->function(7));
+    QVERIFY(scene != NULL);
+    QCOMPARE(scene->name(), QString("Scene 7"));
+    QCOMPARE(scene->values().size(), DIMMER_CHANNELS);
+    QCOMPARE(scene->value(7 % DIMMERS, 3), uchar(7 * 10 + 3));
+
+    delete restored;
+}
+
+void DocAutosave_Test::journal()
+{
+    populate(4);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+
+    QFile base(m_path);
+    qint64 baseSize = base.size();
+    QFile journal(journalPath());
+    qint64 journalSize = journal.size();
+
+    Scene *scene = qobject_cast<Scene *>(m_doc->function(1));
+    QVERIFY(scene != NULL);
+    scene->setValue(1, 0, 42);
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::FunctionSection, 1)));
+
+    autosave.flush();
+    QCOMPARE(autosave.m_journalEntries, 1);
+
+    /* Only the journal grows */
+    QCOMPARE(base.size(), baseSize);
+    QVERIFY(journal.size() > journalSize);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    scene = qobject_cast<Scene *>(restored->function(1));
+    QVERIFY(scene != NULL);
+    QCOMPARE(scene->value(1, 0), uchar(42));
+    delete restored;
+
+    /* A change that results in the same XML is not journaled */
+    m_doc->setModified();
+    autosave.flush();
+    QCOMPARE(autosave.m_journalEntries, 1);
+}
+
+void DocAutosave_Test::removal()
+{
+    populate(4);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+
+    QVERIFY(m_doc->deleteFunction(2) == true);
+    autosave.flush();
+    QCOMPARE(autosave.m_journalEntries, 1);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(restored->functions().size(), 3);
+    QVERIFY(restored->function(2) == NULL);
+    delete restored;
+}
+
+void DocAutosave_Test::compaction()
+{
+    populate(4);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setCompactThreshold(3);
+    autosave.setEnabled(true);
+    autosave.flush();
+
+    quint32 generation = autosave.m_generation;
+    QFile journal(journalPath());
+    qint64 emptySize = journal.size();
+
+    Scene *scene = qobject_cast<Scene *>(m_doc->function(0));
+    QVERIFY(scene != NULL);
+
+    scene->setValue(0, 0, 1);
+    autosave.flush();
+    scene->setValue(0, 0, 2);
+    autosave.flush();
+    QCOMPARE(autosave.m_journalEntries, 2);
+    QVERIFY(journal.size() > emptySize);
+    QCOMPARE(autosave.m_generation, generation);
+
+    /* The third entry reaches the threshold */
+    scene->setValue(0, 0, 3);
+    autosave.flush();
+    QCOMPARE(autosave.m_journalEntries, 0);
+    QCOMPARE(autosave.m_generation, generation + 1);
+    QCOMPARE(journal.size(), emptySize);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    scene = qobject_cast<Scene *>(restored->function(0));
+    QVERIFY(scene != NULL);
+    QCOMPARE(scene->value(0, 0), uchar(3));
+    delete restored;
+}
+
+void DocAutosave_Test::staleJournal()
+{
+    populate(2);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+
+    Scene *scene = qobject_cast<Scene *>(m_doc->function(0));
+    QVERIFY(scene != NULL);
+    uchar original = scene->value(0, 0);
+    scene->setValue(0, 0, 99);
+    autosave.flush();
+
+    /* Pretend the journal belongs to another generation, like after
+       a crash between writing the base and resetting the journal */
+    QFile journal(journalPath());
+    QVERIFY(journal.open(QIODevice::ReadWrite) == true);
+    QDataStream stream(&journal);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, generation;
+    stream >> magic >> generation;
+    journal.seek(sizeof(quint32));
+    stream << quint32(generation - 1);
+    journal.close();
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    scene = qobject_cast<Scene *>(restored->function(0));
+    QVERIFY(scene != NULL);
+    QCOMPARE(scene->value(0, 0), original);
+    delete restored;
+}
+
+void DocAutosave_Test::truncatedJournal()
+{
+    populate(2);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+
+    Scene *scene = qobject_cast<Scene *>(m_doc->function(0));
+    QVERIFY(scene != NULL);
+    scene->setValue(0, 0, 10);
+    autosave.flush();
+    qint64 firstEntryEnd = QFile(journalPath()).size();
+
+    scene = qobject_cast<Scene *>(m_doc->function(1));
+    QVERIFY(scene != NULL);
+    scene->setValue(1, 0, 20);
+    autosave.flush();
+
+    /* Cut the last entry in half, like a crash while appending it */
+    QFile journal(journalPath());
+    qint64 fullSize = journal.size();
+    QVERIFY(journal.resize(firstEntryEnd + (fullSize - firstEntryEnd) / 2) == true);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(qobject_cast<Scene *>(restored->function(0))->value(0, 0), uchar(10));
+    QCOMPARE(qobject_cast<Scene *>(restored->function(1))->value(1, 0), uchar(10));
+    delete restored;
+}
+
+void DocAutosave_Test::slicedSave()
+{
+    populate(2000);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    QCOMPARE(autosave.m_dirty.size(), DIMMERS + 2000 + 3);
+
+    /* A single tick can't serialize 2000 scenes within the budget */
+    autosave.slotTimeout();
+    QVERIFY(autosave.m_dirty.isEmpty() == false);
+    QVERIFY(autosave.m_dirty.size() < DIMMERS + 2000 + 3);
+    QVERIFY(autosave.m_timer.isActive() == true);
+    QVERIFY(autosave.m_timer.interval() < autosave.interval());
+
+    /* Nothing is written until the records are complete */
+    autosave.m_pool.waitForDone();
+    QVERIFY(QFile::exists(m_path) == false);
+
+    int ticks = 1;
+    while (autosave.m_dirty.isEmpty() == false)
+    {
+        autosave.slotTimeout();
+        ticks++;
+    }
+    QVERIFY(ticks > 1);
+    autosave.m_pool.waitForDone();
+    QVERIFY(QFile::exists(m_path) == true);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(restored->functions().size(), 2000);
+    delete restored;
+}
+
+void DocAutosave_Test::discard()
+{
+    populate(2);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+    QVERIFY(DocAutosave::exists(m_path) == true);
+
+    autosave.discard();
+    QVERIFY(DocAutosave::exists(m_path) == false);
+    QVERIFY(QFile::exists(journalPath()) == false);
+
+    /* The next change writes a complete base again */
+    Scene *scene = qobject_cast<Scene *>(m_doc->function(0));
+    QVERIFY(scene != NULL);
+    scene->setValue(0, 0, 5);
+    autosave.flush();
+    QVERIFY(DocAutosave::exists(m_path) == true);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(restored->functions().size(), 2);
+    QCOMPARE(restored->fixtures().size(), DIMMERS);
+    delete restored;
+}
+
+void DocAutosave_Test::cleared()
+{
+    populate(2);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+    QVERIFY(DocAutosave::exists(m_path) == true);
+
+    m_doc->clearContents();
+    QVERIFY(DocAutosave::exists(m_path) == false);
+    QVERIFY(autosave.m_records.isEmpty() == true);
+    QVERIFY(autosave.m_dirty.isEmpty() == true);
+}
+
+void DocAutosave_Test::changeTracking()
+{
+    populate(2);
+
+    ChannelsGroup *grp = new ChannelsGroup(m_doc);
+    grp->setName("Group");
+    grp->addChannel(0, 0);
+    m_doc->addChannelsGroup(grp);
+
+    QLCPalette *palette = new QLCPalette(QLCPalette::Dimmer);
+    palette->setValue(100);
+    m_doc->addPalette(palette);
+
+    DocAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+
+    /* A generic modification serializes only what can't notify */
+    m_doc->setModified();
+    QCOMPARE(autosave.m_dirty.size(), 1);
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::EngineSection, 0)));
+    autosave.flush();
+
+    grp->addChannel(1, 0);
+    QCOMPARE(autosave.m_dirty.size(), 2);
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::ChannelsGroupSection, grp->id())));
+    autosave.flush();
+
+    palette->setValue(50);
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::PaletteSection, palette->id())));
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::ChannelsGroupSection, grp->id())) == false);
+    autosave.flush();
+
+    m_doc->monitorProperties()->setLabelsVisible(true);
+    QCOMPARE(autosave.m_dirty.size(), 1);
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::MonitorSection, 0)));
+    autosave.flush();
+
+    m_doc->inputOutputMap()->setUniverseName(0, "Renamed");
+    QCOMPARE(autosave.m_dirty.size(), 1);
+    QVERIFY(autosave.m_dirty.contains(DocAutosave::recordKey(DocAutosave::IOMapSection, 0)));
+    autosave.flush();
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(restored->channelsGroup(grp->id())->getChannels().size(), 2);
+    QCOMPARE(restored->palette(palette->id())->value().toInt(), 50);
+    QCOMPARE(restored->monitorProperties()->labelsVisible(), true);
+    QCOMPARE(restored->inputOutputMap()->getUniverseNameByIndex(0), QString("Renamed"));
+    delete restored;
+}
+
+void DocAutosave_Test::workspaceSections()
+{
+    populate(2);
+
+    WorkspaceAutosave autosave(m_doc);
+    autosave.setPath(m_path);
+    autosave.setEnabled(true);
+    autosave.flush();
+    QCOMPARE(autosave.m_saved, 1);
+
+    /* Application sections are serialized again on any modification */
+    m_doc->setModified();
+    autosave.flush();
+    QCOMPARE(autosave.m_saved, 2);
+    QCOMPARE(autosave.m_journalEntries, 1);
+
+    QByteArray xml;
+    QVERIFY(DocAutosave::restore(m_path, xml) == true);
+
+    /* The section follows the Engine, inside the Workspace */
+    QXmlStreamReader doc(xml);
+    QVERIFY(doc.readNextStartElement() == true);
+    QCOMPARE(doc.name().toString(), QString("Workspace"));
+    QVERIFY(doc.readNextStartElement() == true);
+    QCOMPARE(doc.name().toString(), QString("Engine"));
+    doc.skipCurrentElement();
+    QVERIFY(doc.readNextStartElement() == true);
+    QCOMPARE(doc.name().toString(), QString("TestSection"));
+    QCOMPARE(doc.readElementText(), QString("2"));
+    QVERIFY(doc.readNextStartElement() == false);
+    QVERIFY(doc.hasError() == false);
+
+    Doc *restored = restore();
+    QVERIFY(restored != NULL);
+    QCOMPARE(restored->functions().size(), 2);
+    delete restored;
+}
+
+QTEST_MAIN(DocAutosave_Test)
@@ -0,0 +1,65 @@
+/*
+  Q Light Controller Plus - Unit test
+  docautosave_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DOCAUTOSAVE_TEST_H
+#define DOCAUTOSAVE_TEST_H
+
+#include <QTemporaryDir>
+#include <QObject>
+
+class Doc;
+class DocAutosave_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    void disabled();
+    void fullSave();
+    void journal();
+    void removal();
+    void compaction();
+    void staleJournal();
+    void truncatedJournal();
+    void slicedSave();
+    void discard();
+    void cleared();
+    void changeTracking();
+    void workspaceSections();
+
+private:
+    /** Add the dimmer packs and $scenes scenes to m_doc */
+    void populate(int scenes);
+
+    /** Restore the autosave into a new Doc, owned by the caller */
+    Doc *restore();
+
+    QString journalPath() const;
+
+private:
+    QTemporaryDir *m_dir;
+    QString m_path;
+    Doc *m_doc;
+};
+
+#endif
@@ -0,0 +1,367 @@
+/*
+  Q Light Controller Plus - Unit test
+  docsnapshot_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QtTest>
+
+#include "docsnapshot_test.h"
+#include "fixturegroup.h"
+#include "docsnapshot.h"
+#include "collection.h"
+#include "chaserstep.h"
+#include "fixture.h"
+#include "qlcfile.h"
+#include "chaser.h"
+#include "scene.h"
+#include "bus.h"
+#include "doc.h"
+
+#define FIXTURES 4
+#define CHANNELS 8
+
+void DocSnapshot_Test::initTestCase()
+{
+    Bus::init(this);
+    m_dir = new QTemporaryDir();
+    QVERIFY(m_dir->isValid() == true);
+}
+
+void DocSnapshot_Test::cleanupTestCase()
+{
+    delete m_dir;
+}
+
+void DocSnapshot_Test::createWorkspace(Doc *doc, int scenes)
+{
+    /* The last fixture is added to the scenes without values */
+    for (int i = 0; i <= FIXTURES; i++)
+    {
+        Fixture *fxi = new Fixture(doc);
+        fxi->setName(QString("Dimmers %1").arg(i));
+        fxi->setChannels(CHANNELS);
+        fxi->setAddress(i * CHANNELS);
+        fxi->setUniverse(0);
+        QVERIFY(doc->addFixture(fxi) == true);
+    }
+
+    FixtureGroup *grp = new FixtureGroup(doc);
+    grp->setName("Group");
+    doc->addFixtureGroup(grp);
+
+    Chaser *chaser = new Chaser(doc);
+    chaser->setName("Chaser");
+    QVERIFY(doc->addFunction(chaser) == true);
+
+    Collection *collection = new Collection(doc);
+    collection->setName("Collection");
+    QVERIFY(doc->addFunction(collection) == true);
+
+    for (int s = 0; s < scenes; s++)
+    {
+        Scene *scene = new Scene(doc);
+        scene->setName(QString("Scene %1").arg(s));
+        for (quint32 fxId = 0; fxId < FIXTURES; fxId++)
+        {
+            for (quint32 ch = 0; ch < CHANNELS; ch++)
+                scene->setValue(fxId, ch, uchar((s + fxId + ch) % 256));
+        }
+        scene->addFixture(FIXTURES);
+        scene->addFixtureGroup(grp->id());
+        QVERIFY(doc->addFunction(scene) == true);
+
+        if (s < 16)
+            chaser->addStep(ChaserStep(scene->id()));
+        if (s < 2)
+            collection->addFunction(scene->id());
+    }
+
+    doc->setStartupFunction(chaser->id());
+}
+
+void DocSnapshot_Test::saveWorkspace(Doc *doc, const QString &path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(engineXML(doc));
+    file.close();
+
+    DocSnapshot snapshot;
+    QVERIFY(doc->saveSnapshot(&snapshot) == true);
+    snapshot.setWorkspaceXML("<Workspace><Creator/></Workspace>");
+    QVERIFY(snapshot.save(path) == true);
+}
+
+QByteArray DocSnapshot_Test::engineXML(Doc *doc)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter xmlWriter(&buffer);
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.writeStartDocument();
+    doc->saveXML(&xmlWriter);
+    xmlWriter.writeEndDocument();
+    buffer.close();
+
+    return buffer.data();
+}
+
+bool DocSnapshot_Test::loadXML(Doc *doc, const QString &path)
+{
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return false;
+
+    QXmlStreamReader xmlReader(&file);
+    if (xmlReader.readNextStartElement() == false)
+        return false;
+
+    return doc->loadXML(xmlReader);
+}
+
+void DocSnapshot_Test::snapshotPath()
+{
+    QCOMPARE(DocSnapshot::snapshotPath("/tmp/show.qxw"), QString("/tmp/show%1").arg(KExtSnapshot));
+    QCOMPARE(DocSnapshot::snapshotPath("/tmp/my.show.qxw"), QString("/tmp/my.show%1").arg(KExtSnapshot));
+}
+
+void DocSnapshot_Test::roundTrip()
+{
+    QString path = m_dir->path() + "/roundtrip" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 32);
+    saveWorkspace(doc, path);
+    delete doc;
+
+    Doc *xmlDoc = new Doc(this);
+    QVERIFY(loadXML(xmlDoc, path) == true);
+
+    DocSnapshot snapshot;
+    QVERIFY(snapshot.open(path) == true);
+    QVERIFY(snapshot.isValid() == true);
+    QCOMPARE(snapshot.startupFunction(), quint32(0));
+    QCOMPARE(snapshot.workspaceXML(), QByteArray("<Workspace><Creator/></Workspace>"));
+
+    Doc *snapDoc = new Doc(this);
+    QSignalSpy loading(snapDoc, SIGNAL(loading()));
+    QSignalSpy loaded(snapDoc, SIGNAL(loaded()));
+    QVERIFY(snapDoc->loadSnapshot(snapshot) == true);
+    QCOMPARE(loading.size(), 1);
+    QCOMPARE(loaded.size(), 1);
+    QVERIFY(snapDoc->loadStatus() == Doc::Loaded);
+
+    QCOMPARE(snapDoc->fixtures().size(), xmlDoc->fixtures().size());
+    QCOMPARE(snapDoc->functions().size(), xmlDoc->functions().size());
+    QCOMPARE(snapDoc->fixtureGroups().size(), xmlDoc->fixtureGroups().size());
+    QCOMPARE(snapDoc->startupFunction(), xmlDoc->startupFunction());
+
+    Scene *xmlScene = qobject_cast<Scene *>(xmlDoc->function(5));
+    Scene *snapScene = qobject_cast<Scene *>(snapDoc->function(5));
+    QVERIFY(xmlScene != NULL);
+    QVERIFY(snapScene != NULL);
+    QCOMPARE(snapScene->fixtures().size(), FIXTURES + 1);
+    QCOMPARE(snapScene->fixtures(), xmlScene->fixtures());
+    QCOMPARE(snapScene->values(), xmlScene->values());
+    QCOMPARE(snapScene->fixtureGroups(), xmlScene->fixtureGroups());
+
+    /* Both loaders must produce the very same document */
+    QCOMPARE(engineXML(snapDoc), engineXML(xmlDoc));
+
+    delete xmlDoc;
+    delete snapDoc;
+}
+
+void DocSnapshot_Test::hiddenScene()
+{
+    QString path = m_dir->path() + "/hidden" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 1);
+    Scene *scene = qobject_cast<Scene *>(doc->function(2));
+    QVERIFY(scene != NULL);
+    scene->setVisible(false);
+    saveWorkspace(doc, path);
+    delete doc;
+
+    DocSnapshot snapshot;
+    QVERIFY(snapshot.open(path) == true);
+
+    doc = new Doc(this);
+    QVERIFY(doc->loadSnapshot(snapshot) == true);
+    scene = qobject_cast<Scene *>(doc->function(2));
+    QVERIFY(scene != NULL);
+    QVERIFY(scene->isVisible() == false);
+    QCOMPARE(scene->values().size(), FIXTURES * CHANNELS);
+
+    /* Hidden scenes are saved with zero values, like in the XML */
+    foreach (SceneValue scv, scene->values())
+        QCOMPARE(scv.value, uchar(0));
+
+    delete doc;
+}
+
+void DocSnapshot_Test::fixtureRemoval()
+{
+    QString path = m_dir->path() + "/removal" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 2);
+    saveWorkspace(doc, path);
+    delete doc;
+
+    DocSnapshot snapshot;
+    QVERIFY(snapshot.open(path) == true);
+
+    doc = new Doc(this);
+    QVERIFY(doc->loadSnapshot(snapshot) == true);
+    Scene *scene = qobject_cast<Scene *>(doc->function(2));
+    QVERIFY(scene != NULL);
+    QCOMPARE(scene->values().size(), FIXTURES * CHANNELS);
+    QVERIFY(doc->fixtureUsers(0).contains(scene->id()));
+
+    /* The scene, loaded with its values, is told about the removal */
+    QVERIFY(doc->deleteFixture(0) == true);
+    QCOMPARE(scene->values().size(), (FIXTURES - 1) * CHANNELS);
+    foreach (SceneValue scv, scene->values())
+        QVERIFY(scv.fxi != 0);
+
+    delete doc;
+}
+
+void DocSnapshot_Test::staleWorkspace()
+{
+    QString path = m_dir->path() + "/stale" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 2);
+    saveWorkspace(doc, path);
+    delete doc;
+
+    DocSnapshot snapshot;
+    QVERIFY(snapshot.open(path) == true);
+    snapshot.close();
+    QVERIFY(snapshot.isValid() == false);
+
+    /* Edit the workspace file behind the snapshot's back */
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::Append) == true);
+    file.write("\n");
+    file.close();
+
+    QVERIFY(snapshot.open(path) == false);
+    QVERIFY(snapshot.isValid() == false);
+
+    doc = new Doc(this);
+    QVERIFY(doc->loadSnapshot(snapshot) == false);
+    QCOMPARE(doc->functions().size(), 0);
+    delete doc;
+}
+
+void DocSnapshot_Test::corruptedSnapshot()
+{
+    QString path = m_dir->path() + "/corrupted" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 2);
+    saveWorkspace(doc, path);
+    delete doc;
+
+    QFile file(DocSnapshot::snapshotPath(path));
+    QVERIFY(file.open(QIODevice::ReadOnly) == true);
+    QByteArray data = file.readAll();
+    file.close();
+
+    /* Truncated */
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(data.left(data.size() - 1));
+    file.close();
+
+    DocSnapshot snapshot;
+    QVERIFY(snapshot.open(path) == false);
+
+    /* Unknown version */
+    QByteArray newer(data);
+    newer[8] = char(newer.at(8) + 1);
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(newer);
+    file.close();
+    QVERIFY(snapshot.open(path) == false);
+
+    /* Not a snapshot at all */
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(QByteArray(data.size(), 'x'));
+    file.close();
+    QVERIFY(snapshot.open(path) == false);
+
+    /* Restored */
+    QVERIFY(file.open(QIODevice::WriteOnly) == true);
+    file.write(data);
+    file.close();
+    QVERIFY(snapshot.open(path) == true);
+}
+
+void DocSnapshot_Test::missingSnapshot()
+{
+    DocSnapshot snapshot;
+    QVERIFY(snapshot.open(m_dir->path() + "/missing" + KExtWorkspace) == false);
+    QVERIFY(snapshot.isValid() == false);
+    QCOMPARE(snapshot.recordCount(), 0);
+    QCOMPARE(snapshot.recordXML(0), QByteArray());
+}
+
+void DocSnapshot_Test::loadXMLBenchmark()
+{
+    QString path = m_dir->path() + "/xmlbenchmark" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 2000);
+    saveWorkspace(doc, path);
+
+    QBENCHMARK
+    {
+        doc->clearContents();
+        loadXML(doc, path);
+    }
+
+    QCOMPARE(doc->functions().size(), 2002);
+    delete doc;
+}
+
+void DocSnapshot_Test::loadSnapshotBenchmark()
+{
+    QString path = m_dir->path() + "/snapshotbenchmark" + KExtWorkspace;
+
+    Doc *doc = new Doc(this);
+    createWorkspace(doc, 2000);
+    saveWorkspace(doc, path);
+
+    QBENCHMARK
+    {
+        doc->clearContents();
+        DocSnapshot snapshot;
+        snapshot.open(path);
+        doc->loadSnapshot(snapshot);
+    }
+
+    QCOMPARE(doc->functions().size(), 2002);
+    delete doc;
+}
+
+QTEST_APPLESS_MAIN(DocSnapshot_Test)
@@ -0,0 +1,64 @@
+/*
+  Q Light Controller Plus - Unit test
+  docsnapshot_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DOCSNAPSHOT_TEST_H
+#define DOCSNAPSHOT_TEST_H
+
+#include <QTemporaryDir>
+#include <QObject>
+
+class Doc;
+class DocSnapshot_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void snapshotPath();
+    void roundTrip();
+    void hiddenScene();
+    void fixtureRemoval();
+    void staleWorkspace();
+    void corruptedSnapshot();
+    void missingSnapshot();
+
+    void loadXMLBenchmark();
+    void loadSnapshotBenchmark();
+
+private:
+    /** Fill $doc with fixtures, groups and functions. $scenes
+     *  scenes are created, each one setting all the fixtures */
+    void createWorkspace(Doc *doc, int scenes);
+
+    /** Save $doc as an Engine XML file and write its snapshot */
+    void saveWorkspace(Doc *doc, const QString& path);
+
+    /** Get the Engine XML of $doc */
+    QByteArray engineXML(Doc *doc);
+
+    /** Load the Engine XML file $path into $doc */
+    bool loadXML(Doc *doc, const QString& path);
+
+private:
+    QTemporaryDir *m_dir;
+};
+
+#endif
@@ -128,6 +128,29 @@ void GenericFader_Test::addRemove()
     QCOMPARE(fader->m_channels[chHash].target(), uchar(63));
 }
 
+void GenericFader_Test::channelFaderTemplate()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = QSharedPointer<GenericFader>(new GenericFader());
+
+    FadeChannel tmpl(m_doc, 0, 0);
+    quint32 chHash = GenericFader::channelHash(tmpl.fixture(), tmpl.channel());
+
+    FadeChannel *fc = fader->getChannelFader(tmpl, ua[0]);
+    QVERIFY(fc != NULL);
+    QCOMPARE(fader->m_channels.count(), 1);
+    QVERIFY(fader->m_channels.contains(chHash) == true);
+    QCOMPARE(fc->flags(), tmpl.flags());
+    QCOMPARE(fc->current(), ua[0]->preGMValue(10));
+
+    // same channel, same fader
+    fc->setTarget(100);
+    FadeChannel *fc2 = fader->getChannelFader(m_doc, ua[0], 0, 0);
+    QVERIFY(fc == fc2);
+    QCOMPARE(fc2->target(), uchar(100));
+    QCOMPARE(fader->m_channels.count(), 1);
+}
+
 void GenericFader_Test::writeZeroFade()
 {
     QList<Universe*> ua = m_doc->inputOutputMap()->universes();
@@ -33,6 +33,7 @@ private slots:
     void cleanup();
 
     void addRemove();
+    void channelFaderTemplate();
     void writeZeroFade();
     void writeLoop();
     void adjustIntensity();
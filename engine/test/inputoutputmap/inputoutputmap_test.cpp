@@ -16,7 +16,11 @@
   See the License for the specific language governing permissions and
   limitations under the License.
 */
+#include <QXmlStreamReader>
+#include <QBuffer>
+#include <QXmlStreamWriter>
 #include <QSignalSpy>
+#include <QThread>
 #include <QtTest>
 
 #define private public
@@ -37,6 +41,29 @@
 #define ENGINEDIR "../../src"
 #include "../common/resource_paths.h"
 
+/** Claim the universes exclusively from another thread */
+class ExclusiveClaimer : public QThread
+{
+public:
+    ExclusiveClaimer(InputOutputMap *iom)
+        : m_iom(iom)
+        , m_claimed(0)
+    {
+    }
+
+protected:
+    void run()
+    {
+        m_iom->claimUniverses(true);
+        m_claimed.storeRelease(1);
+        m_iom->releaseUniverses(false);
+    }
+
+public:
+    InputOutputMap *m_iom;
+    QAtomicInt m_claimed;
+};
+
 static QDir testPluginDir()
 {
     QDir dir(TESTPLUGINDIR);
@@ -523,6 +550,114 @@ void InputOutputMap_Test::slotValueChanged()
     QVERIFY(spy.at(3).at(2) == UCHAR_MAX);
 }
 
+void InputOutputMap_Test::inputSubscriptions()
+{
+    InputOutputMap im(m_doc, 4);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    // subscriptions made before patching apply to the new patch
+    im.subscribeInputChannel(1, 20);
+    im.subscribeInputChannel(1, (2 << 16) | 20);
+    QVERIFY(im.setInputPatch(1, stub->name(), stub->inputs().at(0), 0) == true);
+    InputPatch *ip = im.inputPatch(1);
+    QVERIFY(ip->isChannelSubscribed(20) == true);
+    QVERIFY(ip->isChannelSubscribed(21) == false);
+
+    // the page is ignored and subscriptions are counted
+    im.unsubscribeInputChannel(1, 20);
+    QVERIFY(ip->isChannelSubscribed(20) == true);
+    im.unsubscribeInputChannel(1, (2 << 16) | 20);
+    QVERIFY(ip->isChannelSubscribed(20) == false);
+    QVERIFY(im.m_inputSubscriptions.isEmpty());
+
+    im.setInputMonitor(true);
+    im.setInputMonitor(true);
+    QVERIFY(ip->m_monitored == true);
+    im.setInputMonitor(false);
+    QVERIFY(ip->m_monitored == true);
+    im.setInputMonitor(false);
+    QVERIFY(ip->m_monitored == false);
+}
+
+void InputOutputMap_Test::feedback()
+{
+    InputOutputMap im(m_doc, 4);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+    stub->m_feedbackFrames.clear();
+
+    // no feedback line, nothing is collected
+    QVERIFY(im.sendFeedBack(1, 10, 100) == false);
+    QVERIFY(im.sendFeedBack(5, 10, 100) == false);
+    QVERIFY(im.m_pendingFeedback.isEmpty());
+
+    QVERIFY(im.setOutputPatch(1, stub->name(), stub->outputs().at(0), 0, true) == true);
+
+    // only the last value of each channel is sent, at the next tick
+    QVERIFY(im.sendFeedBack(1, 20, 1) == true);
+    QVERIFY(im.sendFeedBack(1, 10, 100) == true);
+    QVERIFY(im.sendFeedBack(1, 10, 200) == true);
+    QVERIFY(im.sendFeedBack(1, 30, 5, "/foo") == true);
+    QCOMPARE(stub->m_feedbackFrames.count(), 0);
+
+    im.flushFeedback();
+    QVERIFY(im.m_feedbackQueued == true);
+    im.slotSendFeedback();
+    QVERIFY(im.m_feedbackQueued == false);
+
+    QCOMPARE(stub->m_feedbackFrames.count(), 1);
+    QList<PluginFeedbackValue> frame = stub->m_feedbackFrames.at(0);
+    QCOMPARE(frame.count(), 3);
+    QCOMPARE(frame.at(0).channel, quint32(10));
+    QCOMPARE(frame.at(0).value, uchar(200));
+    QCOMPARE(frame.at(1).channel, quint32(20));
+    QCOMPARE(frame.at(1).value, uchar(1));
+    QCOMPARE(frame.at(2).channel, quint32(30));
+    QCOMPARE(frame.at(2).key, QString("/foo"));
+    QVERIFY(im.m_pendingFeedback.isEmpty());
+
+    // nothing to send, nothing is queued
+    im.flushFeedback();
+    QVERIFY(im.m_feedbackQueued == false);
+
+    // a rate limited line keeps collecting until its interval elapses
+    im.setFeedbackInterval(1, 60000);
+    QCOMPARE(im.feedbackInterval(1), uint(60000));
+    QCOMPARE(im.feedbackInterval(2), uint(0));
+    QVERIFY(im.sendFeedBack(1, 10, 0) == true);
+    im.slotSendFeedback();
+    QCOMPARE(stub->m_feedbackFrames.count(), 1);
+    QCOMPARE(im.m_pendingFeedback[1].count(), 1);
+
+    im.setFeedbackInterval(1, 0);
+    QVERIFY(im.sendFeedBack(1, 11, 0) == true);
+    im.slotSendFeedback();
+    QCOMPARE(stub->m_feedbackFrames.count(), 2);
+    QCOMPARE(stub->m_feedbackFrames.at(1).count(), 2);
+    QVERIFY(im.m_pendingFeedback.isEmpty());
+
+    // the interval is saved and loaded with the feedback patch
+    im.setFeedbackInterval(1, 250);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+    QVERIFY(im.universes().at(1)->saveXML(&xmlWriter) == true);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+    QVERIFY(buffer.data().contains("Interval=\"250\""));
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+    QVERIFY(im.universes().at(2)->loadXML(xmlReader, 2, &im) == true);
+    QCOMPARE(im.feedbackInterval(2), uint(250));
+}
+
 void InputOutputMap_Test::slotConfigurationChanged()
 {
     InputOutputMap im(m_doc, 4);
@@ -565,6 +700,17 @@ void InputOutputMap_Test::loadInputProfiles()
     // Shouldn't load duplicates
     im.loadProfiles(dir);
     QCOMPARE(names, im.profileNames());
+
+    // Profiles are parsed only when requested
+    QVERIFY(im.m_profiles.isEmpty() == true);
+    QLCInputProfile *prof = im.profile(names.last());
+    QVERIFY(prof != NULL);
+    QCOMPARE(prof->name(), names.last());
+    QCOMPARE(im.m_profiles.size(), 1);
+    QCOMPARE(im.profile(names.last()), prof);
+    QCOMPARE(im.m_profiles.size(), 1);
+    QCOMPARE(im.profileNames().size(), names.size());
+    QVERIFY(im.profile("Not an existing profile") == NULL);
 }
 
 void InputOutputMap_Test::inputSourceNames()
@@ -680,6 +826,102 @@ void InputOutputMap_Test::claimReleaseDumpReset()
     }
 }
 
+void InputOutputMap_Test::frameCommit()
+{
+    InputOutputMap iom(m_doc, 4);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    QVERIFY(iom.setOutputPatch(0, stub->name(), "", 0) == true);
+    QVERIFY(iom.setOutputPatch(2, stub->name(), "", 1) == true);
+
+    /* Two universes are patched, the frame is committed
+     * when both have written their output */
+    QList<Universe*> unis = iom.claimUniverses();
+    iom.beginFrame(unis);
+    iom.releaseUniverses(false);
+
+    stub->m_commitCount = 0;
+    emit unis.at(0)->outputDumped();
+    QCOMPARE(stub->m_commitCount, 0);
+    emit unis.at(2)->outputDumped();
+    QCOMPARE(stub->m_commitCount, 1);
+    QVERIFY(iom.frameSkew() >= 0);
+    QVERIFY(iom.maxFrameSkew() >= iom.frameSkew());
+
+    /* An incomplete frame is committed when the next one begins */
+    unis = iom.claimUniverses();
+    iom.beginFrame(unis);
+    iom.releaseUniverses(false);
+
+    emit unis.at(2)->outputDumped();
+    QCOMPARE(stub->m_commitCount, 1);
+
+    unis = iom.claimUniverses();
+    iom.beginFrame(unis);
+    iom.releaseUniverses(false);
+    QCOMPARE(stub->m_commitCount, 2);
+
+    /* Without output patches, nothing is committed */
+    InputOutputMap empty(m_doc, 2);
+    unis = empty.claimUniverses();
+    empty.beginFrame(unis);
+    empty.releaseUniverses(false);
+    emit unis.at(0)->outputDumped();
+    QCOMPARE(stub->m_commitCount, 2);
+}
+
+void InputOutputMap_Test::claimedUniverses()
+{
+    InputOutputMap iom(m_doc, 4);
+
+    IOPluginStub* stub = static_cast<IOPluginStub*>
+                                (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    /* Patching and flushing don't wait for the universes to be released */
+    QList<Universe*> unis = iom.claimUniverses();
+    QVERIFY(iom.setOutputPatch(0, stub->name(), "", 0) == true);
+    QVERIFY(iom.setInputPatch(1, stub->name(), "", 0) == true);
+    iom.flushInputs();
+    QCOMPARE(unis.at(0)->outputPatchesCount(), 1);
+    QVERIFY(unis.at(1)->inputPatch() != NULL);
+
+    /* The claimed list is a snapshot */
+    QList<Universe*> claimed = iom.claimUniverses();
+    QCOMPARE(claimed.count(), 4);
+    iom.releaseUniverses(false);
+    iom.releaseUniverses(false);
+
+    QVERIFY(iom.addUniverse() == true);
+    QCOMPARE(unis.count(), 4);
+    QCOMPARE(iom.universesCount(), quint32(5));
+
+    QCOMPARE(iom.universeLockWaits(), quint64(0));
+    QCOMPARE(iom.universeLockWaitTime(), qint64(0));
+
+    QVERIFY(iom.setOutputPatch(0, stub->name(), "", QLCIOPlugin::invalidLine()) == true);
+    QVERIFY(iom.setInputPatch(1, stub->name(), "", QLCIOPlugin::invalidLine()) == true);
+    QCOMPARE(unis.at(0)->outputPatchesCount(), 0);
+    QVERIFY(unis.at(1)->inputPatch() == NULL);
+
+    /* An exclusive claim, like changing the channels state,
+     * waits for the shared ones to be released */
+    unis = iom.claimUniverses();
+    ExclusiveClaimer claimer(&iom);
+    claimer.start();
+    QTest::qWait(50);
+    QCOMPARE(claimer.m_claimed.loadAcquire(), 0);
+
+    iom.releaseUniverses(false);
+    QVERIFY(claimer.wait(1000) == true);
+    QCOMPARE(claimer.m_claimed.loadAcquire(), 1);
+    QCOMPARE(iom.universeLockWaits(), quint64(1));
+    QVERIFY(iom.universeLockWaitTime() > 0);
+}
+
 void InputOutputMap_Test::blackout()
 {
     InputOutputMap iom(m_doc, 4);
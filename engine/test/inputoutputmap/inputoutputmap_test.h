@@ -47,11 +47,15 @@ private slots:
     void setOutputPatch();
     void setMultipleOutputPatches();
     void slotValueChanged();
+    void inputSubscriptions();
+    void feedback();
     void slotConfigurationChanged();
     void loadInputProfiles();
     void inputSourceNames();
     void profileDirectories();
     void claimReleaseDumpReset();
+    void frameCommit();
+    void claimedUniverses();
     void blackout();
     void grandMaster();
 
@@ -158,4 +158,134 @@ void InputPatch_Test::parameters()
     delete ip;
 }
 
+void InputPatch_Test::values()
+{
+    IOPluginStub* stub = static_cast<IOPluginStub*> (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    InputPatch* ip = new InputPatch(2, this);
+    QVERIFY(ip->set(stub, 1, NULL) == true);
+    QSignalSpy spy(ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,QString)));
+
+    // values of other lines are ignored
+    emit stub->valueChanged(2, 0, 10, 100);
+    QVERIFY(ip->m_inputChangedWords.isEmpty());
+
+    // only the last value of a channel is notified, in channel order
+    emit stub->valueChanged(2, 1, 700, 5);
+    emit stub->valueChanged(2, 1, 10, 100);
+    emit stub->valueChanged(2, 1, 10, 120);
+    emit stub->valueChanged(UINT_MAX, 1, 0xFFFF, 42);
+    QCOMPARE(spy.count(), 0);
+
+    ip->flush(2);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy[0][1].toUInt(), quint32(10));
+    QCOMPARE(spy[0][2].toUInt(), uint(120));
+    QCOMPARE(spy[1][1].toUInt(), quint32(700));
+    QCOMPARE(spy[1][2].toUInt(), uint(5));
+    QCOMPARE(spy[2][1].toUInt(), quint32(0xFFFF));
+    QCOMPARE(spy[2][2].toUInt(), uint(42));
+    QVERIFY(ip->m_inputChangedWords.isEmpty());
+
+    // nothing left to notify
+    ip->flush(2);
+    QCOMPARE(spy.count(), 3);
+
+    // every ON/OFF change passes through
+    spy.clear();
+    emit stub->valueChanged(2, 1, 3, 255);
+    emit stub->valueChanged(2, 1, 3, 0);
+    emit stub->valueChanged(2, 1, 3, 255);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy[0][2].toUInt(), uint(255));
+    QCOMPARE(spy[1][2].toUInt(), uint(0));
+    ip->flush(2);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy[2][1].toUInt(), quint32(3));
+    QCOMPARE(spy[2][2].toUInt(), uint(255));
+
+    // keyed values and channels out of the dense range keep their key
+    spy.clear();
+    emit stub->valueChanged(2, 1, 1234, 0, "/fader/1");
+    emit stub->valueChanged(2, 1, 1234, 80, "/fader/1");
+    emit stub->valueChanged(2, 1, 0x10000, 9);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][2].toUInt(), uint(0));
+    QCOMPARE(spy[0][3].toString(), QString("/fader/1"));
+    QVERIFY(ip->m_inputChangedWords.isEmpty());
+
+    ip->flush(2);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(ip->m_keyedInputBuffer.count(), 0);
+
+    delete ip;
+}
+
+void InputPatch_Test::frames()
+{
+    IOPluginStub* stub = static_cast<IOPluginStub*> (m_doc->ioPluginCache()->plugins().at(0));
+    QVERIFY(stub != NULL);
+
+    InputPatch* ip = new InputPatch(2, this);
+    QVERIFY(ip->set(stub, 1, NULL) == true);
+    QSignalSpy spy(ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,QString)));
+
+    QByteArray values(512, 0);
+    QBitArray dirty(512);
+    values[5] = 100;
+    values[7] = 50;
+    dirty.setBit(5);
+    dirty.setBit(7);
+
+    // frames of other lines are ignored
+    emit stub->frameChanged(2, 0, values, dirty);
+    QVERIFY(ip->m_frameDirty.isEmpty());
+
+    emit stub->frameChanged(2, 1, values, dirty);
+    QCOMPARE(ip->m_frameDirty.count(true), 2);
+
+    // nothing is notified without subscriptions
+    ip->flush(2);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(ip->m_frameDirty.isEmpty());
+
+    // the changes of the frames received within a tick accumulate
+    ip->setChannelSubscribed(7, true);
+    values[7] = 60;
+    dirty.fill(false);
+    dirty.setBit(7);
+    emit stub->frameChanged(2, 1, values, dirty);
+    values[9] = 1;
+    dirty.fill(false);
+    dirty.setBit(9);
+    emit stub->frameChanged(2, 1, values, dirty);
+    QCOMPARE(ip->m_frameDirty.count(true), 2);
+
+    ip->flush(2);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][0].toUInt(), quint32(2));
+    QCOMPARE(spy[0][1].toUInt(), quint32(7));
+    QCOMPARE(spy[0][2].toUInt(), uint(60));
+
+    // changed channels are copied to the passthrough values,
+    // and monitoring notifies all of them
+    ip->setChannelSubscribed(7, false);
+    ip->setMonitored(true);
+    values[9] = 2;
+    emit stub->frameChanged(2, 1, values, dirty);
+
+    QByteArray passthrough(512, 0);
+    QBitArray changed;
+    ip->flush(2, &passthrough, &changed);
+    QCOMPARE(changed.count(true), 1);
+    QVERIFY(changed.testBit(9) == true);
+    QCOMPARE(uchar(passthrough.at(9)), uchar(2));
+    QCOMPARE(uchar(passthrough.at(7)), uchar(0));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy[1][1].toUInt(), quint32(9));
+
+    delete ip;
+}
+
 QTEST_APPLESS_MAIN(InputPatch_Test)
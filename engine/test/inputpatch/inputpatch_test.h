@@ -34,6 +34,8 @@ private slots:
     void defaults();
     void patch();
     void parameters();
+    void values();
+    void frames();
 
 private:
     Doc* m_doc;
@@ -32,6 +32,7 @@ void IOPluginStub::init()
 {
     m_configureCalled = 0;
     m_canConfigure = false;
+    m_commitCount = 0;
     m_universe = QByteArray(int(4 * 512), char(0));
 }
 
@@ -93,6 +94,11 @@ void IOPluginStub::writeUniverse(quint32 universe, quint32 output, const QByteAr
     m_universe = m_universe.replace(output * 512, data.size(), data);
 }
 
+void IOPluginStub::commitFrame()
+{
+    m_commitCount++;
+}
+
 /*****************************************************************************
  * Inputs
  *****************************************************************************/
@@ -129,6 +135,14 @@ QString IOPluginStub::inputInfo(quint32 input)
     return QString("This is a plugin stub for testing.");
 }
 
+void IOPluginStub::sendFeedBackFrame(quint32 universe, quint32 inputLine,
+                                     const QList<PluginFeedbackValue> &values)
+{
+    Q_UNUSED(universe)
+    Q_UNUSED(inputLine)
+    m_feedbackFrames.append(values);
+}
+
 /*****************************************************************************
  * Configuration
  *****************************************************************************/
@@ -72,10 +72,16 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void commitFrame();
+
 public:
     /** List of outputs that have been opened */
     QList <quint32> m_openOutputs;
 
+    /** Number of commitFrame() calls */
+    int m_commitCount;
+
     /** Fake universe buffer */
     QByteArray m_universe;
 
@@ -95,6 +101,10 @@ public:
     /** @reimp */
     QString inputInfo(quint32 input);
 
+    /** @reimp */
+    void sendFeedBackFrame(quint32 universe, quint32 inputLine,
+                           const QList<PluginFeedbackValue>& values);
+
     /** Tell the plugin to emit valueChanged signal */
     void emitValueChanged(quint32 universe, quint32 input, quint32 channel, uchar value)
     {
@@ -105,6 +115,9 @@ public:
     /** List of inputs that have been opened */
     QList <quint32> m_openInputs;
 
+    /** Feedback frames received by sendFeedBackFrame() */
+    QList <QList<PluginFeedbackValue> > m_feedbackFrames;
+
     /*********************************************************************
      * Configuration
      *********************************************************************/
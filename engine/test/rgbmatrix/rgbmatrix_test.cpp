@@ -25,12 +25,14 @@
 #define protected public
 #define private public
 #include "rgbscriptscache.h"
+#include "inputoutputmap.h"
 #include "rgbmatrix_test.h"
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
 #include "fixturegroup.h"
 #include "mastertimer.h"
 #include "rgbmatrix.h"
+#include "universe.h"
 #include "fixture.h"
 #include "qlcfile.h"
 #include "doc.h"
@@ -358,4 +360,70 @@ void RGBMatrix_Test::loadSave()
 
 }
 
+QList<QByteArray> RGBMatrix_Test::renderFrames(bool parallel, int ticks)
+{
+    QStringList algorithms;
+    algorithms << "Stripes" << "Plasma" << "Fill" << "Gradient" << "Even/Odd" << "Waves";
+
+    MasterTimer *timer = m_doc->masterTimer();
+    timer->setParallelWrite(parallel);
+
+    quint32 groupId = m_doc->fixtureGroups().first()->id();
+    QList<RGBMatrix *> matrices;
+
+    for (int i = 0; i < algorithms.count(); i++)
+    {
+        RGBMatrix *mtx = new RGBMatrix(m_doc);
+        mtx->setFixtureGroup(groupId);
+        mtx->setAlgorithm(RGBAlgorithm::algorithm(m_doc, algorithms.at(i)));
+        mtx->setStartColor(QColor::fromHsv(i * 60, 255, 255));
+        mtx->setDuration(100 + i * 60);
+        if (i % 2)
+            mtx->setBlendMode(Universe::AdditiveBlend);
+        m_doc->addFunction(mtx);
+        matrices << mtx;
+
+        mtx->start(timer, FunctionParent::master());
+    }
+
+    QList<Universe *> universes = m_doc->inputOutputMap()->universes();
+    QList<QByteArray> frames;
+
+    for (int t = 0; t < ticks; t++)
+    {
+        // stop one matrix halfway, its faders are dismissed serially
+        if (t == ticks / 2)
+            matrices.first()->stop(FunctionParent::master());
+
+        timer->timerTickFunctions(universes);
+        universes.first()->processFaders();
+        frames << universes.first()->preGMValues();
+    }
+
+    foreach (RGBMatrix *mtx, matrices)
+        mtx->stop(FunctionParent::master());
+    timer->timerTickFunctions(universes);
+    universes.first()->processFaders();
+
+    foreach (RGBMatrix *mtx, matrices)
+        m_doc->deleteFunction(mtx->id());
+    m_doc->inputOutputMap()->resetUniverses();
+    timer->setParallelWrite(false);
+
+    return frames;
+}
+
+void RGBMatrix_Test::parallelWrite()
+{
+    QList<QByteArray> serial = renderFrames(false, 100);
+    QCOMPARE(m_doc->masterTimer()->runningFunctions(), 0);
+
+    QList<QByteArray> parallel = renderFrames(true, 100);
+    QCOMPARE(m_doc->masterTimer()->runningFunctions(), 0);
+
+    QCOMPARE(parallel.count(), serial.count());
+    for (int i = 0; i < serial.count(); i++)
+        QVERIFY2(parallel.at(i) == serial.at(i), qPrintable(QString("Frame %1 differs").arg(i)));
+}
+
 QTEST_MAIN(RGBMatrix_Test)
@@ -44,8 +44,12 @@ private slots:
     void previewMaps();
     void property();
     void loadSave();
+    void parallelWrite();
 
 private:
+    /** Run a few matrices for $ticks and return the output of every tick */
+    QList<QByteArray> renderFrames(bool parallel, int ticks);
+
     Doc* m_doc;
 };
 
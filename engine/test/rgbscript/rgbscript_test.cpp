@@ -127,6 +127,31 @@ void RGBScript_Test::script()
 #endif
 }
 
+void RGBScript_Test::lazyLoad()
+{
+    RGBScriptsCache cache(m_doc);
+    QVERIFY(cache.load(QDir(INTERNAL_SCRIPTDIR)));
+
+    // Scripts are only scanned on load
+    QVERIFY(cache.m_scriptsMap.isEmpty() == true);
+    QVERIFY(cache.m_pendingMap.contains("stripes.js") == true);
+    QCOMPARE(cache.m_pendingMap["stripes.js"].name, QString("Stripes"));
+    int pending = cache.m_pendingMap.size();
+
+    // and evaluated on first use
+    RGBScript s = cache.script("Stripes");
+    QCOMPARE(s.name(), QString("Stripes"));
+    QVERIFY(cache.m_scriptsMap.contains("stripes.js") == true);
+    QVERIFY(cache.m_pendingMap.contains("stripes.js") == false);
+    QCOMPARE(cache.m_pendingMap.size(), pending - 1);
+
+    // names() needs all of them
+    QStringList names = cache.names();
+    QVERIFY(cache.m_pendingMap.isEmpty() == true);
+    QCOMPARE(names.size(), cache.m_scriptsMap.size());
+    QVERIFY(names.contains("Stripes") == true);
+}
+
 void RGBScript_Test::evaluateException()
 {
     // Should be    function()
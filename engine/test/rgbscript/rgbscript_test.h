@@ -35,6 +35,7 @@ private slots:
     void directories();
     void scripts();
     void script();
+    void lazyLoad();
     void evaluateException();
     void evaluateNoRgbMapFunction();
     void evaluateNoRgbMapStepCountFunction();
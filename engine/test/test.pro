@@ -7,6 +7,8 @@ SUBDIRS += collection
 SUBDIRS += cue
 SUBDIRS += cuestack
 SUBDIRS += doc
+SUBDIRS += docautosave
+SUBDIRS += docsnapshot
 SUBDIRS += efx
 SUBDIRS += efxfixture
 SUBDIRS += fadechannel
@@ -26,7 +26,14 @@
 #include "universe.h"
 #undef protected
 
+#define private public
+#include "genericfader.h"
+#undef private
+
 #include "grandmaster.h"
+#include "fadechannel.h"
+#include "fixture.h"
+#include "doc.h"
 
 void Universe_Test::init()
 {
@@ -418,6 +425,138 @@ void Universe_Test::reset()
         QCOMPARE((int)m_uni->postGMValues()->at(i), 0);
 }
 
+void Universe_Test::faderPool()
+{
+    GenericFaderPool *pool = m_uni->m_faderPool.data();
+    QCOMPARE(pool->allocatedCount(), quint64(0));
+
+    Doc doc(this);
+    QSharedPointer<GenericFader> fader = m_uni->requestFader(Universe::Override);
+    GenericFader *first = fader.data();
+    fader->setName("First");
+    fader->setParentFunctionID(42);
+    for (quint32 i = 0; i < 24; i++)
+        fader->getChannelFader(&doc, m_uni, Fixture::invalidId(), i);
+    QCOMPARE(fader->channelsCount(), 24);
+    QCOMPARE(pool->allocatedCount(), quint64(1));
+
+    // still referenced after being removed from the universe
+    fader->requestDelete();
+    m_uni->processFaders();
+    QCOMPARE(m_uni->faders().count(), 0);
+    QCOMPARE(pool->freeCount(), 0);
+
+    fader.clear();
+    QCOMPARE(pool->freeCount(), 1);
+
+    // the same fader comes back, as new
+    fader = m_uni->requestFader();
+    QVERIFY(fader.data() == first);
+    QCOMPARE(pool->allocatedCount(), quint64(1));
+    QCOMPARE(pool->recycledCount(), quint64(1));
+    QCOMPARE(pool->freeCount(), 0);
+    QCOMPARE(fader->name(), QString());
+    QCOMPARE(fader->parentFunctionID(), Function::invalidId());
+    QCOMPARE(fader->priority(), int(Universe::Auto));
+    QCOMPARE(fader->channelsCount(), 0);
+    QCOMPARE(fader->deleteRequested(), false);
+    QVERIFY(fader->m_channels.capacity() >= 24);
+
+    // a second request while the first is in use allocates
+    QSharedPointer<GenericFader> second = m_uni->requestFader();
+    QVERIFY(second.data() != first);
+    QCOMPARE(pool->allocatedCount(), quint64(2));
+
+    m_uni->dismissFader(second);
+    second.clear();
+    QCOMPARE(pool->freeCount(), 1);
+
+    // faders can outlive their universe
+    delete m_uni;
+    m_uni = NULL;
+    fader.clear();
+}
+
+void Universe_Test::sparseAllocation()
+{
+    Universe other(1, m_gm, this);
+
+    // untouched universes share their buffers
+    QCOMPARE(m_uni->memoryUsage(), 0);
+    QCOMPARE(other.memoryUsage(), 0);
+    QVERIFY(m_uni->postGMValues()->constData() == other.postGMValues()->constData());
+
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    QCOMPARE(m_uni->memoryUsage(), 512);
+    QCOMPARE(other.memoryUsage(), 0);
+    QCOMPARE(other.channelCapabilities(0), uchar(Universe::Undefined));
+
+    m_uni->write(0, 100);
+    QCOMPARE(m_uni->memoryUsage(), 3 * 512);
+    QCOMPARE(other.preGMValue(0), uchar(0));
+    QCOMPARE(other.postGMValue(0), uchar(0));
+
+    // reading and resetting don't allocate
+    m_uni->zeroIntensityChannels();
+    m_uni->zeroRelativeValues();
+    other.zeroIntensityChannels();
+    other.zeroRelativeValues();
+    other.reset();
+    QCOMPARE(m_uni->memoryUsage(), 3 * 512);
+    QCOMPARE(other.memoryUsage(), 0);
+
+    // the zero filled buffers are given back, the channel mask is kept
+    m_uni->reclaim();
+    QCOMPARE(m_uni->memoryUsage(), 512);
+    QCOMPARE(m_uni->channelCapabilities(0), uchar(Universe::HTP | Universe::Intensity));
+    QCOMPARE(m_uni->preGMValue(0), uchar(0));
+
+    m_uni->write(1, 10);
+    m_uni->writeRelative(1, 137);
+    QCOMPARE(m_uni->postGMValue(1), uchar(20));
+    QCOMPARE(m_uni->memoryUsage(), 3 * 512 + 512 * int(sizeof(short)));
+}
+
+void Universe_Test::dormancy()
+{
+    QVERIFY(m_uni->isDormant() == true);
+
+    // threads are not started until the universes are in use
+    m_uni->startThread();
+    QVERIFY(m_uni->isDormant() == true);
+    QVERIFY(m_uni->isRunning() == false);
+
+    // ticks are not accumulated while dormant
+    m_uni->tick();
+    QCOMPARE(m_uni->m_semaphore.available(), 0);
+
+    QSharedPointer<GenericFader> fader = m_uni->requestFader();
+    QVERIFY(m_uni->isDormant() == false);
+    QVERIFY(m_uni->isRunning() == true);
+
+    // a dismissed fader leaves the universe idle
+    m_uni->dismissFader(fader);
+    fader.clear();
+    m_uni->write(0, 50);
+    QVERIFY(m_uni->memoryUsage() > 0);
+
+    for (int i = 0; i < 500 && m_uni->isDormant() == false; i++)
+    {
+        m_uni->tick();
+        QTest::qSleep(1);
+    }
+    QVERIFY(m_uni->isDormant() == true);
+    QVERIFY(m_uni->wait(1000) == true);
+
+    // the values written are kept
+    QCOMPARE(m_uni->preGMValue(0), uchar(50));
+
+    // and a new fader wakes the universe up again
+    fader = m_uni->requestFader();
+    QVERIFY(m_uni->isDormant() == false);
+    QVERIFY(m_uni->isRunning() == true);
+}
+
 void Universe_Test::loadEmpty()
 {
     QBuffer buffer;
@@ -588,6 +727,68 @@ void Universe_Test::savePasthroughTrue()
     QCOMPARE(xmlReader.attributes().value("Passthrough").toString(), QString("True"));
 }
 
+void Universe_Test::faderPoolStress()
+{
+    /* 16 steps chasers at 300 BPM on 8 universes: each step requests a
+       new fader with 32 channels and dismisses the previous one */
+    const int universes = 8;
+    const int steps = 16 * 500;
+    const int channels = 32;
+
+    Doc doc(this);
+    QList<Universe *> unis;
+    QList<QSharedPointer<GenericFader> > faders;
+    for (int u = 0; u < universes; u++)
+    {
+        unis.append(new Universe(u, m_gm, this));
+        faders.append(QSharedPointer<GenericFader>());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int step = 0; step < steps; step++)
+    {
+        for (int u = 0; u < universes; u++)
+        {
+            Universe *uni = unis.at(u);
+            if (faders.at(u).isNull() == false)
+                faders.at(u)->requestDelete();
+
+            faders[u] = uni->requestFader();
+            for (quint32 ch = 0; ch < channels; ch++)
+            {
+                FadeChannel *fc = faders[u]->getChannelFader(&doc, uni, Fixture::invalidId(), ch);
+                fc->setTarget(uchar(step));
+            }
+
+            uni->processFaders();
+        }
+    }
+
+    qint64 elapsed = qMax(timer.elapsed(), qint64(1));
+
+    quint64 allocated = 0;
+    quint64 recycled = 0;
+    foreach (Universe *uni, unis)
+    {
+        allocated += uni->m_faderPool->allocatedCount();
+        recycled += uni->m_faderPool->recycledCount();
+    }
+
+    qDebug() << "Fader requests:" << steps * universes << "in" << elapsed << "ms."
+             << "Allocated:" << allocated << "recycled:" << recycled
+             << "-" << (allocated * 1000) / elapsed << "allocations per second,"
+             << (quint64(steps * universes) * 1000) / elapsed << "requests per second";
+
+    // at most the fader of the current step and the one being released
+    QVERIFY(allocated <= quint64(universes * 2));
+    QCOMPARE(allocated + recycled, quint64(steps * universes));
+
+    faders.clear();
+    qDeleteAll(unis);
+}
+
 void Universe_Test::setGMValueEfficiency()
 {
     int i;
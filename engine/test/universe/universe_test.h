@@ -45,6 +45,9 @@ private slots:
     void write();
     void writeRelative();
     void reset();
+    void faderPool();
+    void sparseAllocation();
+    void dormancy();
 
     void loadEmpty();
     void loadPassthroughTrue();
@@ -54,6 +57,7 @@ private slots:
     void saveEmpty();
     void savePasthroughTrue();
 
+    void faderPoolStress();
     void setGMValueEfficiency();
     void writeEfficiency();
     void hasChangedEfficiency();
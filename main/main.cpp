@@ -100,6 +100,9 @@ namespace QLCArgs
     /** Log to file flag */
     bool logToFile = false;
 
+    /** If true, print the time spent in each startup stage */
+    bool startupProfile = false;
+
     QFile logFile;
 
 #if defined(WIN32) || defined(__APPLE__)
@@ -193,6 +196,7 @@ void printUsage()
     cout << "  -n or --nogui\t\t\tStart the application with the GUI hidden (requires --nowm)" << endl;
     cout << "  -o or --open <file>\t\tOpen the specified workspace file" << endl;
     cout << "  -p or --operate\t\tStart in operate mode" << endl;
+    cout << "  --startup-profile\t\tPrint the time spent in each startup stage" << endl;
     cout << "  -v or --version\t\tPrint version information" << endl;
     cout << "  -w or --web\t\t\tEnable remote web access" << endl;
     cout << "  -wp or --web-port <port>\t\tSet the port to use for web access" << endl;
@@ -302,6 +306,10 @@ bool parseArgs()
             if(it.hasNext())
                 QLCArgs::webAccessPasswordFile = it.next();
         }
+        else if (arg == "--startup-profile")
+        {
+            QLCArgs::startupProfile = true;
+        }
         else if (arg == "-v" || arg == "--version")
         {
             /* Don't print anything, since version is always
@@ -367,6 +375,9 @@ int main(int argc, char** argv)
     if (QLCArgs::noGui == true)
         app.disableGUI();
 
+    if (QLCArgs::startupProfile == true)
+        app.enableStartupProfile();
+
     app.startup();
     app.show();
 
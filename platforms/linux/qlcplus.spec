@@ -87,6 +87,7 @@ desktop-file-validate %{buildroot}/%{_datadir}/applications/*.desktop
 %{_datadir}/qlcplus/miditemplates
 %{_datadir}/qlcplus/modifierstemplates
 %{_datadir}/qlcplus/rgbscripts
+%{_datadir}/qlcplus/shm
 %{_datadir}/qlcplus/translations
 %{_datadir}/qlcplus/web
 %_libdir/qt5/plugins/qlcplus/audio/libmadplugin.so
@@ -102,6 +103,7 @@ desktop-file-validate %{buildroot}/%{_datadir}/applications/*.desktop
 %_libdir/qt5/plugins/qlcplus/libos2l.so
 %_libdir/qt5/plugins/qlcplus/libosc.so
 %_libdir/qt5/plugins/qlcplus/libpeperoni.so
+%_libdir/qt5/plugins/qlcplus/libshm.so
 %_libdir/qt5/plugins/qlcplus/libspi.so
 %_libdir/qt5/plugins/qlcplus/libudmx.so
 %_mandir/*/*
@@ -39,6 +39,7 @@
 #define KMapColumnE131Uni       5
 #define KMapColumnTransmitMode  6
 #define KMapColumnPriority      7
+#define KMapColumnSyncAddress   8
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -184,6 +185,13 @@ void ConfigureE131::fillMappingTree()
                 prioritySpin->setValue(info->outputPriority);
                 prioritySpin->setToolTip(tr("%1 - min, %2 - default, %3 - max").arg(E131_PRIORITY_MIN).arg(E131_PRIORITY_DEFAULT).arg(E131_PRIORITY_MAX));
                 m_uniMapTree->setItemWidget(item, KMapColumnPriority, prioritySpin);
+
+                QSpinBox *syncSpin = new QSpinBox(this);
+                syncSpin->setRange(0, 63999);
+                syncSpin->setValue(info->outputSyncAddress);
+                syncSpin->setSpecialValueText(tr("None"));
+                syncSpin->setToolTip(tr("E1.31 universe used to synchronize the output of multiple universes"));
+                m_uniMapTree->setItemWidget(item, KMapColumnSyncAddress, syncSpin);
             }
         }
     }
@@ -388,6 +396,10 @@ void ConfigureE131::accept()
                 QSpinBox* prioSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnPriority));
                 m_plugin->setParameter(universe, line, QLCIOPlugin::Output,
                         E131_PRIORITY, prioSpin->value());
+
+                QSpinBox* syncSpin = qobject_cast<QSpinBox*>(m_uniMapTree->itemWidget(item, KMapColumnSyncAddress));
+                m_plugin->setParameter(universe, line, QLCIOPlugin::Output,
+                        E131_SYNCADDRESS, syncSpin->value());
             }
         }
     }
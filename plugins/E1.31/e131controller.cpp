@@ -80,6 +80,7 @@ void E131Controller::addUniverse(quint32 universe, E131Controller::Type type)
         info.outputUniverse = universe + 1;
         info.outputTransmissionMode = Full;
         info.outputPriority = E131_PRIORITY_DEFAULT;
+        info.outputSyncAddress = 0;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -267,6 +268,15 @@ void E131Controller::setOutputPriority(quint32 universe, quint32 e131Priority)
     m_universeMap[universe].outputPriority = e131Priority;
 }
 
+void E131Controller::setOutputSyncAddress(quint32 universe, quint32 syncAddress)
+{
+    if (m_universeMap.contains(universe) == false)
+        return;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSyncAddress = syncAddress;
+}
+
 void E131Controller::setOutputTransmissionMode(quint32 universe, E131Controller::TransmissionMode mode)
 {
     if (m_universeMap.contains(universe) == false)
@@ -345,6 +355,7 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
     quint16 outPort = E131_DEFAULT_PORT;
     quint32 outUniverse = universe;
     quint32 outPriority = E131_PRIORITY_DEFAULT;
+    quint16 syncAddress = 0;
     TransmissionMode transmitMode = Full;
 
     if (m_universeMap.contains(universe))
@@ -361,7 +372,33 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
         }
         outUniverse = info.outputUniverse;
         outPriority = info.outputPriority;
+        syncAddress = info.outputSyncAddress;
         transmitMode = TransmissionMode(info.outputTransmissionMode);
+
+        if (syncAddress != 0)
+        {
+            SyncTarget target;
+            target.syncAddress = syncAddress;
+            // multicast sync packets go to the sync universe address
+            if (info.outputMulticast)
+                target.address = QHostAddress(QString("239.255.%1.%2").arg(syncAddress >> 8).arg(syncAddress & 0xFF));
+            else
+                target.address = outAddress;
+            target.port = outPort;
+
+            bool found = false;
+            foreach (SyncTarget const& pending, m_pendingSync)
+            {
+                if (pending.syncAddress == target.syncAddress &&
+                    pending.address == target.address && pending.port == target.port)
+                {
+                    found = true;
+                    break;
+                }
+            }
+            if (found == false)
+                m_pendingSync.append(target);
+        }
     }
     else
         qWarning() << Q_FUNC_INFO << "universe" << universe << "unknown";
@@ -370,10 +407,10 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
     {
         QByteArray wholeuniverse(512, 0);
         wholeuniverse.replace(0, data.length(), data);
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, wholeuniverse);
+        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, wholeuniverse, syncAddress);
     }
     else
-        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data);
+        m_packetizer->setupE131Dmx(dmxPacket, outUniverse, outPriority, data, syncAddress);
 
     qint64 sent = m_UdpSocket->writeDatagram(dmxPacket.data(), dmxPacket.size(),
                                              outAddress, outPort);
@@ -387,6 +424,25 @@ void E131Controller::sendDmx(const quint32 universe, const QByteArray &data)
         m_packetSent++;
 }
 
+void E131Controller::sendSync()
+{
+    QMutexLocker locker(&m_dataMutex);
+    QByteArray syncPacket;
+
+    foreach (SyncTarget const& target, m_pendingSync)
+    {
+        m_packetizer->setupE131Sync(syncPacket, target.syncAddress);
+
+        qint64 sent = m_UdpSocket->writeDatagram(syncPacket.data(), syncPacket.size(),
+                                                 target.address, target.port);
+        if (sent < 0)
+            qDebug() << "sendSync failed:" << m_UdpSocket->errorString();
+        else
+            m_packetSent++;
+    }
+    m_pendingSync.clear();
+}
+
 void E131Controller::processPendingPackets()
 {
     QUdpSocket* socket = qobject_cast<QUdpSocket*>(sender());
@@ -51,10 +51,20 @@ typedef struct
     quint16 outputUniverse;
     int outputTransmissionMode;
     int outputPriority;
+    /** E1.31 universe used to synchronize the output, 0 if none */
+    quint16 outputSyncAddress;
 
     int type;
 } UniverseInfo;
 
+/** A destination that must receive a sync packet at the end of a frame */
+typedef struct
+{
+    quint16 syncAddress;
+    QHostAddress address;
+    quint16 port;
+} SyncTarget;
+
 class E131Controller : public QObject
 {
     Q_OBJECT
@@ -115,6 +125,14 @@ public:
     /** Set a specific E1.31 output priority for the given QLC+ universe */
     void setOutputPriority(quint32 universe, quint32 e131Priority);
 
+    /** Set the E1.31 universe used to synchronize the output of
+     *  the given QLC+ universe. 0 disables the synchronization */
+    void setOutputSyncAddress(quint32 universe, quint32 syncAddress);
+
+    /** Send a sync packet for every synchronization address used
+     *  since the last call, so receivers apply the frame at once */
+    void sendSync();
+
     /** Set the transmission mode of the ArtNet DMX packets over the network.
      *  It can be 'Full', which transmits always 512 channels, or
      *  'Partial', which transmits only the channels actually used in a
@@ -175,6 +193,9 @@ private:
      *  controller, with the related, specific parameters */
     QMap<quint32, UniverseInfo> m_universeMap;
 
+    /** The sync packets to send at the end of the current frame */
+    QList<SyncTarget> m_pendingSync;
+
     /** Mutex to handle the change of output IP address or in general
      *  variables that could be used to transmit/receive data */
     QMutex m_dataMutex;
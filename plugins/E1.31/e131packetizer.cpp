@@ -150,7 +150,8 @@ E131Packetizer::~E131Packetizer()
  * Sender functions
  *********************************************************************/
 
-void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority, const QByteArray &values)
+void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const int &priority,
+                                  const QByteArray &values, const int &syncAddress)
 {
     data.clear();
     data.append(m_commonHeader);
@@ -170,6 +171,9 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
 
     data[108] = (char) priority;
 
+    data[109] = (char)(syncAddress >> 8);
+    data[110] = (char)(syncAddress & 0x00FF);
+
     data[111] = m_sequence[universe];
 
     data[113] = (char)(universe >> 8);
@@ -187,6 +191,52 @@ void E131Packetizer::setupE131Dmx(QByteArray& data, const int &universe, const i
         m_sequence[universe]++;
 }
 
+void E131Packetizer::setupE131Sync(QByteArray &data, const int &syncAddress)
+{
+    data.clear();
+
+    // The root layer is the same as DMX packets, up to the sender's CID
+    data.append(m_commonHeader.left(38));
+
+    // Identifies RLP Data as 1.31 Extended Protocol PDU
+    data[21] = (char)0x08;
+
+    // empty flags & PDU length (bytes 38-39)
+    data.append('\0');
+    data.append('\0');
+
+    // Identifies 1.31 data as a Synchronization Packet
+    data.append((char)0x00);
+    data.append((char)0x00);
+    data.append((char)0x00);
+    data.append((char)0x01);
+
+    // sequence counter (byte 44)
+    data.append((char)m_syncSequence[syncAddress]);
+
+    // Synchronization address (bytes 45-46)
+    data.append((char)(syncAddress >> 8));
+    data.append((char)(syncAddress & 0x00FF));
+
+    // reserved
+    data.append('\0');
+    data.append('\0');
+
+    int rootLayerSize = data.count() - 16;
+    int e131LayerSize = data.count() - 38;
+
+    data[16] = 0x70 | (char)(rootLayerSize >> 8);
+    data[17] = (char)(rootLayerSize & 0x00FF);
+
+    data[38] = 0x70 | (char)(e131LayerSize >> 8);
+    data[39] = (char)(e131LayerSize & 0x00FF);
+
+    if (m_syncSequence[syncAddress] == 0xff)
+        m_syncSequence[syncAddress] = 1;
+    else
+        m_syncSequence[syncAddress]++;
+}
+
 bool E131Packetizer::checkPacket(QByteArray &data)
 {
     /* An E1.31 packet must be at least 125 bytes long */
@@ -41,8 +41,13 @@ public:
      * Sender functions
      *********************************************************************/
 
-    /** Prepare an E1.31 DMX packet */
-    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority, const QByteArray &values);
+    /** Prepare an E1.31 DMX packet. A non zero $syncAddress tells
+     *  receivers to wait for a sync packet on that universe */
+    void setupE131Dmx(QByteArray& data, const int& universe, const int& priority,
+                      const QByteArray &values, const int& syncAddress = 0);
+
+    /** Prepare an E1.31 universe synchronization packet */
+    void setupE131Sync(QByteArray& data, const int& syncAddress);
 
     /*********************************************************************
      * Receiver functions
@@ -56,6 +61,7 @@ public:
 private:
     QByteArray m_commonHeader;
     QHash<int, uchar> m_sequence;
+    QHash<int, uchar> m_syncSequence;
 };
 
 #endif
@@ -208,6 +208,15 @@ void E131Plugin::writeUniverse(quint32 universe, quint32 output, const QByteArra
         controller->sendDmx(universe, data);
 }
 
+void E131Plugin::commitFrame()
+{
+    foreach (E131IO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->sendSync();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -352,6 +361,8 @@ void E131Plugin::setParameter(quint32 universe, quint32 line, Capability type,
             controller->setOutputTransmissionMode(universe, E131Controller::stringToTransmissionMode(value.toString()));
         else if (name == E131_PRIORITY)
             controller->setOutputPriority(universe, value.toUInt());
+        else if (name == E131_SYNCADDRESS)
+            controller->setOutputSyncAddress(universe, value.toUInt());
         else
             qWarning() << Q_FUNC_INFO << name << "is not a valid E1.31 output parameter";
     }
@@ -0,0 +1,95 @@
+/*
+  Q Light Controller Plus
+  e131_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTest>
+
+#include "e131_test.h"
+#include "e131packetizer.h"
+
+/****************************************************************************
+ * E1.31 tests
+ ****************************************************************************/
+
+void E131_Test::setupE131Sync()
+{
+    E131Packetizer ep("01:02:03:0a:0b:0c");
+    QByteArray data;
+
+    ep.setupE131Sync(data, 0x1234);
+
+    const char expected[] = {
+        // Preamble and post-amble size
+        0x00, 0x10, 0x00, 0x00,
+        // ACN packet identifier
+        0x41, 0x53, 0x43, 0x2D, 0x45, 0x31, 0x2E, 0x31, 0x37, 0x00, 0x00, 0x00,
+        // Root layer flags & length (49 - 16 = 33)
+        0x70, 0x21,
+        // VECTOR_ROOT_E131_EXTENDED
+        0x00, 0x00, 0x00, 0x08,
+        // Sender's CID, the last 6 bytes being the MAC address
+        char(0xFB), 0x3C, 0x10, 0x65, char(0xA1), 0x7F, 0x4D, char(0xE2),
+        char(0x99), 0x19, 0x01, 0x02, 0x03, 0x0A, 0x0B, 0x0C,
+        // Framing layer flags & length (49 - 38 = 11)
+        0x70, 0x0B,
+        // VECTOR_E131_EXTENDED_SYNCHRONIZATION
+        0x00, 0x00, 0x00, 0x01,
+        // Sequence number
+        0x00,
+        // Synchronization address
+        0x12, 0x34,
+        // Reserved
+        0x00, 0x00
+    };
+
+    QCOMPARE(data.size(), int(sizeof(expected)));
+    QCOMPARE(data, QByteArray(expected, sizeof(expected)));
+
+    /* A sync packet must never be mistaken for a DMX data packet */
+    data.append(QByteArray(125 - data.size(), 0));
+    QVERIFY(ep.checkPacket(data) == false);
+}
+
+void E131_Test::syncSequence()
+{
+    E131Packetizer ep("00:00:00:00:00:00");
+    QByteArray data;
+
+    /* Each sync address counts on its own */
+    ep.setupE131Sync(data, 1);
+    QCOMPARE(uchar(data.at(44)), uchar(0));
+    ep.setupE131Sync(data, 1);
+    QCOMPARE(uchar(data.at(44)), uchar(1));
+    ep.setupE131Sync(data, 2);
+    QCOMPARE(uchar(data.at(44)), uchar(0));
+
+    /* The counter wraps around to 1 after 0xff */
+    for (int i = 2; i < 0xff; i++)
+        ep.setupE131Sync(data, 1);
+    ep.setupE131Sync(data, 1);
+    QCOMPARE(uchar(data.at(44)), uchar(0xff));
+    ep.setupE131Sync(data, 1);
+    QCOMPARE(uchar(data.at(44)), uchar(1));
+
+    /* A DMX packet doesn't advance the sync counter */
+    ep.setupE131Dmx(data, 1, E131_PRIORITY_DEFAULT, QByteArray(512, 0), 1);
+    ep.setupE131Sync(data, 1);
+    QCOMPARE(uchar(data.at(44)), uchar(2));
+}
+
+QTEST_MAIN(E131_Test)
@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = e131_test
+
+QT      += core testlib network
+QT      -= gui
+
+INCLUDEPATH += ..
+DEPENDPATH  += ..
+
+# Test sources
+HEADERS += e131_test.h
+
+SOURCES += e131_test.cpp \
+           ../e131packetizer.cpp
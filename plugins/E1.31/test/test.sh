@@ -0,0 +1,2 @@
+#!/bin/sh
+./e131_test
@@ -41,6 +41,7 @@ ArtNetController::ArtNetController(QNetworkInterface const& interface, QNetworkA
     , m_line(line)
     , m_udpSocket(udpSocket)
     , m_packetizer(new ArtNetPacketizer())
+    , m_syncPending(false)
     , m_pollTimer(NULL)
 {
     if (m_ipAddr == QHostAddress::LocalHost)
@@ -118,6 +119,7 @@ void ArtNetController::addUniverse(quint32 universe, ArtNetController::Type type
         info.outputAddress = m_broadcastAddr;
         info.outputUniverse = universe;
         info.outputTransmissionMode = Full;
+        info.outputSync = false;
         info.type = type;
         m_universeMap[universe] = info;
     }
@@ -222,6 +224,17 @@ bool ArtNetController::setTransmissionMode(quint32 universe, ArtNetController::T
     return mode == ArtNetController::Full;
 }
 
+bool ArtNetController::setOutputSync(quint32 universe, bool enable)
+{
+    if (!m_universeMap.contains(universe))
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].outputSync = enable;
+
+    return enable == false;
+}
+
 QString ArtNetController::transmissionModeToString(ArtNetController::TransmissionMode mode)
 {
     switch (mode)
@@ -271,6 +284,8 @@ void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
         outAddress = info.outputAddress;
         outUniverse = info.outputUniverse;
         transmitMode = TransmissionMode(info.outputTransmissionMode);
+        if (info.outputSync)
+            m_syncPending = true;
     }
 
     if (transmitMode == Full)
@@ -297,6 +312,24 @@ void ArtNetController::sendDmx(const quint32 universe, const QByteArray &data)
     }
 }
 
+void ArtNetController::sendSync()
+{
+    QMutexLocker locker(&m_dataMutex);
+    if (m_syncPending == false)
+        return;
+
+    QByteArray syncPacket;
+    m_packetizer->setupArtNetSync(syncPacket);
+
+    qint64 sent = m_udpSocket->writeDatagram(syncPacket, m_broadcastAddr, ARTNET_PORT);
+    if (sent < 0)
+        qWarning() << "sendSync failed:" << m_udpSocket->errorString();
+    else
+        m_packetSent++;
+
+    m_syncPending = false;
+}
+
 bool ArtNetController::sendRDMCommand(const quint32 universe, uchar command, QVariantList params)
 {
     QByteArray rdmPacket;
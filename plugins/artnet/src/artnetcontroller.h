@@ -43,6 +43,8 @@ typedef struct
     QHostAddress outputAddress;
     ushort outputUniverse;
     int outputTransmissionMode;
+    /** Send an ArtSync at the end of each frame */
+    bool outputSync;
 
     int type;
 } UniverseInfo;
@@ -100,6 +102,14 @@ public:
      *  Return true if this restores default transmission mode */
     bool setTransmissionMode(quint32 universe, TransmissionMode mode);
 
+    /** Enable or disable ArtSync for the given QLC+ universe.
+     *  Return true if this restores the default (disabled) */
+    bool setOutputSync(quint32 universe, bool enable);
+
+    /** Broadcast an ArtSync if a universe with sync enabled has
+     *  been sent since the last call */
+    void sendSync();
+
     /** Converts a TransmissionMode value into a human readable string */
     static QString transmissionModeToString(TransmissionMode mode);
 
@@ -170,6 +180,9 @@ private:
      *  controller, with the related, specific parameters */
     QMap<quint32, UniverseInfo> m_universeMap;
 
+    /** True when an ArtSync must be sent at the end of the frame */
+    bool m_syncPending;
+
     /** Mutex to handle the change of output IP address or in general
      *  variables that could be used to transmit/receive data */
     QMutex m_dataMutex;
@@ -144,6 +144,16 @@ void ArtNetPacketizer::setupArtNetDmx(QByteArray& data, const int &universe, con
         m_sequence[universe]++;
 }
 
+void ArtNetPacketizer::setupArtNetSync(QByteArray &data)
+{
+    data.clear();
+    data.append(m_commonHeader);
+    const char opCodeMSB = (ARTNET_SYNC >> 8);
+    data[9] = opCodeMSB;
+    data.append('\0'); // Aux1
+    data.append('\0'); // Aux2
+}
+
 void ArtNetPacketizer::setupArtNetTodRequest(QByteArray &data, const int &universe)
 {
     data.clear();
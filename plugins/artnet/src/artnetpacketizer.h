@@ -31,6 +31,7 @@
 #define ARTNET_COMMAND        0x2400
 #define ARTNET_DMX            0x5000
 #define ARTNET_NZS            0x5100
+#define ARTNET_SYNC           0x5200
 #define ARTNET_ADDRESS        0x6000
 #define ARTNET_INPUT          0x7000
 #define ARTNET_TODREQUEST     0x8000
@@ -91,6 +92,9 @@ public:
     /** Prepare an ArtNetDmx packet */
     void setupArtNetDmx(QByteArray& data, const int& universe, const QByteArray &values);
 
+    /** Prepare an ArtSync packet */
+    void setupArtNetSync(QByteArray& data);
+
     /** Prepare an ArtTodRequest packet */
     void setupArtNetTodRequest(QByteArray& data, const int& universe);
 
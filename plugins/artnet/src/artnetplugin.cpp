@@ -223,6 +223,15 @@ void ArtNetPlugin::writeUniverse(quint32 universe, quint32 output, const QByteAr
         controller->sendDmx(universe, data);
 }
 
+void ArtNetPlugin::commitFrame()
+{
+    foreach (ArtNetIO line, m_IOmapping)
+    {
+        if (line.controller != NULL)
+            line.controller->sendSync();
+    }
+}
+
 /*************************************************************************
   * Inputs
   *************************************************************************/
@@ -361,6 +370,8 @@ void ArtNetPlugin::setParameter(quint32 universe, quint32 line, Capability type,
             unset = controller->setOutputUniverse(universe, value.toUInt());
         else if (name == ARTNET_TRANSMITMODE)
             unset = controller->setTransmissionMode(universe, ArtNetController::stringToTransmissionMode(value.toString()));
+        else if (name == ARTNET_OUTPUTSYNC)
+            unset = controller->setOutputSync(universe, value.toBool());
         else
         {
             qWarning() << Q_FUNC_INFO << name << "is not a valid ArtNet output parameter";
@@ -41,6 +41,7 @@ typedef struct
 #define ARTNET_OUTPUTIP "outputIP"
 #define ARTNET_OUTPUTUNI "outputUni"
 #define ARTNET_TRANSMITMODE "transmitMode"
+#define ARTNET_OUTPUTSYNC "outputSync"
 
 class ArtNetPlugin : public QLCIOPlugin
 {
@@ -91,6 +92,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void commitFrame();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
@@ -62,4 +62,24 @@ void ArtNet_Test::setupArtNetDmx()
     QCOMPARE(data.data(), "Art-Net");
 }
 
+void ArtNet_Test::setupArtNetSync()
+{
+    ArtNetPacketizer ap;
+    QByteArray data;
+    quint16 opCode = 0;
+
+    ap.setupArtNetSync(data);
+
+    QCOMPARE(data.size(), 14);
+    QCOMPARE(data.data(), "Art-Net");
+    QVERIFY(ap.checkPacketAndCode(data, opCode) == true);
+    QCOMPARE(opCode, quint16(ARTNET_SYNC));
+
+    // protocol version 14, then Aux1 and Aux2
+    QCOMPARE(data.at(10), char(0x00));
+    QCOMPARE(data.at(11), char(0x0e));
+    QCOMPARE(data.at(12), char(0x00));
+    QCOMPARE(data.at(13), char(0x00));
+}
+
 QTEST_MAIN(ArtNet_Test)
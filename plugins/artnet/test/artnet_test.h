@@ -28,6 +28,7 @@ class ArtNet_Test : public QObject
 
 private slots:
     void setupArtNetDmx();
+    void setupArtNetSync();
 };
 
 #endif
@@ -0,0 +1,189 @@
+/*
+  Q Light Controller Plus
+  dmxusbframescheduler.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX)
+  #include <pthread.h>
+  #include <sched.h>
+  #include <errno.h>
+  #include <time.h>
+#endif
+
+#include "dmxusbframescheduler.h"
+
+#define SETTINGS_REALTIME "dmxusb/realtime"
+
+/** Weight of a new sample in the frame rate and jitter moving averages */
+#define STATS_WEIGHT    (1.0 / 16.0)
+
+DMXUSBFrameScheduler::DMXUSBFrameScheduler()
+    : m_frameTimeNs(0)
+    , m_deadline(0)
+    , m_lastFrame(-1)
+    , m_meanPeriodNs(0)
+    , m_meanDeviationNs(0)
+{
+    m_clock.start();
+}
+
+void DMXUSBFrameScheduler::start(int frameTimeUs)
+{
+    setRealtimePriority();
+
+    m_frameTimeNs = qint64(frameTimeUs) * 1000;
+    m_deadline = now();
+    m_lastFrame = -1;
+
+    QMutexLocker locker(&m_statsMutex);
+    m_meanPeriodNs = 0;
+    m_meanDeviationNs = 0;
+}
+
+void DMXUSBFrameScheduler::setFrameTime(int frameTimeUs)
+{
+    m_frameTimeNs = qint64(frameTimeUs) * 1000;
+}
+
+bool DMXUSBFrameScheduler::waitNextFrame()
+{
+    bool onTime = true;
+
+    m_deadline += m_frameTimeNs;
+
+    qint64 current = now();
+    if (current > m_deadline + m_frameTimeNs)
+    {
+        /* Too late to catch up: restart the schedule from now */
+        m_deadline = current;
+        onTime = false;
+    }
+    else
+    {
+        sleepUntil(m_deadline);
+        current = now();
+    }
+
+    if (m_lastFrame >= 0)
+    {
+        double period = double(current - m_lastFrame);
+        double deviation = qAbs(period - double(m_frameTimeNs));
+
+        QMutexLocker locker(&m_statsMutex);
+        if (m_meanPeriodNs == 0)
+        {
+            m_meanPeriodNs = period;
+            m_meanDeviationNs = deviation;
+        }
+        else
+        {
+            m_meanPeriodNs += (period - m_meanPeriodNs) * STATS_WEIGHT;
+            m_meanDeviationNs += (deviation - m_meanDeviationNs) * STATS_WEIGHT;
+        }
+    }
+    m_lastFrame = current;
+
+    return onTime;
+}
+
+void DMXUSBFrameScheduler::sleepUs(int us)
+{
+    sleepUntil(now() + qint64(us) * 1000);
+}
+
+double DMXUSBFrameScheduler::frameRate() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    if (m_meanPeriodNs <= 0)
+        return 0;
+
+    return 1000000000.0 / m_meanPeriodNs;
+}
+
+double DMXUSBFrameScheduler::jitterUs() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    return m_meanDeviationNs / 1000.0;
+}
+
+QString DMXUSBFrameScheduler::info() const
+{
+    QString info;
+
+    double rate = frameRate();
+    if (rate == 0)
+        return info;
+
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2Hz").arg(QObject::tr("Achieved Frame Frequency"))
+                                      .arg(rate, 0, 'f', 1);
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2us").arg(QObject::tr("Frame Jitter"))
+                                      .arg(jitterUs(), 0, 'f', 0);
+
+    return info;
+}
+
+qint64 DMXUSBFrameScheduler::now() const
+{
+#if defined(Q_OS_LINUX)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return m_clock.nsecsElapsed();
+#endif
+}
+
+void DMXUSBFrameScheduler::sleepUntil(qint64 deadline)
+{
+#if defined(Q_OS_LINUX)
+    struct timespec ts;
+    ts.tv_sec = time_t(deadline / 1000000000);
+    ts.tv_nsec = long(deadline % 1000000000);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+#else
+    /* No absolute sleep: the deadline is still absolute, so at least
+     * the oversleeping of a frame is recovered on the next one */
+    qint64 left = deadline - now();
+    if (left > 0)
+        QThread::usleep(static_cast<unsigned long>(left / 1000));
+#endif
+}
+
+void DMXUSBFrameScheduler::setRealtimePriority()
+{
+    QSettings settings;
+    if (settings.value(SETTINGS_REALTIME, false).toBool() == false)
+        return;
+
+#if defined(Q_OS_LINUX)
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+
+    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0)
+        qWarning() << "[DMXUSB] Cannot use SCHED_FIFO for the output thread:" << ret;
+#else
+    qDebug() << "[DMXUSB] Real time scheduling is not supported on this platform";
+#endif
+}
@@ -0,0 +1,91 @@
+/*
+  Q Light Controller Plus
+  dmxusbframescheduler.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXUSBFRAMESCHEDULER_H
+#define DMXUSBFRAMESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QMutex>
+
+/**
+ * Paces the DMX frames of a widget output thread.
+ *
+ * Frames are scheduled on absolute deadlines (clock_nanosleep with
+ * TIMER_ABSTIME on Linux), so the time spent writing a frame, or
+ * oversleeping, never accumulates into a slower frame rate.
+ * When a frame is late by more than a whole period, the schedule is
+ * restarted from the current time instead of sending a burst of frames.
+ *
+ * The achieved frame rate and jitter are measured, to be displayed in
+ * the widget information.
+ */
+class DMXUSBFrameScheduler
+{
+public:
+    DMXUSBFrameScheduler();
+
+    /** Start scheduling from now. To be called by the output thread,
+     *  that is also raised to SCHED_FIFO if enabled in the settings */
+    void start(int frameTimeUs);
+
+    /** Change the frame period. Effective from the next frame */
+    void setFrameTime(int frameTimeUs);
+
+    /**
+     * Sleep until the deadline of the next frame.
+     *
+     * @return false if the current frame has missed its deadline
+     */
+    bool waitNextFrame();
+
+    /** Sleep for a short, precise amount of time, e.g. a DMX break */
+    void sleepUs(int us);
+
+    /** The measured frame rate in Hertz, 0 if not running */
+    double frameRate() const;
+
+    /** The measured mean deviation from the frame period in microseconds */
+    double jitterUs() const;
+
+    /** HTML lines with the measured values, for additionalInfo().
+     *  Empty if nothing has been measured yet */
+    QString info() const;
+
+private:
+    /** Monotonic time in nanoseconds */
+    qint64 now() const;
+
+    /** Sleep until the monotonic time $deadline */
+    void sleepUntil(qint64 deadline);
+
+    void setRealtimePriority();
+
+private:
+    QElapsedTimer m_clock;
+    qint64 m_frameTimeNs;
+    qint64 m_deadline;
+    qint64 m_lastFrame;
+
+    mutable QMutex m_statsMutex;
+    double m_meanPeriodNs;
+    double m_meanDeviationNs;
+};
+
+#endif
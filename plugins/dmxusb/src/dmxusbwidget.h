@@ -23,6 +23,8 @@
 
 #include <QElapsedTimer>
 
+#include "dmxusbframescheduler.h"
+
 #if defined(FTD2XX)
   #include "ftd2xx-interface.h"
 #endif
@@ -160,6 +162,9 @@ protected:
     /** Array of output lines supported by the device. This is resized on setOutputsNumber */
     QVector<DMXUSBLineInfo> m_outputLines;
 
+    /** Paces the frames of the widget output thread */
+    DMXUSBFrameScheduler m_scheduler;
+
     /********************************************************************
      * Inputs
      ********************************************************************/
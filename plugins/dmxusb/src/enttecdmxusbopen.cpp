@@ -133,6 +133,8 @@ QString EnttecDMXUSBOpen::additionalInfo() const
     else
         gran = tr("Patch this widget to a universe to find out.");
     info += QString("<B>%1:</B> %2").arg(tr("System Timer Accuracy")).arg(gran);
+    if (isRunning())
+        info += m_scheduler.info();
     info += QString("</P>");
 
     return info;
@@ -167,7 +169,7 @@ void EnttecDMXUSBOpen::run()
     // Also measure, whether timer granularity is OK
     QElapsedTimer time;
     time.start();
-    usleep(1000);
+    m_scheduler.sleepUs(1000);
     if (time.elapsed() > 3)
         m_granularity = Bad;
     else
@@ -189,31 +191,27 @@ void EnttecDMXUSBOpen::run()
     }
 
     m_running = true;
+    m_scheduler.start(m_frameTimeUs);
     while (m_running == true)
     {
-        // Measure how much time passes during these calls
-        time.restart();
-
         if (interface()->setBreak(true) == false)
             goto framesleep;
 
         if (m_granularity == Good)
-            usleep(DMX_BREAK);
+            m_scheduler.sleepUs(DMX_BREAK);
 
         if (interface()->setBreak(false) == false)
             goto framesleep;
 
         if (m_granularity == Good)
-            usleep(DMX_MAB);
+            m_scheduler.sleepUs(DMX_MAB);
 
         if (interface()->write(m_outputLines[0].m_universeData) == false)
             goto framesleep;
 
 framesleep:
-        // Sleep for the remainder of the DMX frame time
-        if (m_granularity == Good)
-            while (time.elapsed() < (m_frameTimeUs / 1000)) { usleep(1000); }
-        else
-            while (time.elapsed() < (m_frameTimeUs / 1000)) { /* Busy sleep */ }
+        // Sleep until the beginning of the next DMX frame
+        m_scheduler.setFrameTime(m_frameTimeUs);
+        m_scheduler.waitNextFrame();
     }
 }
@@ -116,6 +116,8 @@ QString EnttecDMXUSBPro::additionalInfo() const
     info += QString("<B>%1:</B> %2").arg(tr("Manufacturer")).arg(vendor());
     info += QString("<BR>");
     info += QString("<B>%1:</B> %2").arg(tr("Serial number")).arg(m_proSerial);
+    if (isRunning())
+        info += m_scheduler.info();
     info += QString("</P>");
 
     return info;
@@ -489,16 +491,12 @@ bool EnttecDMXUSBPro::writeUniverse(quint32 universe, quint32 output, const QByt
 void EnttecDMXUSBPro::run()
 {
     qDebug() << "OUTPUT thread started";
-    QElapsedTimer timer;
 
     m_outputRunning = true;
+    m_scheduler.start(m_frameTimeUs);
 
     while (m_outputRunning == true)
     {
-        timer.restart();
-
-        //goto framesleep;
-
         // no open output lines: do nothing
         if (openOutputLines() == 0)
             goto framesleep;
@@ -598,11 +596,9 @@ void EnttecDMXUSBPro::run()
         }
 
 framesleep:
-        int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
-        if (timetoSleep < 0)
+        m_scheduler.setFrameTime(m_frameTimeUs);
+        if (m_scheduler.waitNextFrame() == false)
             qWarning() << "DMX output is running late !";
-        else
-            usleep(timetoSleep);
     }
 
     qDebug() << "OUTPUT thread terminated";
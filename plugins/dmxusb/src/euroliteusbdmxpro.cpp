@@ -177,6 +177,8 @@ QString EuroliteUSBDMXPro::additionalInfo() const
     info += QString("<BR>");
     info += QString("<B>%1:</B> %2").arg(QObject::tr("Serial number"))
                                                  .arg(serial());
+    if (isRunning())
+        info += m_scheduler.info();
     info += QString("</P>");
 
     return info;
@@ -219,14 +221,12 @@ void EuroliteUSBDMXPro::stop()
 void EuroliteUSBDMXPro::run()
 {
     qDebug() << "OUTPUT thread started";
-    QElapsedTimer timer;
     QByteArray request;
 
     m_running = true;
+    m_scheduler.start(m_frameTimeUs);
     while (m_running == true)
     {
-        timer.restart();
-
         int dataLen = m_outputLines[0].m_universeData.length();
         if (dataLen == 0)
             goto framesleep;
@@ -252,11 +252,9 @@ void EuroliteUSBDMXPro::run()
 #endif
         }
 framesleep:
-        int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
-        if (timetoSleep < 0)
+        m_scheduler.setFrameTime(m_frameTimeUs);
+        if (m_scheduler.waitNextFrame() == false)
             qWarning() << "DMX output is running late !";
-        else
-            usleep(timetoSleep);
     }
 
     qDebug() << "OUTPUT thread terminated";
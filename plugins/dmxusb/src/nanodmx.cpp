@@ -242,6 +242,8 @@ QString NanoDMX::additionalInfo() const
     info += QString("<BR>");
     info += QString("<B>%1:</B> %2").arg(QObject::tr("Serial number"))
                                                  .arg(serial());
+    if (isRunning())
+        info += m_scheduler.info();
     info += QString("</P>");
 
     return info;
@@ -287,8 +289,6 @@ void NanoDMX::run()
 {
     qDebug() << "OUTPUT thread started";
 
-    QElapsedTimer timer;
-
     m_running = true;
 
     if (m_outputLines[0].m_compareData.size() == 0)
@@ -297,10 +297,9 @@ void NanoDMX::run()
     // Wait for device to settle in case the device was opened just recently
     usleep(1000);
 
+    m_scheduler.start(m_frameTimeUs);
     while (m_running == true)
     {
-        timer.restart();
-
         for (int i = 0; i < m_outputLines[0].m_universeData.length(); i++)
         {
             uchar val = uchar(m_outputLines[0].m_universeData[i]);
@@ -343,11 +342,9 @@ void NanoDMX::run()
             }
         }
 
-        int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
-        if (timetoSleep < 0)
+        m_scheduler.setFrameTime(m_frameTimeUs);
+        if (m_scheduler.waitNextFrame() == false)
             qWarning() << "DMX output is running late !";
-        else
-            usleep(timetoSleep);
     }
 }
 
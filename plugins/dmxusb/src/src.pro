@@ -113,6 +113,7 @@ HEADERS += ../../interfaces/qlcioplugin.h
 
 HEADERS += dmxusb.h \
            dmxusbwidget.h \
+           dmxusbframescheduler.h \
            dmxusbconfig.h \
            enttecdmxusbpro.h \
            enttecdmxusbopen.h \
@@ -129,6 +130,7 @@ SOURCES += ../../interfaces/qlcioplugin.cpp \
 SOURCES += dmxinterface.cpp \
            dmxusb.cpp \
            dmxusbwidget.cpp \
+           dmxusbframescheduler.cpp \
            dmxusbconfig.cpp \
            enttecdmxusbpro.cpp \
            enttecdmxusbopen.cpp \
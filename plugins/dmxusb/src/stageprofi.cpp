@@ -147,6 +147,8 @@ QString Stageprofi::additionalInfo() const
     info += QString("<BR>");
     info += QString("<B>%1:</B> %2").arg(QObject::tr("Serial number"))
                                                  .arg(serial());
+    if (isRunning())
+        info += m_scheduler.info();
     info += QString("</P>");
 
     return info;
@@ -185,8 +187,6 @@ void Stageprofi::run()
 {
     qDebug() << "OUTPUT thread started";
 
-    QElapsedTimer timer;
-
     m_running = true;
 
     if (m_outputLines[0].m_compareData.size() == 0)
@@ -195,10 +195,9 @@ void Stageprofi::run()
     // Wait for device to settle in case the device was opened just recently
     usleep(1000);
 
+    m_scheduler.start(m_frameTimeUs);
     while (m_running == true)
     {
-        timer.restart();
-
         for (int i = 0; i < m_outputLines[0].m_universeData.length(); i++)
         {
             uchar val = uchar(m_outputLines[0].m_universeData[i]);
@@ -233,11 +232,9 @@ void Stageprofi::run()
             }
         }
 
-        int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
-        if (timetoSleep < 0)
+        m_scheduler.setFrameTime(m_frameTimeUs);
+        if (m_scheduler.waitNextFrame() == false)
             qWarning() << "DMX output is running late !";
-        else
-            usleep(timetoSleep);
     }
 
     qDebug() << "OUTPUT thread terminated";
@@ -33,6 +33,9 @@
 
 GPIOPlugin::~GPIOPlugin()
 {
+    /* Stop reading before closing the PINs */
+    delete m_readerThread;
+
     for (int i = 0; i < MAX_GPIO_PINS; i++)
         setPinStatus(i, false);
 }
@@ -43,6 +46,10 @@ void GPIOPlugin::init()
     m_inputUniverse = UINT_MAX;
     m_outputUniverse = UINT_MAX;
 
+    m_sysfsPath = QString::fromLocal8Bit(qgetenv("QLCPLUS_GPIO_SYSFS"));
+    if (m_sysfsPath.isEmpty())
+        m_sysfsPath = QString(GPIO_SYSFS_PATH);
+
     for (int i = 0; i < MAX_GPIO_PINS; i++)
     {
         GPIOPinInfo *gpio = new GPIOPinInfo;
@@ -50,9 +57,11 @@ void GPIOPlugin::init()
         gpio->m_enabled = false;
         gpio->m_usage = NoUsage;
         gpio->m_value = 1;
-        gpio->m_count = 0;
+        gpio->m_edge = false;
+        gpio->m_lastChange = -1;
+        gpio->m_pending = false;
 
-        QString pinPath = QString("/sys/class/gpio/gpio%1/value").arg(i);
+        QString pinPath = QString("%1/gpio%2/value").arg(m_sysfsPath).arg(i);
         gpio->m_file = new QFile(pinPath);
 
         m_gpioList.append(gpio);
@@ -191,7 +200,7 @@ void GPIOPlugin::setPinStatus(int gpioNumber, bool enable)
     if (m_gpioList.at(gpioNumber)->m_enabled == enable)
         return;
 
-    QString sysPath = QString("/sys/class/gpio/%1").arg(enable ? "export" : "unexport");
+    QString sysPath = QString("%1/%2").arg(m_sysfsPath).arg(enable ? "export" : "unexport");
     QString gpioStr = QString("%1").arg(gpioNumber);
     QFile file(sysPath);
     if (!file.open(QIODevice::WriteOnly))
@@ -225,7 +234,10 @@ void GPIOPlugin::setPinUsage(int gpioNumber, GPIOPlugin::PinUsage usage)
     if (usage == NoUsage)
     {
         if (gpio->m_usage == InputUsage)
+        {
             m_gpioList[gpioNumber]->m_file->close();
+            setPinEdge(gpioNumber, "none");
+        }
 
         m_gpioList[gpioNumber]->m_usage = usage;
 
@@ -241,7 +253,7 @@ void GPIOPlugin::setPinUsage(int gpioNumber, GPIOPlugin::PinUsage usage)
     else
         setPinStatus(gpioNumber, true);
 
-    QString pinPath = QString("/sys/class/gpio/gpio%1/direction").arg(gpioNumber);
+    QString pinPath = QString("%1/gpio%2/direction").arg(m_sysfsPath).arg(gpioNumber);
     QFile file(pinPath);
     int attempts = MAX_FILE_ATTEMPTS;
 
@@ -268,6 +280,11 @@ void GPIOPlugin::setPinUsage(int gpioNumber, GPIOPlugin::PinUsage usage)
         file.write("in");
     file.close();
 
+    if (usage == InputUsage)
+        gpio->m_edge = setPinEdge(gpioNumber, "both");
+    else if (gpio->m_usage == InputUsage)
+        setPinEdge(gpioNumber, "none");
+
     m_gpioList[gpioNumber]->m_usage = usage;
 
     if (m_readerThread != NULL)
@@ -311,6 +328,26 @@ void GPIOPlugin::setPinValue(int gpioNumber, uchar value)
     m_gpioList[gpioNumber]->m_value = value;
 }
 
+bool GPIOPlugin::setPinEdge(int gpioNumber, const QString &edge)
+{
+    if (gpioNumber < 0 || gpioNumber >= m_gpioList.count())
+        return false;
+
+    QString pinPath = QString("%1/gpio%2/edge").arg(m_sysfsPath).arg(gpioNumber);
+    QFile file(pinPath);
+
+    if (file.exists() == false || !file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "[GPIO] PIN" << gpioNumber << "has no edge support, it will be sampled";
+        return false;
+    }
+
+    bool ok = file.write(edge.toLatin1()) == edge.length();
+    file.close();
+
+    return ok;
+}
+
 /*************************************************************************
  * Inputs
  *************************************************************************/
@@ -26,6 +26,10 @@
 
 #define GPIO_PARAM_USAGE "pinUsage"
 
+/** The sysfs GPIO root. Can be overridden with the QLCPLUS_GPIO_SYSFS
+ *  environment variable, to run the plugin on a directory of plain files */
+#define GPIO_SYSFS_PATH  "/sys/class/gpio"
+
 typedef struct
 {
     int m_number;
@@ -33,7 +37,12 @@ typedef struct
     int m_usage;
     QFile *m_file;
     uchar m_value;
-    uchar m_count;
+    /** True when the kernel signals the value changes (edge file set) */
+    bool m_edge;
+    /** Reader time of the last emitted change, -1 if none */
+    qint64 m_lastChange;
+    /** A change was seen while debouncing and must be checked again */
+    bool m_pending;
 } GPIOPinInfo;
 
 class ReadThread;
@@ -68,6 +77,7 @@ public:
     QList<GPIOPinInfo *> gpioList() const;
 
 protected:
+    QString m_sysfsPath;
     QList<GPIOPinInfo *> m_gpioList;
     ReadThread *m_readerThread;
     quint32 m_inputUniverse, m_outputUniverse;
@@ -91,6 +101,10 @@ private:
     void setPinUsage(int gpioNumber, PinUsage usage);
     void setPinValue(int gpioNumber, uchar value);
 
+    /** Write $edge ("none", "rising", "falling", "both") to the PIN edge
+     *  file. Return false if the PIN cannot signal its changes */
+    bool setPinEdge(int gpioNumber, const QString& edge);
+
     /*********************************************************************
      * Outputs
      *********************************************************************/
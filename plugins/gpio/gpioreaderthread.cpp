@@ -17,12 +17,22 @@
   limitations under the License.
 */
 
+#include <QVector>
 #include <QDebug>
 
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+
 #include "gpioreaderthread.h"
 #include "gpioplugin.h"
 
-#define HYSTERESIS_THRESHOLD  3
+/** Time during which a PIN changes are ignored, after one has been emitted */
+#define DEBOUNCE_MS         20
+
+/** Sampling interval of the PINs that cannot signal their edges */
+#define SAMPLE_INTERVAL_MS  50
 
 ReadThread::ReadThread(GPIOPlugin *plugin, QObject *parent)
     : QThread(parent)
@@ -30,6 +40,18 @@ ReadThread::ReadThread(GPIOPlugin *plugin, QObject *parent)
     , m_running(false)
     , m_paused(false)
 {
+    if (pipe(m_wakePipe) == 0)
+    {
+        fcntl(m_wakePipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(m_wakePipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else
+    {
+        qWarning() << "[GPIO] Cannot create the reader wake pipe";
+        m_wakePipe[0] = m_wakePipe[1] = -1;
+    }
+
+    m_clock.start();
     updateReadPINs();
     start();
 }
@@ -37,6 +59,12 @@ ReadThread::ReadThread(GPIOPlugin *plugin, QObject *parent)
 ReadThread::~ReadThread()
 {
     stop();
+
+    if (m_wakePipe[0] != -1)
+    {
+        close(m_wakePipe[0]);
+        close(m_wakePipe[1]);
+    }
 }
 
 void ReadThread::stop()
@@ -45,6 +73,7 @@ void ReadThread::stop()
     if (isRunning() == true)
     {
         m_running = false;
+        wake();
         wait();
     }
 }
@@ -54,6 +83,7 @@ void ReadThread::pause(bool paused)
     qDebug() << Q_FUNC_INFO << paused;
     QMutexLocker locker(&m_mutex);
     m_paused = paused;
+    wake();
 }
 
 void ReadThread::updateReadPINs()
@@ -83,52 +113,125 @@ void ReadThread::updateReadPINs()
             }
         }
     }
+
+    wake();
+}
+
+void ReadThread::wake()
+{
+    if (m_wakePipe[1] == -1)
+        return;
+
+    char c = 0;
+    if (write(m_wakePipe[1], &c, 1) < 0 && errno != EAGAIN)
+        qWarning() << "[GPIO] Cannot wake up the reader thread";
+}
+
+void ReadThread::checkPin(GPIOPinInfo *gpio, qint64 now)
+{
+    if (gpio->m_file == NULL || gpio->m_file->isOpen() == false)
+        return;
+
+    /* Reading the value file also re-arms the edge notification */
+    gpio->m_file->reset();
+    QByteArray dataRead = gpio->m_file->readAll().simplified();
+    if (dataRead.isEmpty())
+        return;
+
+    uchar newVal = dataRead.toUInt();
+    if (newVal == gpio->m_value)
+    {
+        gpio->m_pending = false;
+        return;
+    }
+
+    if (gpio->m_lastChange >= 0 && now - gpio->m_lastChange < DEBOUNCE_MS)
+    {
+        gpio->m_pending = true;
+        return;
+    }
+
+    qDebug() << "Value read: GPIO:" << gpio->m_number << "val:" <<  newVal;
+    gpio->m_value = newVal;
+    gpio->m_lastChange = now;
+    gpio->m_pending = false;
+    emit valueChanged(gpio->m_number, gpio->m_value);
 }
 
 void ReadThread::run()
 {
     qDebug() << "[GPIO] Reader thread created";
+    QVector<struct pollfd> fds;
+
     m_running = true;
     while (m_running == true)
     {
-        if (m_paused == true)
-        {
-            usleep(50000);
-            continue;
-        }
-
         QMutexLocker locker(&m_mutex);
 
-        foreach(GPIOPinInfo *gpio, m_readList)
+        /* Without the wake pipe, fall back to sampling everything */
+        int timeout = m_wakePipe[0] == -1 ? SAMPLE_INTERVAL_MS : -1;
+
+        fds.resize(1);
+        fds[0].fd = m_wakePipe[0];
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+
+        if (m_paused == false)
         {
-            if (gpio->m_file == NULL || gpio->m_file->isOpen() == false)
-                continue;
-
-            //qDebug() << "Reading file:" << gpio->m_file->fileName();
-            gpio->m_file->reset();
-            QByteArray dataRead = gpio->m_file->readAll().simplified();
-            if (dataRead.isEmpty())
-                continue;
-            uchar newVal = dataRead.toUInt();
-            if (newVal != gpio->m_value)
+            qint64 now = m_clock.elapsed();
+
+            foreach (GPIOPinInfo *gpio, m_readList)
             {
-                gpio->m_count++;
-                if (gpio->m_count > HYSTERESIS_THRESHOLD)
+                if (gpio->m_file == NULL || gpio->m_file->isOpen() == false)
+                    continue;
+
+                if (gpio->m_edge)
                 {
-                    qDebug() << "Value read: GPIO:" << gpio->m_number << "val:" <<  newVal;
-                    gpio->m_value = newVal;
-                    gpio->m_count = 0;
-                    emit valueChanged(gpio->m_number, gpio->m_value);
+                    struct pollfd pfd;
+                    pfd.fd = gpio->m_file->handle();
+                    pfd.events = POLLPRI | POLLERR;
+                    pfd.revents = 0;
+                    fds.append(pfd);
+                }
+                else if (timeout < 0 || timeout > SAMPLE_INTERVAL_MS)
+                {
+                    timeout = SAMPLE_INTERVAL_MS;
+                }
+
+                if (gpio->m_pending)
+                {
+                    qint64 left = qMax(qint64(0), gpio->m_lastChange + DEBOUNCE_MS - now);
+                    if (timeout < 0 || left < timeout)
+                        timeout = int(left);
                 }
-            }
-            else
-            {
-                gpio->m_count = 0;
             }
         }
+
         locker.unlock();
 
-        usleep(50000);
+        int ret = poll(fds.data(), fds.size(), timeout);
+        if (ret < 0 && errno != EINTR)
+        {
+            qWarning() << "[GPIO] poll error:" << errno;
+            usleep(SAMPLE_INTERVAL_MS * 1000);
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            char buf[32];
+            while (read(m_wakePipe[0], buf, sizeof(buf)) > 0) {}
+        }
+
+        locker.relock();
+
+        if (m_running == false || m_paused == true)
+            continue;
+
+        /* There are at most a few tens of PINs: checking them all is
+         * cheaper than mapping the descriptors back to them, and the
+         * thread only wakes up when something happens */
+        qint64 now = m_clock.elapsed();
+        foreach (GPIOPinInfo *gpio, m_readList)
+            checkPin(gpio, now);
     }
 }
-
@@ -20,11 +20,22 @@
 #ifndef GPIOREADERTHREAD_H
 #define GPIOREADERTHREAD_H
 
+#include <QElapsedTimer>
 #include <QThread>
 #include <QMutexLocker>
 
 #include "gpioplugin.h"
 
+/**
+ * Reads the input PINs without polling their values periodically:
+ * the thread blocks in poll() on the value files of the PINs configured
+ * to signal their edges, and wakes up as soon as one of them changes.
+ * PINs that cannot signal their edges are sampled instead.
+ *
+ * Changes are emitted immediately, then the PIN is ignored for a
+ * debounce time. If the value is different at the end of it, the new
+ * value is emitted too.
+ */
 class ReadThread : public QThread
 {
     Q_OBJECT
@@ -43,6 +54,13 @@ public:
 protected:
     void run();
 
+    /** Interrupt a running poll(), to make it reconsider the PINs */
+    void wake();
+
+    /** Read the value of $gpio and emit it if it has changed
+     *  and the PIN is not debouncing */
+    void checkPin(GPIOPinInfo *gpio, qint64 now);
+
 signals:
     void valueChanged(quint32 channel, uchar value);
 
@@ -52,6 +70,10 @@ private:
     bool m_paused;
     QMutex m_mutex;
     QList<GPIOPinInfo *> m_readList;
+
+    /** Used to wake up the thread blocked in poll() */
+    int m_wakePipe[2];
+    QElapsedTimer m_clock;
 };
 
 #endif
@@ -0,0 +1,271 @@
+/*
+  Q Light Controller Plus
+  gpio_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QThread>
+#include <QMutex>
+#include <QFile>
+#include <QDir>
+#include <QTest>
+
+#define protected public
+#define private public
+#include "gpioplugin.h"
+#include "gpioreaderthread.h"
+#undef private
+#undef protected
+
+#include "gpio_test.h"
+
+/** PIN without an edge file: the reader samples it */
+#define SAMPLED_PIN     0
+
+/** PIN with an edge file: the reader waits for its interrupts */
+#define EDGE_PIN        1
+
+/** Must match the reader debounce time */
+#define DEBOUNCE_MS     20
+
+static QByteArray readFile(const QString& path)
+{
+    QFile file(path);
+    if (file.open(QIODevice::ReadOnly) == false)
+        return QByteArray();
+    return file.readAll();
+}
+
+static void writeFile(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data);
+    file.close();
+}
+
+/****************************************************************************
+ * Fake sysfs
+ ****************************************************************************/
+
+QString GPIO_Test::pinPath(int pin, const QString& file) const
+{
+    return QString("%1/gpio%2/%3").arg(m_sysfs->path()).arg(pin).arg(file);
+}
+
+void GPIO_Test::setValue(int pin, char value)
+{
+    writeFile(pinPath(pin, "value"), QByteArray(1, value) + '\n');
+}
+
+void GPIO_Test::raiseEdge()
+{
+    m_plugin->m_readerThread->wake();
+}
+
+void GPIO_Test::init()
+{
+    m_sysfs = new QTemporaryDir();
+    QVERIFY(m_sysfs->isValid());
+
+    QDir dir(m_sysfs->path());
+    writeFile(dir.filePath("export"), QByteArray());
+    writeFile(dir.filePath("unexport"), QByteArray());
+
+    /* Regular files never signal POLLPRI, so the edge PIN only
+     * wakes up the reader when the test raises an edge */
+    for (int pin = SAMPLED_PIN; pin <= EDGE_PIN; pin++)
+    {
+        QVERIFY(dir.mkdir(QString("gpio%1").arg(pin)));
+        writeFile(pinPath(pin, "direction"), "out");
+        setValue(pin, '1');
+    }
+    writeFile(pinPath(EDGE_PIN, "edge"), "none");
+
+    qputenv("QLCPLUS_GPIO_SYSFS", m_sysfs->path().toLocal8Bit());
+
+    m_plugin = new GPIOPlugin();
+    m_plugin->init();
+    m_plugin->openInput(0, 0);
+}
+
+void GPIO_Test::cleanup()
+{
+    delete m_plugin;
+    m_plugin = NULL;
+
+    delete m_sysfs;
+    m_sysfs = NULL;
+
+    qunsetenv("QLCPLUS_GPIO_SYSFS");
+}
+
+/****************************************************************************
+ * Tests
+ ****************************************************************************/
+
+void GPIO_Test::setup()
+{
+    QVERIFY(m_plugin->m_readerThread == NULL);
+
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(EDGE_PIN), "Input");
+
+    QCOMPARE(readFile(m_sysfs->path() + "/export"), QByteArray("1"));
+    QCOMPARE(readFile(pinPath(EDGE_PIN, "direction")), QByteArray("in"));
+    QCOMPARE(readFile(pinPath(EDGE_PIN, "edge")), QByteArray("both"));
+
+    GPIOPinInfo *gpio = m_plugin->gpioList().at(EDGE_PIN);
+    QVERIFY(gpio->m_edge == true);
+    QVERIFY(gpio->m_file->isOpen() == true);
+    QVERIFY(m_plugin->m_readerThread != NULL);
+    QVERIFY(m_plugin->m_readerThread->m_readList.contains(gpio));
+
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(SAMPLED_PIN), "Input");
+    QVERIFY(m_plugin->gpioList().at(SAMPLED_PIN)->m_edge == false);
+
+    /* Releasing the PIN disables its edge and unexports it */
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(EDGE_PIN), "NotUsed");
+
+    QCOMPARE(readFile(pinPath(EDGE_PIN, "edge")), QByteArray("none"));
+    QCOMPARE(readFile(m_sysfs->path() + "/unexport"), QByteArray("1"));
+    QVERIFY(gpio->m_file->isOpen() == false);
+    QVERIFY(m_plugin->m_readerThread->m_readList.contains(gpio) == false);
+}
+
+void GPIO_Test::sampled()
+{
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(SAMPLED_PIN), "Input");
+
+    QSignalSpy spy(m_plugin->m_readerThread, SIGNAL(valueChanged(quint32,uchar)));
+
+    /* No change, nothing emitted */
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 0);
+
+    /* The change is picked up by sampling, without any edge */
+    setValue(SAMPLED_PIN, '0');
+    QVERIFY(spy.wait(500));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), quint32(SAMPLED_PIN));
+    QCOMPARE(spy.at(0).at(1).toUInt(), 0U);
+
+    setValue(SAMPLED_PIN, '1');
+    QVERIFY(spy.wait(500));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toUInt(), 1U);
+}
+
+void GPIO_Test::edge()
+{
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(EDGE_PIN), "Input");
+
+    QSignalSpy spy(m_plugin->m_readerThread, SIGNAL(valueChanged(quint32,uchar)));
+
+    /* An edge PIN is not sampled: the change stays unseen... */
+    setValue(EDGE_PIN, '0');
+    QTest::qWait(200);
+    QCOMPARE(spy.count(), 0);
+
+    /* ...until its edge wakes up the reader */
+    raiseEdge();
+    QVERIFY(spy.wait(500));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toUInt(), quint32(EDGE_PIN));
+    QCOMPARE(spy.at(0).at(1).toUInt(), 0U);
+
+    /* An edge without a change emits nothing */
+    raiseEdge();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+
+    /* While paused, edges are ignored and the change is seen on resume */
+    m_plugin->m_readerThread->pause(true);
+    setValue(EDGE_PIN, '1');
+    raiseEdge();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+
+    m_plugin->m_readerThread->pause(false);
+    QVERIFY(spy.wait(500));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toUInt(), 1U);
+}
+
+void GPIO_Test::debounce()
+{
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(EDGE_PIN), "Input");
+
+    QSignalSpy spy(m_plugin->m_readerThread, SIGNAL(valueChanged(quint32,uchar)));
+
+    /* The first change is emitted at once */
+    setValue(EDGE_PIN, '0');
+    raiseEdge();
+    QVERIFY(spy.wait(500));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /* The next one is held back until the debounce time has passed,
+     * then emitted without any further edge */
+    setValue(EDGE_PIN, '1');
+    raiseEdge();
+    QVERIFY(spy.wait(500));
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(1).toUInt(), 1U);
+
+    /* The timer started after the first emission, so allow some slack */
+    QVERIFY(timer.elapsed() >= DEBOUNCE_MS - 5);
+}
+
+void GPIO_Test::bounce()
+{
+    m_plugin->setParameter(0, 0, QLCIOPlugin::Input,
+                           QString("%1-%2").arg(GPIO_PARAM_USAGE).arg(EDGE_PIN), "Input");
+
+    QSignalSpy spy(m_plugin->m_readerThread, SIGNAL(valueChanged(quint32,uchar)));
+
+    setValue(EDGE_PIN, '0');
+    raiseEdge();
+    QVERIFY(spy.wait(500));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    /* A contact bounce shorter than the debounce time */
+    setValue(EDGE_PIN, '1');
+    raiseEdge();
+    setValue(EDGE_PIN, '0');
+    raiseEdge();
+
+    if (timer.elapsed() >= DEBOUNCE_MS / 2)
+        QSKIP("The bounce took too long to be simulated");
+
+    /* The value is back to the emitted one when the debounce time
+     * is over, so nothing more is emitted */
+    QTest::qWait(DEBOUNCE_MS * 5);
+    QCOMPARE(spy.count(), 1);
+}
+
+QTEST_MAIN(GPIO_Test)
@@ -0,0 +1,57 @@
+/*
+  Q Light Controller Plus
+  gpio_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef GPIO_TEST_H
+#define GPIO_TEST_H
+
+#include <QObject>
+
+class QTemporaryDir;
+class GPIOPlugin;
+
+class GPIO_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void setup();
+    void sampled();
+    void edge();
+    void debounce();
+    void bounce();
+
+private:
+    /** Path of $file of $pin in the fake sysfs */
+    QString pinPath(int pin, const QString& file) const;
+
+    /** Write the value file of $pin, like a changing input would */
+    void setValue(int pin, char value);
+
+    /** Wake up the reader thread, like an edge interrupt would */
+    void raiseEdge();
+
+private:
+    QTemporaryDir *m_sysfs;
+    GPIOPlugin *m_plugin;
+};
+
+#endif
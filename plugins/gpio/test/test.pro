@@ -0,0 +1,30 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = gpio_test
+
+QT      += core testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH += ../../interfaces
+INCLUDEPATH += ..
+DEPENDPATH  += ..
+
+HEADERS += ../../interfaces/qlcioplugin.h
+SOURCES += ../../interfaces/qlcioplugin.cpp
+
+HEADERS += ../gpioplugin.h \
+           ../gpioreaderthread.h \
+           ../gpioconfiguration.h
+
+SOURCES += ../gpioplugin.cpp \
+           ../gpioreaderthread.cpp \
+           ../gpioconfiguration.cpp
+
+FORMS += ../gpioconfiguration.ui
+
+# Test sources
+HEADERS += gpio_test.h
+SOURCES += gpio_test.cpp
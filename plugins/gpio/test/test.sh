@@ -0,0 +1,2 @@
+#!/bin/sh
+./gpio_test
@@ -17,7 +17,9 @@
   limitations under the License.
 */
 
+#include <QElapsedTimer>
 #include <QString>
+#include <time.h>
 
 #include "hiddevice.h"
 #include "hidplugin.h"
@@ -29,6 +31,8 @@ HIDDevice::HIDDevice(HIDPlugin* parent, quint32 line, const QString &name, const
     m_file.setFileName(path);
     m_line = line;
     m_running = false;
+    m_lastEventTime = 0;
+    m_lastEventLatency = 0;
 }
 
 HIDDevice::~HIDDevice()
@@ -97,6 +101,36 @@ void HIDDevice::feedBack(quint32 channel, uchar value)
     Q_UNUSED(value);
 }
 
+qint64 HIDDevice::lastEventTime() const
+{
+    return m_lastEventTime;
+}
+
+qint64 HIDDevice::lastEventLatency() const
+{
+    return m_lastEventLatency;
+}
+
+void HIDDevice::stampEvent(qint64 eventTime)
+{
+    m_lastEventTime = eventTime;
+    m_lastEventLatency = qMax(qint64(0), monotonicTime() - eventTime);
+}
+
+qint64 HIDDevice::monotonicTime()
+{
+#if defined(Q_OS_LINUX)
+    // the clock of the evdev timestamps
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return qint64(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+#else
+    QElapsedTimer timer;
+    timer.start();
+    return timer.msecsSinceReference() * 1000;
+#endif
+}
+
 void HIDDevice::run()
 {
 }
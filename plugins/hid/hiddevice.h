@@ -136,8 +136,28 @@ public:
      */
     virtual void feedBack(quint32 channel, uchar value);
 
+    /**
+     * The time of the last input event, in microseconds of the monotonic
+     * clock. Devices stamp it with the kernel event time when available,
+     * otherwise with the time the event was read. 0 if no event yet.
+     */
+    qint64 lastEventTime() const;
+
+    /** The time elapsed between the last input event and
+     *  the emission of its value, in microseconds */
+    qint64 lastEventLatency() const;
+
+protected:
+    /** Record the time of an input event that is about to be emitted */
+    void stampEvent(qint64 eventTime);
+
+    /** The current time of the monotonic clock, in microseconds */
+    static qint64 monotonicTime();
+
 protected:
     bool m_running;
+    qint64 m_lastEventTime;
+    qint64 m_lastEventLatency;
 
 private:
     /** Input data thread worker method */
@@ -17,25 +17,47 @@
   limitations under the License.
 */
 
+#include <QFileInfo>
 #include <QDebug>
+#include <QDir>
 
 #include <linux/joystick.h>
 #include <linux/input.h>
+#include <sys/eventfd.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <string.h>
 #include <poll.h>
 
 #include "hidlinuxjoystick.h"
 #include "hidplugin.h"
 
-#define KPollTimeout 1000
+/** Number of events read at once */
+#define KEventBatchSize 64
+
+/* The evdev timestamp fields depend on the time_t size of the platform */
+#ifndef input_event_sec
+  #define input_event_sec time.tv_sec
+  #define input_event_usec time.tv_usec
+#endif
 
 HIDLinuxJoystick::HIDLinuxJoystick(HIDPlugin* parent, quint32 line, struct hid_device_info *info)
     : HIDJsDevice(parent, line, info)
+    , m_eventFd(-1)
+    , m_wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , m_dropping(false)
 {
     init();
 }
 
+HIDLinuxJoystick::~HIDLinuxJoystick()
+{
+    closeInput();
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+}
+
 bool HIDLinuxJoystick::openDevice()
 {
     bool result = m_file.open(QIODevice::Unbuffered | QIODevice::ReadWrite);
@@ -57,6 +79,84 @@ bool HIDLinuxJoystick::openDevice()
     return result;
 }
 
+bool HIDLinuxJoystick::openEventDevice()
+{
+    /* The evdev node is a sibling of the joydev node in sysfs */
+    QString jsName = QFileInfo(m_file.fileName()).fileName();
+    QDir sysDir(QString("/sys/class/input/%1/device").arg(jsName));
+    QStringList nodes = sysDir.entryList(QStringList() << "event*", QDir::Dirs);
+    if (nodes.isEmpty())
+        return false;
+
+    /* The joydev mapping of the axes and buttons to its own numbering */
+    __u8 axesMap[ABS_CNT];
+    __u16 buttonsMap[KEY_MAX - BTN_MISC + 1];
+    if (ioctl(handle(), JSIOCGAXMAP, axesMap) < 0 ||
+        ioctl(handle(), JSIOCGBTNMAP, buttonsMap) < 0)
+    {
+        qWarning() << "Unable to get the mapping of" << m_file.fileName()
+                   << ":" << strerror(errno);
+        return false;
+    }
+
+    QString path = QString("/dev/input/%1").arg(nodes.first());
+    int fd = open(path.toUtf8().constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        qDebug() << "Unable to open" << path << ":" << strerror(errno)
+                 << "- reading" << m_file.fileName();
+        return false;
+    }
+
+    /* Stamp the events with the same clock as HIDDevice::monotonicTime() */
+    int clock = CLOCK_MONOTONIC;
+    if (ioctl(fd, EVIOCSCLOCKID, &clock) < 0)
+    {
+        qDebug() << "Unable to set the clock of" << path << ":" << strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    m_axisChannels.clear();
+    m_axisInfo.clear();
+    m_buttonChannels.clear();
+
+    for (int i = 0; i < m_axesNumber && i < ABS_CNT; i++)
+    {
+        struct input_absinfo info;
+        if (ioctl(fd, EVIOCGABS(axesMap[i]), &info) < 0)
+            continue;
+
+        m_axisChannels[axesMap[i]] = quint32(i);
+        m_axisInfo[axesMap[i]] = info;
+    }
+
+    /* Map button channels to start after axes */
+    for (int i = 0; i < m_buttonsNumber && i < KEY_MAX - BTN_MISC + 1; i++)
+        m_buttonChannels[buttonsMap[i]] = quint32(m_axesNumber + i);
+
+    qDebug() << "Reading" << m_file.fileName() << "through" << path;
+    m_eventFd = fd;
+
+    return true;
+}
+
+static uchar axisValue(const struct input_absinfo &info, int value)
+{
+    if (info.maximum <= info.minimum)
+        return 0;
+
+    /* Apply the dead zone around the center, like joydev does */
+    int center = (info.minimum + info.maximum) / 2;
+    if (info.flat > 0 && qAbs(value - center) <= info.flat)
+        value = center;
+
+    value = CLAMP(value, info.minimum, info.maximum);
+
+    return uchar(SCALE(double(value), double(info.minimum), double(info.maximum),
+                       double(0), double(UCHAR_MAX)));
+}
+
 void HIDLinuxJoystick::init()
 {
     if (openDevice() == false)
@@ -87,6 +187,13 @@ bool HIDLinuxJoystick::openInput()
 
     if (result == true)
     {
+        if (openEventDevice() == false)
+        {
+            /* Read the joydev node until it's drained */
+            int flags = fcntl(handle(), F_GETFL);
+            fcntl(handle(), F_SETFL, flags | O_NONBLOCK);
+        }
+
         m_running = true;
         start();
     }
@@ -94,83 +201,238 @@ bool HIDLinuxJoystick::openInput()
     return result;
 }
 
-bool HIDLinuxJoystick::readEvent()
+void HIDLinuxJoystick::closeInput()
 {
-    struct js_event ev;
-    int r;
+    if (isRunning() == true)
+    {
+        m_running = false;
+
+        /* Wake up the thread blocked in poll() */
+        quint64 wake = 1;
+        if (write(m_wakeFd, &wake, sizeof(wake)) < 0)
+            qWarning() << "Unable to wake up" << m_file.fileName() << ":" << strerror(errno);
+        wait();
+    }
+
+    HIDJsDevice::closeInput();
 
-    r = read(m_file.handle(), &ev, sizeof(struct js_event));
-    if (r > 0)
+    if (m_eventFd >= 0)
     {
-        quint32 ch;
-        uchar val;
+        close(m_eventFd);
+        m_eventFd = -1;
+    }
+    m_pendingAxes.clear();
+    m_dropping = false;
+}
 
-        /* Get the event type */
-        if ((ev.type & ~JS_EVENT_INIT) == JS_EVENT_BUTTON)
-        {
-            if (ev.value != 0)
-                val = UCHAR_MAX;
-            else
-                val = 0;
+bool HIDLinuxJoystick::readEvent()
+{
+    if (m_eventFd >= 0)
+        return readEvdevEvents();
+    else
+        return readJsEvents();
+}
 
-            /* Map button channels to start after axes */
-            ch = quint32(m_axesNumber + ev.number);
+bool HIDLinuxJoystick::readJsEvents()
+{
+    struct js_event events[KEventBatchSize];
+    bool result = false;
 
-            /* Generate and post an event */
-            emit valueChanged(UINT_MAX, m_line, ch, val);
+    forever
+    {
+        ssize_t r = read(handle(), events, sizeof(events));
+        if (r < 0 && (errno == EAGAIN || errno == EINTR))
+            break;
+        if (r <= 0)
+        {
+            /* This device seems to be dead */
+            return false;
         }
-        else if ((ev.type & ~JS_EVENT_INIT) == JS_EVENT_AXIS)
+
+        int count = int(r / sizeof(struct js_event));
+        for (int i = 0; i < count; i++)
         {
-            val = SCALE(double(ev.value), double(SHRT_MIN), double(SHRT_MAX),
-                        double(0), double(UCHAR_MAX));
-            ch = quint32(ev.number);
+            const struct js_event &ev = events[i];
 
-            qDebug() << "HID JS" << m_line << ch << val;
-            emit valueChanged(UINT_MAX, m_line, ch, val);
+            /* Get the event type */
+            if ((ev.type & ~JS_EVENT_INIT) == JS_EVENT_BUTTON)
+            {
+                /* Map button channels to start after axes */
+                quint32 ch = quint32(m_axesNumber + ev.number);
+                stampEvent(monotonicTime());
+                emit valueChanged(UINT_MAX, m_line, ch, ev.value != 0 ? UCHAR_MAX : 0);
+            }
+            else if ((ev.type & ~JS_EVENT_INIT) == JS_EVENT_AXIS)
+            {
+                m_pendingAxes[quint32(ev.number)] =
+                        uchar(SCALE(double(ev.value), double(SHRT_MIN), double(SHRT_MAX),
+                                    double(0), double(UCHAR_MAX)));
+            }
         }
-        else
+        result = true;
+
+        if (count < KEventBatchSize)
+            break;
+    }
+
+    /* joydev timestamps use another clock, so the read time is used */
+    flushAxes(monotonicTime());
+
+    return result;
+}
+
+bool HIDLinuxJoystick::readEvdevEvents()
+{
+    struct input_event events[KEventBatchSize];
+
+    forever
+    {
+        ssize_t r = read(m_eventFd, events, sizeof(events));
+        if (r < 0 && (errno == EAGAIN || errno == EINTR))
+            return true;
+        if (r <= 0)
         {
-            /* Unknown event type */
+            /* This device seems to be dead */
+            return false;
         }
 
-        return true;
+        int count = int(r / sizeof(struct input_event));
+        for (int i = 0; i < count; i++)
+        {
+            const struct input_event &ev = events[i];
+            qint64 time = qint64(ev.input_event_sec) * 1000000 + ev.input_event_usec;
+
+            if (m_dropping == true)
+            {
+                /* The events of the incomplete frame are unreliable: skip them
+                 * up to the next report, then start over from the current state */
+                if (ev.type == EV_SYN && ev.code == SYN_REPORT)
+                {
+                    m_dropping = false;
+                    emitInitialState();
+                }
+                continue;
+            }
+
+            if (ev.type == EV_ABS)
+            {
+                QHash<int, quint32>::const_iterator it = m_axisChannels.constFind(ev.code);
+                if (it != m_axisChannels.constEnd())
+                    m_pendingAxes[it.value()] = axisValue(m_axisInfo[ev.code], ev.value);
+            }
+            else if (ev.type == EV_KEY)
+            {
+                /* Every button change is emitted, autorepeat is not */
+                QHash<int, quint32>::const_iterator it = m_buttonChannels.constFind(ev.code);
+                if (it != m_buttonChannels.constEnd() && ev.value != 2)
+                {
+                    stampEvent(time);
+                    emit valueChanged(UINT_MAX, m_line, it.value(), ev.value != 0 ? UCHAR_MAX : 0);
+                }
+            }
+            else if (ev.type == EV_SYN && ev.code == SYN_REPORT)
+            {
+                flushAxes(time);
+            }
+            else if (ev.type == EV_SYN && ev.code == SYN_DROPPED)
+            {
+                /* The kernel buffer overflowed */
+                m_pendingAxes.clear();
+                m_dropping = true;
+            }
+        }
     }
-    else
+}
+
+void HIDLinuxJoystick::flushAxes(qint64 eventTime)
+{
+    if (m_pendingAxes.isEmpty())
+        return;
+
+    stampEvent(eventTime);
+
+    QHashIterator<quint32, uchar> it(m_pendingAxes);
+    while (it.hasNext())
     {
-        /* This device seems to be dead */
-        /*
-        e = new HIDInputEvent(this, 0, 0, 0, false);
-        QApplication::postEvent(parent(), e);
-        */
-        return false;
+        it.next();
+        emit valueChanged(UINT_MAX, m_line, it.key(), it.value());
+    }
+    m_pendingAxes.clear();
+}
+
+void HIDLinuxJoystick::emitInitialState()
+{
+    stampEvent(monotonicTime());
+
+    QHashIterator<int, quint32> ait(m_axisChannels);
+    while (ait.hasNext())
+    {
+        ait.next();
+        struct input_absinfo info;
+        if (ioctl(m_eventFd, EVIOCGABS(ait.key()), &info) < 0)
+            continue;
+        m_axisInfo[ait.key()] = info;
+        emit valueChanged(UINT_MAX, m_line, ait.value(), axisValue(info, info.value));
+    }
+
+    uchar keys[KEY_MAX / 8 + 1];
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(m_eventFd, EVIOCGKEY(sizeof(keys)), keys) < 0)
+        return;
+
+    QHashIterator<int, quint32> bit(m_buttonChannels);
+    while (bit.hasNext())
+    {
+        bit.next();
+        bool pressed = (keys[bit.key() / 8] >> (bit.key() % 8)) & 0x01;
+        emit valueChanged(UINT_MAX, m_line, bit.value(), pressed ? UCHAR_MAX : 0);
     }
 }
 
 void HIDLinuxJoystick::run()
 {
-    struct pollfd* fds = NULL;
-    fds = new struct pollfd[1];
-    memset(fds, 0, 1);
+    struct pollfd fds[2];
+    memset(fds, 0, sizeof(fds));
 
-    fds[0].fd = handle();
+    fds[0].fd = m_eventFd >= 0 ? m_eventFd : handle();
     fds[0].events = POLLIN;
+    fds[1].fd = m_wakeFd;
+    fds[1].events = POLLIN;
 
+    if (m_eventFd >= 0)
+        emitInitialState();
 
     while (m_running == true)
     {
-        int r = poll(fds, 1, KPollTimeout);
+        /* Block until there are events, or the input is closed */
+        int r = poll(fds, 2, -1);
 
-        if (r < 0 && errno != EINTR)
+        if (r < 0)
         {
             /* Print abnormal errors. EINTR may happen often. */
-            perror("poll");
+            if (errno != EINTR)
+                perror("poll");
+            continue;
         }
-        else if (r != 0)
+
+        if (fds[1].revents != 0)
         {
-            if (fds[0].revents != 0)
-                readEvent();
+            quint64 wake;
+            if (read(m_wakeFd, &wake, sizeof(wake)) < 0)
+                qDebug() << "Spurious wake up of" << m_file.fileName();
+            continue;
         }
-    }
-}
 
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+            qWarning() << m_file.fileName() << "has been disconnected";
+            break;
+        }
 
+        if (fds[0].revents & POLLIN)
+        {
+            if (readEvent() == false)
+                break;
+        }
+    }
+}
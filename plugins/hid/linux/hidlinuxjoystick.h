@@ -24,13 +24,25 @@
 #include <linux/input.h>
 #include <linux/types.h>
 
+#include <QHash>
+
 #include "hidjsdevice.h"
 
+/**
+ * Linux joysticks are read through their evdev node when it is accessible,
+ * which stamps every event with the monotonic clock and groups them in
+ * frames ended by SYN_REPORT. Otherwise the joydev node is read.
+ *
+ * The reading thread blocks in poll() until events arrive, then drains
+ * them all at once. Axis values are coalesced per frame: only the last
+ * value of each axis is emitted, while every button change is.
+ */
 class HIDLinuxJoystick: public HIDJsDevice
 {
     Q_OBJECT
 public:
     HIDLinuxJoystick(HIDPlugin* parent, quint32 line, struct hid_device_info *info);
+    ~HIDLinuxJoystick();
 
     /** @reimp */
     void init();
@@ -38,15 +50,55 @@ public:
     /** @reimp */
     bool openInput();
 
+    /** @reimp */
+    void closeInput();
+
     /** @reimp */
     bool readEvent();
 
 protected:
     bool openDevice();
 
+    /** Open the evdev node of the joystick and map its axes and
+     *  buttons to the same channels as the joydev node */
+    bool openEventDevice();
+
+    /** Read and emit all the pending joydev events */
+    bool readJsEvents();
+
+    /** Read all the pending evdev events, emitting complete frames */
+    bool readEvdevEvents();
+
+    /** Emit the coalesced axis values of the current frame */
+    void flushAxes(qint64 eventTime);
+
+    /** Emit the current state of the evdev axes and buttons, like
+     *  the joydev node does on open */
+    void emitInitialState();
+
 private:
     /** @reimp */
     void run();
+
+private:
+    /** evdev file descriptor, -1 when reading the joydev node */
+    int m_eventFd;
+
+    /** eventfd waking up the reading thread when closing the input */
+    int m_wakeFd;
+
+    /** evdev code -> channel */
+    QHash<int, quint32> m_axisChannels;
+    QHash<int, quint32> m_buttonChannels;
+
+    /** evdev axis code -> range */
+    QHash<int, struct input_absinfo> m_axisInfo;
+
+    /** channel -> value of the axes changed in the current frame */
+    QHash<quint32, uchar> m_pendingAxes;
+
+    /** True after a SYN_DROPPED, until the next SYN_REPORT */
+    bool m_dropping;
 };
 
 #endif // HIDLINUXJOYSTICK_H
@@ -0,0 +1,329 @@
+/*
+  Q Light Controller Plus
+  hid_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QFileInfo>
+#include <QDir>
+#include <QTest>
+
+#include <linux/uinput.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define protected public
+#define private public
+#include "hidlinuxjoystick.h"
+#undef private
+#undef protected
+
+#include "hid_test.h"
+#include "hidapi.h"
+
+#define TEST_DEVICE_NAME "QLC+ HID test joystick"
+
+/** Range of the virtual joystick axes */
+#define AXIS_MIN    0
+#define AXIS_MAX    1020
+
+/** Channels of the virtual joystick, as mapped by joydev */
+#define X_CHANNEL       0
+#define Y_CHANNEL       1
+#define TRIGGER_CHANNEL 2
+#define THUMB_CHANNEL   3
+
+static void setupAxis(int fd, int code)
+{
+    struct uinput_abs_setup abs;
+    memset(&abs, 0, sizeof(abs));
+    abs.code = code;
+    abs.absinfo.minimum = AXIS_MIN;
+    abs.absinfo.maximum = AXIS_MAX;
+    abs.absinfo.value = (AXIS_MIN + AXIS_MAX) / 2;
+    ioctl(fd, UI_ABS_SETUP, &abs);
+}
+
+/** Return the joydev node of the input device called $name, or an empty string */
+static QString findJoystick(const QString &name)
+{
+    QDir dir("/sys/class/input");
+    foreach (QString node, dir.entryList(QStringList() << "js*", QDir::Dirs | QDir::System))
+    {
+        QFile file(dir.absoluteFilePath(node + "/device/name"));
+        if (file.open(QIODevice::ReadOnly) == false)
+            continue;
+        if (QString(file.readAll()).trimmed() == name)
+            return QString("/dev/input/%1").arg(node);
+    }
+    return QString();
+}
+
+void HID_Test::init()
+{
+    m_uinput = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+    if (m_uinput < 0)
+        QSKIP("/dev/uinput is not accessible");
+
+    ioctl(m_uinput, UI_SET_EVBIT, EV_KEY);
+    ioctl(m_uinput, UI_SET_EVBIT, EV_ABS);
+    ioctl(m_uinput, UI_SET_EVBIT, EV_SYN);
+    ioctl(m_uinput, UI_SET_KEYBIT, BTN_TRIGGER);
+    ioctl(m_uinput, UI_SET_KEYBIT, BTN_THUMB);
+    ioctl(m_uinput, UI_SET_ABSBIT, ABS_X);
+    ioctl(m_uinput, UI_SET_ABSBIT, ABS_Y);
+    setupAxis(m_uinput, ABS_X);
+    setupAxis(m_uinput, ABS_Y);
+
+    struct uinput_setup setup;
+    memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;
+    setup.id.product = 0x0001;
+    strncpy(setup.name, TEST_DEVICE_NAME, UINPUT_MAX_NAME_SIZE - 1);
+
+    if (ioctl(m_uinput, UI_DEV_SETUP, &setup) < 0 ||
+        ioctl(m_uinput, UI_DEV_CREATE) < 0)
+    {
+        close(m_uinput);
+        m_uinput = -1;
+        QSKIP("Unable to create the virtual joystick");
+    }
+
+    QTRY_VERIFY_WITH_TIMEOUT(findJoystick(TEST_DEVICE_NAME).isEmpty() == false, 2000);
+    m_jsPath = findJoystick(TEST_DEVICE_NAME);
+
+    // wait for udev to set the permissions of the new nodes
+    QTRY_VERIFY_WITH_TIMEOUT(QFileInfo(m_jsPath).isReadable() == true, 2000);
+}
+
+void HID_Test::cleanup()
+{
+    if (m_uinput < 0)
+        return;
+
+    ioctl(m_uinput, UI_DEV_DESTROY);
+    close(m_uinput);
+    m_uinput = -1;
+}
+
+void HID_Test::sendEvent(int type, int code, int value)
+{
+    struct input_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    QVERIFY(write(m_uinput, &ev, sizeof(ev)) == sizeof(ev));
+}
+
+/** Fill $info with the data HIDPlugin gets from hid_enumerate() */
+static void deviceInfo(struct hid_device_info &info, QByteArray &path)
+{
+    static wchar_t manufacturer[] = L"QLC+";
+    static wchar_t product[] = L"test joystick";
+
+    memset(&info, 0, sizeof(info));
+    info.path = path.data();
+    info.manufacturer_string = manufacturer;
+    info.product_string = product;
+}
+
+void HID_Test::initialState()
+{
+    QByteArray path = m_jsPath.toUtf8();
+    struct hid_device_info info;
+    deviceInfo(info, path);
+
+    HIDLinuxJoystick js(NULL, 0, &info);
+    QVERIFY(js.hasInput() == true);
+    QCOMPARE(js.m_axesNumber, uchar(2));
+    QCOMPARE(js.m_buttonsNumber, uchar(2));
+
+    QSignalSpy spy(&js, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+    QVERIFY(js.openInput() == true);
+
+    // axes centered, buttons released
+    QTRY_COMPARE(spy.count(), 4);
+    QMap<quint32, uchar> values;
+    for (int i = 0; i < spy.count(); i++)
+        values[spy[i][2].toUInt()] = spy[i][3].value<uchar>();
+    QCOMPARE(values[X_CHANNEL], uchar(127));
+    QCOMPARE(values[Y_CHANNEL], uchar(127));
+    QCOMPARE(values[TRIGGER_CHANNEL], uchar(0));
+    QCOMPARE(values[THUMB_CHANNEL], uchar(0));
+
+    js.closeInput();
+}
+
+void HID_Test::axesCoalescing()
+{
+    QByteArray path = m_jsPath.toUtf8();
+    struct hid_device_info info;
+    deviceInfo(info, path);
+
+    HIDLinuxJoystick js(NULL, 0, &info);
+    QVERIFY(js.openInput() == true);
+    if (js.m_eventFd < 0)
+        QSKIP("The evdev node is not accessible");
+
+    // let the initial state through
+    QTest::qWait(100);
+    QSignalSpy spy(&js, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+
+    // several moves in the same frame: only the last one is emitted
+    sendEvent(EV_ABS, ABS_X, 100);
+    sendEvent(EV_ABS, ABS_X, 200);
+    sendEvent(EV_ABS, ABS_X, AXIS_MAX);
+    sendEvent(EV_ABS, ABS_Y, AXIS_MIN);
+    sendEvent(EV_SYN, SYN_REPORT, 0);
+
+    QTRY_COMPARE(spy.count(), 2);
+    QTest::qWait(50);
+    QCOMPARE(spy.count(), 2);
+
+    QMap<quint32, uchar> values;
+    for (int i = 0; i < spy.count(); i++)
+        values[spy[i][2].toUInt()] = spy[i][3].value<uchar>();
+    QCOMPARE(values[X_CHANNEL], uchar(255));
+    QCOMPARE(values[Y_CHANNEL], uchar(0));
+
+    js.closeInput();
+}
+
+void HID_Test::buttons()
+{
+    QByteArray path = m_jsPath.toUtf8();
+    struct hid_device_info info;
+    deviceInfo(info, path);
+
+    HIDLinuxJoystick js(NULL, 0, &info);
+    QVERIFY(js.openInput() == true);
+    QTest::qWait(100);
+    QSignalSpy spy(&js, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+
+    // a press and release in the same frame are both emitted
+    sendEvent(EV_KEY, BTN_THUMB, 1);
+    sendEvent(EV_SYN, SYN_REPORT, 0);
+    sendEvent(EV_KEY, BTN_THUMB, 0);
+    sendEvent(EV_SYN, SYN_REPORT, 0);
+
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy[0][2].toUInt(), quint32(THUMB_CHANNEL));
+    QCOMPARE(spy[0][3].value<uchar>(), uchar(255));
+    QCOMPARE(spy[1][2].toUInt(), quint32(THUMB_CHANNEL));
+    QCOMPARE(spy[1][3].value<uchar>(), uchar(0));
+
+    js.closeInput();
+}
+
+void HID_Test::latency()
+{
+    QByteArray path = m_jsPath.toUtf8();
+    struct hid_device_info info;
+    deviceInfo(info, path);
+
+    HIDLinuxJoystick js(NULL, 0, &info);
+    QVERIFY(js.openInput() == true);
+    QTest::qWait(100);
+    QSignalSpy spy(&js, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+
+    qint64 before = HIDDevice::monotonicTime();
+    sendEvent(EV_KEY, BTN_TRIGGER, 1);
+    sendEvent(EV_SYN, SYN_REPORT, 0);
+    QTRY_COMPARE(spy.count(), 1);
+
+    QVERIFY(js.lastEventTime() >= before);
+    QVERIFY(js.lastEventLatency() >= 0);
+
+    // the reading thread stops without waiting for events
+    QElapsedTimer timer;
+    timer.start();
+    js.closeInput();
+    QVERIFY(timer.elapsed() < 500);
+    QVERIFY(js.isRunning() == false);
+}
+
+void HID_Test::droppedEvents()
+{
+    QByteArray path = m_jsPath.toUtf8();
+    struct hid_device_info info;
+    deviceInfo(info, path);
+
+    /* Read the events by hand, without the reading thread */
+    HIDLinuxJoystick js(NULL, 0, &info);
+    QVERIFY(js.openDevice() == true);
+    if (js.openEventDevice() == false)
+        QSKIP("The evdev node is not accessible");
+
+    QSignalSpy spy(&js, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)));
+
+    /* The kernel never forwards a SYN_DROPPED written to uinput,
+     * so the events are fed through a pipe */
+    int eventFd = js.m_eventFd;
+    int fds[2];
+    QVERIFY(pipe(fds) == 0);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    js.m_eventFd = fds[0];
+
+    struct input_event events[7];
+    memset(events, 0, sizeof(events));
+    events[0].type = EV_ABS; events[0].code = ABS_X; events[0].value = AXIS_MAX;
+    events[1].type = EV_SYN; events[1].code = SYN_DROPPED;
+    events[2].type = EV_KEY; events[2].code = BTN_THUMB; events[2].value = 1;
+    events[3].type = EV_ABS; events[3].code = ABS_Y; events[3].value = AXIS_MIN;
+    events[4].type = EV_SYN; events[4].code = SYN_REPORT;
+    events[5].type = EV_KEY; events[5].code = BTN_TRIGGER; events[5].value = 1;
+    events[6].type = EV_SYN; events[6].code = SYN_REPORT;
+    QVERIFY(write(fds[1], events, sizeof(events)) == sizeof(events));
+
+    /* The pending axis and the events up to the next report are dropped.
+     * The re-sync finds no state on a pipe, so only the next frame is emitted */
+    QVERIFY(js.readEvdevEvents() == true);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy[0][2].toUInt(), quint32(TRIGGER_CHANNEL));
+    QCOMPARE(spy[0][3].value<uchar>(), uchar(255));
+    QVERIFY(js.m_dropping == false);
+
+    close(fds[0]);
+    close(fds[1]);
+    js.m_eventFd = eventFd;
+
+    /* Re-syncing on the real node emits its current state,
+     * including the changes of the dropped events */
+    sendEvent(EV_KEY, BTN_THUMB, 1);
+    sendEvent(EV_SYN, SYN_REPORT, 0);
+    spy.clear();
+    js.m_dropping = true;
+    QVERIFY(js.readEvdevEvents() == true);
+    QVERIFY(js.m_dropping == false);
+
+    QCOMPARE(spy.count(), 4);
+    QMap<quint32, uchar> values;
+    for (int i = 0; i < spy.count(); i++)
+        values[spy[i][2].toUInt()] = spy[i][3].value<uchar>();
+    QCOMPARE(values[X_CHANNEL], uchar(127));
+    QCOMPARE(values[Y_CHANNEL], uchar(127));
+    QCOMPARE(values[TRIGGER_CHANNEL], uchar(0));
+    QCOMPARE(values[THUMB_CHANNEL], uchar(255));
+
+    js.closeInput();
+}
+
+QTEST_MAIN(HID_Test)
@@ -0,0 +1,51 @@
+/*
+  Q Light Controller Plus
+  hid_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef HID_TEST_H
+#define HID_TEST_H
+
+#include <QObject>
+
+class HID_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void initialState();
+    void axesCoalescing();
+    void buttons();
+    void latency();
+    void droppedEvents();
+
+private:
+    /** Send an input event to the virtual device */
+    void sendEvent(int type, int code, int value);
+
+private:
+    /** uinput file descriptor of the virtual joystick */
+    int m_uinput;
+
+    /** joydev node of the virtual joystick */
+    QString m_jsPath;
+};
+
+#endif
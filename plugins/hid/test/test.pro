@@ -0,0 +1,29 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = hid_test
+
+QT      += core testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+INCLUDEPATH += ../../interfaces
+INCLUDEPATH += ..
+INCLUDEPATH += ../linux
+DEPENDPATH  += ..
+
+HEADERS += ../../interfaces/qlcioplugin.h
+SOURCES += ../../interfaces/qlcioplugin.cpp
+
+HEADERS += ../hiddevice.h \
+           ../hidjsdevice.h \
+           ../linux/hidlinuxjoystick.h
+
+SOURCES += ../hiddevice.cpp \
+           ../hidjsdevice.cpp \
+           ../linux/hidlinuxjoystick.cpp
+
+# Test sources
+HEADERS += hid_test.h
+SOURCES += hid_test.cpp
@@ -0,0 +1,2 @@
+#!/bin/sh
+./hid_test
@@ -56,6 +56,10 @@ void QLCIOPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArr
     Q_UNUSED(data)
 }
 
+void QLCIOPlugin::commitFrame()
+{
+}
+
 /*************************************************************************
  * Inputs
  *************************************************************************/
@@ -94,6 +98,13 @@ void QLCIOPlugin::sendFeedBack(quint32 universe, quint32 inputLine,
     Q_UNUSED(key)
 }
 
+void QLCIOPlugin::sendFeedBackFrame(quint32 universe, quint32 inputLine,
+                                    const QList<PluginFeedbackValue> &values)
+{
+    foreach (PluginFeedbackValue fb, values)
+        sendFeedBack(universe, inputLine, fb.channel, fb.value, fb.key);
+}
+
 /*************************************************************************
  * Configure
  *************************************************************************/
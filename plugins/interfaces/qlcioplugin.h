@@ -22,6 +22,7 @@
 #define QLCIOPLUGIN_H
 
 #include <QStringList>
+#include <QBitArray>
 #include <QtPlugin>
 #include <QVariant>
 #include <QObject>
@@ -87,6 +88,19 @@ typedef struct
 
 } PluginUniverseDescriptor;
 
+typedef struct
+{
+    /** The channel number where to send the feedback */
+    quint32 channel;
+
+    /** The actual value of the channel */
+    uchar value;
+
+    /** A string to identify a channel by name (ATM used only by OSC) */
+    QString key;
+
+} PluginFeedbackValue;
+
 class QLCIOPlugin : public QObject
 {
     Q_OBJECT
@@ -204,6 +218,17 @@ public:
      */
     virtual void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /**
+     * Called once all the universes of a frame have been written.
+     * Plugins able to synchronize several universes (e.g. with E1.31
+     * sync or ArtSync packets) send their synchronization packets here,
+     * so that receivers apply a whole frame at once.
+     *
+     * This is called by a universe thread. The default implementation
+     * does nothing.
+     */
+    virtual void commitFrame();
+
     /*************************************************************************
      * Inputs
      *************************************************************************/
@@ -265,6 +290,19 @@ public:
     virtual void sendFeedBack(quint32 universe, quint32 inputLine,
                               quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Send at once the feedback values collected during a MasterTimer tick,
+     * holding only the last value of each channel. The default implementation
+     * calls sendFeedBack() for each of them: plugins able to pack several
+     * values in a single transfer should reimplement it.
+     *
+     * @param universe the universe where to send the feedback
+     * @param inputLine the input line where to send the feedback
+     * @param values the feedback values, in ascending channel order
+     */
+    virtual void sendFeedBackFrame(quint32 universe, quint32 inputLine,
+                                   const QList<PluginFeedbackValue>& values);
+
 signals:
     /**
      * Tells that the value of a channel in an input line has changed and needs
@@ -283,6 +321,19 @@ signals:
      */
     void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value, const QString& key = 0);
 
+    /**
+     * Alternative to valueChanged() for plugins producing whole input
+     * frames at once. Input patches receive it in the emitting thread and
+     * keep a reference to $values, so a plugin must not modify its data
+     * after the emission, other than through QByteArray's copy-on-write.
+     *
+     * @param universe The universe ID, like in valueChanged()
+     * @param input The input line that produced the frame
+     * @param values The values of the whole input line
+     * @param dirty The channels changed since the previous frame
+     */
+    void frameChanged(quint32 universe, quint32 input, const QByteArray& values, const QBitArray& dirty);
+
     /*************************************************************************
      * Configure
      *************************************************************************/
@@ -81,6 +81,7 @@ void Loopback::closeOutput(quint32 output, quint32 universe)
 {
     m_outputMap.remove(output);
     m_channelData.remove(output);
+    m_dirtyChannels.remove(output);
     removeFromMap(output, universe, Output);
 }
 
@@ -187,22 +188,38 @@ void Loopback::writeUniverse(quint32 universe, quint32 output, const QByteArray
     if (!m_outputMap.contains(output))
         return;
 
+    if (!m_inputMap.contains(output))
+        return;
+
     QByteArray &chData = m_channelData[output];
+    QBitArray &dirty = m_dirtyChannels[output];
+    int size = qMin(data.size(), chData.size());
+    bool changed = false;
 
-    if (m_inputMap.contains(output))
-    {
-        quint32 inputUniverse = m_inputMap[output];
+    dirty.fill(false, chData.size());
 
-        for (int i = 0; i < data.size(); i++)
+    const char *prev = chData.constData();
+    const char *curr = data.constData();
+    for (int i = 0; i < size; i++)
+    {
+        if (prev[i] != curr[i])
         {
-            if (chData[i] != data[i])
-            {
-                chData[i] = data[i];
-                //qDebug() << "Data changed at" << i << QString::number(chData[i]) << QString::number(data[i]);
-                emit valueChanged(inputUniverse, output, i, chData[i]);
-            }
+            dirty.setBit(i);
+            changed = true;
         }
     }
+
+    if (changed == false)
+        return;
+
+    // the whole frame is handed over to the input patch, sharing the
+    // output buffer when possible instead of copying it
+    if (data.size() == chData.size())
+        chData = data;
+    else
+        chData.replace(0, size, curr, size);
+
+    emit frameChanged(m_inputMap[output], output, chData, dirty);
 }
 
 void Loopback::sendFeedBack(quint32 universe, quint32 input, quint32 channel, uchar value, const QString &)
@@ -20,6 +20,7 @@
 #ifndef LOOPBACK_H
 #define LOOPBACK_H
 
+#include <QBitArray>
 #include <QString>
 
 #include "qlcioplugin.h"
@@ -94,6 +95,9 @@ private:
     //! loopback line -> channel data
     QMap<quint32, QByteArray> m_channelData;
 
+    //! loopback line -> channels changed by the last frame
+    QMap<quint32, QBitArray> m_dirtyChannels;
+
     typedef QMap<quint32, quint32> TLineUniverseMap;
 
     //! output line -> universe
@@ -18,11 +18,15 @@
 */
 
 #include <alsa/asoundlib.h>
+#include <QMutexLocker>
 #include <QDebug>
 
 #include "alsamidioutputdevice.h"
 #include "midiprotocol.h"
 
+/** Time to wait for the bandwidth to send more queued messages, in ms */
+#define FLUSH_INTERVAL 5
+
 /****************************************************************************
  * AlsaMidiOutputDevice
  ****************************************************************************/
@@ -46,6 +50,11 @@ AlsaMidiOutputDevice::AlsaMidiOutputDevice(const QVariant& uid,
     m_sender_address = send_address;
     qDebug() << "[AlsaMidiOutputDevice] receiver client: " << m_receiver_address->client << ", port: " << m_receiver_address->port;
     qDebug() << "[AlsaMidiOutputDevice] sender client (QLC+): " << m_sender_address->client << ", port: " << m_sender_address->port;
+
+    m_clock.start();
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FLUSH_INTERVAL);
+    connect(&m_flushTimer, SIGNAL(timeout()), this, SLOT(slotFlush()));
 }
 
 AlsaMidiOutputDevice::~AlsaMidiOutputDevice()
@@ -60,7 +69,10 @@ AlsaMidiOutputDevice::~AlsaMidiOutputDevice()
 bool AlsaMidiOutputDevice::open()
 {
     qDebug() << Q_FUNC_INFO;
+
+    m_mutex.lock();
     m_open = true;
+    m_mutex.unlock();
 
     Q_ASSERT(m_sender_address != NULL);
     Q_ASSERT(m_receiver_address != NULL);
@@ -78,7 +90,11 @@ bool AlsaMidiOutputDevice::open()
 void AlsaMidiOutputDevice::close()
 {
     qDebug() << Q_FUNC_INFO;
+
+    m_mutex.lock();
     m_open = false;
+    m_queue.clear();
+    m_mutex.unlock();
 
     Q_ASSERT(m_sender_address != NULL);
     Q_ASSERT(m_receiver_address != NULL);
@@ -98,22 +114,19 @@ bool AlsaMidiOutputDevice::isOpen() const
 
 void AlsaMidiOutputDevice::writeChannel(ushort channel, uchar value)
 {
-    // m_universe contains scaled values (0-127), so we have to compare scaled value as well
-    // however, since writeUniverse scales the value again, we have to store unscaled value.
-    char scaled = DMX2MIDI(value);
-    if (channel < ushort(m_universe.size()) && m_universe[channel] != scaled)
-    {
-        QByteArray tmp(m_universe);
+    if (isOpen() == false)
+        return;
 
-        for (uchar ch = 0; ch < MAX_MIDI_DMX_CHANNELS && ch < tmp.size(); ++ch)
-        {
-           char midi = tmp[ch];
-           tmp[ch] = (char)MIDI2DMX(midi);
-        }
+    QMutexLocker locker(&m_mutex);
 
-        tmp[channel] = value;
-        writeUniverse(tmp);
-    }
+    // m_universe contains scaled values (0-127)
+    uchar scaled = DMX2MIDI(value);
+    if (channel >= ushort(m_universe.size()) || uchar(m_universe[channel]) == scaled)
+        return;
+
+    m_universe[channel] = scaled;
+    queueChannel(channel, scaled);
+    flush();
 }
 
 void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
@@ -121,12 +134,7 @@ void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
     if (isOpen() == false)
         return;
 
-    // Setup a common event structure for all values
-    snd_seq_event_t ev;
-    snd_seq_ev_clear(&ev);
-    snd_seq_ev_set_dest(&ev, m_receiver_address->client, m_receiver_address->port);
-    //snd_seq_ev_set_subs(&ev);
-    snd_seq_ev_set_direct(&ev);
+    QMutexLocker locker(&m_mutex);
 
     // Since MIDI devices can have only 128 real channels, we don't
     // attempt to write more than that.
@@ -134,49 +142,18 @@ void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
                             channel < universe.size(); channel++)
     {
         // Scale 0-255 to 0-127
-        char scaled = DMX2MIDI(universe[channel]);
-        bool invalidData = false;
+        uchar scaled = DMX2MIDI(uchar(universe[channel]));
 
         // Since MIDI is so slow, we only send values that are actually changed
-        if (m_universe[channel] == scaled)
+        if (uchar(m_universe[channel]) == scaled)
             continue;
 
         // Store the changed MIDI value
         m_universe[channel] = scaled;
-
-        if (mode() == Note)
-        {
-            qDebug() << "Send out NOTE";
-            // 0 is sent as a note off
-            // 1-127 is sent as note on
-            if (scaled == 0)
-                snd_seq_ev_set_noteoff(&ev, midiChannel(), channel, scaled);
-            else
-                snd_seq_ev_set_noteon(&ev, midiChannel(), channel, scaled);
-            snd_seq_event_output(m_alsa, &ev);
-        }
-        else if (mode() == ProgramChange)
-        {
-            qDebug() << "Send out Program Change";
-            snd_seq_ev_set_pgmchange(&ev, midiChannel(), channel);
-        }
-        else if (mode() == ControlChange)
-        {
-            qDebug() << "Send out CC. Channel: " << midiChannel() << ", CC: " << channel << ", val: " << scaled;
-
-            // Control change
-            snd_seq_ev_set_controller(&ev, midiChannel(), channel, scaled);
-        }
-        else
-            invalidData = true;
-
-        if (!invalidData)
-            if (snd_seq_event_output(m_alsa, &ev) < 0)
-                qDebug() << "snd_seq_event_output ERROR";
+        queueChannel(channel, scaled);
     }
 
-    // Make sure that all values go to the MIDI endpoint
-    snd_seq_drain_output(m_alsa);
+    flush();
 }
 
 void AlsaMidiOutputDevice::writeFeedback(uchar cmd, uchar data1, uchar data2)
@@ -184,84 +161,145 @@ void AlsaMidiOutputDevice::writeFeedback(uchar cmd, uchar data1, uchar data2)
     if (isOpen() == false)
         return;
 
-    // Setup a common event structure for all values
-    snd_seq_event_t ev;
-    snd_seq_ev_clear(&ev);
-    snd_seq_ev_set_dest(&ev, m_receiver_address->client, m_receiver_address->port);
-    //snd_seq_ev_set_subs(&ev);
-    snd_seq_ev_set_direct(&ev);
+    QMutexLocker locker(&m_mutex);
+    m_queue.enqueue(cmd, data1, data2);
+    flush();
+}
+
+void AlsaMidiOutputDevice::writeSysEx(QByteArray message)
+{
+    if(message.isEmpty())
+        return;
+
+    if (isOpen() == false)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    m_queue.enqueueSysEx(message);
+    flush();
+}
+
+void AlsaMidiOutputDevice::writeFeedbackFrame(const QList<MidiMessage>& messages)
+{
+    if (messages.isEmpty() || isOpen() == false)
+        return;
+
+    // Queue the whole frame first, so that it goes out with a single drain
+    QMutexLocker locker(&m_mutex);
+    foreach (MidiMessage msg, messages)
+        m_queue.enqueue(msg.cmd, msg.data1, msg.data2);
+    flush();
+}
+
+QString AlsaMidiOutputDevice::queueInfo()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QString info;
+    info += QString("<BR>%1: %2").arg(tr("Messages sent")).arg(m_queue.sentCount());
+    info += QString("<BR>%1: %2").arg(tr("Messages merged")).arg(m_queue.mergedCount());
+    info += QString("<BR>%1: %2").arg(tr("Messages dropped")).arg(m_queue.droppedCount());
 
-    uchar midiCmd = MIDI_CMD(cmd);
-    uchar midiCh = MIDI_CH(cmd);
+    return info;
+}
 
-    bool invalidCmd = false;
+void AlsaMidiOutputDevice::queueChannel(uchar channel, uchar value)
+{
+    uchar midiCh = uchar(midiChannel()) & 0x0F;
 
-    switch(midiCmd)
+    if (mode() == Note)
     {
-    case MIDI_NOTE_OFF:
-        snd_seq_ev_set_noteoff(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_NOTE_ON:
-        snd_seq_ev_set_noteon(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_CONTROL_CHANGE:
-        snd_seq_ev_set_controller(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_PROGRAM_CHANGE:
-        snd_seq_ev_set_pgmchange(&ev, midiCh, data1);
-        break;
-
-    case MIDI_NOTE_AFTERTOUCH:
-        snd_seq_ev_set_keypress(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_CHANNEL_AFTERTOUCH:
-        snd_seq_ev_set_chanpress(&ev, midiCh, data1);
-        break;
-
-    case MIDI_PITCH_WHEEL:
-        snd_seq_ev_set_pitchbend(&ev, midiCh, ((data1 & 0x7f) | ((data2 & 0x7f) << 7)) - 8192);
-        break;
-
-    default:
-        // What to do here ??
-        invalidCmd = true;
-        break;
+        // 0 is sent as a note off
+        // 1-127 is sent as note on
+        if (value == 0)
+            m_queue.enqueue(MIDI_NOTE_OFF | midiCh, channel, value);
+        else
+            m_queue.enqueue(MIDI_NOTE_ON | midiCh, channel, value);
     }
-
-    if (!invalidCmd)
+    else if (mode() == ProgramChange)
     {
-        if (snd_seq_event_output(m_alsa, &ev) < 0)
-            qDebug() << "snd_seq_event_output ERROR";
+        m_queue.enqueue(MIDI_PROGRAM_CHANGE | midiCh, channel, 0);
+    }
+    else if (mode() == ControlChange)
+    {
+        m_queue.enqueue(MIDI_CONTROL_CHANGE | midiCh, channel, value);
     }
-
-    // Make sure that all values go to the MIDI endpoint
-    snd_seq_drain_output(m_alsa);
 }
 
-
-void AlsaMidiOutputDevice::writeSysEx(QByteArray message)
+void AlsaMidiOutputDevice::flush()
 {
-    if(message.isEmpty())
-        return;
+    m_queue.setBandwidth(bandwidth());
 
-    if (isOpen() == false)
-        return;
+    QList<MidiMessage> batch = m_queue.take(m_clock.elapsed());
+
+    foreach (MidiMessage msg, batch)
+    {
+        snd_seq_event_t ev;
+        snd_seq_ev_clear(&ev);
+        snd_seq_ev_set_dest(&ev, m_receiver_address->client, m_receiver_address->port);
+        //snd_seq_ev_set_subs(&ev);
+        snd_seq_ev_set_direct(&ev);
+
+        uchar midiCh = MIDI_CH(msg.cmd);
+        bool invalidCmd = false;
+
+        switch (MIDI_CMD(msg.cmd))
+        {
+        case MIDI_NOTE_OFF:
+            snd_seq_ev_set_noteoff(&ev, midiCh, msg.data1, msg.data2);
+            break;
+
+        case MIDI_NOTE_ON:
+            snd_seq_ev_set_noteon(&ev, midiCh, msg.data1, msg.data2);
+            break;
 
-    snd_seq_event_t ev;
-    snd_seq_ev_clear(&ev);
-    snd_seq_ev_set_dest(&ev, m_receiver_address->client, m_receiver_address->port);
-    //snd_seq_ev_set_subs(&ev);
-    snd_seq_ev_set_direct(&ev);
+        case MIDI_CONTROL_CHANGE:
+            snd_seq_ev_set_controller(&ev, midiCh, msg.data1, msg.data2);
+            break;
 
-    snd_seq_ev_set_sysex (&ev, message.count(), message.data());
+        case MIDI_PROGRAM_CHANGE:
+            snd_seq_ev_set_pgmchange(&ev, midiCh, msg.data1);
+            break;
+
+        case MIDI_NOTE_AFTERTOUCH:
+            snd_seq_ev_set_keypress(&ev, midiCh, msg.data1, msg.data2);
+            break;
+
+        case MIDI_CHANNEL_AFTERTOUCH:
+            snd_seq_ev_set_chanpress(&ev, midiCh, msg.data1);
+            break;
+
+        case MIDI_PITCH_WHEEL:
+            snd_seq_ev_set_pitchbend(&ev, midiCh, ((msg.data1 & 0x7f) | ((msg.data2 & 0x7f) << 7)) - 8192);
+            break;
+
+        default:
+            if (msg.cmd == MIDI_SYSEX)
+                snd_seq_ev_set_sysex(&ev, msg.sysex.size(), msg.sysex.data());
+            else
+                invalidCmd = true;
+            break;
+        }
 
-    if (snd_seq_event_output(m_alsa, &ev) < 0)
-        qDebug() << "snd_seq_event_output ERROR";
+        if (!invalidCmd)
+        {
+            if (snd_seq_event_output(m_alsa, &ev) < 0)
+                qDebug() << "snd_seq_event_output ERROR";
+        }
+    }
 
     // Make sure that all values go to the MIDI endpoint
-    snd_seq_drain_output(m_alsa);
+    if (batch.isEmpty() == false)
+        snd_seq_drain_output(m_alsa);
+
+    // QTimer must be started from its own thread
+    if (m_queue.isEmpty() == false)
+        QMetaObject::invokeMethod(&m_flushTimer, "start", Qt::QueuedConnection);
+}
+
+void AlsaMidiOutputDevice::slotFlush()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_open == true)
+        flush();
 }
@@ -20,7 +20,12 @@
 #ifndef ALSAMIDIOUTPUTDEVICE_H
 #define ALSAMIDIOUTPUTDEVICE_H
 
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QMutex>
+
 #include "midioutputdevice.h"
+#include "midioutputqueue.h"
 
 struct _snd_seq;
 typedef _snd_seq snd_seq_t;
@@ -30,6 +35,8 @@ typedef snd_seq_addr snd_seq_addr_t;
 
 class AlsaMidiOutputDevice : public MidiOutputDevice
 {
+    Q_OBJECT
+
 public:
     AlsaMidiOutputDevice(const QVariant& uid, const QString& name,
                          const snd_seq_addr_t* recv_address, snd_seq_t* alsa,
@@ -45,12 +52,35 @@ public:
     void writeFeedback(uchar cmd, uchar data1, uchar data2);
     void writeSysEx(QByteArray message);
 
+    /** @reimp */
+    void writeFeedbackFrame(const QList<MidiMessage>& messages);
+
+    /** @reimp */
+    QString queueInfo();
+
+private:
+    /** Queue the message of a changed DMX channel, depending on the mode */
+    void queueChannel(uchar channel, uchar value);
+
+    /** Send the queued messages allowed by the bandwidth. If some
+     *  are left, schedule another flush. Called with m_mutex locked */
+    void flush();
+
+private slots:
+    void slotFlush();
+
 private:
     snd_seq_t* m_alsa;
     snd_seq_addr_t* m_receiver_address;
     snd_seq_addr_t* m_sender_address;
     bool m_open;
     QByteArray m_universe;
+
+    /** Messages are written from the universe and the UI threads */
+    QMutex m_mutex;
+    MidiOutputQueue m_queue;
+    QElapsedTimer m_clock;
+    QTimer m_flushTimer;
 };
 
 #endif
@@ -13,6 +13,7 @@ HEADERS     += ../../../../engine/src/qlcfile.h
 HEADERS += ../common/mididevice.h \
            ../common/midiinputdevice.h \
            ../common/midioutputdevice.h \
+           ../common/midioutputqueue.h \
            ../common/midiplugin.h \
            ../common/midiprotocol.h \
            ../common/miditemplate.h \
@@ -23,6 +24,7 @@ SOURCES += ../../../interfaces/qlcioplugin.cpp
 SOURCES += ../common/mididevice.cpp \
            ../common/midiinputdevice.cpp \
            ../common/midioutputdevice.cpp \
+           ../common/midioutputqueue.cpp \
            ../common/midiplugin.cpp \
            ../common/midiprotocol.cpp \
            ../common/miditemplate.cpp \
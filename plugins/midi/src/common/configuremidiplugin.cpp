@@ -25,6 +25,7 @@
 
 #include "configuremidiplugin.h"
 #include "midioutputdevice.h"
+#include "midioutputqueue.h"
 #include "midiinputdevice.h"
 #include "midienumerator.h"
 #include "midiprotocol.h"
@@ -36,6 +37,7 @@
 #define COL_CHANNEL     1
 #define COL_MODE        2
 #define COL_INITMESSAGE 3
+#define COL_BANDWIDTH   4
 
 ConfigureMidiPlugin::ConfigureMidiPlugin(MidiPlugin* plugin, QWidget* parent)
     : QDialog(parent)
@@ -118,6 +120,18 @@ void ConfigureMidiPlugin::slotInitMessageChanged(QString midiTemplateName)
     dev->setMidiTemplateName(midiTemplateName);
 }
 
+void ConfigureMidiPlugin::slotBandwidthValueChanged(int value)
+{
+    QWidget* widget = qobject_cast<QWidget*> (QObject::sender());
+    Q_ASSERT(widget != NULL);
+
+    QVariant var = widget->property(PROP_DEV);
+    Q_ASSERT(var.isValid() == true);
+
+    MidiOutputDevice* dev = (MidiOutputDevice*) var.toULongLong();
+    Q_ASSERT(dev != NULL);
+    dev->setBandwidth(value);
+}
 
 void ConfigureMidiPlugin::slotUpdateTree()
 {
@@ -144,6 +158,10 @@ void ConfigureMidiPlugin::slotUpdateTree()
         widget = createInitMessageWidget(dev->midiTemplateName());
         widget->setProperty(PROP_DEV, (qulonglong) dev);
         m_tree->setItemWidget(item, COL_INITMESSAGE, widget);
+
+        widget = createBandwidthWidget(dev->bandwidth());
+        widget->setProperty(PROP_DEV, (qulonglong) dev);
+        m_tree->setItemWidget(item, COL_BANDWIDTH, widget);
     }
 
     QTreeWidgetItem* inputs = new QTreeWidgetItem(m_tree);
@@ -235,3 +253,16 @@ QWidget* ConfigureMidiPlugin::createInitMessageWidget(QString midiTemplateName)
 
     return combo;
 }
+
+QWidget* ConfigureMidiPlugin::createBandwidthWidget(int bandwidth)
+{
+    QSpinBox* spin = new QSpinBox;
+    spin->setRange(0, 1000000);
+    spin->setSingleStep(MIDI_DIN_BANDWIDTH);
+    spin->setSuffix(QString(" B/s"));
+    spin->setSpecialValueText(tr("Unlimited"));
+    spin->setToolTip(tr("MIDI DIN ports transmit up to %1 bytes per second").arg(MIDI_DIN_BANDWIDTH));
+    spin->setValue(bandwidth);
+    connect(spin, SIGNAL(valueChanged(int)), this, SLOT(slotBandwidthValueChanged(int)));
+    return spin;
+}
@@ -17,16 +17,53 @@
   limitations under the License.
 */
 
+#include <QSettings>
 #include <QDebug>
+
 #include "midioutputdevice.h"
+#include "midioutputqueue.h"
+
+#define SETTINGS_BANDWIDTH "midiplugin/Output/%1/bandwidth"
 
 MidiOutputDevice::MidiOutputDevice(const QVariant& uid, const QString& name, QObject* parent)
     : MidiDevice(uid, name, Output, parent)
+    , m_bandwidth(MIDI_DIN_BANDWIDTH)
 {
     //qDebug() << Q_FUNC_INFO;
+    QSettings settings;
+    QVariant value = settings.value(QString(SETTINGS_BANDWIDTH).arg(name));
+    if (value.isValid() == true)
+        m_bandwidth = value.toInt();
 }
 
 MidiOutputDevice::~MidiOutputDevice()
 {
     //qDebug() << Q_FUNC_INFO;
+    QSettings settings;
+    settings.setValue(QString(SETTINGS_BANDWIDTH).arg(name()), m_bandwidth);
+}
+
+void MidiOutputDevice::writeFeedbackFrame(const QList<MidiMessage>& messages)
+{
+    foreach (MidiMessage msg, messages)
+        writeFeedback(msg.cmd, msg.data1, msg.data2);
+}
+
+/****************************************************************************
+ * Bandwidth
+ ****************************************************************************/
+
+void MidiOutputDevice::setBandwidth(int bytesPerSecond)
+{
+    m_bandwidth = qMax(0, bytesPerSecond);
+}
+
+int MidiOutputDevice::bandwidth() const
+{
+    return m_bandwidth;
+}
+
+QString MidiOutputDevice::queueInfo()
+{
+    return QString();
 }
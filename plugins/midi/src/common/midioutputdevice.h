@@ -21,6 +21,7 @@
 #define MIDIOUTPUTDEVICE_H
 
 #include "mididevice.h"
+#include "midioutputqueue.h"
 
 class MidiOutputDevice : public MidiDevice
 {
@@ -35,6 +36,25 @@ public:
     virtual void writeUniverse(const QByteArray& universe) = 0;
     virtual void writeFeedback(uchar cmd, uchar data1, uchar data2) = 0;
     virtual void writeSysEx(QByteArray message) = 0;
+
+    /** Write the feedback messages of a whole frame. The default
+     *  implementation calls writeFeedback() for each of them */
+    virtual void writeFeedbackFrame(const QList<MidiMessage>& messages);
+
+    /************************************************************************
+     * Bandwidth
+     ************************************************************************/
+public:
+    /** Set the maximum bandwidth of the port, in bytes per second.
+     *  0 means unlimited */
+    void setBandwidth(int bytesPerSecond);
+    int bandwidth() const;
+
+    /** HTML statistics of the output queue, if the backend has one */
+    virtual QString queueInfo();
+
+private:
+    int m_bandwidth;
 };
 
 #endif
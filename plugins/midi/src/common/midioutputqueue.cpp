@@ -0,0 +1,257 @@
+/*
+  Q Light Controller Plus
+  midioutputqueue.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "midioutputqueue.h"
+#include "midiprotocol.h"
+
+/** The budget is accounted in thousandths of bytes, to keep
+ *  the fractions of frequent updates */
+#define BUDGET_UNIT         1000
+
+/** Maximum time the budget can be saved up for, in milliseconds */
+#define MAX_BURST_TIME      50
+
+/** Maximum size of the system exclusive messages waiting to be sent */
+#define MAX_SYSEX_QUEUE     65536
+
+/** Status of a queued message dropped on overflow, skipped when taken */
+#define DROPPED_MESSAGE     0x00
+
+MidiOutputQueue::MidiOutputQueue()
+    : m_bandwidth(MIDI_DIN_BANDWIDTH)
+    , m_budget(0)
+    , m_lastTime(0)
+    , m_timeValid(false)
+    , m_runningStatus(0)
+    , m_taken(0)
+    , m_sysexSize(0)
+    , m_sent(0)
+    , m_merged(0)
+    , m_dropped(0)
+{
+}
+
+void MidiOutputQueue::setBandwidth(int bytesPerSecond)
+{
+    m_bandwidth = qMax(0, bytesPerSecond);
+}
+
+int MidiOutputQueue::bandwidth() const
+{
+    return m_bandwidth;
+}
+
+quint32 MidiOutputQueue::messageKey(uchar cmd, uchar data1)
+{
+    uchar type = MIDI_CMD(cmd);
+
+    switch (type)
+    {
+        case MIDI_NOTE_OFF:
+            // Note Off and Note On address the same note
+            type = MIDI_NOTE_ON;
+            break;
+        case MIDI_NOTE_ON:
+        case MIDI_NOTE_AFTERTOUCH:
+        case MIDI_CONTROL_CHANGE:
+            break;
+        case MIDI_PROGRAM_CHANGE:
+        case MIDI_CHANNEL_AFTERTOUCH:
+        case MIDI_PITCH_WHEEL:
+            // one value per MIDI channel
+            data1 = 0;
+            break;
+        default:
+            return (quint32(cmd) << 8) | data1;
+    }
+
+    return (quint32(type | MIDI_CH(cmd)) << 8) | data1;
+}
+
+void MidiOutputQueue::enqueue(uchar cmd, uchar data1, uchar data2)
+{
+    quint32 key = messageKey(cmd, data1);
+    QHash<quint32, quint64>::const_iterator it = m_latest.constFind(key);
+    if (it != m_latest.constEnd())
+    {
+        // the pending value is superseded and keeps its place in the queue,
+        // unless a message with another status (e.g. Note Off after Note On)
+        // is queued for the same note in between
+        MidiMessage &pending = m_queue[int(it.value() - m_taken)];
+        if (pending.cmd == cmd)
+        {
+            pending.data1 = data1;
+            pending.data2 = data2;
+            m_merged++;
+            return;
+        }
+    }
+
+    MidiMessage msg;
+    msg.cmd = cmd;
+    msg.data1 = data1;
+    msg.data2 = data2;
+
+    m_latest[key] = m_taken + m_queue.count();
+    m_queue.append(msg);
+}
+
+void MidiOutputQueue::enqueueSysEx(const QByteArray &message)
+{
+    // drop the oldest system exclusive messages. They keep their place
+    // in the queue, so that the positions in m_latest stay valid
+    for (int i = 0; i < m_queue.count() && m_sysexSize + message.size() > MAX_SYSEX_QUEUE; i++)
+    {
+        MidiMessage &pending = m_queue[i];
+        if (pending.cmd != MIDI_SYSEX)
+            continue;
+
+        m_sysexSize -= pending.sysex.size();
+        pending.cmd = DROPPED_MESSAGE;
+        pending.sysex.clear();
+        m_dropped++;
+    }
+
+    // channel messages queued before are not merged across it
+    m_latest.clear();
+
+    MidiMessage msg;
+    msg.cmd = MIDI_SYSEX;
+    msg.data1 = 0;
+    msg.data2 = 0;
+    msg.sysex = message;
+
+    m_queue.append(msg);
+    m_sysexSize += message.size();
+}
+
+QList<MidiMessage> MidiOutputQueue::take(qint64 now)
+{
+    QList<MidiMessage> batch;
+    bool unlimited = (m_bandwidth == 0);
+
+    if (m_timeValid == false || now < m_lastTime)
+    {
+        m_budget = qint64(m_bandwidth) * MAX_BURST_TIME;
+        m_timeValid = true;
+    }
+    else
+    {
+        m_budget += (now - m_lastTime) * m_bandwidth;
+        m_budget = qMin(m_budget, qint64(m_bandwidth) * MAX_BURST_TIME);
+    }
+    m_lastTime = now;
+
+    while (m_queue.isEmpty() == false && (unlimited || m_budget > 0))
+    {
+        MidiMessage msg = m_queue.takeFirst();
+
+        if (msg.cmd == DROPPED_MESSAGE)
+        {
+            m_taken++;
+            continue;
+        }
+
+        if (msg.cmd == MIDI_SYSEX)
+        {
+            m_sysexSize -= msg.sysex.size();
+        }
+        else
+        {
+            quint32 key = messageKey(msg.cmd, msg.data1);
+            if (m_latest.value(key) == m_taken)
+                m_latest.remove(key);
+        }
+        m_taken++;
+
+        m_budget -= messageSize(msg, m_runningStatus) * BUDGET_UNIT;
+        // system exclusive messages cancel running status
+        m_runningStatus = (msg.cmd == MIDI_SYSEX) ? 0 : msg.cmd;
+        batch.append(msg);
+    }
+
+    if (unlimited)
+        m_budget = 0;
+
+    m_sent += batch.count();
+
+    return batch;
+}
+
+bool MidiOutputQueue::isEmpty() const
+{
+    foreach (MidiMessage msg, m_queue)
+    {
+        if (msg.cmd != DROPPED_MESSAGE)
+            return false;
+    }
+
+    return true;
+}
+
+void MidiOutputQueue::clear()
+{
+    foreach (MidiMessage msg, m_queue)
+    {
+        if (msg.cmd != DROPPED_MESSAGE)
+            m_dropped++;
+    }
+
+    m_taken += m_queue.count();
+    m_queue.clear();
+    m_latest.clear();
+    m_sysexSize = 0;
+    m_runningStatus = 0;
+    m_timeValid = false;
+}
+
+int MidiOutputQueue::messageSize(const MidiMessage &msg, uchar runningStatus)
+{
+    if (msg.cmd == MIDI_SYSEX)
+        return msg.sysex.size();
+
+    int size = 3;
+    uchar type = MIDI_CMD(msg.cmd);
+    if (type == MIDI_PROGRAM_CHANGE || type == MIDI_CHANNEL_AFTERTOUCH)
+        size = 2;
+
+    if (msg.cmd == runningStatus)
+        size--;
+
+    return size;
+}
+
+/*********************************************************************
+ * Statistics
+ *********************************************************************/
+
+quint64 MidiOutputQueue::sentCount() const
+{
+    return m_sent;
+}
+
+quint64 MidiOutputQueue::mergedCount() const
+{
+    return m_merged;
+}
+
+quint64 MidiOutputQueue::droppedCount() const
+{
+    return m_dropped;
+}
@@ -0,0 +1,128 @@
+/*
+  Q Light Controller Plus
+  midioutputqueue.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef MIDIOUTPUTQUEUE_H
+#define MIDIOUTPUTQUEUE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+
+/** The bandwidth of a MIDI DIN port: 31250 baud, 10 bits per byte */
+#define MIDI_DIN_BANDWIDTH  3125
+
+typedef struct
+{
+    uchar cmd;
+    uchar data1;
+    uchar data2;
+    /** The whole message when cmd is MIDI_SYSEX */
+    QByteArray sysex;
+} MidiMessage;
+
+/**
+ * Queue of the messages waiting to be sent to a MIDI output.
+ *
+ * Messages are released in the order they have been queued, within the
+ * port bandwidth. A channel message with the same status byte and the
+ * same controller or note as the latest pending message addressing it
+ * replaces its value in place: only the latest value is sent.
+ *
+ * The queue is not thread safe: the output device serializes the calls.
+ */
+class MidiOutputQueue
+{
+public:
+    MidiOutputQueue();
+
+    /** Set the bandwidth in bytes per second. 0 means unlimited */
+    void setBandwidth(int bytesPerSecond);
+    int bandwidth() const;
+
+    /** Queue a channel message, replacing the value of the latest pending
+     *  message if it has the same status and addresses the same controller,
+     *  note or channel parameter */
+    void enqueue(uchar cmd, uchar data1, uchar data2);
+
+    /** Queue a system exclusive message. They are never merged */
+    void enqueueSysEx(const QByteArray& message);
+
+    /**
+     * Take the messages that can be sent at $now within the bandwidth,
+     * in the order they have been queued.
+     *
+     * @param now A monotonic time, in milliseconds
+     */
+    QList<MidiMessage> take(qint64 now);
+
+    bool isEmpty() const;
+
+    /** Discard all the pending messages */
+    void clear();
+
+    /** The number of bytes a message takes on the wire, without
+     *  the status byte if $runningStatus is the same */
+    static int messageSize(const MidiMessage& msg, uchar runningStatus);
+
+    /*********************************************************************
+     * Statistics
+     *********************************************************************/
+public:
+    /** Number of messages sent */
+    quint64 sentCount() const;
+
+    /** Number of messages superseded by a newer value before being sent */
+    quint64 mergedCount() const;
+
+    /** Number of messages discarded because of a queue overflow or close */
+    quint64 droppedCount() const;
+
+private:
+    /** The key identifying what a channel message addresses */
+    static quint32 messageKey(uchar cmd, uchar data1);
+
+private:
+    int m_bandwidth;
+
+    /** Bytes that can be sent right now. May be negative after
+     *  a message bigger than the available budget */
+    qint64 m_budget;
+    qint64 m_lastTime;
+    bool m_timeValid;
+
+    /** The last status byte sent, to account for running status */
+    uchar m_runningStatus;
+
+    /** Pending messages, in queue order */
+    QList<MidiMessage> m_queue;
+    /** Number of messages ever taken from the head of m_queue */
+    quint64 m_taken;
+    /** Key -> absolute position (m_taken based) of the latest
+     *  pending channel message addressing it */
+    QHash<quint32, quint64> m_latest;
+
+    /** Total size of the pending system exclusive messages */
+    int m_sysexSize;
+
+    quint64 m_sent;
+    quint64 m_merged;
+    quint64 m_dropped;
+};
+
+#endif
@@ -164,6 +164,7 @@ QString MidiPlugin::outputInfo(quint32 output)
         else
             status = tr("Not Open");
         str += QString("%1: %2").arg(tr("Status")).arg(status);
+        str += dev->queueInfo();
         str += QString("</P>");
     }
     else
@@ -306,6 +307,27 @@ void MidiPlugin::sendFeedBack(quint32 universe, quint32 output, quint32 channel,
     }
 }
 
+void MidiPlugin::sendFeedBackFrame(quint32 universe, quint32 output,
+                                   const QList<PluginFeedbackValue>& values)
+{
+    Q_UNUSED(universe)
+
+    MidiOutputDevice* dev = outputDevice(output);
+    if (dev == NULL)
+        return;
+
+    QList<MidiMessage> messages;
+    foreach (PluginFeedbackValue fb, values)
+    {
+        MidiMessage msg;
+        if (QLCMIDIProtocol::feedbackToMidi(fb.channel, fb.value, dev->midiChannel(), dev->sendNoteOff(),
+                                            &msg.cmd, &msg.data1, &msg.data2) == true)
+            messages.append(msg);
+    }
+
+    dev->writeFeedbackFrame(messages);
+}
+
 void MidiPlugin::sendSysEx(quint32 output, const QByteArray &data)
 {
     qDebug() << "sendSysEx data: " << data;
@@ -114,6 +114,9 @@ public:
     /** @reimp */
     void sendFeedBack(quint32 universe, quint32 output, quint32 channel, uchar value, const QString& key);
 
+    /** @reimp */
+    void sendFeedBackFrame(quint32 universe, quint32 output, const QList<PluginFeedbackValue>& values);
+
     void sendSysEx(quint32 output, const QByteArray &data);
 
 private:
@@ -199,6 +199,41 @@ void CoreMidiOutputDevice::writeFeedback(uchar cmd, uchar data1, uchar data2)
         qWarning() << Q_FUNC_INFO << "Unable to send MIDI data to" << name();
 }
 
+void CoreMidiOutputDevice::writeFeedbackFrame(const QList<MidiMessage>& messages)
+{
+    if (messages.isEmpty() || isOpen() == false)
+        return;
+
+    Byte buffer[512]; // Should be enough for 128 messages
+    MIDIPacketList* list = (MIDIPacketList*) buffer;
+    MIDIPacket* packet = MIDIPacketListInit(list);
+
+    foreach (MidiMessage msg, messages)
+    {
+        Byte message[3];
+        message[0] = msg.cmd;
+        message[1] = msg.data1;
+        message[2] = msg.data2;
+
+        /* Add the MIDI command to the packet list */
+        MIDIPacket* next = MIDIPacketListAdd(list, sizeof(buffer), packet, 0, sizeof(message), message);
+        if (next == 0)
+        {
+            /* The list is full: send it and start a new one */
+            if (MIDISend(m_outPort, m_destination, list) != 0)
+                qWarning() << Q_FUNC_INFO << "Unable to send MIDI data to" << name();
+            packet = MIDIPacketListInit(list);
+            next = MIDIPacketListAdd(list, sizeof(buffer), packet, 0, sizeof(message), message);
+        }
+        packet = next;
+    }
+
+    /* Send the MIDI packet list */
+    OSStatus s = MIDISend(m_outPort, m_destination, list);
+    if (s != 0)
+        qWarning() << Q_FUNC_INFO << "Unable to send MIDI data to" << name();
+}
+
 void CoreMidiOutputDevice::writeSysEx(QByteArray message)
 {
     if(message.isEmpty())
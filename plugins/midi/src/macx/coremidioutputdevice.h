@@ -42,6 +42,9 @@ public:
     void writeFeedback(uchar cmd, uchar data1, uchar data2);
     void writeSysEx(QByteArray message);
 
+    /** @reimp */
+    void writeFeedbackFrame(const QList<MidiMessage>& messages);
+
 private:
     MIDIClientRef m_client;
     MIDIPortRef m_outPort;
@@ -21,6 +21,7 @@
 
 #define private public
 #include "midi_test.h"
+#include "midioutputqueue.h"
 #include "midiprotocol.h"
 
 #undef private
@@ -45,4 +46,166 @@ void Midi_Test::midiToInput()
     QCOMPARE(value, uchar(255U));
 }
 
+void Midi_Test::outputQueueMerge()
+{
+    MidiOutputQueue queue;
+    queue.setBandwidth(0);
+
+    queue.enqueue(MIDI_CONTROL_CHANGE | 2, 7, 10);
+    queue.enqueue(MIDI_CONTROL_CHANGE | 2, 8, 5);
+    queue.enqueue(MIDI_CONTROL_CHANGE | 2, 7, 20);
+    // same controller on another MIDI channel
+    queue.enqueue(MIDI_CONTROL_CHANGE | 3, 7, 30);
+    // Note On and Note Off have different status bytes
+    queue.enqueue(MIDI_NOTE_ON | 2, 60, 100);
+    queue.enqueue(MIDI_NOTE_OFF | 2, 60, 0);
+
+    QList<MidiMessage> batch = queue.take(0);
+    QCOMPARE(batch.count(), 5);
+    QCOMPARE(batch.at(0).cmd, uchar(MIDI_CONTROL_CHANGE | 2));
+    QCOMPARE(batch.at(0).data1, uchar(7));
+    QCOMPARE(batch.at(0).data2, uchar(20));
+    QCOMPARE(batch.at(1).data1, uchar(8));
+    QCOMPARE(batch.at(2).cmd, uchar(MIDI_CONTROL_CHANGE | 3));
+    QCOMPARE(batch.at(3).cmd, uchar(MIDI_NOTE_ON | 2));
+    QCOMPARE(batch.at(4).cmd, uchar(MIDI_NOTE_OFF | 2));
+
+    QVERIFY(queue.isEmpty() == true);
+    QCOMPARE(queue.sentCount(), quint64(5));
+    QCOMPARE(queue.mergedCount(), quint64(1));
+    QCOMPARE(queue.droppedCount(), quint64(0));
+
+    // a value is not merged across another status for the same note
+    queue.enqueue(MIDI_NOTE_ON, 62, 100);
+    queue.enqueue(MIDI_NOTE_OFF, 62, 0);
+    queue.enqueue(MIDI_NOTE_ON, 62, 90);
+    queue.enqueue(MIDI_NOTE_ON, 62, 80);
+    batch = queue.take(1);
+    QCOMPARE(batch.count(), 3);
+    QCOMPARE(batch.at(0).cmd, uchar(MIDI_NOTE_ON));
+    QCOMPARE(batch.at(0).data2, uchar(100));
+    QCOMPARE(batch.at(1).cmd, uchar(MIDI_NOTE_OFF));
+    QCOMPARE(batch.at(2).cmd, uchar(MIDI_NOTE_ON));
+    QCOMPARE(batch.at(2).data2, uchar(80));
+    QCOMPARE(queue.mergedCount(), quint64(2));
+
+    // a taken message is not merged anymore
+    queue.enqueue(MIDI_NOTE_ON, 62, 70);
+    batch = queue.take(2);
+    QCOMPARE(batch.count(), 1);
+    QCOMPARE(batch.at(0).data2, uchar(70));
+
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 1);
+    queue.enqueue(MIDI_PITCH_WHEEL, 0, 64);
+    queue.clear();
+    QVERIFY(queue.isEmpty() == true);
+    QCOMPARE(queue.droppedCount(), quint64(2));
+
+    // merging still works after a clear
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 1);
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 2);
+    batch = queue.take(3);
+    QCOMPARE(batch.count(), 1);
+    QCOMPARE(batch.at(0).data2, uchar(2));
+}
+
+void Midi_Test::outputQueueBandwidth()
+{
+    MidiOutputQueue queue;
+    QCOMPARE(queue.bandwidth(), MIDI_DIN_BANDWIDTH);
+
+    for (uchar cc = 0; cc < 100; cc++)
+        queue.enqueue(MIDI_CONTROL_CHANGE, cc, 127);
+
+    // 50ms of DIN bandwidth: 156 bytes, 3 for the first message
+    // then 2 for each following one with running status.
+    // The last message overdraws the budget
+    QList<MidiMessage> batch = queue.take(0);
+    QCOMPARE(batch.count(), 78);
+    QVERIFY(queue.isEmpty() == false);
+
+    // nothing left of the budget
+    batch = queue.take(0);
+    QCOMPARE(batch.count(), 0);
+
+    // 1ms later, 3 more bytes minus the overdraft
+    batch = queue.take(1);
+    QCOMPARE(batch.count(), 2);
+
+    // a late update is merged into the pending message
+    queue.enqueue(MIDI_CONTROL_CHANGE, 99, 0);
+    QCOMPARE(queue.mergedCount(), quint64(1));
+
+    batch = queue.take(1000);
+    QCOMPARE(batch.count(), 20);
+    QCOMPARE(batch.last().data1, uchar(99));
+    QCOMPARE(batch.last().data2, uchar(0));
+    QVERIFY(queue.isEmpty() == true);
+    QCOMPARE(queue.sentCount(), quint64(100));
+}
+
+void Midi_Test::outputQueueOrder()
+{
+    MidiOutputQueue queue;
+    queue.setBandwidth(0);
+
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 10);
+    queue.enqueue(MIDI_NOTE_ON, 60, 100);
+    queue.enqueue(MIDI_CONTROL_CHANGE, 2, 20);
+    queue.enqueue(MIDI_NOTE_ON, 61, 100);
+
+    // messages are never regrouped by status
+    QList<MidiMessage> batch = queue.take(0);
+    QCOMPARE(batch.count(), 4);
+    QCOMPARE(batch.at(0).cmd, uchar(MIDI_CONTROL_CHANGE));
+    QCOMPARE(batch.at(1).cmd, uchar(MIDI_NOTE_ON));
+    QCOMPARE(batch.at(2).cmd, uchar(MIDI_CONTROL_CHANGE));
+    QCOMPARE(batch.at(3).cmd, uchar(MIDI_NOTE_ON));
+    QCOMPARE(batch.at(3).data1, uchar(61));
+
+    MidiMessage msg = batch.at(0);
+    QCOMPARE(MidiOutputQueue::messageSize(msg, 0), 3);
+    QCOMPARE(MidiOutputQueue::messageSize(msg, MIDI_CONTROL_CHANGE), 2);
+    msg.cmd = MIDI_PROGRAM_CHANGE;
+    QCOMPARE(MidiOutputQueue::messageSize(msg, 0), 2);
+}
+
+void Midi_Test::outputQueueSysEx()
+{
+    MidiOutputQueue queue;
+    queue.setBandwidth(0);
+
+    QByteArray sysex;
+    sysex.append(char(0xF0)).append(char(0x7E)).append(char(0x7F)).append(char(0xF7));
+
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 10);
+    queue.enqueue(MIDI_CONTROL_CHANGE, 2, 10);
+    QCOMPARE(queue.take(0).count(), 2);
+
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 20);
+    queue.enqueueSysEx(sysex);
+    queue.enqueueSysEx(sysex);
+    queue.enqueue(MIDI_CONTROL_CHANGE, 1, 30);
+
+    // never merged, and kept in queue order. The channel message
+    // after them is not merged into the one before either
+    QList<MidiMessage> batch = queue.take(1);
+    QCOMPARE(batch.count(), 4);
+    QCOMPARE(batch.at(0).cmd, uchar(MIDI_CONTROL_CHANGE));
+    QCOMPARE(batch.at(1).cmd, uchar(MIDI_SYSEX));
+    QCOMPARE(batch.at(1).sysex, sysex);
+    QCOMPARE(batch.at(2).cmd, uchar(MIDI_SYSEX));
+    QCOMPARE(batch.at(3).cmd, uchar(MIDI_CONTROL_CHANGE));
+    QCOMPARE(queue.mergedCount(), quint64(0));
+
+    // overflow drops the oldest messages
+    QByteArray big(40000, char(0));
+    queue.enqueueSysEx(big);
+    queue.enqueueSysEx(big);
+    QCOMPARE(queue.droppedCount(), quint64(1));
+    batch = queue.take(2);
+    QCOMPARE(batch.count(), 1);
+    QVERIFY(queue.isEmpty() == true);
+}
+
 QTEST_MAIN(Midi_Test)
@@ -28,6 +28,11 @@ class Midi_Test : public QObject
 
 private slots:
     void midiToInput();
+
+    void outputQueueMerge();
+    void outputQueueBandwidth();
+    void outputQueueOrder();
+    void outputQueueSysEx();
 };
 
 #endif
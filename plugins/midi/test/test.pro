@@ -14,5 +14,5 @@ INCLUDEPATH += ../src/common
 DEPENDPATH  += ../src
 
 # Test sources
-HEADERS += midi_test.h ../../interfaces/qlcioplugin.h ../src/common/midiprotocol.h
-SOURCES += midi_test.cpp  ../src/common/midiprotocol.cpp ../../interfaces/qlcioplugin.cpp
+HEADERS += midi_test.h ../../interfaces/qlcioplugin.h ../src/common/midiprotocol.h ../src/common/midioutputqueue.h
+SOURCES += midi_test.cpp  ../src/common/midiprotocol.cpp ../src/common/midioutputqueue.cpp ../../interfaces/qlcioplugin.cpp
@@ -20,6 +20,7 @@
 #include <QTreeWidgetItem>
 #include <QMessageBox>
 #include <QComboBox>
+#include <QCheckBox>
 #include <QLineEdit>
 #include <QSpinBox>
 #include <QLabel>
@@ -33,6 +34,7 @@
 #define KMapColumnInputPort     2
 #define KMapColumnOutputAddress 3
 #define KMapColumnOutputPort    4
+#define KMapColumnBundle        5
 
 #define PROP_UNIVERSE (Qt::UserRole + 0)
 #define PROP_LINE (Qt::UserRole + 1)
@@ -129,6 +131,11 @@ void ConfigureOSC::fillMappingTree()
                 outSpin->setRange(1, 65535);
                 outSpin->setValue(info->feedbackPort);
                 m_uniMapTree->setItemWidget(item, KMapColumnOutputPort, outSpin);
+
+                QCheckBox *bundleCheck = new QCheckBox(this);
+                bundleCheck->setChecked(info->feedbackBundle);
+                bundleCheck->setToolTip(tr("Send the feedback values of a frame in OSC bundles"));
+                m_uniMapTree->setItemWidget(item, KMapColumnBundle, bundleCheck);
             }
             if (info->type & OSCController::Output)
             {
@@ -221,6 +228,10 @@ void ConfigureOSC::accept()
                 else
                     m_plugin->setParameter(universe, line, cap, OSC_OUTPUTPORT, outSpin->value());
             }
+
+            QCheckBox *bundleCheck = qobject_cast<QCheckBox*>(m_uniMapTree->itemWidget(item, KMapColumnBundle));
+            if (bundleCheck != NULL)
+                m_plugin->setParameter(universe, line, QLCIOPlugin::Output, OSC_FEEDBACKBUNDLE, bundleCheck->isChecked());
         }
     }
 
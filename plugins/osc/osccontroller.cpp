@@ -23,6 +23,11 @@
 #include <QByteArray>
 #include <QDebug>
 
+/** '#bundle' string and time tag */
+#define OSC_BUNDLE_HEADER_SIZE  16
+/** Keep the feedback bundles within a typical Ethernet MTU */
+#define OSC_MAX_BUNDLE_SIZE     1400
+
 OSCController::OSCController(QString ipaddr, Type type, quint32 line, QObject *parent)
     : QObject(parent)
     , m_ipAddr(ipaddr)
@@ -71,6 +76,7 @@ void OSCController::addUniverse(quint32 universe, OSCController::Type type)
             info.outputAddress = QHostAddress::Null;
         }
         info.feedbackPort = 9000 + universe;
+        info.feedbackBundle = false;
         info.outputPort = 9000 + universe;
         info.type = type;
         m_universeMap[universe] = info;
@@ -158,6 +164,17 @@ bool OSCController::setFeedbackPort(quint32 universe, quint16 port)
     return port == 9000 + universe;
 }
 
+bool OSCController::setFeedbackBundle(quint32 universe, bool enable)
+{
+    if (m_universeMap.contains(universe) == false)
+        return false;
+
+    QMutexLocker locker(&m_dataMutex);
+    m_universeMap[universe].feedbackBundle = enable;
+
+    return enable == false;
+}
+
 bool OSCController::setOutputIPAddress(quint32 universe, QString address)
 {
     if (m_universeMap.contains(universe) == false)
@@ -277,15 +294,64 @@ void OSCController::sendDmx(const quint32 universe, const QByteArray &dmxData)
 void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar value, const QString &key)
 {
     QMutexLocker locker(&m_dataMutex);
-    QHostAddress outAddress = QHostAddress::Null;
-    quint32 outPort = 9000 + universe;
 
-    if (m_universeMap.contains(universe))
+    QByteArray oscPacket = feedbackMessage(universe, channel, value, key);
+    writeFeedbackPacket(universe, oscPacket);
+}
+
+void OSCController::sendFeedbackFrame(const quint32 universe, const QList<PluginFeedbackValue> &values)
+{
+    QMutexLocker locker(&m_dataMutex);
+    QList<QByteArray> messages;
+    int bundleSize = OSC_BUNDLE_HEADER_SIZE;
+    bool bundled = m_universeMap.contains(universe) && m_universeMap[universe].feedbackBundle;
+
+    foreach (PluginFeedbackValue fb, values)
     {
-        outAddress = m_universeMap[universe].feedbackAddress;
-        outPort = m_universeMap[universe].feedbackPort;
+        QByteArray message = feedbackMessage(universe, fb.channel, fb.value, fb.key);
+        if (message.isEmpty())
+            continue;
+
+        if (bundled == false)
+        {
+            writeFeedbackPacket(universe, message);
+            continue;
+        }
+
+        // keep each bundle within a single UDP datagram
+        if (messages.isEmpty() == false && bundleSize + 4 + message.size() > OSC_MAX_BUNDLE_SIZE)
+        {
+            writeFeedbackMessages(universe, messages);
+            messages.clear();
+            bundleSize = OSC_BUNDLE_HEADER_SIZE;
+        }
+
+        messages.append(message);
+        bundleSize += 4 + message.size();
     }
 
+    writeFeedbackMessages(universe, messages);
+}
+
+void OSCController::writeFeedbackMessages(const quint32 universe, const QList<QByteArray> &messages)
+{
+    if (messages.isEmpty())
+        return;
+
+    // a single value doesn't need the bundle overhead
+    if (messages.count() == 1)
+    {
+        writeFeedbackPacket(universe, messages.first());
+        return;
+    }
+
+    QByteArray bundle;
+    m_packetizer->setupOSCBundle(bundle, messages);
+    writeFeedbackPacket(universe, bundle);
+}
+
+QByteArray OSCController::feedbackMessage(const quint32 universe, quint32 channel, uchar value, const QString &key)
+{
     QString path = key;
     // on invalid key try to retrieve the OSC path from the hash table.
     // This works only if the OSC widget has been previously moved by the user
@@ -324,7 +390,22 @@ void OSCController::sendFeedback(const quint32 universe, quint32 channel, uchar
     pTypes.fill('f', values.count());
 
     m_packetizer->setupOSCGeneric(oscPacket, path, pTypes, values);
-    qint64 sent = m_outputSocket->writeDatagram(oscPacket.data(), oscPacket.size(),
+
+    return oscPacket;
+}
+
+void OSCController::writeFeedbackPacket(const quint32 universe, const QByteArray &packet)
+{
+    QHostAddress outAddress = QHostAddress::Null;
+    quint32 outPort = 9000 + universe;
+
+    if (m_universeMap.contains(universe))
+    {
+        outAddress = m_universeMap[universe].feedbackAddress;
+        outPort = m_universeMap[universe].feedbackPort;
+    }
+
+    qint64 sent = m_outputSocket->writeDatagram(packet.data(), packet.size(),
                                              outAddress, outPort);
     if (sent < 0)
     {
@@ -35,6 +35,7 @@
 #include <QMap>
 
 #include "oscpacketizer.h"
+#include "qlcioplugin.h"
 
 typedef struct
 {
@@ -44,6 +45,8 @@ typedef struct
 
     QHostAddress feedbackAddress;
     quint16 feedbackPort;
+    // send the feedback values of a frame in OSC bundles
+    bool feedbackBundle;
 
     QHostAddress outputAddress;
     quint16 outputPort;
@@ -92,6 +95,11 @@ public:
      *  Return true if this restores default feedback port */
     bool setFeedbackPort(quint32 universe, quint16 port);
 
+    /** Enable or disable the OSC bundles for the feedback frames
+     *  of the given universe.
+     *  Return true if this restores the default (disabled) */
+    bool setFeedbackBundle(quint32 universe, bool enable);
+
     /** Set a specific output IP address for the given QLC+ universe.
      *  Return true if this restores default output IP address */
     bool setOutputIPAddress(quint32 universe, QString address);
@@ -126,7 +134,22 @@ public:
     /** Send a feedback using the specified path and value */
     void sendFeedback(const quint32 universe, quint32 channel, uchar value, const QString &key);
 
+    /** Send the feedback values of a whole frame. If enabled for $universe,
+     *  multiple values are grouped in OSC bundles, otherwise each value
+     *  is sent as a plain message like sendFeedback() does */
+    void sendFeedbackFrame(const quint32 universe, const QList<PluginFeedbackValue>& values);
+
 private:
+    /** Prepare the OSC message of a feedback value. Called with m_dataMutex locked */
+    QByteArray feedbackMessage(const quint32 universe, quint32 channel, uchar value, const QString &key);
+
+    /** Send $packet to the feedback address of $universe. Called with m_dataMutex locked */
+    void writeFeedbackPacket(const quint32 universe, const QByteArray &packet);
+
+    /** Send $messages to the feedback address of $universe, in a bundle
+     *  if there is more than one. Called with m_dataMutex locked */
+    void writeFeedbackMessages(const quint32 universe, const QList<QByteArray> &messages);
+
     QSharedPointer<QUdpSocket> getInputSocket(quint16 port);
 
 protected:
@@ -92,6 +92,27 @@ void OSCPacketizer::setupOSCGeneric(QByteArray &data, QString &path, QString typ
     }
 }
 
+void OSCPacketizer::setupOSCBundle(QByteArray &data, const QList<QByteArray> &messages)
+{
+    data.clear();
+    data.append("#bundle");
+    data.append((char)0x00);
+
+    // the special time tag 1 means "immediately"
+    data.append(QByteArray(7, 0x00));
+    data.append((char)0x01);
+
+    foreach (QByteArray message, messages)
+    {
+        quint32 size = message.size();
+        data.append((char)(size >> 24));
+        data.append((char)((size >> 16) & 0xFF));
+        data.append((char)((size >> 8) & 0xFF));
+        data.append((char)(size & 0xFF));
+        data.append(message);
+    }
+}
+
 /*********************************************************************
  * Receiver functions
  *********************************************************************/
@@ -76,6 +76,15 @@ public:
      */
     void setupOSCGeneric(QByteArray& data, QString &path, QString types, QByteArray &values);
 
+    /**
+     * Prepare an OSC bundle holding the given $messages, to be
+     * processed immediately by the receiver
+     *
+     * @param data the bundle composed by this function to be sent on the network
+     * @param messages the OSC messages, as composed by setupOSCGeneric
+     */
+    void setupOSCBundle(QByteArray& data, const QList<QByteArray>& messages);
+
     /*********************************************************************
      * Receiver functions
      *********************************************************************/
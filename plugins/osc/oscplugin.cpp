@@ -293,6 +293,17 @@ void OSCPlugin::sendFeedBack(quint32 universe, quint32 input,
         controller->sendFeedback(universe, channel, value, key);
 }
 
+void OSCPlugin::sendFeedBackFrame(quint32 universe, quint32 input,
+                                  const QList<PluginFeedbackValue> &values)
+{
+    if (input >= (quint32)m_IOmapping.count())
+        return;
+
+    OSCController *controller = m_IOmapping[input].controller;
+    if (controller != NULL)
+        controller->sendFeedbackFrame(universe, values);
+}
+
 /*********************************************************************
  * Configuration
  *********************************************************************/
@@ -327,6 +338,8 @@ void OSCPlugin::setParameter(quint32 universe, quint32 line, Capability type,
         unset = controller->setFeedbackIPAddress(universe, value.toString());
     else if (name == OSC_FEEDBACKPORT)
         unset = controller->setFeedbackPort(universe, value.toUInt());
+    else if (name == OSC_FEEDBACKBUNDLE)
+        unset = controller->setFeedbackBundle(universe, value.toBool());
     else if (name == OSC_OUTPUTIP)
         unset = controller->setOutputIPAddress(universe, value.toString());
     else if (name == OSC_OUTPUTPORT)
@@ -39,6 +39,7 @@ typedef struct
 #define OSC_INPUTPORT "inputPort"
 #define OSC_FEEDBACKIP "feedbackIP"
 #define OSC_FEEDBACKPORT "feedbackPort"
+#define OSC_FEEDBACKBUNDLE "feedbackBundle"
 #define OSC_OUTPUTIP "outputIP"
 #define OSC_OUTPUTPORT "outputPort"
 
@@ -111,6 +112,9 @@ public:
     /** @reimp */
     void sendFeedBack(quint32 universe, quint32 input, quint32 channel, uchar value, const QString& key);
 
+    /** @reimp */
+    void sendFeedBackFrame(quint32 universe, quint32 input, const QList<PluginFeedbackValue>& values);
+
     /*********************************************************************
      * Configuration
      *********************************************************************/
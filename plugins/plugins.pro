@@ -17,16 +17,21 @@ TEMPLATE = subdirs
  SUBDIRS              += velleman
  SUBDIRS              += enttecwing
  SUBDIRS              += hid
+ !macx:!win32:SUBDIRS += hid/test
  !macx:!win32:SUBDIRS += spi
+ !macx:!win32:SUBDIRS += spi/test
+ linux:SUBDIRS        += shm
 
  greaterThan(QT_MAJOR_VERSION, 4) {
     SUBDIRS              += os2l
     #!macx:!win32:SUBDIRS += uart
     #!macx:!win32:SUBDIRS += gpio
+    linux:SUBDIRS        += gpio/test
  }
 }
 
 SUBDIRS              += artnet
 SUBDIRS              += E1.31
+!android:!ios:SUBDIRS += E1.31/test
 SUBDIRS              += loopback
 SUBDIRS              += osc
@@ -0,0 +1,93 @@
+/*
+  Q Light Controller Plus
+  qlcshm_reader.c
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+/*
+ * Example of a process reading the universes QLC+ publishes through
+ * the shared memory plugin. It prints the first channels of every frame
+ * of an output line, and the frames it missed for being too slow.
+ *
+ * Build with:
+ *   cc -I../src -o qlcshm_reader qlcshm_reader.c -lrt
+ *
+ * Usage:
+ *   qlcshm_reader <QLC+ process ID> [output line, starting from 1] [channels to print]
+ *
+ * e.g. qlcshm_reader $(pidof qlcplus) 1
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+
+#include "qlcshm.h"
+
+int main(int argc, char **argv)
+{
+    unsigned pid;
+    unsigned line = argc > 2 ? (unsigned)atoi(argv[2]) : 1;
+    int channels = argc > 3 ? atoi(argv[3]) : 16;
+    char name[QLCSHM_NAME_SIZE];
+    uint8_t data[QLCSHM_UNIVERSE_SIZE];
+    qlcshm_segment *seg;
+    uint64_t sequence;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <QLC+ process ID> [output line] [channels]\n", argv[0]);
+        return 1;
+    }
+    pid = (unsigned)atoi(argv[1]);
+
+    qlcshm_segment_name(name, pid, 0, line);
+    seg = qlcshm_open(name, 0);
+    if (seg == NULL)
+    {
+        fprintf(stderr, "%s not found: is the output line patched in QLC+?\n", name);
+        return 1;
+    }
+
+    printf("Reading %s, universe %u\n", name, seg->universe + 1);
+
+    sequence = qlcshm_latest(seg);
+    while (__atomic_load_n(&seg->closed, __ATOMIC_ACQUIRE) == 0)
+    {
+        uint64_t latest = qlcshm_wait(seg, sequence, 1000);
+        int size, i;
+
+        if (latest == sequence)
+            continue;
+
+        if (latest - sequence > 1 && sequence != 0)
+            printf("missed %" PRIu64 " frames\n", latest - sequence - 1);
+
+        sequence = latest;
+        size = qlcshm_read(seg, sequence, data);
+        if (size < 0)
+            continue;
+
+        printf("%8" PRIu64 ":", sequence);
+        for (i = 0; i < channels && i < size; i++)
+            printf(" %3u", data[i]);
+        printf("\n");
+    }
+
+    printf("%s closed\n", name);
+    qlcshm_close(seg);
+
+    return 0;
+}
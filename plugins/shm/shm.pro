@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+CONFIG  += ordered
+SUBDIRS += src
+!android:!ios {
+  SUBDIRS += test
+}
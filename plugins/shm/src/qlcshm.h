@@ -0,0 +1,236 @@
+/*
+  Q Light Controller Plus
+  qlcshm.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+/*
+ * Layout and access functions of the shared memory segments used by the
+ * QLC+ shared memory plugin. This header is plain C and has no dependency
+ * other than the C library, so that other processes can include it.
+ *
+ * Every plugin line owns one POSIX shared memory segment, named
+ * "/qlcplus-<pid>-out-<line>" for the outputs and "/qlcplus-<pid>-in-<line>"
+ * for the inputs, where <pid> is the process ID of the QLC+ instance and
+ * <line> starts from 1, so that several instances don't share segments.
+ * QLC+ creates the segments when a line is patched and removes them when
+ * it is unpatched.
+ *
+ * A segment holds a ring of QLCSHM_RING_SIZE frames. Frames are numbered
+ * by a sequence starting from 1: frame N is stored in the slot
+ * N % QLCSHM_RING_SIZE. There is a single writer per segment (QLC+ for the
+ * outputs, the external producer for the inputs) and any number of readers.
+ * Readers never block the writer: a reader that is too slow sees its frame
+ * overwritten and must skip to the latest one.
+ *
+ * After every frame, the writer increments the notify word and wakes up
+ * the readers waiting on it through a futex.
+ *
+ * Linux only. The futex system call needs the default GNU C dialect
+ * (e.g. gnu99) or _GNU_SOURCE defined before including any header.
+ */
+
+#ifndef QLCSHM_H
+#define QLCSHM_H
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QLCSHM_MAGIC            0x514C4353  /* "QLCS" */
+#define QLCSHM_VERSION          1
+#define QLCSHM_RING_SIZE        8
+#define QLCSHM_UNIVERSE_SIZE    512
+#define QLCSHM_NAME_SIZE        32
+
+typedef struct
+{
+    /* Sequence number of the frame in this slot.
+     * 0 while the slot is being written */
+    uint64_t sequence;
+    /* CLOCK_MONOTONIC time of the frame, in nanoseconds */
+    uint64_t timestamp;
+    /* Number of valid channels in data */
+    uint32_t size;
+    uint32_t reserved;
+    uint8_t data[QLCSHM_UNIVERSE_SIZE];
+} qlcshm_frame;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ring_size;
+    uint32_t frame_size;
+    /* QLC+ universe the line is patched to, starting from 0 */
+    uint32_t universe;
+    /* Set to 1 when QLC+ closes the line. The segment is gone
+     * for new readers, the current ones should unmap it */
+    uint32_t closed;
+    /* Futex word, incremented after every frame */
+    uint32_t notify;
+    uint32_t reserved;
+    /* Sequence number of the last complete frame, 0 if none */
+    uint64_t sequence;
+    qlcshm_frame frames[QLCSHM_RING_SIZE];
+} qlcshm_segment;
+
+/* Write the name of the segment of an $input or output $line, starting
+ * from 1, of the QLC+ instance running as process $pid */
+static inline void qlcshm_segment_name(char *name, unsigned pid, int input, unsigned line)
+{
+    snprintf(name, QLCSHM_NAME_SIZE, "/qlcplus-%u-%s-%u", pid, input ? "in" : "out", line);
+}
+
+/* Map the existing segment called $name. Returns NULL if it doesn't
+ * exist or it isn't a valid segment */
+static inline qlcshm_segment *qlcshm_open(const char *name, int writable)
+{
+    int fd = shm_open(name, writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    void *addr = mmap(NULL, sizeof(qlcshm_segment),
+                      writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    qlcshm_segment *seg = (qlcshm_segment *)addr;
+    if (seg->magic != QLCSHM_MAGIC || seg->version != QLCSHM_VERSION)
+    {
+        munmap(addr, sizeof(qlcshm_segment));
+        return NULL;
+    }
+
+    return seg;
+}
+
+static inline void qlcshm_close(qlcshm_segment *seg)
+{
+    munmap(seg, sizeof(qlcshm_segment));
+}
+
+/* Sequence number of the last complete frame, 0 if none */
+static inline uint64_t qlcshm_latest(const qlcshm_segment *seg)
+{
+    return __atomic_load_n(&seg->sequence, __ATOMIC_ACQUIRE);
+}
+
+/* Return a pointer to frame $sequence, to be read in place, or NULL if it
+ * has been overwritten. The frame can still be overwritten while it is
+ * read: qlcshm_frame_valid() tells if what has been read is consistent */
+static inline const qlcshm_frame *qlcshm_frame_at(const qlcshm_segment *seg, uint64_t sequence)
+{
+    const qlcshm_frame *frame = &seg->frames[sequence % QLCSHM_RING_SIZE];
+    if (__atomic_load_n(&frame->sequence, __ATOMIC_ACQUIRE) != sequence)
+        return NULL;
+    return frame;
+}
+
+static inline int qlcshm_frame_valid(const qlcshm_frame *frame, uint64_t sequence)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&frame->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+/* Copy frame $sequence into $data, which must hold QLCSHM_UNIVERSE_SIZE
+ * bytes. Returns the number of channels, or -1 if it has been overwritten */
+static inline int qlcshm_read(const qlcshm_segment *seg, uint64_t sequence, uint8_t *data)
+{
+    const qlcshm_frame *frame = qlcshm_frame_at(seg, sequence);
+    if (frame == NULL)
+        return -1;
+
+    uint32_t size = frame->size;
+    if (size > QLCSHM_UNIVERSE_SIZE)
+        size = QLCSHM_UNIVERSE_SIZE;
+    memcpy(data, frame->data, size);
+
+    if (qlcshm_frame_valid(frame, sequence) == 0)
+        return -1;
+
+    return (int)size;
+}
+
+/* Wait up to $timeout_ms for a frame newer than $sequence.
+ * Returns the latest sequence number, that is still $sequence on timeout */
+static inline uint64_t qlcshm_wait(qlcshm_segment *seg, uint64_t sequence, int timeout_ms)
+{
+    uint32_t notify = __atomic_load_n(&seg->notify, __ATOMIC_ACQUIRE);
+    uint64_t latest = qlcshm_latest(seg);
+    if (latest != sequence || __atomic_load_n(&seg->closed, __ATOMIC_ACQUIRE))
+        return latest;
+
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+    syscall(SYS_futex, &seg->notify, FUTEX_WAIT, notify, &ts, NULL, 0);
+
+    return qlcshm_latest(seg);
+}
+
+/* Wake up all the readers waiting on $seg */
+static inline void qlcshm_wake(qlcshm_segment *seg)
+{
+    syscall(SYS_futex, &seg->notify, FUTEX_WAKE, 0x7FFFFFFF, NULL, NULL, 0);
+}
+
+/* Publish a new frame with $size channels of $data, waking up the readers.
+ * Only one process may write a segment. Returns the frame sequence number */
+static inline uint64_t qlcshm_publish(qlcshm_segment *seg, const uint8_t *data, uint32_t size)
+{
+    uint64_t sequence = __atomic_load_n(&seg->sequence, __ATOMIC_RELAXED) + 1;
+    qlcshm_frame *frame = &seg->frames[sequence % QLCSHM_RING_SIZE];
+    struct timespec now;
+
+    if (size > QLCSHM_UNIVERSE_SIZE)
+        size = QLCSHM_UNIVERSE_SIZE;
+
+    /* invalidate the slot before touching it */
+    __atomic_store_n(&frame->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(frame->data, data, size);
+    frame->size = size;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    frame->timestamp = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+
+    __atomic_store_n(&frame->sequence, sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&seg->sequence, sequence, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&seg->notify, 1, __ATOMIC_RELEASE);
+    qlcshm_wake(seg);
+
+    return sequence;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
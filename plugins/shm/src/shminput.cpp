@@ -0,0 +1,89 @@
+/*
+  Q Light Controller Plus
+  shminput.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+
+#include "shminput.h"
+
+/** How long to wait for a frame before checking if the thread must stop */
+#define WAIT_TIMEOUT_MS 100
+
+SHMInput::SHMInput(qlcshm_segment *segment, quint32 universe, quint32 line, QObject *parent)
+    : QThread(parent)
+    , m_segment(segment)
+    , m_universe(universe)
+    , m_line(line)
+    , m_running(false)
+    , m_values(QLCSHM_UNIVERSE_SIZE, 0)
+{
+}
+
+SHMInput::~SHMInput()
+{
+    stop();
+}
+
+void SHMInput::startReading()
+{
+    // set before starting, so that an early stop() is not overridden
+    m_running = true;
+    start();
+}
+
+void SHMInput::stop()
+{
+    if (isRunning() == false)
+        return;
+
+    m_running = false;
+    qlcshm_wake(m_segment);
+    wait();
+}
+
+void SHMInput::run()
+{
+    uchar frame[QLCSHM_UNIVERSE_SIZE];
+    uchar *values = reinterpret_cast<uchar *>(m_values.data());
+    quint64 sequence = qlcshm_latest(m_segment);
+
+    while (m_running == true)
+    {
+        quint64 latest = qlcshm_wait(m_segment, sequence, WAIT_TIMEOUT_MS);
+        if (latest == sequence)
+            continue;
+
+        // frames older than the latest one are of no use to an input
+        sequence = latest;
+        int size = qlcshm_read(m_segment, sequence, frame);
+        if (size < 0)
+        {
+            qDebug() << "[SHM] input" << m_line << "frame" << sequence << "overwritten while reading";
+            continue;
+        }
+
+        for (int i = 0; i < size; i++)
+        {
+            if (values[i] != frame[i])
+            {
+                values[i] = frame[i];
+                emit valueChanged(m_universe, m_line, i, frame[i]);
+            }
+        }
+    }
+}
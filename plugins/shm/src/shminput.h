@@ -0,0 +1,63 @@
+/*
+  Q Light Controller Plus
+  shminput.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SHMINPUT_H
+#define SHMINPUT_H
+
+#include <QByteArray>
+#include <QThread>
+
+#include "qlcshm.h"
+
+/**
+ * Thread waiting for the frames published by an external process into
+ * an input segment. Every new frame is compared with the previous one
+ * and only the changed channels are reported.
+ */
+class SHMInput : public QThread
+{
+    Q_OBJECT
+
+public:
+    SHMInput(qlcshm_segment *segment, quint32 universe, quint32 line, QObject *parent = 0);
+    ~SHMInput();
+
+    /** Start the thread reading the segment */
+    void startReading();
+
+    /** Stop the thread and wait for it to finish */
+    void stop();
+
+protected:
+    void run();
+
+signals:
+    void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+
+private:
+    qlcshm_segment *m_segment;
+    quint32 m_universe;
+    quint32 m_line;
+    bool m_running;
+
+    /** The values of the last frame read */
+    QByteArray m_values;
+};
+
+#endif
@@ -0,0 +1,300 @@
+/*
+  Q Light Controller Plus
+  shmplugin.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QStringList>
+#include <QString>
+#include <QDebug>
+
+#include <string.h>
+#include <errno.h>
+
+#include "shmplugin.h"
+#include "shminput.h"
+
+#define SHM_LINES 8
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+SHMPlugin::~SHMPlugin()
+{
+    foreach (quint32 input, m_inputSegments.keys())
+        closeInput(input, m_inputSegments[input]->universe);
+
+    foreach (quint32 output, m_outputSegments.keys())
+        closeOutput(output, m_outputSegments[output]->universe);
+}
+
+void SHMPlugin::init()
+{
+}
+
+QString SHMPlugin::name()
+{
+    return QString("Shared Memory");
+}
+
+int SHMPlugin::capabilities() const
+{
+    return QLCIOPlugin::Output | QLCIOPlugin::Input;
+}
+
+QString SHMPlugin::pluginInfo()
+{
+    QString str;
+
+    str += QString("<HTML>");
+    str += QString("<HEAD>");
+    str += QString("<TITLE>%1</TITLE>").arg(name());
+    str += QString("</HEAD>");
+    str += QString("<BODY>");
+
+    str += QString("<P>");
+    str += QString("<H3>%1</H3>").arg(name());
+    str += tr("This plugin exchanges DMX universes with other applications running "
+              "on the same machine, through POSIX shared memory. "
+              "Applications can access it with the qlcshm.h header.");
+    str += QString("</P>");
+
+    return str;
+}
+
+qlcshm_segment *SHMPlugin::createSegment(bool input, quint32 line, quint32 universe)
+{
+    char name[QLCSHM_NAME_SIZE];
+    qlcshm_segment_name(name, getpid(), input ? 1 : 0, line + 1);
+
+    // a segment left behind by a crash is taken over
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        qWarning() << "[SHM] cannot create" << name << ":" << strerror(errno);
+        return NULL;
+    }
+
+    if (ftruncate(fd, sizeof(qlcshm_segment)) < 0)
+    {
+        qWarning() << "[SHM] cannot resize" << name << ":" << strerror(errno);
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    void *addr = mmap(NULL, sizeof(qlcshm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        qWarning() << "[SHM] cannot map" << name << ":" << strerror(errno);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    qlcshm_segment *segment = static_cast<qlcshm_segment *>(addr);
+    memset(segment, 0, sizeof(qlcshm_segment));
+    segment->version = QLCSHM_VERSION;
+    segment->ring_size = QLCSHM_RING_SIZE;
+    segment->frame_size = QLCSHM_UNIVERSE_SIZE;
+    segment->universe = universe;
+    // readers validate the segment by its magic, so it goes last
+    __atomic_store_n(&segment->magic, QLCSHM_MAGIC, __ATOMIC_RELEASE);
+
+    qDebug() << "[SHM] created" << name << "for universe" << universe;
+
+    return segment;
+}
+
+void SHMPlugin::destroySegment(qlcshm_segment *segment, bool input, quint32 line)
+{
+    char name[QLCSHM_NAME_SIZE];
+    qlcshm_segment_name(name, getpid(), input ? 1 : 0, line + 1);
+
+    __atomic_store_n(&segment->closed, 1, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&segment->notify, 1, __ATOMIC_RELEASE);
+    qlcshm_wake(segment);
+
+    shm_unlink(name);
+    qlcshm_close(segment);
+}
+
+/*****************************************************************************
+ * Outputs
+ *****************************************************************************/
+
+bool SHMPlugin::openOutput(quint32 output, quint32 universe)
+{
+    if (output >= SHM_LINES)
+        return false;
+
+    QMutexLocker locker(&m_outputMutex);
+
+    if (m_outputSegments.contains(output) == false)
+    {
+        qlcshm_segment *segment = createSegment(false, output, universe);
+        if (segment == NULL)
+            return false;
+        m_outputSegments[output] = segment;
+    }
+
+    addToMap(universe, output, Output);
+
+    return true;
+}
+
+void SHMPlugin::closeOutput(quint32 output, quint32 universe)
+{
+    QMutexLocker locker(&m_outputMutex);
+
+    qlcshm_segment *segment = m_outputSegments.take(output);
+    if (segment != NULL)
+        destroySegment(segment, false, output);
+
+    removeFromMap(output, universe, Output);
+}
+
+QStringList SHMPlugin::outputs()
+{
+    QStringList list;
+    for (int i = 0; i < SHM_LINES; i++)
+        list << QString("Shared memory %1").arg(i + 1);
+    return list;
+}
+
+QString SHMPlugin::outputInfo(quint32 output)
+{
+    if (output >= SHM_LINES)
+        return QString();
+
+    char name[QLCSHM_NAME_SIZE];
+    qlcshm_segment_name(name, getpid(), 0, output + 1);
+
+    QString str;
+
+    str += QString("<H3>%1 %2</H3>").arg(tr("Output")).arg(outputs()[output]);
+    str += QString("<P>");
+    str += tr("Segment: %1").arg(name);
+    str += QString("<BR>");
+
+    QMutexLocker locker(&m_outputMutex);
+    if (m_outputSegments.contains(output))
+        str += tr("Status: Used, %1 frames published").arg(qlcshm_latest(m_outputSegments[output]));
+    else
+        str += tr("Status: Not used");
+    str += QString("</P>");
+    str += QString("</BODY>");
+    str += QString("</HTML>");
+
+    return str;
+}
+
+void SHMPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray &data)
+{
+    Q_UNUSED(universe);
+
+    QMutexLocker locker(&m_outputMutex);
+
+    qlcshm_segment *segment = m_outputSegments.value(output, NULL);
+    if (segment == NULL)
+        return;
+
+    qlcshm_publish(segment, reinterpret_cast<const uint8_t *>(data.constData()), data.size());
+}
+
+/*****************************************************************************
+ * Inputs
+ *****************************************************************************/
+
+bool SHMPlugin::openInput(quint32 input, quint32 universe)
+{
+    if (input >= SHM_LINES)
+        return false;
+
+    if (m_inputSegments.contains(input) == false)
+    {
+        qlcshm_segment *segment = createSegment(true, input, universe);
+        if (segment == NULL)
+            return false;
+
+        SHMInput *thread = new SHMInput(segment, universe, input, this);
+        connect(thread, SIGNAL(valueChanged(quint32,quint32,quint32,uchar)),
+                this, SLOT(slotInputValueChanged(quint32,quint32,quint32,uchar)));
+        thread->startReading();
+
+        m_inputSegments[input] = segment;
+        m_inputThreads[input] = thread;
+    }
+
+    addToMap(universe, input, Input);
+
+    return true;
+}
+
+void SHMPlugin::closeInput(quint32 input, quint32 universe)
+{
+    SHMInput *thread = m_inputThreads.take(input);
+    if (thread != NULL)
+    {
+        thread->stop();
+        delete thread;
+    }
+
+    qlcshm_segment *segment = m_inputSegments.take(input);
+    if (segment != NULL)
+        destroySegment(segment, true, input);
+
+    removeFromMap(input, universe, Input);
+}
+
+QStringList SHMPlugin::inputs()
+{
+    QStringList list;
+    for (int i = 0; i < SHM_LINES; i++)
+        list << QString("Shared memory %1").arg(i + 1);
+    return list;
+}
+
+QString SHMPlugin::inputInfo(quint32 input)
+{
+    if (input >= SHM_LINES)
+        return QString();
+
+    char name[QLCSHM_NAME_SIZE];
+    qlcshm_segment_name(name, getpid(), 1, input + 1);
+
+    QString str;
+
+    str += QString("<H3>%1 %2</H3>").arg(tr("Input")).arg(inputs()[input]);
+    str += QString("<P>");
+    str += tr("Segment: %1").arg(name);
+    str += QString("<BR>");
+    if (m_inputSegments.contains(input))
+        str += tr("Status: Used, %1 frames received").arg(qlcshm_latest(m_inputSegments[input]));
+    else
+        str += tr("Status: Not used");
+    str += QString("</P>");
+    str += QString("</BODY>");
+    str += QString("</HTML>");
+
+    return str;
+}
+
+void SHMPlugin::slotInputValueChanged(quint32 universe, quint32 input, quint32 channel, uchar value)
+{
+    emit valueChanged(universe, input, channel, value);
+}
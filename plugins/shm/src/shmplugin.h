@@ -0,0 +1,122 @@
+/*
+  Q Light Controller Plus
+  shmplugin.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SHMPLUGIN_H
+#define SHMPLUGIN_H
+
+#include <QString>
+#include <QMutex>
+#include <QHash>
+
+#include "qlcioplugin.h"
+#include "qlcshm.h"
+
+class SHMInput;
+
+/**
+ * Exchange universes with processes running on the same machine through
+ * POSIX shared memory. Every line is a segment holding a ring of frames,
+ * as described in qlcshm.h, which is all an external process needs.
+ */
+class SHMPlugin : public QLCIOPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES(QLCIOPlugin)
+    Q_PLUGIN_METADATA(IID QLCIOPlugin_iid)
+
+    /*************************************************************************
+     * Initialization
+     *************************************************************************/
+public:
+    /** @reimp */
+    virtual ~SHMPlugin();
+
+    /** @reimp */
+    void init();
+
+    /** @reimp */
+    QString name();
+
+    /** @reimp */
+    int capabilities() const;
+
+    /** @reimp */
+    QString pluginInfo();
+
+private:
+    /** Create (or take over) the segment of an $input or output $line */
+    static qlcshm_segment *createSegment(bool input, quint32 line, quint32 universe);
+
+    /** Mark a segment closed, wake up its readers and remove it */
+    static void destroySegment(qlcshm_segment *segment, bool input, quint32 line);
+
+    /*************************************************************************
+     * Outputs
+     *************************************************************************/
+public:
+    /** @reimp */
+    bool openOutput(quint32 output, quint32 universe);
+
+    /** @reimp */
+    void closeOutput(quint32 output, quint32 universe);
+
+    /** @reimp */
+    QStringList outputs();
+
+    /** @reimp */
+    QString outputInfo(quint32 output);
+
+    /** @reimp */
+    void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
+
+private:
+    /** Protects m_outputSegments, since every universe writes from its own thread */
+    QMutex m_outputMutex;
+
+    //! output line -> segment
+    QHash<quint32, qlcshm_segment *> m_outputSegments;
+
+    /*************************************************************************
+     * Inputs
+     *************************************************************************/
+public:
+    /** @reimp */
+    bool openInput(quint32 input, quint32 universe);
+
+    /** @reimp */
+    void closeInput(quint32 input, quint32 universe);
+
+    /** @reimp */
+    QStringList inputs();
+
+    /** @reimp */
+    QString inputInfo(quint32 input);
+
+protected slots:
+    void slotInputValueChanged(quint32 universe, quint32 input, quint32 channel, uchar value);
+
+private:
+    //! input line -> segment
+    QHash<quint32, qlcshm_segment *> m_inputSegments;
+
+    //! input line -> reader thread
+    QHash<quint32, SHMInput *> m_inputThreads;
+};
+
+#endif
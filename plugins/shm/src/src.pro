@@ -0,0 +1,33 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = lib
+LANGUAGE = C++
+TARGET   = shm
+CONFIG  += plugin
+
+INCLUDEPATH += ../../interfaces
+
+# shm_open and shm_unlink live in librt on older glibc
+LIBS += -lrt
+
+HEADERS += ../../interfaces/qlcioplugin.h
+HEADERS += qlcshm.h \
+           shminput.h \
+           shmplugin.h
+
+SOURCES += ../../interfaces/qlcioplugin.cpp
+SOURCES += shminput.cpp \
+           shmplugin.cpp
+
+target.path = $$INSTALLROOT/$$PLUGINDIR
+INSTALLS   += target
+
+# The header external processes include to access the segments
+header.path   = $$INSTALLROOT/$$DATADIR/shm
+header.files += qlcshm.h ../example/qlcshm_reader.c
+INSTALLS     += header
+
+metainfo.path   = $$METAINFODIR
+metainfo.files += org.qlcplus.QLCPlus.shm.metainfo.xml
+INSTALLS       += metainfo
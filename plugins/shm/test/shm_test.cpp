@@ -0,0 +1,234 @@
+/*
+  Q Light Controller Plus
+  shm_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QSignalSpy>
+#include <QElapsedTimer>
+#include <QTest>
+
+#include <sys/wait.h>
+#include <signal.h>
+
+#include "shm_test.h"
+#include "shmplugin.h"
+#include "qlcshm.h"
+
+/** Frames the reader process must receive in a row */
+#define READER_FRAMES 20
+
+/** Run $child in a new process, which exits with its return value */
+static pid_t forkProcess(int (*child)())
+{
+    pid_t pid = fork();
+    if (pid == 0)
+        _exit(child());
+    return pid;
+}
+
+/** Check if process $pid exited, storing its exit code in $code */
+static bool processExited(pid_t pid, int &code)
+{
+    int status = 0;
+    if (waitpid(pid, &status, WNOHANG) != pid)
+        return false;
+
+    code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return true;
+}
+
+/** Wait for process $pid to exit, for up to 5 seconds */
+static int waitProcess(pid_t pid)
+{
+    int code = -1;
+    QElapsedTimer timer;
+    timer.start();
+    while (processExited(pid, code) == false)
+    {
+        if (timer.elapsed() > 5000)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+            return -1;
+        }
+        QTest::qWait(5);
+    }
+    return code;
+}
+
+/**
+ * Reader process: wait for READER_FRAMES consecutive frames of the output
+ * line 1, checking their content against what outputReaderProcess() writes
+ */
+static int outputReader()
+{
+    char name[QLCSHM_NAME_SIZE];
+    uint8_t data[QLCSHM_UNIVERSE_SIZE];
+
+    qlcshm_segment_name(name, getppid(), 0, 1);
+    qlcshm_segment *seg = qlcshm_open(name, 0);
+    if (seg == NULL)
+        return 2;
+
+    if (seg->universe != 3)
+        return 3;
+
+    uint64_t sequence = qlcshm_latest(seg);
+    int frames = 0;
+
+    while (frames < READER_FRAMES)
+    {
+        uint64_t latest = qlcshm_wait(seg, sequence, 2000);
+        if (latest == sequence)
+            return 4;
+
+        sequence = latest;
+        int size = qlcshm_read(seg, sequence, data);
+        if (size < 0)
+            continue;
+
+        // the first channel counts the frames, the others are constant
+        if (size != QLCSHM_UNIVERSE_SIZE || data[0] != uint8_t(sequence) ||
+            data[1] != 0xAB || data[511] != 0xCD)
+            return 5;
+
+        frames++;
+    }
+
+    qlcshm_close(seg);
+    return 0;
+}
+
+/** Writer process: publish a single frame into the input line 2 */
+static int inputWriter()
+{
+    char name[QLCSHM_NAME_SIZE];
+    uint8_t data[QLCSHM_UNIVERSE_SIZE];
+
+    qlcshm_segment_name(name, getppid(), 1, 2);
+    qlcshm_segment *seg = qlcshm_open(name, 1);
+    if (seg == NULL)
+        return 2;
+
+    memset(data, 0, sizeof(data));
+    data[10] = 200;
+    data[300] = 7;
+    qlcshm_publish(seg, data, sizeof(data));
+
+    qlcshm_close(seg);
+    return 0;
+}
+
+void SHM_Test::outputSegment()
+{
+    SHMPlugin plugin;
+    char name[QLCSHM_NAME_SIZE];
+    qlcshm_segment_name(name, getpid(), 0, 1);
+
+    QVERIFY(plugin.openOutput(0, 3) == true);
+
+    qlcshm_segment *seg = qlcshm_open(name, 0);
+    QVERIFY(seg != NULL);
+    QCOMPARE(seg->ring_size, uint32_t(QLCSHM_RING_SIZE));
+    QCOMPARE(seg->frame_size, uint32_t(QLCSHM_UNIVERSE_SIZE));
+    QCOMPARE(seg->universe, uint32_t(3));
+    QCOMPARE(qlcshm_latest(seg), uint64_t(0));
+
+    // partial universes keep their size
+    plugin.writeUniverse(3, 0, QByteArray(100, 42));
+    QCOMPARE(qlcshm_latest(seg), uint64_t(1));
+
+    uint8_t data[QLCSHM_UNIVERSE_SIZE];
+    QCOMPARE(qlcshm_read(seg, 1, data), 100);
+    QCOMPARE(data[99], uint8_t(42));
+
+    // the ring wraps around, dropping the oldest frames
+    for (int i = 0; i < QLCSHM_RING_SIZE; i++)
+        plugin.writeUniverse(3, 0, QByteArray(512, i));
+    QCOMPARE(qlcshm_latest(seg), uint64_t(QLCSHM_RING_SIZE + 1));
+    QCOMPARE(qlcshm_read(seg, 1, data), -1);
+    QCOMPARE(qlcshm_read(seg, QLCSHM_RING_SIZE + 1, data), 512);
+    QCOMPARE(data[0], uint8_t(QLCSHM_RING_SIZE - 1));
+
+    // closing marks the segment closed and removes it
+    plugin.closeOutput(0, 3);
+    QCOMPARE(seg->closed, uint32_t(1));
+    QVERIFY(qlcshm_open(name, 0) == NULL);
+    qlcshm_close(seg);
+}
+
+void SHM_Test::outputReaderProcess()
+{
+    SHMPlugin plugin;
+    QVERIFY(plugin.openOutput(0, 3) == true);
+
+    pid_t pid = forkProcess(outputReader);
+    QVERIFY(pid > 0);
+
+    QByteArray data(512, 0xAB);
+    data[511] = 0xCD;
+
+    int code = -1;
+    QElapsedTimer timer;
+    timer.start();
+    for (quint32 frame = 1; processExited(pid, code) == false; frame++)
+    {
+        if (timer.elapsed() > 5000)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+            QFAIL("The reader process didn't receive the frames");
+        }
+
+        data[0] = char(frame);
+        plugin.writeUniverse(3, 0, data);
+        QTest::qWait(2);
+    }
+
+    QCOMPARE(code, 0);
+
+    plugin.closeOutput(0, 3);
+}
+
+void SHM_Test::inputWriterProcess()
+{
+    SHMPlugin plugin;
+    QSignalSpy spy(&plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)));
+
+    QVERIFY(plugin.openInput(1, 5) == true);
+
+    pid_t pid = forkProcess(inputWriter);
+    QVERIFY(pid > 0);
+    QCOMPARE(waitProcess(pid), 0);
+
+    // only the changed channels are reported
+    QTRY_COMPARE(spy.count(), 2);
+    QCOMPARE(spy[0][0].toUInt(), quint32(5));
+    QCOMPARE(spy[0][1].toUInt(), quint32(1));
+    QCOMPARE(spy[0][2].toUInt(), quint32(10));
+    QCOMPARE(spy[0][3].value<uchar>(), uchar(200));
+    QCOMPARE(spy[1][2].toUInt(), quint32(300));
+    QCOMPARE(spy[1][3].value<uchar>(), uchar(7));
+
+    plugin.closeInput(1, 5);
+
+    char name[QLCSHM_NAME_SIZE];
+    qlcshm_segment_name(name, getpid(), 1, 2);
+    QVERIFY(qlcshm_open(name, 0) == NULL);
+}
+
+QTEST_MAIN(SHM_Test)
@@ -0,0 +1,21 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = shm_test
+
+QT      += core testlib
+QT      -= gui
+LIBS    += -L../src -lshm -lrt
+
+INCLUDEPATH += ../../interfaces
+INCLUDEPATH += ../src
+DEPENDPATH  += ../src
+
+HEADERS += ../../interfaces/qlcioplugin.h
+SOURCES += ../../interfaces/qlcioplugin.cpp
+
+# Test sources
+HEADERS += shm_test.h
+SOURCES += shm_test.cpp
@@ -0,0 +1,3 @@
+#!/bin/sh
+export LD_LIBRARY_PATH=../src
+./shm_test
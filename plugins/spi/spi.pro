@@ -36,11 +36,13 @@ TRANSLATIONS += SPI_ja_JP.ts
 HEADERS += ../interfaces/qlcioplugin.h
 HEADERS += spiplugin.h \
            spiconfiguration.h \
+           spiencoder.h \
            spioutthread.h
 
 SOURCES += ../interfaces/qlcioplugin.cpp
 SOURCES += spiplugin.cpp \
            spiconfiguration.cpp \
+           spiencoder.cpp \
            spioutthread.cpp
 
 FORMS += spiconfiguration.ui
@@ -21,6 +21,7 @@
 #include <QString>
 
 #include "spiconfiguration.h"
+#include "spiencoder.h"
 #include "spiplugin.h"
 
 /*****************************************************************************
@@ -36,8 +37,14 @@ SPIConfiguration::SPIConfiguration(SPIPlugin* plugin, QWidget* parent)
     /* Setup UI controls */
     setupUi(this);
 
+    m_protocolCombo->addItems(SPIEncoder::protocols());
+    m_orderCombo->addItems(SPIEncoder::colorOrders());
+
+    connect(m_protocolCombo, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(slotProtocolChanged(int)));
+
     QSettings settings;
-    QVariant value = settings.value("SPIPlugin/frequency");
+    QVariant value = settings.value(SETTINGS_FREQUENCY);
     if (value.isValid() == true)
     {
         int speed = value.toUInt();
@@ -48,6 +55,14 @@ SPIConfiguration::SPIConfiguration(SPIPlugin* plugin, QWidget* parent)
             case 8000000: m_freqCombo->setCurrentIndex(3); break;
         }
     }
+
+    m_protocolCombo->setCurrentIndex(settings.value(SETTINGS_PROTOCOL, SPIEncoder::Raw).toInt());
+    m_orderCombo->setCurrentIndex(settings.value(SETTINGS_COLORORDER, SPIEncoder::DefaultOrder).toInt());
+    m_gammaSpin->setValue(settings.value(SETTINGS_GAMMA, 1.0).toDouble());
+    m_brightnessSpin->setValue(settings.value(SETTINGS_BRIGHTNESS, 100).toInt());
+    m_ditherCheck->setChecked(settings.value(SETTINGS_DITHERING, false).toBool());
+
+    slotProtocolChanged(m_protocolCombo->currentIndex());
 }
 
 SPIConfiguration::~SPIConfiguration()
@@ -76,6 +91,45 @@ quint32 SPIConfiguration::frequency()
     }
 }
 
+int SPIConfiguration::protocol()
+{
+    return m_protocolCombo->currentIndex();
+}
+
+int SPIConfiguration::colorOrder()
+{
+    return m_orderCombo->currentIndex();
+}
+
+double SPIConfiguration::gamma()
+{
+    return m_gammaSpin->value();
+}
+
+int SPIConfiguration::brightness()
+{
+    return m_brightnessSpin->value();
+}
+
+bool SPIConfiguration::dithering()
+{
+    return m_ditherCheck->isChecked();
+}
+
+void SPIConfiguration::slotProtocolChanged(int index)
+{
+    bool pixels = (index != SPIEncoder::Raw);
+
+    // WS281x timings impose the SPI clock
+    m_freqCombo->setEnabled(index != SPIEncoder::WS281x);
+
+    // raw data is sent as it is
+    m_orderCombo->setEnabled(pixels);
+    m_gammaSpin->setEnabled(pixels);
+    m_brightnessSpin->setEnabled(pixels);
+    m_ditherCheck->setEnabled(pixels);
+}
+
 int SPIConfiguration::exec()
 {
     return QDialog::exec();
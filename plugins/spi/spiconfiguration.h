@@ -39,10 +39,20 @@ public:
     void accept();
 
     quint32 frequency();
+    int protocol();
+    int colorOrder();
+    double gamma();
+
+    /** The global brightness, in percentage */
+    int brightness();
+    bool dithering();
 
 public slots:
     int exec();
 
+private slots:
+    void slotProtocolChanged(int index);
+
 private:
     SPIPlugin* m_plugin;
 
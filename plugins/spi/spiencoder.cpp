@@ -0,0 +1,334 @@
+/*
+  Q Light Controller Plus
+  spiencoder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <string.h>
+#include <qmath.h>
+
+#include "spiencoder.h"
+
+/** WS281x bit rate, with 3 SPI bits per data bit */
+#define WS281X_CLOCK_SPEED  2400000
+
+/** Low time latching the WS281x values: 300us at 2.4MHz. Recent
+ *  WS2812B need more than 280us, older chips just 50us */
+#define WS281X_RESET_BYTES  90
+
+/*****************************************************************************
+ * Initialization
+ *****************************************************************************/
+
+SPIEncoder::SPIEncoder()
+    : m_colorOrder(DefaultOrder)
+    , m_gamma(1.0)
+    , m_brightness(255)
+    , m_dithering(false)
+    , m_tablesReady(false)
+{
+}
+
+SPIEncoder::~SPIEncoder()
+{
+}
+
+SPIEncoder *SPIEncoder::create(SPIEncoder::Protocol protocol)
+{
+    switch (protocol)
+    {
+        case WS281x: return new SPIWS281xEncoder();
+        case APA102: return new SPIAPA102Encoder();
+        case SK9822: return new SPISK9822Encoder();
+        default:
+        case Raw: return new SPIRawEncoder();
+    }
+}
+
+QStringList SPIEncoder::protocols()
+{
+    QStringList list;
+    list << "Raw (WS2801)" << "WS281x" << "APA102" << "SK9822";
+    return list;
+}
+
+QStringList SPIEncoder::colorOrders()
+{
+    QStringList list;
+    list << "Default" << "RGB" << "RBG" << "GRB" << "GBR" << "BRG" << "BGR";
+    return list;
+}
+
+int SPIEncoder::clockSpeed() const
+{
+    return 0;
+}
+
+bool SPIEncoder::needsRefresh() const
+{
+    return m_dithering == true && protocol() != Raw;
+}
+
+/*****************************************************************************
+ * Color correction
+ *****************************************************************************/
+
+void SPIEncoder::setColorOrder(SPIEncoder::ColorOrder order)
+{
+    m_colorOrder = order;
+    m_tablesReady = false;
+}
+
+SPIEncoder::ColorOrder SPIEncoder::colorOrder() const
+{
+    return m_colorOrder;
+}
+
+void SPIEncoder::setGamma(double gamma)
+{
+    m_gamma = qBound(0.1, gamma, 5.0);
+    m_tablesReady = false;
+}
+
+double SPIEncoder::gamma() const
+{
+    return m_gamma;
+}
+
+void SPIEncoder::setBrightness(int level)
+{
+    m_brightness = qBound(0, level, 255);
+    m_tablesReady = false;
+}
+
+int SPIEncoder::brightness() const
+{
+    return m_brightness;
+}
+
+void SPIEncoder::setDithering(bool enable)
+{
+    m_dithering = enable;
+    m_error.clear();
+}
+
+bool SPIEncoder::dithering() const
+{
+    return m_dithering;
+}
+
+SPIEncoder::ColorOrder SPIEncoder::defaultColorOrder() const
+{
+    return RGB;
+}
+
+void SPIEncoder::updateTables()
+{
+    ColorOrder order = m_colorOrder;
+    if (order == DefaultOrder)
+        order = defaultColorOrder();
+
+    QString wire = colorOrders().at(order);
+    for (int i = 0; i < 3; i++)
+        m_wireOrder[i] = QString("RGB").indexOf(wire.at(i));
+
+    for (int i = 0; i < 256; i++)
+    {
+        double value = qPow(double(i) / 255.0, m_gamma) * double(m_brightness);
+        m_correction[i] = quint16(qRound(value * 256.0));
+    }
+
+    m_tablesReady = true;
+}
+
+int SPIEncoder::preparePixels(const QByteArray &data)
+{
+    if (m_tablesReady == false)
+        updateTables();
+
+    int pixels = data.size() / 3;
+    int length = pixels * 3;
+
+    m_pixels.resize(length);
+    if (m_dithering == true && m_error.size() != length)
+        m_error.fill(0, length);
+
+    const uchar *src = reinterpret_cast<const uchar *>(data.constData());
+    uchar *dst = reinterpret_cast<uchar *>(m_pixels.data());
+
+    for (int p = 0; p < length; p += 3)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            quint32 value = m_correction[src[p + m_wireOrder[c]]];
+
+            if (m_dithering == true)
+            {
+                // carry the truncated fraction over to the next frame
+                value += m_error[p + c];
+                m_error[p + c] = uchar(value & 0xFF);
+            }
+            else
+            {
+                value += 0x80;
+            }
+
+            dst[p + c] = uchar(qMin(value >> 8, quint32(255)));
+        }
+    }
+
+    return pixels;
+}
+
+/*****************************************************************************
+ * Raw
+ *****************************************************************************/
+
+SPIEncoder::Protocol SPIRawEncoder::protocol() const
+{
+    return Raw;
+}
+
+void SPIRawEncoder::encode(const QByteArray &data, QByteArray &out)
+{
+    out = data;
+}
+
+/*****************************************************************************
+ * WS281x
+ *****************************************************************************/
+
+uchar SPIWS281xEncoder::s_expansion[256][3];
+bool SPIWS281xEncoder::s_expansionReady = false;
+
+SPIWS281xEncoder::SPIWS281xEncoder()
+    : SPIEncoder()
+{
+    if (s_expansionReady == true)
+        return;
+
+    for (int value = 0; value < 256; value++)
+    {
+        quint32 bits = 0;
+        for (int b = 7; b >= 0; b--)
+            bits = (bits << 3) | (((value >> b) & 0x01) ? 0x06 : 0x04);
+
+        s_expansion[value][0] = uchar(bits >> 16);
+        s_expansion[value][1] = uchar(bits >> 8);
+        s_expansion[value][2] = uchar(bits);
+    }
+    s_expansionReady = true;
+}
+
+SPIEncoder::Protocol SPIWS281xEncoder::protocol() const
+{
+    return WS281x;
+}
+
+int SPIWS281xEncoder::clockSpeed() const
+{
+    return WS281X_CLOCK_SPEED;
+}
+
+SPIEncoder::ColorOrder SPIWS281xEncoder::defaultColorOrder() const
+{
+    return GRB;
+}
+
+void SPIWS281xEncoder::encode(const QByteArray &data, QByteArray &out)
+{
+    int length = preparePixels(data) * 3;
+
+    out.resize(length * 3 + WS281X_RESET_BYTES);
+
+    const uchar *src = reinterpret_cast<const uchar *>(m_pixels.constData());
+    uchar *dst = reinterpret_cast<uchar *>(out.data());
+
+    for (int i = 0; i < length; i++)
+    {
+        const uchar *bits = s_expansion[src[i]];
+        dst[0] = bits[0];
+        dst[1] = bits[1];
+        dst[2] = bits[2];
+        dst += 3;
+    }
+
+    memset(dst, 0, WS281X_RESET_BYTES);
+}
+
+/*****************************************************************************
+ * APA102
+ *****************************************************************************/
+
+SPIEncoder::Protocol SPIAPA102Encoder::protocol() const
+{
+    return APA102;
+}
+
+SPIEncoder::ColorOrder SPIAPA102Encoder::defaultColorOrder() const
+{
+    return BGR;
+}
+
+int SPIAPA102Encoder::endFrameSize(int pixels) const
+{
+    // the data is delayed by half a clock cycle by every pixel,
+    // so at least one more clock edge per 2 pixels is needed
+    return qMax(4, (pixels + 15) / 16);
+}
+
+void SPIAPA102Encoder::encode(const QByteArray &data, QByteArray &out)
+{
+    int pixels = preparePixels(data);
+    int endSize = endFrameSize(pixels);
+
+    out.resize(4 + pixels * 4 + endSize);
+
+    const uchar *src = reinterpret_cast<const uchar *>(m_pixels.constData());
+    uchar *dst = reinterpret_cast<uchar *>(out.data());
+
+    memset(dst, 0, 4);
+    dst += 4;
+
+    for (int p = 0; p < pixels; p++)
+    {
+        // the brightness is applied by the correction tables,
+        // so the 5 bit global brightness is always full
+        dst[0] = 0xFF;
+        dst[1] = src[0];
+        dst[2] = src[1];
+        dst[3] = src[2];
+        dst += 4;
+        src += 3;
+    }
+
+    memset(dst, 0, endSize);
+}
+
+/*****************************************************************************
+ * SK9822
+ *****************************************************************************/
+
+SPIEncoder::Protocol SPISK9822Encoder::protocol() const
+{
+    return SK9822;
+}
+
+int SPISK9822Encoder::endFrameSize(int pixels) const
+{
+    // a 32 bit reset frame, then the APA102 end frame
+    return 4 + (pixels + 15) / 16;
+}
@@ -0,0 +1,208 @@
+/*
+  Q Light Controller Plus
+  spiencoder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SPIENCODER_H
+#define SPIENCODER_H
+
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * Base class of the SPI output encoders.
+ *
+ * An encoder turns the serialized universes data into the bytes to be
+ * shifted out on the SPI bus. Pixel protocols consider the data as a
+ * sequence of RGB pixels: the values are gamma corrected, scaled by the
+ * global brightness and optionally dithered through lookup tables, then
+ * reordered in the strip color order and framed by the protocol encoder.
+ */
+class SPIEncoder
+{
+public:
+    enum Protocol
+    {
+        Raw = 0,
+        WS281x,
+        APA102,
+        SK9822
+    };
+
+    enum ColorOrder
+    {
+        DefaultOrder = 0,
+        RGB,
+        RBG,
+        GRB,
+        GBR,
+        BRG,
+        BGR
+    };
+
+    SPIEncoder();
+    virtual ~SPIEncoder();
+
+    /** Create a new encoder for $protocol. The caller owns it */
+    static SPIEncoder *create(Protocol protocol);
+
+    /** Names of the available protocols, in Protocol order */
+    static QStringList protocols();
+
+    /** Names of the available color orders, in ColorOrder order */
+    static QStringList colorOrders();
+
+    virtual Protocol protocol() const = 0;
+
+    /** The SPI clock imposed by the protocol timings, in Hz,
+     *  or 0 if the protocol works at any speed */
+    virtual int clockSpeed() const;
+
+    /**
+     * Encode $data into $out. The allocation of $out is reused,
+     * so encoding a frame of the same size doesn't allocate memory.
+     */
+    virtual void encode(const QByteArray &data, QByteArray &out) = 0;
+
+    /** Check if the encoded output changes even if the data doesn't,
+     *  e.g. because of temporal dithering */
+    bool needsRefresh() const;
+
+    /*********************************************************************
+     * Color correction
+     *********************************************************************/
+public:
+    void setColorOrder(ColorOrder order);
+    ColorOrder colorOrder() const;
+
+    /** Set the gamma correction exponent. 1.0 means linear */
+    void setGamma(double gamma);
+    double gamma() const;
+
+    /** Set the global brightness, from 0 to 255 */
+    void setBrightness(int level);
+    int brightness() const;
+
+    /** Enable temporal dithering of the corrected values */
+    void setDithering(bool enable);
+    bool dithering() const;
+
+protected:
+    /** The native color order of the strips using this protocol */
+    virtual ColorOrder defaultColorOrder() const;
+
+    /**
+     * Correct and reorder the RGB pixels of $data into m_pixels.
+     * Trailing bytes not making a whole pixel are ignored.
+     *
+     * @return the number of pixels
+     */
+    int preparePixels(const QByteArray &data);
+
+private:
+    /** Build the correction and color order tables. This is done
+     *  lazily, since the default color order depends on the protocol */
+    void updateTables();
+
+protected:
+    /** Corrected pixel values, in the strip color order */
+    QByteArray m_pixels;
+
+private:
+    ColorOrder m_colorOrder;
+    double m_gamma;
+    int m_brightness;
+    bool m_dithering;
+    bool m_tablesReady;
+
+    /** The source component of each of the 3 wire components */
+    int m_wireOrder[3];
+
+    /** Corrected values, with 8 bits of fraction used for dithering */
+    quint16 m_correction[256];
+
+    /** Dithering error carried over to the next frame, per channel */
+    QVector<uchar> m_error;
+};
+
+/**
+ * No encoding at all: the data is sent as it is, like chips
+ * accepting raw bytes (e.g. WS2801) expect it.
+ */
+class SPIRawEncoder : public SPIEncoder
+{
+public:
+    Protocol protocol() const;
+    void encode(const QByteArray &data, QByteArray &out);
+};
+
+/**
+ * WS2811/WS2812/SK6812 single wire protocol. Every bit is expanded to
+ * 3 SPI bits (100 for 0, 110 for 1) sent at 2.4MHz, followed by a
+ * low period latching the values.
+ */
+class SPIWS281xEncoder : public SPIEncoder
+{
+public:
+    SPIWS281xEncoder();
+
+    Protocol protocol() const;
+    int clockSpeed() const;
+    void encode(const QByteArray &data, QByteArray &out);
+
+protected:
+    ColorOrder defaultColorOrder() const;
+
+private:
+    /** The 3 SPI bytes of every possible value */
+    static uchar s_expansion[256][3];
+    static bool s_expansionReady;
+};
+
+/**
+ * APA102 clocked protocol: a 32 bit start frame, a 32 bit frame per
+ * pixel made of 3 bits set, 5 bits of global brightness and the color
+ * values, and enough end bits to clock the data through the whole strip.
+ */
+class SPIAPA102Encoder : public SPIEncoder
+{
+public:
+    Protocol protocol() const;
+    void encode(const QByteArray &data, QByteArray &out);
+
+protected:
+    ColorOrder defaultColorOrder() const;
+
+    /** Number of bytes to append after the pixel frames */
+    virtual int endFrameSize(int pixels) const;
+};
+
+/**
+ * SK9822 is APA102 compatible, but latches the values on a 32 bit
+ * reset frame that must follow the pixel frames.
+ */
+class SPISK9822Encoder : public SPIAPA102Encoder
+{
+public:
+    Protocol protocol() const;
+
+protected:
+    int endFrameSize(int pixels) const;
+};
+
+#endif
@@ -17,18 +17,23 @@
   limitations under the License.
 */
 
+#include <QElapsedTimer>
 #include <QMutexLocker>
 #include <QSettings>
 #include <QDebug>
 
-#include <time.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
 
 #include "spioutthread.h"
 
 SPIOutThread::SPIOutThread()
-    : m_isRunning(false)
+    : m_spifd(-1)
+    , m_bitsPerWord(8)
+    , m_speed(1000000)
+    , m_isRunning(false)
+    , m_newFrame(false)
     , m_dataSize(0)
     , m_estimatedWireTime(50000)
 {
@@ -65,7 +70,11 @@ void SPIOutThread::runThread(int fd, int speed)
 
 void SPIOutThread::stopThread()
 {
+    m_mutex.lock();
     m_isRunning = false;
+    m_frameReady.wakeAll();
+    m_mutex.unlock();
+
     wait();
 }
 
@@ -76,58 +85,65 @@ void SPIOutThread::setSpeed(int speed)
 
     if (isRunning())
     {
-        m_isRunning = false;
-        wait();
+        stopThread();
         runThread(m_spifd, speed);
     }
 }
 
 void SPIOutThread::run()
 {
+    QElapsedTimer timer;
+    bool warned = false;
+
     while (m_isRunning)
     {
-        struct spi_ioc_transfer spi;
-
-        struct timespec ts_start;
-        struct timespec ts_end;
-#ifdef CLOCK_MONOTONIC
-        clock_gettime(CLOCK_MONOTONIC, &ts_start);
-#else
-        clock_gettime(CLOCK_REALTIME, &ts_start);
-#endif
+        timer.restart();
 
-        if (m_spifd != -1 && m_pluginData.size() > 0)
+        // m_frame is owned by this thread, so the plugin can
+        // encode the next frame while this one is on the wire
+        if (m_spifd != -1 && m_frame.size() > 0)
         {
-            QMutexLocker locker(&m_mutex);
+            struct spi_ioc_transfer spi;
             memset(&spi, 0, sizeof(spi));
-            spi.tx_buf        = reinterpret_cast<__u64>(m_pluginData.data());
-            spi.len           = m_pluginData.size();
+            spi.tx_buf        = reinterpret_cast<__u64>(m_frame.data());
+            spi.len           = m_frame.size();
             spi.delay_usecs   = 0;
             spi.speed_hz      = m_speed;
             spi.bits_per_word = m_bitsPerWord;
             spi.cs_change = 0;
 
             int retVal = ioctl(m_spifd, SPI_IOC_MESSAGE(1), &spi);
-            if (retVal < 0)
-                qWarning() << "Problem transmitting SPI data: ioctl failed";
+            if (retVal < 0 && warned == false)
+            {
+                qWarning() << "Problem transmitting SPI data: ioctl failed."
+                           << "Frames of" << m_frame.size()
+                           << "bytes might exceed the spidev bufsiz parameter";
+                warned = true;
+            }
         }
 
-#ifdef CLOCK_MONOTONIC
-        clock_gettime(CLOCK_MONOTONIC, &ts_end);
-#else
-        clock_gettime(CLOCK_REALTIME, &ts_end);
-#endif
-        int uSecDiff = (difftime(ts_end.tv_sec, ts_start.tv_sec) * 1000000) + ((ts_end.tv_nsec - ts_start.tv_nsec) / 1000);
-        //qDebug() << "[SPI] ioctl took" << microseconds << "uSecDiff";
-        usleep(m_estimatedWireTime - uSecDiff);
+        QMutexLocker locker(&m_mutex);
+
+        // refresh the output periodically, unless a new frame comes first
+        qint64 waitTime = qint64(m_estimatedWireTime / 1000) - timer.elapsed();
+        if (m_isRunning && m_newFrame == false && waitTime > 0)
+            m_frameReady.wait(&m_mutex, waitTime);
+
+        if (m_newFrame == true)
+        {
+            m_frame.swap(m_pendingFrame);
+            m_newFrame = false;
+        }
     }
 }
 
-void SPIOutThread::writeData(const QByteArray &data)
+void SPIOutThread::writeFrame(QByteArray &frame)
 {
     QMutexLocker locker(&m_mutex);
-    m_pluginData = data;
-    if (m_dataSize != data.size())
+    m_pendingFrame.swap(frame);
+    m_newFrame = true;
+
+    if (m_dataSize != m_pendingFrame.size())
     {
         // Data size has changed ! I need to estimate the
         // time that the SPI writes will take on the wire.
@@ -136,9 +152,10 @@ void SPIOutThread::writeData(const QByteArray &data)
         // where 512 bytes at 1Mhz takes about 70ms to be sent
 
         double byteWriteTimeuS = (double)(70000.0 / ((double)m_speed / 1000000.0)) / 512.0; // time taken to write a byte
-        m_estimatedWireTime = byteWriteTimeuS * (double)data.size();
-        m_dataSize = data.size();
+        m_estimatedWireTime = byteWriteTimeuS * (double)m_pendingFrame.size();
+        m_dataSize = m_pendingFrame.size();
         qDebug() << "[SPI out thread] estimated sleep time:" << m_estimatedWireTime;
     }
-}
 
+    m_frameReady.wakeOne();
+}
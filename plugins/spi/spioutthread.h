@@ -20,8 +20,18 @@
 #ifndef SPIOUTTHREAD_H
 #define SPIOUTTHREAD_H
 
+#include <QWaitCondition>
+#include <QByteArray>
 #include <QThread>
-
+#include <QMutex>
+
+/**
+ * The thread shifting the encoded frames out on the SPI bus.
+ *
+ * Frames are double buffered: the plugin encodes the next frame while
+ * the current one is being transmitted, then hands it over with
+ * writeFrame(). Buffers are swapped, never copied.
+ */
 class SPIOutThread : public QThread
 {
 public:
@@ -33,7 +43,15 @@ public:
 
     void run();
 
-    void writeData(const QByteArray& data);
+    /**
+     * Queue an encoded frame for transmission. If the previous frame
+     * hasn't been picked up yet, it is replaced.
+     *
+     * @param frame The encoded frame. On return it holds a buffer that
+     *              is not used by the thread anymore, to encode the
+     *              next frame into.
+     */
+    void writeFrame(QByteArray& frame);
 
 protected:
     /** File handle for /dev/spidev0.0 */
@@ -43,8 +61,12 @@ protected:
 
     bool m_isRunning;
 
-    /** Copy of data received from the SPI plugin */
-    QByteArray m_pluginData;
+    /** The frame waiting to be transmitted */
+    QByteArray m_pendingFrame;
+    bool m_newFrame;
+
+    /** The frame being transmitted, owned by the thread */
+    QByteArray m_frame;
 
     /** Last size of data sent to the SPI bus */
     int m_dataSize;
@@ -55,6 +77,9 @@ protected:
     /** Mutex used to synchronize data between the SPI plugin
      *  and the output thread */
     QMutex m_mutex;
+
+    /** Wakes the thread up when a new frame is queued */
+    QWaitCondition m_frameReady;
 };
 
 #endif // SPIOUTTHREAD_H
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QMutexLocker>
 #include <QStringList>
 #include <QSettings>
 #include <QString>
@@ -28,6 +29,7 @@
 
 #include "spiplugin.h"
 #include "spioutthread.h"
+#include "spiencoder.h"
 #include "spiconfiguration.h"
 
 #define SPI_DEFAULT_DEVICE  "/dev/spidev0.0"
@@ -39,17 +41,26 @@
 SPIPlugin::~SPIPlugin()
 {
     if (m_outThread != NULL)
+    {
         m_outThread->stopThread();
+        delete m_outThread;
+    }
 
     if (m_spifd != -1)
         close(m_spifd);
+
+    delete m_encoder;
 }
 
 void SPIPlugin::init()
 {
     m_spifd = -1;
     m_referenceCount = 0;
+    m_dataChanged = false;
+    m_encoder = NULL;
     m_outThread = NULL;
+
+    setupEncoder();
 }
 
 QString SPIPlugin::name()
@@ -85,14 +96,11 @@ bool SPIPlugin::openOutput(quint32 output, quint32 universe)
         return false;
     }
 
-    QSettings settings;
-    int speed = 1000000;
-    QVariant value = settings.value("SPIPlugin/frequency");
-    if (value.isValid() == true)
-        speed = value.toUInt();
+    SPIOutThread *outThread = new SPIOutThread();
+    outThread->runThread(m_spifd, busSpeed());
 
-    m_outThread = new SPIOutThread();
-    m_outThread->runThread(m_spifd, speed);
+    QMutexLocker locker(&m_mutex);
+    m_outThread = outThread;
 
     return true;
 }
@@ -108,6 +116,15 @@ void SPIPlugin::closeOutput(quint32 output, quint32 universe)
 
     if (m_referenceCount == 0)
     {
+        m_mutex.lock();
+        if (m_outThread != NULL)
+        {
+            m_outThread->stopThread();
+            delete m_outThread;
+            m_outThread = NULL;
+        }
+        m_mutex.unlock();
+
         if (m_spifd != -1)
             close(m_spifd);
         m_spifd = -1;
@@ -173,6 +190,16 @@ QString SPIPlugin::outputInfo(quint32 output)
     if (output != QLCIOPlugin::invalidLine() && output == 0)
     {
         str += QString("<H3>%1</H3>").arg(outputs()[output]);
+
+        QMutexLocker locker(&m_mutex);
+        if (m_encoder != NULL)
+        {
+            str += QString("<P>");
+            str += tr("Protocol: %1").arg(SPIEncoder::protocols().at(m_encoder->protocol()));
+            str += QString("<BR>");
+            str += tr("Bytes per frame: %1").arg(m_encodedData.size());
+            str += QString("</P>");
+        }
     }
 
     str += QString("</BODY>");
@@ -188,6 +215,8 @@ void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray
 
     qDebug() << "[SPI] write" << universe << "size" << data.size();
 
+    QMutexLocker locker(&m_mutex);
+
     SPIUniverse *uniInfo = m_uniChannelsMap[universe];
     if (uniInfo != NULL)
     {
@@ -210,7 +239,25 @@ void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray
         m_uniChannelsMap[universe] = newUni;
     }
 
-    m_outThread->writeData(m_serializedData);
+    m_dataChanged = true;
+}
+
+void SPIPlugin::commitFrame()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_outThread == NULL || m_encoder == NULL)
+        return;
+
+    if (m_dataChanged == false && m_encoder->needsRefresh() == false)
+        return;
+
+    // encode into the back buffer and swap it with the thread,
+    // while the previous frame is still being transmitted
+    m_encoder->encode(m_serializedData, m_encodedData);
+    m_dataChanged = false;
+
+    m_outThread->writeFrame(m_encodedData);
 }
 
 /*****************************************************************************
@@ -223,9 +270,17 @@ void SPIPlugin::configure()
     if (conf.exec() == QDialog::Accepted)
     {
         QSettings settings;
-        settings.setValue("SPIPlugin/frequency", QVariant(conf.frequency()));
+        settings.setValue(SETTINGS_FREQUENCY, QVariant(conf.frequency()));
+        settings.setValue(SETTINGS_PROTOCOL, QVariant(conf.protocol()));
+        settings.setValue(SETTINGS_COLORORDER, QVariant(conf.colorOrder()));
+        settings.setValue(SETTINGS_GAMMA, QVariant(conf.gamma()));
+        settings.setValue(SETTINGS_BRIGHTNESS, QVariant(conf.brightness()));
+        settings.setValue(SETTINGS_DITHERING, QVariant(conf.dithering()));
+
+        setupEncoder();
+
         if (m_outThread != NULL)
-            m_outThread->setSpeed(conf.frequency());
+            m_outThread->setSpeed(busSpeed());
     }
 }
 
@@ -243,6 +298,8 @@ void SPIPlugin::setParameter(quint32 universe, quint32 line, Capability type,
     // If property name is UniverseChannels, map the channels count
     if (name == PLUGIN_UNIVERSECHANNELS)
     {
+        QMutexLocker locker(&m_mutex);
+
         int chans = value.toInt();
         SPIUniverse *uniStruct = new SPIUniverse;
         uniStruct->m_channels = chans;
@@ -254,6 +311,40 @@ void SPIPlugin::setParameter(quint32 universe, quint32 line, Capability type,
     }
 }
 
+void SPIPlugin::setupEncoder()
+{
+    QSettings settings;
+
+    int protocol = settings.value(SETTINGS_PROTOCOL, SPIEncoder::Raw).toInt();
+    SPIEncoder *encoder = SPIEncoder::create(SPIEncoder::Protocol(protocol));
+
+    encoder->setColorOrder(SPIEncoder::ColorOrder(
+                               settings.value(SETTINGS_COLORORDER, SPIEncoder::DefaultOrder).toInt()));
+    encoder->setGamma(settings.value(SETTINGS_GAMMA, 1.0).toDouble());
+    // the brightness is stored as a percentage
+    encoder->setBrightness(qRound(settings.value(SETTINGS_BRIGHTNESS, 100).toDouble() * 2.55));
+    encoder->setDithering(settings.value(SETTINGS_DITHERING, false).toBool());
+
+    QMutexLocker locker(&m_mutex);
+    delete m_encoder;
+    m_encoder = encoder;
+    m_dataChanged = true;
+}
+
+int SPIPlugin::busSpeed()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_encoder != NULL && m_encoder->clockSpeed() != 0)
+        return m_encoder->clockSpeed();
+
+    QSettings settings;
+    QVariant value = settings.value(SETTINGS_FREQUENCY);
+    if (value.isValid() == true)
+        return value.toUInt();
+
+    return 1000000;
+}
+
 /*****************************************************************************
  * Plugin export
  ****************************************************************************/
@@ -27,6 +27,13 @@
 
 #include "qlcioplugin.h"
 
+#define SETTINGS_FREQUENCY  "SPIPlugin/frequency"
+#define SETTINGS_PROTOCOL   "SPIPlugin/protocol"
+#define SETTINGS_COLORORDER "SPIPlugin/colorOrder"
+#define SETTINGS_GAMMA      "SPIPlugin/gamma"
+#define SETTINGS_BRIGHTNESS "SPIPlugin/brightness"
+#define SETTINGS_DITHERING  "SPIPlugin/dithering"
+
 typedef struct
 {
     /** number of channels used in a universe */
@@ -40,6 +47,7 @@ typedef struct
 } SPIUniverse;
 
 class SPIOutThread;
+class SPIEncoder;
 
 class SPIPlugin : public QLCIOPlugin
 {
@@ -90,6 +98,9 @@ public:
     /** @reimp */
     void writeUniverse(quint32 universe, quint32 output, const QByteArray& data);
 
+    /** @reimp */
+    void commitFrame();
+
 protected:
     /** File handle for /dev/spidev0.0 */
     int m_spifd;
@@ -104,6 +115,20 @@ protected:
      *  transfer */
     QByteArray m_serializedData;
 
+    /** Flag raised when m_serializedData has changed since the last
+     *  frame has been encoded */
+    bool m_dataChanged;
+
+    /** Encoder of the strip protocol */
+    SPIEncoder *m_encoder;
+
+    /** The frame being encoded, while the previous one is transmitted */
+    QByteArray m_encodedData;
+
+    /** Mutex protecting the serialized data and the encoder, since
+     *  each universe writes from its own thread */
+    QMutex m_mutex;
+
     SPIOutThread *m_outThread;
 
     /*********************************************************************
@@ -118,6 +143,14 @@ public:
 
     /** @reimp */
     void setParameter(quint32 universe, quint32 line, Capability type, QString name, QVariant value);
+
+private:
+    /** Create the encoder with the protocol and corrections in the settings */
+    void setupEncoder();
+
+    /** The SPI clock speed: the one required by the protocol if any,
+     *  otherwise the configured one */
+    int busSpeed();
 };
 
 #endif
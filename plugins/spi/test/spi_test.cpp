@@ -0,0 +1,253 @@
+/*
+  Q Light Controller Plus
+  spi_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QTest>
+
+#include "spi_test.h"
+#include "spiencoder.h"
+
+static QByteArray bytes(const char *data, int size)
+{
+    return QByteArray(data, size);
+}
+
+/****************************************************************************
+ * Protocols
+ ****************************************************************************/
+
+void SPI_Test::raw()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::Raw);
+    QCOMPARE(enc->protocol(), SPIEncoder::Raw);
+    QCOMPARE(enc->clockSpeed(), 0);
+
+    QByteArray data = bytes("\x01\x02\x03\x04", 4);
+    QByteArray out;
+
+    /* The data is sent untouched, even with corrections */
+    enc->setGamma(2.2);
+    enc->setBrightness(10);
+    enc->setDithering(true);
+    QVERIFY(enc->needsRefresh() == false);
+
+    enc->encode(data, out);
+    QCOMPARE(out, data);
+
+    delete enc;
+}
+
+void SPI_Test::ws281x()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::WS281x);
+    QCOMPARE(enc->protocol(), SPIEncoder::WS281x);
+    QCOMPARE(enc->clockSpeed(), 2400000);
+
+    /* One RGB pixel and a trailing byte, which is ignored */
+    QByteArray data = bytes("\xFF\x00\x80\x42", 4);
+    QByteArray out;
+
+    enc->encode(data, out);
+
+    /* 3 wire bytes per value, then 300us of low level */
+    QCOMPARE(out.size(), 3 * 3 + 90);
+
+    /* GRB order, every bit expanded to 100 (0) or 110 (1) */
+    QCOMPARE(out.left(9), bytes("\x92\x49\x24"    // G = 0x00
+                                "\xDB\x6D\xB6"    // R = 0xFF
+                                "\xD2\x49\x24",   // B = 0x80
+                                9));
+    QCOMPARE(out.mid(9), QByteArray(90, 0));
+
+    /* The output buffer is reused with the same size */
+    const char *buffer = out.constData();
+    enc->encode(data, out);
+    QVERIFY(out.constData() == buffer);
+
+    delete enc;
+}
+
+void SPI_Test::apa102()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::APA102);
+    QCOMPARE(enc->protocol(), SPIEncoder::APA102);
+    QCOMPARE(enc->clockSpeed(), 0);
+
+    QByteArray data = bytes("\x01\x02\x03\x04\x05\x06", 6);
+    QByteArray out;
+
+    enc->encode(data, out);
+
+    /* Start frame, BGR pixel frames at full global brightness
+     * and a 32 bit end frame for short strips */
+    QCOMPARE(out, bytes("\x00\x00\x00\x00"
+                        "\xFF\x03\x02\x01"
+                        "\xFF\x06\x05\x04"
+                        "\x00\x00\x00\x00", 16));
+
+    /* Longer strips need half a clock edge per pixel */
+    enc->encode(QByteArray(100 * 3, 0), out);
+    QCOMPARE(out.size(), 4 + 100 * 4 + 7);
+    QCOMPARE(out.right(7), QByteArray(7, 0));
+
+    delete enc;
+}
+
+void SPI_Test::sk9822()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::SK9822);
+    QCOMPARE(enc->protocol(), SPIEncoder::SK9822);
+
+    QByteArray data = bytes("\x01\x02\x03\x04\x05\x06", 6);
+    QByteArray out;
+
+    enc->encode(data, out);
+
+    /* Same as APA102, with a 32 bit reset frame before the end frame */
+    QCOMPARE(out, bytes("\x00\x00\x00\x00"
+                        "\xFF\x03\x02\x01"
+                        "\xFF\x06\x05\x04"
+                        "\x00\x00\x00\x00"
+                        "\x00", 17));
+
+    enc->encode(QByteArray(100 * 3, 0), out);
+    QCOMPARE(out.size(), 4 + 100 * 4 + 4 + 7);
+
+    delete enc;
+}
+
+/****************************************************************************
+ * Color correction
+ ****************************************************************************/
+
+void SPI_Test::colorOrder()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::APA102);
+    QByteArray data = bytes("\x01\x02\x03", 3);
+    QByteArray out;
+
+    QCOMPARE(enc->colorOrder(), SPIEncoder::DefaultOrder);
+
+    enc->setColorOrder(SPIEncoder::RGB);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x01\x02\x03", 4));
+
+    enc->setColorOrder(SPIEncoder::GBR);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x02\x03\x01", 4));
+
+    enc->setColorOrder(SPIEncoder::DefaultOrder);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x03\x02\x01", 4));
+
+    delete enc;
+}
+
+void SPI_Test::gamma()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::APA102);
+    enc->setColorOrder(SPIEncoder::RGB);
+
+    QByteArray data = bytes("\x00\x80\xFF", 3);
+    QByteArray out;
+
+    /* Linear by default */
+    QCOMPARE(enc->gamma(), 1.0);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x00\x80\xFF", 4));
+
+    /* (128 / 255)^2 * 255 = 64.25 */
+    enc->setGamma(2.0);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x00\x40\xFF", 4));
+
+    /* Out of range values are clamped */
+    enc->setGamma(10.0);
+    QCOMPARE(enc->gamma(), 5.0);
+    enc->setGamma(0.0);
+    QCOMPARE(enc->gamma(), 0.1);
+
+    delete enc;
+}
+
+void SPI_Test::brightness()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::APA102);
+    enc->setColorOrder(SPIEncoder::RGB);
+
+    QByteArray data = bytes("\x00\x64\xFF", 3);
+    QByteArray out;
+
+    /* 100 * 128 / 255 = 50.2 */
+    enc->setBrightness(128);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x00\x32\x80", 4));
+
+    enc->setBrightness(300);
+    QCOMPARE(enc->brightness(), 255);
+    enc->setBrightness(-1);
+    QCOMPARE(enc->brightness(), 0);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x00\x00\x00", 4));
+
+    delete enc;
+}
+
+void SPI_Test::dithering()
+{
+    SPIEncoder *enc = SPIEncoder::create(SPIEncoder::APA102);
+    enc->setColorOrder(SPIEncoder::RGB);
+
+    /* 1 * 128 / 255 = 0.502, stored as 129/256 */
+    enc->setBrightness(128);
+
+    QByteArray data = bytes("\x01\x01\x01", 3);
+    QByteArray out;
+
+    /* Without dithering the value is rounded */
+    QVERIFY(enc->needsRefresh() == false);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x01\x01\x01", 4));
+
+    enc->setDithering(true);
+    QVERIFY(enc->needsRefresh() == true);
+
+    /* The truncated fraction is carried over to the next frame */
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x00\x00\x00", 4));
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x01\x01\x01", 4));
+
+    /* Over 256 frames the average is exactly the corrected value */
+    int sum = 1;
+    for (int i = 2; i < 256; i++)
+    {
+        enc->encode(data, out);
+        sum += uchar(out.at(5));
+    }
+    QCOMPARE(sum, 129);
+
+    /* Disabling dithering resets the error */
+    enc->setDithering(false);
+    enc->encode(data, out);
+    QCOMPARE(out.mid(4, 4), bytes("\xFF\x01\x01\x01", 4));
+
+    delete enc;
+}
+
+QTEST_MAIN(SPI_Test)
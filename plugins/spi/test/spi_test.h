@@ -0,0 +1,40 @@
+/*
+  Q Light Controller Plus
+  spi_test.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SPI_TEST_H
+#define SPI_TEST_H
+
+#include <QObject>
+
+class SPI_Test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void raw();
+    void ws281x();
+    void apa102();
+    void sk9822();
+    void colorOrder();
+    void gamma();
+    void brightness();
+    void dithering();
+};
+
+#endif
@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = spi_test
+
+QT      += core testlib
+QT      -= gui
+
+INCLUDEPATH += ..
+DEPENDPATH  += ..
+
+# Test sources
+HEADERS += spi_test.h
+
+SOURCES += spi_test.cpp \
+           ../spiencoder.cpp
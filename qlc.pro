@@ -8,6 +8,9 @@ SUBDIRS        += engine
 qmlui: {
   message("Building QLC+ 5 QML UI")
   SUBDIRS      += qmlui
+  qmluitest.subdir = qmlui/test
+  qmluitest.depends = engine
+  SUBDIRS      += qmluitest
 } else {
   message("Building QLC+ 4 QtWidget UI")
   SUBDIRS      += ui
@@ -57,12 +57,15 @@
 #include "qlcfixturedefcache.h"
 #include "audioplugincache.h"
 #include "rgbscriptscache.h"
+#include "startuptasks.h"
+#include "docsnapshot.h"
 #include "qlcfixturedef.h"
 #include "qlcconfig.h"
 #include "qlcfile.h"
 
 #define SETTINGS_WORKINGPATH "workspace/workingpath"
 #define SETTINGS_RECENTFILE "workspace/recent"
+#define SETTINGS_SNAPSHOT "workspace/snapshot"
 #define KXMLQLCWorkspaceWindow "CurrentWindow"
 
 #define MAX_RECENT_FILES    10
@@ -79,6 +82,7 @@ App::App()
     , m_videoProvider(nullptr)
     , m_doc(nullptr)
     , m_docLoaded(false)
+    , m_startupProfile(false)
     , m_printItem(nullptr)
     , m_fileName(QString())
     , m_importManager(nullptr)
@@ -155,6 +159,9 @@ void App::startup()
     connect(m_networkManager, &NetworkManager::clientAccessRequest, this, &App::slotClientAccessRequest);
     connect(m_networkManager, &NetworkManager::accessMaskChanged, this, &App::setAccessMask);
     connect(m_networkManager, &NetworkManager::requestProjectLoad, this, &App::slotLoadDocFromMemory);
+    // feed the previews with the output streamed by a server, when requested
+    connect(m_networkManager, SIGNAL(remoteUniverseWritten(quint32,QByteArray)),
+            m_contextManager, SLOT(slotUniverseWritten(quint32,QByteArray)));
 
     m_tardis = new Tardis(this, m_doc, m_networkManager, m_fixtureManager, m_functionManager,
                           m_contextManager, m_simpleDesk, m_showManager, m_virtualConsole);
@@ -370,45 +377,50 @@ void App::initDoc()
 
     connect(m_doc, SIGNAL(modified(bool)), this, SIGNAL(docModifiedChanged()));
 
-    /* Load user fixtures first so that they override system fixtures */
-    m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
-    m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
-
-    /* Load channel modifiers templates */
-    m_doc->modifiersCache()->load(QLCModifiersCache::systemTemplateDirectory(), true);
-    m_doc->modifiersCache()->load(QLCModifiersCache::userTemplateDirectory());
+    Q_ASSERT(m_doc->inputOutputMap() != nullptr);
 
-    /* Load RGB scripts */
-    m_doc->rgbScriptsCache()->load(RGBScriptsCache::systemScriptsDirectory());
-    m_doc->rgbScriptsCache()->load(RGBScriptsCache::userScriptsDirectory());
+    /* Fixture definitions, channel modifiers, RGB scripts and
+     * input profiles are loaded in background threads */
+    StartupTasks startupTasks(m_doc, m_startupProfile);
+    startupTasks.startCacheLoaders();
 
     /* Load plugins */
+    startupTasks.beginStage("I/O plugins");
 #if defined Q_OS_ANDROID
     QString pluginsPath = QString("%1/../lib").arg(QDir::currentPath());
     m_doc->ioPluginCache()->load(QDir(pluginsPath));
 #else
     m_doc->ioPluginCache()->load(IOPluginCache::systemPluginDirectory());
 #endif
+    startupTasks.endStage();
 
     /* Load audio decoder plugins
      * This doesn't use a AudioPluginCache::systemPluginDirectory() cause
      * otherwise the qlcconfig.h creation should have been moved into the
      * audio folder, which doesn't make much sense */
+    startupTasks.beginStage("Audio plugins");
     m_doc->audioPluginCache()->load(QLCFile::systemDirectory(AUDIOPLUGINDIR, KExtPlugin));
     m_videoProvider = new VideoProvider(this, m_doc);
+    startupTasks.endStage();
 
-    Q_ASSERT(m_doc->inputOutputMap() != nullptr);
-
-    /* Load input plugins & profiles */
-    m_doc->inputOutputMap()->loadProfiles(InputOutputMap::userProfileDirectory());
-    m_doc->inputOutputMap()->loadProfiles(InputOutputMap::systemProfileDirectory());
+    /* Restore outputmap settings. Patches refer to input profiles */
+    startupTasks.waitForFinished();
+    startupTasks.beginStage("I/O defaults");
     m_doc->inputOutputMap()->loadDefaults();
+    startupTasks.endStage();
+
+    startupTasks.printReport();
 
     m_doc->inputOutputMap()->setBeatGeneratorType(InputOutputMap::Internal);
     m_doc->inputOutputMap()->startUniverses();
     m_doc->masterTimer()->start();
 }
 
+void App::enableStartupProfile()
+{
+    m_startupProfile = true;
+}
+
 void App::enableKioskMode()
 {
     // enable Virtual console only
@@ -665,6 +677,28 @@ QFileDevice::FileError App::loadXML(const QString &fileName)
     if (fileName.isEmpty() == true)
         return QFile::OpenError;
 
+    /* Load the binary snapshot instead, if it is up to date
+       with the workspace file */
+    DocSnapshot snapshot;
+    if (snapshot.open(fileName) == true)
+    {
+        m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
+        if (m_doc->loadSnapshot(snapshot) == true)
+        {
+            QXmlStreamReader workspace(snapshot.workspaceXML());
+            if (loadXML(workspace) == false)
+                return QFile::ReadError;
+
+            setFileName(fileName);
+            m_doc->resetModified();
+            return QFile::NoError;
+        }
+
+        /* Drop whatever the snapshot loaded and parse the XML file */
+        qWarning() << Q_FUNC_INFO << "Unable to load the snapshot of" << fileName;
+        m_doc->clearContents();
+    }
+
     QXmlStreamReader *doc = QLCFile::getXMLReader(fileName);
     if (doc == nullptr || doc->device() == nullptr || doc->hasError())
     {
@@ -793,29 +827,7 @@ QFile::FileError App::saveXML(const QString& fileName)
     doc.writeStartDocument();
     doc.writeDTD(QString("<!DOCTYPE %1>").arg(KXMLQLCWorkspace));
 
-    doc.writeStartElement(KXMLQLCWorkspace);
-    doc.writeAttribute("xmlns", QString("%1%2").arg(KXMLQLCplusNamespace).arg(KXMLQLCWorkspace));
-
-    /* Currently active context */
-    doc.writeAttribute(KXMLQLCWorkspaceWindow, m_contextManager->currentContext());
-
-    /* Creator information */
-    doc.writeStartElement(KXMLQLCCreator);
-    doc.writeTextElement(KXMLQLCCreatorName, APPNAME);
-    doc.writeTextElement(KXMLQLCCreatorVersion, APPVERSION);
-    doc.writeTextElement(KXMLQLCCreatorAuthor, QLCFile::currentUserName());
-    doc.writeEndElement();
-
-    /* Write engine components to the XML document */
-    m_doc->saveXML(&doc);
-
-    /* Write virtual console to the XML document */
-    m_virtualConsole->saveXML(&doc);
-
-    /* Write Simple Desk to the XML document */
-    //SimpleDesk::instance()->saveXML(&doc);
-
-    doc.writeEndElement(); // close KXMLQLCWorkspace
+    saveWorkspaceXML(&doc, true);
 
     /* End the document and close all the open elements */
     doc.writeEndDocument();
@@ -834,6 +846,11 @@ QFile::FileError App::saveXML(const QString& fileName)
         return file.error();
     }
 
+    /* Write the binary snapshot next to the workspace file, if enabled */
+    QSettings settings;
+    if (settings.value(SETTINGS_SNAPSHOT, false).toBool() == true)
+        saveSnapshot(fileName);
+
     /* Set the file name for the current Doc instance and
        set it also in an unmodified state. */
     setFileName(fileName);
@@ -842,6 +859,57 @@ QFile::FileError App::saveXML(const QString& fileName)
     return QFile::NoError;
 }
 
+void App::saveWorkspaceXML(QXmlStreamWriter *doc, bool saveEngine)
+{
+    doc->writeStartElement(KXMLQLCWorkspace);
+    doc->writeAttribute("xmlns", QString("%1%2").arg(KXMLQLCplusNamespace).arg(KXMLQLCWorkspace));
+
+    /* Currently active context */
+    doc->writeAttribute(KXMLQLCWorkspaceWindow, m_contextManager->currentContext());
+
+    /* Creator information */
+    doc->writeStartElement(KXMLQLCCreator);
+    doc->writeTextElement(KXMLQLCCreatorName, APPNAME);
+    doc->writeTextElement(KXMLQLCCreatorVersion, APPVERSION);
+    doc->writeTextElement(KXMLQLCCreatorAuthor, QLCFile::currentUserName());
+    doc->writeEndElement();
+
+    /* Write engine components to the XML document */
+    if (saveEngine == true)
+        m_doc->saveXML(doc);
+
+    /* Write virtual console to the XML document */
+    m_virtualConsole->saveXML(doc);
+
+    /* Write Simple Desk to the XML document */
+    //SimpleDesk::instance()->saveXML(doc);
+
+    doc->writeEndElement(); // close KXMLQLCWorkspace
+}
+
+bool App::saveSnapshot(const QString& fileName)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    QXmlStreamWriter doc(&buffer);
+    doc.setCodec("UTF-8");
+    saveWorkspaceXML(&doc, false);
+    buffer.close();
+
+    DocSnapshot snapshot;
+    m_doc->saveSnapshot(&snapshot);
+    snapshot.setWorkspaceXML(buffer.data());
+
+    if (snapshot.save(fileName) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to save the snapshot of" << fileName;
+        return false;
+    }
+
+    return true;
+}
+
 /*********************************************************************
  * Import project
  *********************************************************************/
@@ -134,6 +134,9 @@ public:
     void enableKioskMode();
     void createKioskCloseButton(const QRect& rect);
 
+    /** Print the time spent in each startup stage */
+    void enableStartupProfile();
+
     void show();
 
     /** Return the number of pixels in 1mm */
@@ -211,6 +214,7 @@ signals:
 private:
     Doc *m_doc;
     bool m_docLoaded;
+    bool m_startupProfile;
 
     /*********************************************************************
      * Printer
@@ -275,6 +279,19 @@ public:
     QFile::FileError saveXML(const QString& fileName);
 
 private:
+    /**
+     * Write the workspace XML document. When $saveEngine is false the
+     * Engine element is omitted, since the binary snapshot stores it
+     * on its own.
+     */
+    void saveWorkspaceXML(QXmlStreamWriter *doc, bool saveEngine);
+
+    /**
+     * Write the binary snapshot of the workspace file $fileName,
+     * which must have been saved already.
+     */
+    bool saveSnapshot(const QString& fileName);
+
     /**
      * Update the list of the recently open files.
      * If filename is specified, it will be removed from the list
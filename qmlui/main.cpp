@@ -97,6 +97,10 @@ int main(int argc, char *argv[])
                                       "Disable the 3D preview.");
     parser.addOption(threedSupportOption);
 
+    QCommandLineOption startupProfileOption(QStringList() << "startup-profile",
+                                      "Print the time spent in each startup stage.");
+    parser.addOption(startupProfileOption);
+
     parser.process(app);
 
     if (!parser.isSet(threedSupportOption))
@@ -119,6 +123,9 @@ int main(int argc, char *argv[])
     if (parser.isSet(kioskOption))
         qlcplusApp.enableKioskMode();
 
+    if (parser.isSet(startupProfileOption))
+        qlcplusApp.enableStartupProfile();
+
     qlcplusApp.startup();
     qlcplusApp.show();
 
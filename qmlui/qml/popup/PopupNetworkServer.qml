@@ -131,6 +131,20 @@ CustomPopupDialog
             }
 
             // Row 6
+            RobotoText
+            {
+                height: UISettings.listItemHeight
+                label: qsTr("Dropped stream frames")
+            }
+
+            RobotoText
+            {
+                height: UISettings.listItemHeight
+                Layout.columnSpan: 2
+                label: networkManager.streamDroppedFrames
+            }
+
+            // Row 7
             Row
             {
                 Layout.columnSpan: 2
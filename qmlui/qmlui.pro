@@ -98,12 +98,14 @@ SOURCES += main.cpp \
 
 HEADERS += \
     tardis/tardis.h \
+    tardis/tardishistory.h \
     tardis/networkpacketizer.h \
     tardis/networkmanager.h \
     tardis/simplecrypt.h
 
 SOURCES += \
     tardis/tardis.cpp \
+    tardis/tardishistory.cpp \
     tardis/networkpacketizer.cpp \
     tardis/networkmanager.cpp \
     tardis/simplecrypt.cpp
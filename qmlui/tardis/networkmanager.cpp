@@ -20,11 +20,14 @@
 #include <QXmlStreamWriter>
 #include <QNetworkInterface>
 #include <QtCore/qbuffer.h>
+#include <QTimer>
 #include <QFile>
 
 #include "networkmanager.h"
 #include "networkpacketizer.h"
+#include "inputoutputmap.h"
 #include "simplecrypt.h"
+#include "universe.h"
 #include "tardis.h"
 #include "doc.h"
 
@@ -33,6 +36,19 @@
 
 #define WORKSPACE_CHUNK_SIZE    8 * 1024
 
+/* Universe stream timer resolution, and thus maximum rate */
+#define STREAM_TICK_MS              20
+#define STREAM_MAX_RATE             (1000 / STREAM_TICK_MS)
+/* Seconds between two universe stream keyframes */
+#define STREAM_KEYFRAME_SECONDS     2
+/* Maximum payload of a universe stream packet */
+#define STREAM_MAX_PACKET_SIZE      (16 * 1024)
+/* Frames are skipped when a client has more than this pending on its socket */
+#define STREAM_MAX_PENDING_BYTES    (64 * 1024)
+
+/** Rate of the universe stream requested by a client, in frames per second */
+#define STREAM_CLIENT_RATE          25
+
 static const quint64 defaultKey = 0x5131632B4E33744B; // this is "Q1c+N3tK"
 
 NetworkManager::NetworkManager(QObject *parent, Doc *doc)
@@ -42,6 +58,9 @@ NetworkManager::NetworkManager(QObject *parent, Doc *doc)
     , m_udpSocket(nullptr)
     , m_tcpServer(nullptr)
     , m_serverStarted(false)
+    , m_streamTimer(nullptr)
+    , m_streamSubscribers(0)
+    , m_streamDroppedFrames(0)
     , m_tcpSocket(nullptr)
     , m_clientStatus(Disconnected)
 {
@@ -377,6 +396,133 @@ QHostAddress NetworkManager::getHostFromName(QString name)
     return QHostAddress();
 }
 
+/*********************************************************************
+ * Universe streaming (server side)
+ *********************************************************************/
+
+quint64 NetworkManager::streamDroppedFrames() const
+{
+    return m_streamDroppedFrames;
+}
+
+void NetworkManager::setHostStreamRate(NetworkHost *host, int rate)
+{
+    rate = qBound(0, rate, STREAM_MAX_RATE);
+
+    if (host->streamRate == rate)
+        return;
+
+    if (host->streamRate == 0)
+        m_streamSubscribers++;
+    else if (rate == 0)
+        m_streamSubscribers--;
+
+    qDebug() << "Host" << host->hostName << "universe stream rate:" << rate;
+
+    host->streamRate = rate;
+    host->streamFrameCount = 0;
+    host->streamUniverses.clear();
+    host->streamTimer.invalidate();
+
+    /* Universes are cached only when written, so a new subscriber would
+     * get nothing until the next change. Seed them with their current values */
+    if (rate > 0)
+    {
+        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+        for (Universe *universe : ua)
+        {
+            if (m_streamData.contains(universe->id()) == false)
+                m_streamData[universe->id()] = *universe->postGMValues();
+        }
+        m_doc->inputOutputMap()->releaseUniverses(false);
+    }
+
+    if (m_streamSubscribers && m_streamTimer == nullptr)
+    {
+        m_streamTimer = new QTimer(this);
+        m_streamTimer->setInterval(STREAM_TICK_MS);
+        connect(m_streamTimer, &QTimer::timeout, this, &NetworkManager::slotStreamTimerTimeout);
+        connect(m_doc->inputOutputMap(), &InputOutputMap::universeWritten,
+                this, &NetworkManager::slotStreamUniverseWritten);
+        m_streamTimer->start();
+    }
+    else if (m_streamSubscribers == 0 && m_streamTimer != nullptr)
+    {
+        disconnect(m_doc->inputOutputMap(), &InputOutputMap::universeWritten,
+                   this, &NetworkManager::slotStreamUniverseWritten);
+        m_streamTimer->stop();
+        delete m_streamTimer;
+        m_streamTimer = nullptr;
+        m_streamData.clear();
+    }
+}
+
+void NetworkManager::sendStreamFrame(NetworkHost *host)
+{
+    bool keyFrame = (host->streamFrameCount % (host->streamRate * STREAM_KEYFRAME_SECONDS)) == 0;
+    QByteArray packet;
+
+    m_packetizer->initializePacket(packet, Tardis::NetUniverseData);
+
+    for (auto it = m_streamData.constBegin(); it != m_streamData.constEnd(); ++it)
+    {
+        QByteArray &lastSent = host->streamUniverses[it.key()];
+
+        if (keyFrame == false && lastSent == it.value())
+            continue;
+
+        QByteArray delta = NetworkPacketizer::encodeUniverseDelta(lastSent, it.value(), keyFrame);
+
+        /* Flush the packet before it gets too big. The sections number is an 8 bit field */
+        if (packet.length() + delta.length() > STREAM_MAX_PACKET_SIZE || quint8(packet.at(4)) >= 254)
+        {
+            sendTCPPacket(host->tcpSocket, packet, m_encryptPackets);
+            m_packetizer->initializePacket(packet, Tardis::NetUniverseData);
+        }
+
+        m_packetizer->addSection(packet, QVariant(int(it.key())));
+        m_packetizer->addSection(packet, QVariant(delta));
+        lastSent = it.value();
+    }
+
+    if (packet.at(4) != 0)
+        sendTCPPacket(host->tcpSocket, packet, m_encryptPackets);
+
+    host->streamFrameCount++;
+}
+
+void NetworkManager::slotStreamUniverseWritten(quint32 index, const QByteArray &data)
+{
+    m_streamData[index] = data;
+}
+
+void NetworkManager::slotStreamTimerTimeout()
+{
+    for (NetworkHost *host : m_hostsMap.values())
+    {
+        if (host->streamRate == 0 || host->isAuthenticated == false || host->tcpSocket == nullptr)
+            continue;
+
+        /* Half a tick of tolerance, to absorb the timer jitter */
+        if (host->streamTimer.isValid() &&
+            host->streamTimer.elapsed() + STREAM_TICK_MS / 2 < 1000 / host->streamRate)
+            continue;
+
+        host->streamTimer.start();
+
+        /* Don't pile up frames on a slow link. Since deltas are computed against
+         * what has been actually sent, the next frame will catch up */
+        if (host->tcpSocket->bytesToWrite() > STREAM_MAX_PENDING_BYTES)
+        {
+            m_streamDroppedFrames++;
+            emit streamDroppedFramesChanged();
+            continue;
+        }
+
+        sendStreamFrame(host);
+    }
+}
+
 /*********************************************************************
  * Client
  *********************************************************************/
@@ -473,6 +619,21 @@ bool NetworkManager::disconnectClient()
     return true;
 }
 
+bool NetworkManager::requestUniverseStream(int rate)
+{
+    if (m_hostType != ClientHostType || m_tcpSocket == nullptr)
+        return false;
+
+    if (rate == 0)
+        m_remoteUniverses.clear();
+
+    QByteArray packet;
+    m_packetizer->initializePacket(packet, Tardis::NetUniverseSubscribe);
+    m_packetizer->addSection(packet, QVariant(rate));
+
+    return sendTCPPacket(m_tcpSocket, packet, m_encryptPackets);
+}
+
 QVariant NetworkManager::serverList() const
 {
     QVariantList serverList;
@@ -503,6 +664,11 @@ void NetworkManager::setClientStatus(int clientStatus)
 
     m_clientStatus = clientStatus;
     emit clientStatusChanged(m_clientStatus);
+
+    if (m_clientStatus == Connected)
+        requestUniverseStream(STREAM_CLIENT_RATE);
+    else if (m_clientStatus == Disconnected)
+        m_remoteUniverses.clear();
 }
 
 void NetworkManager::slotProcessUDPPackets()
@@ -675,6 +841,38 @@ void NetworkManager::slotProcessTCPPackets()
             }
             break;
 
+            case Tardis::NetUniverseSubscribe:
+            {
+                NetworkHost *host = m_hostsMap.value(senderAddress, nullptr);
+                if (m_hostType != ServerHostType || host == nullptr ||
+                    host->isAuthenticated == false || paramsList.isEmpty())
+                    break;
+
+                setHostStreamRate(host, paramsList.at(0).toInt());
+            }
+            break;
+            case Tardis::NetUniverseData:
+            {
+                if (m_hostType != ClientHostType)
+                    break;
+
+                /* sections come in pairs of universe index and delta */
+                for (int i = 0; i + 1 < paramsList.count(); i += 2)
+                {
+                    quint32 index = paramsList.at(i).toUInt();
+                    QByteArray &data = m_remoteUniverses[index];
+
+                    if (NetworkPacketizer::applyUniverseDelta(paramsList.at(i + 1).toByteArray(), data) == false)
+                    {
+                        qDebug() << "Invalid delta received for universe" << index;
+                        continue;
+                    }
+
+                    emit remoteUniverseWritten(index, data);
+                }
+            }
+            break;
+
             default:
             {
                 if (paramsList.count() == 2)
@@ -705,6 +903,7 @@ void NetworkManager::slotProcessNewTCPConnection()
         NetworkHost *host = m_hostsMap[senderAddress];
         host->isAuthenticated = false;
         host->tcpSocket = clientConnection;
+        setHostStreamRate(host, 0);
     }
     else
     {
@@ -712,6 +911,8 @@ void NetworkManager::slotProcessNewTCPConnection()
         NetworkHost *newHost = new NetworkHost;
         newHost->isAuthenticated = false;
         newHost->tcpSocket = clientConnection;
+        newHost->streamRate = 0;
+        newHost->streamFrameCount = 0;
         m_hostsMap[senderAddress] = newHost;
         emit connectionsCountChanged();
     }
@@ -728,6 +929,7 @@ void NetworkManager::slotHostDisconnected()
     if (m_hostsMap.contains(senderAddress) == true)
     {
         NetworkHost *host = m_hostsMap.take(senderAddress);
+        setHostStreamRate(host, 0);
         delete host;
         emit connectionsCountChanged();
     }
@@ -27,12 +27,14 @@
 #include <QTcpSocket>
 #include <QTcpServer>
 #include <QUdpSocket>
+#include <QElapsedTimer>
 #include <QThread>
 #include <QHash>
 
 #include "tardis.h"
 
 class Doc;
+class QTimer;
 class SimpleCrypt;
 class NetworkPacketizer;
 
@@ -44,6 +46,14 @@ typedef struct
     QString hostName;
     /** The TCP socket for unicast client/server communication */
     QTcpSocket *tcpSocket;
+    /** The universe stream frames per second requested by the host. 0 means disabled */
+    int streamRate;
+    /** Time elapsed since the last universe stream frame sent to the host */
+    QElapsedTimer streamTimer;
+    /** The universe stream frames sent since the last keyframe */
+    int streamFrameCount;
+    /** The universe data last sent to the host, used to compute deltas */
+    QHash<quint32, QByteArray> streamUniverses;
 } NetworkHost;
 
 class NetworkManager : public QObject
@@ -55,6 +65,7 @@ class NetworkManager : public QObject
     Q_PROPERTY(QVariant serverList READ serverList NOTIFY serverListChanged)
     Q_PROPERTY(int clientStatus READ clientStatus WRITE setClientStatus NOTIFY clientStatusChanged)
     Q_PROPERTY(int connectionsCount READ connectionsCount NOTIFY connectionsCountChanged)
+    Q_PROPERTY(quint64 streamDroppedFrames READ streamDroppedFrames NOTIFY streamDroppedFramesChanged)
 
 public:
     explicit NetworkManager(QObject *parent = nullptr, Doc *doc = nullptr);
@@ -154,6 +165,41 @@ private:
     /** Map of the QLC+ hosts detected on the network */
     QHash<QHostAddress, NetworkHost *> m_hostsMap;
 
+    /*********************************************************************
+     * Universe streaming (server side)
+     *********************************************************************/
+public:
+    /** Get the number of universe stream frames not sent
+     *  to a client because its connection was busy */
+    quint64 streamDroppedFrames() const;
+
+protected:
+    /** Update the stream subscription of $host to $rate frames per second */
+    void setHostStreamRate(NetworkHost *host, int rate);
+
+    /** Send a universe stream frame to $host, with deltas of all the
+     *  universes changed since the previous frame */
+    void sendStreamFrame(NetworkHost *host);
+
+protected slots:
+    void slotStreamUniverseWritten(quint32 index, const QByteArray& data);
+    void slotStreamTimerTimeout();
+
+signals:
+    void streamDroppedFramesChanged();
+
+private:
+    /** The latest data written to each universe */
+    QHash<quint32, QByteArray> m_streamData;
+
+    /** Timer driving the universe stream frames */
+    QTimer *m_streamTimer;
+
+    /** Number of hosts currently subscribed to the universe stream */
+    int m_streamSubscribers;
+
+    quint64 m_streamDroppedFrames;
+
     /*********************************************************************
      * Client
      *********************************************************************/
@@ -173,7 +219,13 @@ public:
 
     QVariant serverList() const;
 
-    /** Get/Set the connection status of a QLC+ client instance */
+    /** Ask the server to stream its universes output at $rate frames
+     *  per second. A $rate of 0 stops the stream */
+    Q_INVOKABLE bool requestUniverseStream(int rate);
+
+    /** Get/Set the connection status of a QLC+ client instance.
+     *  Once connected, the client requests the universe stream
+     *  of the server, to preview its output */
     int clientStatus() const;
     void setClientStatus(int clientStatus);
 
@@ -183,6 +235,9 @@ signals:
     void accessMaskChanged(int mask);
     void requestProjectLoad(QByteArray &data);
 
+    /** Signal emitted when a universe streamed by the server has been updated */
+    void remoteUniverseWritten(quint32 index, const QByteArray& data);
+
 private:
     /** The socket used to send/receive unicast TCP packets */
     QTcpSocket *m_tcpSocket;
@@ -196,6 +251,9 @@ private:
     /** Project transfer variables */
     QByteArray m_projectData;
     int m_projectSize;
+
+    /** Universes data received through the universe stream */
+    QHash<quint32, QByteArray> m_remoteUniverses;
 };
 
 #endif /* NETWORKMANAGER_H */
@@ -28,6 +28,17 @@
 #include "scenevalue.h"
 #include "tardis.h"
 
+/* Universe delta flags */
+#define DELTA_KEYFRAME      0x01
+/* Length bit marking a run of identical values */
+#define DELTA_RUN_FLAG      0x8000
+/* Unchanged bytes that can be merged into a changed range,
+ * since a new range would cost as much as the record header */
+#define DELTA_MERGE_GAP     4
+/* Minimum length of a run of identical values worth encoding as such */
+#define DELTA_MIN_RUN       4
+#define DELTA_RECORD_HEADER 4
+
 NetworkPacketizer::NetworkPacketizer()
 {
 }
@@ -433,3 +444,144 @@ int NetworkPacketizer::decodePacket(QByteArray &packet, int &opCode, QVariantLis
 
     return HEADER_LENGTH + sections_length;
 }
+
+/*********************************************************************
+ * Universe delta streaming
+ *********************************************************************/
+
+static void appendDeltaRecord(QByteArray &delta, int offset, int length, bool run)
+{
+    quint16 lenField = quint16(length) | (run ? DELTA_RUN_FLAG : 0);
+    delta.append((char)(offset >> 8));      // offset MSB
+    delta.append((char)(offset & 0x00FF));  // offset LSB
+    delta.append((char)(lenField >> 8));    // length MSB
+    delta.append((char)(lenField & 0x00FF)); // length LSB
+}
+
+static void encodeDeltaRange(QByteArray &delta, const char *data, int start, int end)
+{
+    int literalStart = start;
+    int i = start;
+
+    while (i < end)
+    {
+        int runEnd = i + 1;
+        while (runEnd < end && data[runEnd] == data[i])
+            runEnd++;
+
+        if (runEnd - i >= DELTA_MIN_RUN)
+        {
+            if (i > literalStart)
+            {
+                appendDeltaRecord(delta, literalStart, i - literalStart, false);
+                delta.append(data + literalStart, i - literalStart);
+            }
+            appendDeltaRecord(delta, i, runEnd - i, true);
+            delta.append(data[i]);
+            literalStart = runEnd;
+        }
+        i = runEnd;
+    }
+
+    if (end > literalStart)
+    {
+        appendDeltaRecord(delta, literalStart, end - literalStart, false);
+        delta.append(data + literalStart, end - literalStart);
+    }
+}
+
+QByteArray NetworkPacketizer::encodeUniverseDelta(const QByteArray &previous,
+                                                  const QByteArray &current, bool keyFrame)
+{
+    QByteArray delta;
+    int size = current.length();
+
+    if (previous.length() != size)
+        keyFrame = true;
+
+    delta.append(keyFrame ? (char)DELTA_KEYFRAME : (char)0x00); // flags
+    delta.append((char)(size >> 8));     // universe size MSB
+    delta.append((char)(size & 0x00FF)); // universe size LSB
+
+    const char *cur = current.constData();
+
+    if (keyFrame)
+    {
+        encodeDeltaRange(delta, cur, 0, size);
+        return delta;
+    }
+
+    const char *prev = previous.constData();
+    int i = 0;
+
+    while (i < size)
+    {
+        if (cur[i] == prev[i])
+        {
+            i++;
+            continue;
+        }
+
+        /* Extend the changed range, merging small unchanged gaps */
+        int start = i;
+        int end = i + 1;
+        for (int j = end; j < size && j - end < DELTA_MERGE_GAP; j++)
+        {
+            if (cur[j] != prev[j])
+                end = j + 1;
+        }
+
+        encodeDeltaRange(delta, cur, start, end);
+        i = end;
+    }
+
+    return delta;
+}
+
+bool NetworkPacketizer::applyUniverseDelta(const QByteArray &delta, QByteArray &universe)
+{
+    if (delta.length() < 3)
+        return false;
+
+    bool keyFrame = (quint8)delta.at(0) & DELTA_KEYFRAME;
+    int size = ((quint8)delta.at(1) << 8) + (quint8)delta.at(2);
+
+    if (universe.length() != size)
+    {
+        /* A delta can't be applied to data of a different size */
+        if (keyFrame == false)
+            return false;
+        universe.fill(0, size);
+    }
+
+    char *data = universe.data();
+    int bytes_read = 3;
+
+    while (bytes_read + DELTA_RECORD_HEADER <= delta.length())
+    {
+        int offset = ((quint8)delta.at(bytes_read) << 8) + (quint8)delta.at(bytes_read + 1);
+        quint16 lenField = ((quint8)delta.at(bytes_read + 2) << 8) + (quint8)delta.at(bytes_read + 3);
+        int length = lenField & ~DELTA_RUN_FLAG;
+        bytes_read += DELTA_RECORD_HEADER;
+
+        if (offset + length > size)
+            return false;
+
+        if (lenField & DELTA_RUN_FLAG)
+        {
+            if (bytes_read >= delta.length())
+                return false;
+            memset(data + offset, delta.at(bytes_read), length);
+            bytes_read++;
+        }
+        else
+        {
+            if (bytes_read + length > delta.length())
+                return false;
+            memcpy(data + offset, delta.constData() + bytes_read, length);
+            bytes_read += length;
+        }
+    }
+
+    return bytes_read == delta.length();
+}
@@ -56,6 +56,21 @@ public:
     QByteArray encryptPacket(QByteArray &packet, SimpleCrypt *crypter);
     int decodePacket(QByteArray &packet, int &opCode, QVariantList &sections, SimpleCrypt *decrypter);
 
+    /**
+     * Encode the changes between $previous and $current universe data
+     * as a compact binary delta. Changed ranges are run-length encoded.
+     * When $keyFrame is true, or the sizes don't match, the whole
+     * $current data is encoded.
+     */
+    static QByteArray encodeUniverseDelta(const QByteArray &previous,
+                                          const QByteArray &current, bool keyFrame);
+
+    /**
+     * Apply a delta produced by encodeUniverseDelta to $universe.
+     * Returns false if the delta is malformed or cannot be applied
+     */
+    static bool applyUniverseDelta(const QByteArray &delta, QByteArray &universe);
+
 private:
 
 };
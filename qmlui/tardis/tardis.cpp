@@ -19,6 +19,7 @@
 
 #include <QMutexLocker>
 #include <QXmlStreamReader>
+#include <QSettings>
 #include <QtCore/qbuffer.h>
 
 #include "tardis.h"
@@ -52,6 +53,12 @@
 #define TARDIS_ACTION_INTERTIME     150
 /* The maximum number of action a Tardis can hold */
 #define TARDIS_MAX_ACTIONS_NUMBER   100
+/* The maximum number of single actions the history ring can hold */
+#define TARDIS_HISTORY_CAPACITY     4096
+/* The default memory cap of the history, in bytes */
+#define TARDIS_HISTORY_MEMORY_LIMIT (32 * 1024 * 1024)
+
+#define SETTINGS_TARDIS_MEMORY_LIMIT "tardis/memorylimit"
 
 Tardis* Tardis::s_instance = nullptr;
 
@@ -69,6 +76,8 @@ Tardis::Tardis(QQuickView *view, Doc *doc, NetworkManager *netMgr,
     , m_simpleDesk(sDesk)
     , m_showManager(showMgr)
     , m_virtualConsole(vc)
+    , m_history(TARDIS_HISTORY_CAPACITY)
+    , m_historyMemoryLimit(TARDIS_HISTORY_MEMORY_LIMIT)
     , m_historyIndex(-1)
     , m_historyCount(0)
     , m_busy(false)
@@ -78,6 +87,11 @@ Tardis::Tardis(QQuickView *view, Doc *doc, NetworkManager *netMgr,
 
     qRegisterMetaType<TardisAction>();
 
+    QSettings settings;
+    QVariant value = settings.value(SETTINGS_TARDIS_MEMORY_LIMIT);
+    if (value.isValid())
+        m_historyMemoryLimit.storeRelease(value.toLongLong());
+
     m_uptime.start();
 
     connect(m_networkManager, &NetworkManager::actionReady, this, &Tardis::slotProcessNetworkAction);
@@ -129,16 +143,16 @@ QString Tardis::actionToString(int action)
 
 void Tardis::undoAction()
 {
-    if (m_historyIndex == -1 || m_history.isEmpty())
+    if (m_historyIndex == -1 || m_history.size() == 0)
         return;
 
     m_busy = true;
 
-    quint64 refTimestamp = m_history.at(m_historyIndex).m_timestamp;
+    quint64 refTimestamp = m_history.item(m_historyIndex).m_action.m_timestamp;
 
     while (1)
     {
-        TardisAction action = m_history.at(m_historyIndex);
+        TardisAction action = m_history.action(m_historyIndex);
 
         if (refTimestamp - action.m_timestamp > TARDIS_ACTION_INTERTIME)
             break;
@@ -163,20 +177,20 @@ void Tardis::undoAction()
 
 void Tardis::redoAction()
 {
-    if (m_history.isEmpty() || m_historyIndex == m_history.count() - 1)
+    if (m_history.size() == 0 || m_historyIndex == m_history.size() - 1)
         return;
 
     bool done = false;
 
     m_busy = true;
 
-    quint64 refTimestamp = m_history.at(m_historyIndex + 1).m_timestamp;
+    quint64 refTimestamp = m_history.item(m_historyIndex + 1).m_action.m_timestamp;
 
     while (!done)
     {
         m_historyIndex++;
 
-        TardisAction action = m_history.at(m_historyIndex);
+        TardisAction action = m_history.action(m_historyIndex);
         qDebug() << "Redo action" << actionToString(action.m_action);
 
         int code = processAction(action, false);
@@ -185,7 +199,7 @@ void Tardis::redoAction()
         forwardActionToNetwork(code, action);
 
         /* Check if I am processing a batch of actions or a single one */
-        if (m_historyIndex == m_history.count() - 1 ||
+        if (m_historyIndex == m_history.size() - 1 ||
             action.m_timestamp - refTimestamp > TARDIS_ACTION_INTERTIME)
         {
             done = true;
@@ -200,6 +214,42 @@ void Tardis::redoAction()
 void Tardis::resetHistory()
 {
     m_history.clear();
+    m_historyIndex = -1;
+    m_historyCount = 0;
+}
+
+qint64 Tardis::historyMemoryLimit() const
+{
+    return m_historyMemoryLimit.loadAcquire();
+}
+
+void Tardis::setHistoryMemoryLimit(qint64 limit)
+{
+    m_historyMemoryLimit.storeRelease(limit);
+
+    QSettings settings;
+    settings.setValue(SETTINGS_TARDIS_MEMORY_LIMIT, limit);
+}
+
+qint64 Tardis::historyMemoryUsage() const
+{
+    return m_history.memoryUsage();
+}
+
+/*********************************************************************
+ * History storage
+ *********************************************************************/
+
+void Tardis::historyDropOldestBatch()
+{
+    int dropped = m_history.dropOldestBatch(TARDIS_ACTION_INTERTIME);
+    if (dropped == 0)
+        return;
+
+    m_historyIndex = qMax(-1, m_historyIndex - dropped);
+
+    if (m_historyCount > 0)
+        m_historyCount--;
 }
 
 void Tardis::forwardActionToNetwork(int code, TardisAction &action)
@@ -246,62 +296,71 @@ void Tardis::run()
         /* If the history index is halfway, it means I need to remove
          * all the actions after the last undo operation before
          * pushing a new one */
-        if (m_historyIndex >= 0 && m_historyIndex != m_history.count())
+        if (m_historyIndex < m_history.size() - 1)
         {
-            int count = m_history.count();
-            qint64 refTimestamp = m_history.last().m_timestamp;
+            qint64 refTimestamp = m_history.item(m_history.size() - 1).m_action.m_timestamp;
+            m_historyCount--;
 
-            for (int i = m_historyIndex + 1; i < count; i++)
+            for (int i = m_history.size() - 1; i > m_historyIndex; i--)
             {
-                if (refTimestamp - m_history.last().m_timestamp > TARDIS_ACTION_INTERTIME)
+                if (refTimestamp - m_history.item(i).m_action.m_timestamp > TARDIS_ACTION_INTERTIME)
                 {
-                    refTimestamp = m_history.last().m_timestamp;
+                    refTimestamp = m_history.item(i).m_action.m_timestamp;
                     m_historyCount--;
                 }
-                m_history.removeLast();
-
             }
+            m_history.truncate(m_historyIndex + 1);
         }
 
-        if (m_history.count())
+        /* Look for a recent action on the same object to merge with */
+        int i = m_history.lastIndexOf(action.m_action, action.m_objID);
+        if (i >= 0)
         {
-            // scan history from the last item to find a match
-            for (int i = m_history.count() - 1; i >= 0; i--)
+            const TardisHistory::Item &item = m_history.item(i);
+
+            if (action.m_timestamp - item.m_action.m_timestamp <= TARDIS_ACTION_INTERTIME)
             {
-                if (action.m_timestamp - m_history.at(i).m_timestamp > TARDIS_ACTION_INTERTIME)
-                    break;
+                QVariant lastValue = item.m_action.m_newValue;
+                if (item.m_packed & TardisHistory::NewPacked)
+                    lastValue = qUncompress(lastValue.toByteArray());
 
-                if (action.m_action == m_history.at(i).m_action &&
-                    action.m_objID == m_history.at(i).m_objID &&
-                    action.m_oldValue == m_history.at(i).m_newValue)
+                if (action.m_oldValue == lastValue)
                 {
-                    qDebug() << "Found match at" << i << action.m_oldValue << m_history.at(i).m_newValue;
-                    action.m_oldValue = m_history.at(i).m_oldValue;
-                    m_history.replace(i, action);
+                    qDebug() << "Found match at" << i << action.m_oldValue << lastValue;
+                    TardisHistory::Item merged = TardisHistory::packAction(action);
+                    merged.m_action.m_oldValue = item.m_action.m_oldValue;
+                    merged.m_packed = (merged.m_packed & ~TardisHistory::OldPacked) |
+                                      (item.m_packed & TardisHistory::OldPacked);
+                    TardisHistory::updateSize(merged);
+
+                    m_history.replace(i, merged);
                     match = true;
-                    break;
                 }
             }
         }
 
-        if (m_history.isEmpty() || action.m_timestamp - m_history.last().m_timestamp > TARDIS_ACTION_INTERTIME)
+        if (m_history.size() == 0 || action.m_timestamp - m_history.item(m_history.size() - 1).m_action.m_timestamp > TARDIS_ACTION_INTERTIME)
             m_historyCount++;
 
         if (match == false)
-            m_history.append(action);
-
-        /* So long and thanks for all the fish */
-        if (m_historyCount > TARDIS_MAX_ACTIONS_NUMBER)
         {
-            qint64 refTimestamp = m_history.first().m_timestamp;
-            while (m_history.first().m_timestamp - refTimestamp < TARDIS_ACTION_INTERTIME)
-                m_history.removeFirst();
-            m_historyCount = TARDIS_MAX_ACTIONS_NUMBER;
+            /* Make room in the ring, if needed */
+            while (m_history.isFull())
+                historyDropOldestBatch();
+
+            m_history.append(TardisHistory::packAction(action));
         }
 
-        m_historyIndex = m_history.count() - 1;
+        /* So long and thanks for all the fish */
+        qint64 memoryLimit = m_historyMemoryLimit.loadAcquire();
+        while (m_historyCount > 1 &&
+               (m_historyCount > TARDIS_MAX_ACTIONS_NUMBER || m_history.memoryUsage() > memoryLimit))
+            historyDropOldestBatch();
+
+        m_historyIndex = m_history.size() - 1;
 
-        qDebug("Got action: 0x%02X, history length: %d (%d)", action.m_action, m_historyCount, m_history.count());
+        qDebug("Got action: 0x%02X, history length: %d (%d), memory: %lld", action.m_action,
+               m_historyCount, m_history.size(), m_history.memoryUsage());
 
         /* If there are active network connections, send the action there too */
         forwardActionToNetwork(action.m_action, action);
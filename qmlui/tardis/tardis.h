@@ -24,10 +24,13 @@
 #include <QQueue>
 #include <QMutex>
 #include <QVariant>
+#include <QAtomicInteger>
 #include <QSemaphore>
 #include <QQuickView>
 #include <QElapsedTimer>
 
+#include "tardishistory.h"
+
 class FixtureManager;
 class FunctionManager;
 class ContextManager;
@@ -37,17 +40,6 @@ class ShowManager;
 class SimpleDesk;
 class Doc;
 
-typedef struct
-{
-    int m_action;
-    quint64 m_timestamp;
-    quint32  m_objID;
-    QVariant m_oldValue;
-    QVariant m_newValue;
-} TardisAction;
-
-Q_DECLARE_METATYPE(TardisAction)
-
 typedef QPair<quint32, uint> UIntPair;
 Q_DECLARE_METATYPE(UIntPair)
 
@@ -187,7 +179,9 @@ public:
         NetAuthenticationReply,
         NetPoll,
         NetPollReply,
-        NetProjectTransfer
+        NetProjectTransfer,
+        NetUniverseSubscribe,
+        NetUniverseData
     };
 
     Q_ENUM(ActionCodes)
@@ -221,6 +215,14 @@ public:
     /** Reset the actions history */
     void resetHistory();
 
+    /** Get/Set the maximum amount of memory in bytes the history can use.
+     *  When exceeded, the oldest batches of actions are discarded */
+    qint64 historyMemoryLimit() const;
+    void setHistoryMemoryLimit(qint64 limit);
+
+    /** Get the approximate amount of memory in bytes used by the history */
+    qint64 historyMemoryUsage() const;
+
     void forwardActionToNetwork(int code, TardisAction &action);
 
     /** @reimp */
@@ -230,6 +232,9 @@ protected:
     QString actionToString(int action);
     bool processBufferedAction(int action, quint32 objID, QVariant &value);
 
+    /** Discard the oldest batch of actions from history */
+    void historyDropOldestBatch();
+
 protected slots:
     void slotProcessNetworkAction(int code, quint32 id, QVariant value);
 
@@ -270,7 +275,11 @@ private:
     QSemaphore m_queueSem;
 
     /** The actual history of actions */
-    QList<TardisAction> m_history;
+    TardisHistory m_history;
+
+    /** Memory cap of the history values, in bytes. Set from the
+     *  UI thread and read by the Tardis thread */
+    QAtomicInteger<qint64> m_historyMemoryLimit;
 
     /** An index pointing to the history last
      *  undone action or the last item */
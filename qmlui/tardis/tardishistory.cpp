@@ -0,0 +1,224 @@
+/*
+  Q Light Controller Plus
+  tardishistory.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QByteArray>
+
+#include "tardishistory.h"
+
+/* Buffered values bigger than this are stored compressed */
+#define TARDIS_COMPRESS_THRESHOLD   1024
+
+TardisHistory::TardisHistory(int capacity)
+    : m_head(0)
+    , m_size(0)
+    , m_firstSeq(0)
+    , m_memory(0)
+{
+    Q_ASSERT(capacity > 0);
+    m_items.resize(capacity);
+}
+
+/*********************************************************************
+ * Items
+ *********************************************************************/
+
+static qint64 variantSize(const QVariant &value)
+{
+    switch (value.type())
+    {
+        case QVariant::ByteArray:
+            return value.toByteArray().size();
+        case QVariant::String:
+            return value.toString().size() * int(sizeof(QChar));
+        default:
+            return 0;
+    }
+}
+
+static bool packValue(QVariant &value)
+{
+    if (value.type() != QVariant::ByteArray)
+        return false;
+
+    QByteArray data = value.toByteArray();
+    if (data.size() < TARDIS_COMPRESS_THRESHOLD)
+        return false;
+
+    value = qCompress(data);
+    return true;
+}
+
+TardisHistory::Item TardisHistory::packAction(const TardisAction &action)
+{
+    Item item;
+    item.m_action = action;
+    item.m_packed = 0;
+
+    if (packValue(item.m_action.m_oldValue))
+        item.m_packed |= OldPacked;
+    if (packValue(item.m_action.m_newValue))
+        item.m_packed |= NewPacked;
+
+    updateSize(item);
+
+    return item;
+}
+
+void TardisHistory::updateSize(Item &item)
+{
+    item.m_size = qint64(sizeof(Item)) +
+                  variantSize(item.m_action.m_oldValue) +
+                  variantSize(item.m_action.m_newValue);
+}
+
+/*********************************************************************
+ * Ring buffer
+ *********************************************************************/
+
+int TardisHistory::size() const
+{
+    return m_size;
+}
+
+int TardisHistory::capacity() const
+{
+    return m_items.size();
+}
+
+bool TardisHistory::isFull() const
+{
+    return m_size == m_items.size();
+}
+
+qint64 TardisHistory::memoryUsage() const
+{
+    return m_memory;
+}
+
+int TardisHistory::position(int index) const
+{
+    return (m_head + index) % m_items.size();
+}
+
+quint64 TardisHistory::key(int action, quint32 objID)
+{
+    return (quint64(quint32(action)) << 32) | objID;
+}
+
+const TardisHistory::Item &TardisHistory::item(int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_size);
+    return m_items.at(position(index));
+}
+
+TardisAction TardisHistory::action(int index) const
+{
+    const Item &it = item(index);
+    TardisAction action = it.m_action;
+
+    if (it.m_packed & OldPacked)
+        action.m_oldValue = qUncompress(action.m_oldValue.toByteArray());
+    if (it.m_packed & NewPacked)
+        action.m_newValue = qUncompress(action.m_newValue.toByteArray());
+
+    return action;
+}
+
+void TardisHistory::replace(int index, const Item &item)
+{
+    Q_ASSERT(index >= 0 && index < m_size);
+    Item &old = m_items[position(index)];
+
+    unindex(index);
+    m_memory += item.m_size - old.m_size;
+    old = item;
+    m_lookup[key(item.m_action.m_action, item.m_action.m_objID)] = m_firstSeq + quint64(index);
+}
+
+int TardisHistory::lastIndexOf(int action, quint32 objID) const
+{
+    QHash<quint64, quint64>::const_iterator it = m_lookup.constFind(key(action, objID));
+    if (it == m_lookup.constEnd())
+        return -1;
+
+    return int(it.value() - m_firstSeq);
+}
+
+void TardisHistory::append(const Item &item)
+{
+    Q_ASSERT(isFull() == false);
+
+    m_items[position(m_size)] = item;
+    m_lookup[key(item.m_action.m_action, item.m_action.m_objID)] = m_firstSeq + quint64(m_size);
+    m_size++;
+    m_memory += item.m_size;
+}
+
+void TardisHistory::unindex(int index)
+{
+    const Item &it = m_items.at(position(index));
+    quint64 k = key(it.m_action.m_action, it.m_action.m_objID);
+    if (m_lookup.value(k) == m_firstSeq + quint64(index))
+        m_lookup.remove(k);
+}
+
+void TardisHistory::truncate(int index)
+{
+    while (m_size > index)
+    {
+        unindex(m_size - 1);
+
+        Item &it = m_items[position(m_size - 1)];
+        m_memory -= it.m_size;
+        it = Item();
+        m_size--;
+    }
+}
+
+int TardisHistory::dropOldestBatch(quint64 interTime)
+{
+    if (m_size == 0)
+        return 0;
+
+    quint64 refTimestamp = item(0).m_action.m_timestamp;
+    int dropped = 0;
+
+    while (m_size && m_items.at(m_head).m_action.m_timestamp - refTimestamp < interTime)
+    {
+        unindex(0);
+
+        Item &it = m_items[m_head];
+        m_memory -= it.m_size;
+        it = Item();
+        m_head = (m_head + 1) % m_items.size();
+        m_size--;
+        m_firstSeq++;
+        dropped++;
+    }
+
+    return dropped;
+}
+
+void TardisHistory::clear()
+{
+    truncate(0);
+    m_head = 0;
+    m_lookup.clear();
+    m_memory = 0;
+}
@@ -0,0 +1,141 @@
+/*
+  Q Light Controller Plus
+  tardishistory.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef TARDISHISTORY_H
+#define TARDISHISTORY_H
+
+#include <QVector>
+#include <QHash>
+#include <QVariant>
+
+typedef struct
+{
+    int m_action;
+    quint64 m_timestamp;
+    quint32  m_objID;
+    QVariant m_oldValue;
+    QVariant m_newValue;
+} TardisAction;
+
+Q_DECLARE_METATYPE(TardisAction)
+
+/**
+ * The history of the Tardis actions, as a ring buffer of fixed capacity.
+ * Items are addressed by their logical index, from 0 (the oldest)
+ * to size() - 1 (the latest), and the latest item of each
+ * (action, object) pair is indexed for O(1) actions coalescing.
+ */
+class TardisHistory
+{
+public:
+    TardisHistory(int capacity);
+
+    /** An action stored in history. Large buffered values are
+     *  kept compressed until the action is undone/redone */
+    typedef struct
+    {
+        TardisAction m_action;
+        /** Bitmask of the compressed values (OldPacked | NewPacked) */
+        int m_packed;
+        /** Approximate memory used by the action values, in bytes */
+        qint64 m_size;
+    } Item;
+
+    enum PackFlags
+    {
+        OldPacked = (1 << 0),
+        NewPacked = (1 << 1)
+    };
+
+    /** Build a history item out of $action, compressing large values */
+    static Item packAction(const TardisAction &action);
+
+    /** Update the memory size of $item after its values have changed */
+    static void updateSize(Item &item);
+
+    /** Return the number of items in history */
+    int size() const;
+
+    /** Return the maximum number of items the history can hold */
+    int capacity() const;
+
+    /** Return true if there is no room for another item */
+    bool isFull() const;
+
+    /** Return the approximate amount of memory used by the items, in bytes */
+    qint64 memoryUsage() const;
+
+    /** Return the history item at the logical $index */
+    const Item &item(int index) const;
+
+    /** Return a copy of the action at the logical $index,
+     *  with its values decompressed */
+    TardisAction action(int index) const;
+
+    /** Replace the item at the logical $index with $item */
+    void replace(int index, const Item &item);
+
+    /** Return the logical index of the latest item holding $action
+     *  on $objID, or -1 if there is no such item in history */
+    int lastIndexOf(int action, quint32 objID) const;
+
+    /** Append a new item at the end of the history.
+     *  The history must not be full */
+    void append(const Item &item);
+
+    /** Discard the items from the logical $index to the end */
+    void truncate(int index);
+
+    /** Discard the oldest batch of items, that is the oldest item and
+     *  the ones following it within $interTime milliseconds.
+     *  Return the number of items discarded */
+    int dropOldestBatch(quint64 interTime);
+
+    /** Discard all the items */
+    void clear();
+
+private:
+    /** Return the ring buffer position of the logical $index */
+    int position(int index) const;
+
+    /** Build the key used to index history items by action and object */
+    static quint64 key(int action, quint32 objID);
+
+    /** Drop the index entry of the item at the logical $index, if the
+     *  entry still points to it */
+    void unindex(int index);
+
+private:
+    QVector<Item> m_items;
+    int m_head;
+    int m_size;
+
+    /** Sequence number of the oldest item in history. Each item
+     *  keeps the same sequence number while it is in history */
+    quint64 m_firstSeq;
+
+    /** Map of (action, objID) to the sequence number of the latest
+     *  history item with such key */
+    QHash<quint64, quint64> m_lookup;
+
+    /** Memory used by the history values, in bytes */
+    qint64 m_memory;
+};
+
+#endif /* TARDISHISTORY_H */
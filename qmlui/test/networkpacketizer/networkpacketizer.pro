@@ -0,0 +1,24 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = networkpacketizer_test
+
+QT      += testlib gui quick
+CONFIG  -= app_bundle
+
+INCLUDEPATH  += ../../tardis
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../../engine/src
+DEPENDPATH   += ../../tardis
+QMAKE_LIBDIR += ../../../engine/src
+LIBS         += -lqlcplusengine
+
+HEADERS += ../../tardis/networkpacketizer.h \
+           ../../tardis/simplecrypt.h
+SOURCES += ../../tardis/networkpacketizer.cpp \
+           ../../tardis/simplecrypt.cpp
+
+# Test sources
+SOURCES += networkpacketizer_test.cpp
+HEADERS += networkpacketizer_test.h
@@ -0,0 +1,189 @@
+/*
+  Q Light Controller Plus - Unit test
+  networkpacketizer_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "networkpacketizer_test.h"
+#include "networkpacketizer.h"
+
+void NetworkPacketizer_Test::keyFrame()
+{
+    QByteArray current(512, 0);
+    current[0] = char(10);
+    current[1] = char(20);
+    current[511] = char(255);
+
+    QByteArray delta = NetworkPacketizer::encodeUniverseDelta(QByteArray(), current, false);
+    // a size change forces a keyframe
+    QCOMPARE(quint8(delta.at(0)), quint8(0x01));
+    QCOMPARE(quint8(delta.at(1)), quint8(0x02));
+    QCOMPARE(quint8(delta.at(2)), quint8(0x00));
+
+    QByteArray universe;
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, universe) == true);
+    QCOMPARE(universe, current);
+
+    // a keyframe overwrites whatever the receiver had
+    QByteArray stale(512, char(99));
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, stale) == true);
+    QCOMPARE(stale, current);
+
+    // a blank universe is a single run: header, offset, length and value
+    delta = NetworkPacketizer::encodeUniverseDelta(current, QByteArray(512, 0), true);
+    QCOMPARE(delta.length(), 8);
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, universe) == true);
+    QCOMPARE(universe, QByteArray(512, 0));
+}
+
+void NetworkPacketizer_Test::unchanged()
+{
+    QByteArray data(512, char(42));
+
+    QByteArray delta = NetworkPacketizer::encodeUniverseDelta(data, data, false);
+    QCOMPARE(delta.length(), 3);
+    QCOMPARE(quint8(delta.at(0)), quint8(0x00));
+
+    QByteArray universe = data;
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, universe) == true);
+    QCOMPARE(universe, data);
+}
+
+void NetworkPacketizer_Test::changes()
+{
+    QByteArray previous(512, 0);
+    for (int i = 0; i < previous.length(); i++)
+        previous[i] = char(i % 7);
+
+    QByteArray current = previous;
+    current[0] = char(200);
+    // close changes are merged in a single range
+    current[100] = char(201);
+    current[102] = char(202);
+    // the last channel
+    current[511] = char(203);
+
+    QByteArray delta = NetworkPacketizer::encodeUniverseDelta(previous, current, false);
+    QCOMPARE(quint8(delta.at(0)), quint8(0x00));
+    QVERIFY(delta.length() < 3 + 3 * 4 + 8);
+
+    QByteArray universe = previous;
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, universe) == true);
+    QCOMPARE(universe, current);
+
+    // the first record starts at channel 0 and holds one literal value
+    QCOMPARE(quint8(delta.at(3)), quint8(0x00));
+    QCOMPARE(quint8(delta.at(4)), quint8(0x00));
+    QCOMPARE(quint8(delta.at(5)), quint8(0x00));
+    QCOMPARE(quint8(delta.at(6)), quint8(0x01));
+    QCOMPARE(quint8(delta.at(7)), quint8(200));
+}
+
+void NetworkPacketizer_Test::runs()
+{
+    QByteArray previous(512, 0);
+    QByteArray current = previous;
+    for (int i = 64; i < 192; i++)
+        current[i] = char(255);
+
+    QByteArray delta = NetworkPacketizer::encodeUniverseDelta(previous, current, false);
+    // a single run record: offset 64, 128 values of 255
+    QCOMPARE(delta.length(), 3 + 4 + 1);
+    QCOMPARE(quint8(delta.at(3)), quint8(0x00));
+    QCOMPARE(quint8(delta.at(4)), quint8(64));
+    QCOMPARE(quint8(delta.at(5)), quint8(0x80));
+    QCOMPARE(quint8(delta.at(6)), quint8(128));
+    QCOMPARE(quint8(delta.at(7)), quint8(255));
+
+    QByteArray universe = previous;
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, universe) == true);
+    QCOMPARE(universe, current);
+}
+
+void NetworkPacketizer_Test::sizeMismatch()
+{
+    QByteArray previous(512, 0);
+    QByteArray current = previous;
+    current[10] = char(1);
+
+    QByteArray delta = NetworkPacketizer::encodeUniverseDelta(previous, current, false);
+
+    // a delta can't be applied to data of a different size
+    QByteArray universe(256, 0);
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, universe) == false);
+}
+
+void NetworkPacketizer_Test::malformed()
+{
+    QByteArray universe(512, 0);
+
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(QByteArray(), universe) == false);
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(QByteArray(2, 0), universe) == false);
+
+    QByteArray current = universe;
+    for (int i = 0; i < 16; i++)
+        current[100 + i] = char(i + 1);
+    QByteArray delta = NetworkPacketizer::encodeUniverseDelta(universe, current, false);
+
+    // truncated literal values
+    QByteArray truncated = delta.left(delta.length() - 1);
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(truncated, universe) == false);
+
+    // trailing garbage
+    QByteArray trailing = delta;
+    trailing.append(char(0));
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(trailing, universe) == false);
+
+    // a record beyond the universe size
+    QByteArray outOfRange = delta;
+    outOfRange[3] = char(0x01);
+    outOfRange[4] = char(0xFF);
+    QVERIFY(NetworkPacketizer::applyUniverseDelta(outOfRange, universe) == false);
+}
+
+void NetworkPacketizer_Test::randomRoundTrip()
+{
+    QRandomGenerator rand(1234);
+    QByteArray previous(512, 0);
+    QByteArray receiver = previous;
+
+    for (int frame = 0; frame < 200; frame++)
+    {
+        QByteArray current = previous;
+        int changes = rand.bounded(64);
+        for (int c = 0; c < changes; c++)
+        {
+            int start = rand.bounded(512);
+            int len = qMin(512 - start, rand.bounded(1, 20));
+            // mix runs and random values
+            bool run = rand.bounded(2) == 0;
+            char value = char(rand.bounded(256));
+            for (int i = start; i < start + len; i++)
+                current[i] = run ? value : char(rand.bounded(256));
+        }
+
+        bool keyFrame = (frame % 50) == 0;
+        QByteArray delta = NetworkPacketizer::encodeUniverseDelta(previous, current, keyFrame);
+        QVERIFY(NetworkPacketizer::applyUniverseDelta(delta, receiver) == true);
+        QCOMPARE(receiver, current);
+
+        previous = current;
+    }
+}
+
+QTEST_APPLESS_MAIN(NetworkPacketizer_Test)
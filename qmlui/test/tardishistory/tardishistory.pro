@@ -0,0 +1,18 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = tardishistory_test
+
+QT      += testlib
+CONFIG  -= app_bundle
+
+INCLUDEPATH  += ../../tardis
+DEPENDPATH   += ../../tardis
+
+HEADERS += ../../tardis/tardishistory.h
+SOURCES += ../../tardis/tardishistory.cpp
+
+# Test sources
+SOURCES += tardishistory_test.cpp
+HEADERS += tardishistory_test.h
@@ -0,0 +1,233 @@
+/*
+  Q Light Controller Plus - Unit test
+  tardishistory_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "tardishistory_test.h"
+#include "tardishistory.h"
+
+/* Same batch time used by the Tardis */
+#define INTERTIME 150
+
+static TardisAction makeAction(int code, quint32 objID, quint64 timestamp,
+                               QVariant oldValue, QVariant newValue)
+{
+    TardisAction action;
+    action.m_action = code;
+    action.m_objID = objID;
+    action.m_timestamp = timestamp;
+    action.m_oldValue = oldValue;
+    action.m_newValue = newValue;
+    return action;
+}
+
+void TardisHistory_Test::append()
+{
+    TardisHistory history(8);
+    QCOMPARE(history.capacity(), 8);
+    QCOMPARE(history.size(), 0);
+    QCOMPARE(history.memoryUsage(), qint64(0));
+    QCOMPARE(history.lastIndexOf(1, 0), -1);
+
+    qint64 memory = 0;
+    for (quint32 i = 0; i < 3; i++)
+    {
+        TardisHistory::Item item = TardisHistory::packAction(makeAction(1, i, i * 1000, i, i + 1));
+        memory += item.m_size;
+        history.append(item);
+    }
+
+    QCOMPARE(history.size(), 3);
+    QVERIFY(history.isFull() == false);
+    QCOMPARE(history.memoryUsage(), memory);
+    QCOMPARE(history.lastIndexOf(1, 0), 0);
+    QCOMPARE(history.lastIndexOf(1, 2), 2);
+    QCOMPARE(history.lastIndexOf(2, 0), -1);
+    QCOMPARE(history.lastIndexOf(1, 3), -1);
+
+    // the index points to the latest item of a key
+    history.append(TardisHistory::packAction(makeAction(1, 0, 4000, 1, 2)));
+    QCOMPARE(history.lastIndexOf(1, 0), 3);
+    QCOMPARE(history.action(3).m_newValue.toInt(), 2);
+}
+
+void TardisHistory_Test::ringEviction()
+{
+    TardisHistory history(4);
+
+    // one batch per action, wrapping the ring more than twice
+    for (quint32 i = 0; i < 10; i++)
+    {
+        while (history.isFull())
+            QCOMPARE(history.dropOldestBatch(INTERTIME), 1);
+
+        history.append(TardisHistory::packAction(makeAction(1, i, i * 1000, i, i + 1)));
+    }
+
+    QCOMPARE(history.size(), 4);
+    QVERIFY(history.isFull() == true);
+    QCOMPARE(history.item(0).m_action.m_objID, quint32(6));
+
+    // evicted actions are gone from the index
+    for (quint32 i = 0; i < 6; i++)
+        QCOMPARE(history.lastIndexOf(1, i), -1);
+
+    // the others are found at their logical index, as undo looks them up
+    for (quint32 i = 6; i < 10; i++)
+    {
+        int index = history.lastIndexOf(1, i);
+        QCOMPARE(index, int(i - 6));
+        TardisAction action = history.action(index);
+        QCOMPARE(action.m_objID, i);
+        QCOMPARE(action.m_oldValue.toUInt(), i);
+        QCOMPARE(action.m_newValue.toUInt(), i + 1);
+    }
+
+    // evicting an older item of a key keeps the newer one indexed
+    QCOMPARE(history.dropOldestBatch(INTERTIME), 1);
+    history.append(TardisHistory::packAction(makeAction(1, 7, 10000, 8, 9)));
+    QCOMPARE(history.lastIndexOf(1, 7), 3);
+
+    QCOMPARE(history.dropOldestBatch(INTERTIME), 1);
+    QCOMPARE(history.item(0).m_action.m_objID, quint32(8));
+    QCOMPARE(history.lastIndexOf(1, 7), 2);
+    QCOMPARE(history.action(2).m_newValue.toInt(), 9);
+}
+
+void TardisHistory_Test::memoryEviction()
+{
+    TardisHistory history(64);
+    QByteArray value(500, 'x');
+
+    qint64 itemSize = TardisHistory::packAction(makeAction(1, 0, 0, QByteArray(), value)).m_size;
+    qint64 limit = itemSize * 5;
+
+    for (quint32 i = 0; i < 20; i++)
+    {
+        history.append(TardisHistory::packAction(makeAction(1, i, i * 1000, QByteArray(), value)));
+
+        while (history.memoryUsage() > limit)
+            history.dropOldestBatch(INTERTIME);
+    }
+
+    QCOMPARE(history.size(), 5);
+    QCOMPARE(history.memoryUsage(), limit);
+    QCOMPARE(history.item(0).m_action.m_objID, quint32(15));
+    QCOMPARE(history.lastIndexOf(1, 14), -1);
+    QCOMPARE(history.lastIndexOf(1, 15), 0);
+    QCOMPARE(history.lastIndexOf(1, 19), 4);
+    QCOMPARE(history.action(4).m_newValue.toByteArray(), value);
+}
+
+void TardisHistory_Test::batchEviction()
+{
+    TardisHistory history(8);
+
+    QCOMPARE(history.dropOldestBatch(INTERTIME), 0);
+
+    // three actions within the same batch, followed by a single one
+    history.append(TardisHistory::packAction(makeAction(1, 0, 0, 0, 1)));
+    history.append(TardisHistory::packAction(makeAction(1, 1, 50, 0, 1)));
+    history.append(TardisHistory::packAction(makeAction(2, 0, 100, 0, 1)));
+    history.append(TardisHistory::packAction(makeAction(1, 0, 1000, 1, 2)));
+
+    QCOMPARE(history.dropOldestBatch(INTERTIME), 3);
+    QCOMPARE(history.size(), 1);
+    QCOMPARE(history.item(0).m_action.m_timestamp, quint64(1000));
+    QCOMPARE(history.lastIndexOf(1, 0), 0);
+    QCOMPARE(history.lastIndexOf(1, 1), -1);
+    QCOMPARE(history.lastIndexOf(2, 0), -1);
+
+    history.clear();
+    QCOMPARE(history.size(), 0);
+    QCOMPARE(history.memoryUsage(), qint64(0));
+    QCOMPARE(history.lastIndexOf(1, 0), -1);
+    QCOMPARE(history.dropOldestBatch(INTERTIME), 0);
+}
+
+void TardisHistory_Test::truncate()
+{
+    TardisHistory history(4);
+    qint64 memory = 0;
+
+    // wrap the ring first, so truncation crosses its end
+    for (quint32 i = 0; i < 6; i++)
+    {
+        while (history.isFull())
+            history.dropOldestBatch(INTERTIME);
+
+        TardisHistory::Item item = TardisHistory::packAction(makeAction(1, i, i * 1000, i, i + 1));
+        if (i == 2 || i == 3)
+            memory += item.m_size;
+        history.append(item);
+    }
+
+    history.truncate(2);
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history.memoryUsage(), memory);
+    QCOMPARE(history.lastIndexOf(1, 2), 0);
+    QCOMPARE(history.lastIndexOf(1, 3), 1);
+    QCOMPARE(history.lastIndexOf(1, 4), -1);
+    QCOMPARE(history.lastIndexOf(1, 5), -1);
+
+    history.append(TardisHistory::packAction(makeAction(1, 9, 9000, 0, 1)));
+    QCOMPARE(history.lastIndexOf(1, 9), 2);
+    QCOMPARE(history.action(2).m_objID, quint32(9));
+}
+
+void TardisHistory_Test::replace()
+{
+    TardisHistory history(4);
+    history.append(TardisHistory::packAction(makeAction(1, 0, 0, 0, 1)));
+    history.append(TardisHistory::packAction(makeAction(1, 1, 10, QString("a"), QString("b"))));
+
+    TardisHistory::Item merged = TardisHistory::packAction(makeAction(1, 1, 20, QString("a"), QString("bcd")));
+    qint64 memory = history.memoryUsage() - history.item(1).m_size + merged.m_size;
+
+    history.replace(1, merged);
+    QCOMPARE(history.size(), 2);
+    QCOMPARE(history.memoryUsage(), memory);
+    QCOMPARE(history.lastIndexOf(1, 1), 1);
+    QCOMPARE(history.action(1).m_newValue.toString(), QString("bcd"));
+    QCOMPARE(history.action(1).m_timestamp, quint64(20));
+}
+
+void TardisHistory_Test::packedValues()
+{
+    QByteArray small(16, 'a');
+    QByteArray large;
+    for (int i = 0; i < 4096; i++)
+        large.append(char(i % 16));
+
+    TardisHistory::Item item = TardisHistory::packAction(makeAction(1, 0, 0, small, large));
+    QCOMPARE(item.m_packed, int(TardisHistory::NewPacked));
+    QVERIFY(item.m_size < qint64(sizeof(TardisHistory::Item)) + large.size());
+
+    TardisHistory history(4);
+    history.append(item);
+
+    TardisAction action = history.action(0);
+    QCOMPARE(action.m_oldValue.toByteArray(), small);
+    QCOMPARE(action.m_newValue.toByteArray(), large);
+
+    // the stored item keeps the compressed value
+    QVERIFY(history.item(0).m_action.m_newValue.toByteArray() != large);
+}
+
+QTEST_APPLESS_MAIN(TardisHistory_Test)
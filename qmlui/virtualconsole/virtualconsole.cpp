@@ -103,6 +103,8 @@ VirtualConsole::VirtualConsole(QQuickView *view, Doc *doc,
 
     connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar,QString)),
             this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+    // widgets match the input sources themselves, so they need every channel
+    m_doc->inputOutputMap()->setInputMonitor(true);
 }
 
 qreal VirtualConsole::pixelDensity() const
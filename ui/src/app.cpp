@@ -53,6 +53,9 @@
 #include "qlcfixturedefcache.h"
 #include "audioplugincache.h"
 #include "rgbscriptscache.h"
+#include "startuptasks.h"
+#include "docsnapshot.h"
+#include "docautosave.h"
 #include "qlcfixturedef.h"
 #include "qlcconfig.h"
 #include "qlcfile.h"
@@ -78,6 +81,10 @@ extern void qt_set_sequence_auto_mnemonic(bool b);
 #define SETTINGS_GEOMETRY "workspace/geometry"
 #define SETTINGS_WORKINGPATH "workspace/workingpath"
 #define SETTINGS_RECENTFILE "workspace/recent"
+#define SETTINGS_SNAPSHOT "workspace/snapshot"
+#define SETTINGS_AUTOSAVE "workspace/autosave"
+
+#define AUTOSAVE_FILE "autosave.qxa"
 #define KXMLQLCWorkspaceWindow "CurrentWindow"
 
 #define MAX_RECENT_FILES    10
@@ -95,8 +102,10 @@ App::App()
     , m_tab(NULL)
     , m_overscan(false)
     , m_noGui(false)
+    , m_startupProfile(false)
     , m_progressDialog(NULL)
     , m_doc(NULL)
+    , m_autosave(NULL)
 
     , m_fileNewAction(NULL)
     , m_fileOpenAction(NULL)
@@ -204,6 +213,11 @@ void App::disableGUI()
     m_noGui = true;
 }
 
+void App::enableStartupProfile()
+{
+    m_startupProfile = true;
+}
+
 void App::init()
 {
     QSettings settings;
@@ -334,6 +348,8 @@ void App::init()
         this->setStyleSheet(styleSheet);
     }
 
+    initAutosave(ssDir);
+
 #if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
     m_videoProvider = new VideoProvider(m_doc, this);
 #endif
@@ -381,6 +397,8 @@ void App::closeEvent(QCloseEvent* e)
         if( saveModifiedDoc(tr("Close"), tr("Do you wish to save the current workspace " \
                                             "before closing the application?")) == true)
         {
+            if (m_autosave != NULL)
+                m_autosave->discard();
             e->accept();
         }
         else
@@ -402,6 +420,8 @@ void App::closeEvent(QCloseEvent* e)
             }
         }
 
+        if (m_autosave != NULL)
+            m_autosave->discard();
         e->accept();
     }
 }
@@ -465,6 +485,67 @@ Doc *App::doc()
     return m_doc;
 }
 
+/**
+ * Autosave of the whole workspace: the Engine contents, followed by the
+ * Virtual Console and the Simple Desk sections
+ */
+class WorkspaceAutosave : public DocAutosave
+{
+public:
+    WorkspaceAutosave(Doc *doc, QObject *parent)
+        : DocAutosave(doc, parent)
+    {
+    }
+
+protected:
+    int workspaceSections() const
+    {
+        return 2;
+    }
+
+    bool saveWorkspaceSection(int index, QXmlStreamWriter *doc)
+    {
+        if (index == 0)
+            return VirtualConsole::instance()->saveXML(doc);
+        else
+            return SimpleDesk::instance()->saveXML(doc);
+    }
+};
+
+void App::initAutosave(const QString& userDir)
+{
+    QSettings settings;
+    int interval = settings.value(SETTINGS_AUTOSAVE, 0).toInt();
+    if (interval <= 0)
+        return;
+
+    QString path = userDir + QDir::separator() + AUTOSAVE_FILE;
+
+    m_autosave = new WorkspaceAutosave(m_doc, this);
+    m_autosave->setPath(path);
+    m_autosave->setInterval(interval * 1000);
+
+    /* The autosave of a session is removed when the application is
+       closed, so finding one means that something went wrong */
+    if (DocAutosave::exists(path) == true && m_noGui == false)
+    {
+        int result = QMessageBox::question(this, tr("Recover workspace"),
+                                           tr("The application was not closed properly. " \
+                                              "Do you wish to recover the autosaved workspace?"),
+                                           QMessageBox::Yes, QMessageBox::No);
+        QByteArray xml;
+        if (result == QMessageBox::Yes && DocAutosave::restore(path, xml) == true)
+        {
+            QXmlStreamReader doc(xml);
+            loadXML(doc, false, true);
+            /* The recovered workspace has not been saved anywhere */
+            m_doc->setModified();
+        }
+    }
+
+    m_autosave->setEnabled(true);
+}
+
 void App::initDoc()
 {
     Q_ASSERT(m_doc == NULL);
@@ -475,36 +556,35 @@ void App::initDoc()
 #ifdef DEBUG_SPEED
     speedTime.start();
 #endif
-    /* Load user fixtures first so that they override system fixtures */
-    m_doc->fixtureDefCache()->load(QLCFixtureDefCache::userDefinitionDirectory());
-    m_doc->fixtureDefCache()->loadMap(QLCFixtureDefCache::systemDefinitionDirectory());
-
-    /* Load channel modifiers templates */
-    m_doc->modifiersCache()->load(QLCModifiersCache::systemTemplateDirectory(), true);
-    m_doc->modifiersCache()->load(QLCModifiersCache::userTemplateDirectory());
+    Q_ASSERT(m_doc->inputOutputMap() != NULL);
 
-    /* Load RGB scripts */
-    m_doc->rgbScriptsCache()->load(RGBScriptsCache::systemScriptsDirectory());
-    m_doc->rgbScriptsCache()->load(RGBScriptsCache::userScriptsDirectory());
+    /* Fixture definitions, channel modifiers, RGB scripts and
+     * input profiles are loaded in background threads */
+    StartupTasks startupTasks(m_doc, m_startupProfile);
+    startupTasks.startCacheLoaders();
 
     /* Load plugins */
+    startupTasks.beginStage("I/O plugins");
     connect(m_doc->ioPluginCache(), SIGNAL(pluginLoaded(const QString&)),
             this, SLOT(slotSetProgressText(const QString&)));
     m_doc->ioPluginCache()->load(IOPluginCache::systemPluginDirectory());
+    startupTasks.endStage();
 
     /* Load audio decoder plugins
      * This doesn't use a AudioPluginCache::systemPluginDirectory() cause
      * otherwise the qlcconfig.h creation should have been moved into the
      * audio folder, which doesn't make much sense */
+    startupTasks.beginStage("Audio plugins");
     m_doc->audioPluginCache()->load(QLCFile::systemDirectory(AUDIOPLUGINDIR, KExtPlugin));
+    startupTasks.endStage();
 
-    /* Restore outputmap settings */
-    Q_ASSERT(m_doc->inputOutputMap() != NULL);
-
-    /* Load input plugins & profiles */
-    m_doc->inputOutputMap()->loadProfiles(InputOutputMap::userProfileDirectory());
-    m_doc->inputOutputMap()->loadProfiles(InputOutputMap::systemProfileDirectory());
+    /* Restore outputmap settings. Patches refer to input profiles */
+    startupTasks.waitForFinished();
+    startupTasks.beginStage("I/O defaults");
     m_doc->inputOutputMap()->loadDefaults();
+    startupTasks.endStage();
+
+    startupTasks.printReport();
 
 #ifdef DEBUG_SPEED
     qDebug() << "[App] Doc initialization took" << speedTime.elapsed() << "ms";
@@ -1316,6 +1396,28 @@ QFile::FileError App::loadXML(const QString& fileName)
     if (fileName.isEmpty() == true)
         return QFile::OpenError;
 
+    /* Load the binary snapshot instead, if it is up to date
+       with the workspace file */
+    DocSnapshot snapshot;
+    if (snapshot.open(fileName) == true)
+    {
+        m_doc->setWorkspacePath(QFileInfo(fileName).absolutePath());
+        if (m_doc->loadSnapshot(snapshot) == true)
+        {
+            QXmlStreamReader workspace(snapshot.workspaceXML());
+            if (loadXML(workspace) == false)
+                return QFile::ReadError;
+
+            setFileName(fileName);
+            m_doc->resetModified();
+            return QFile::NoError;
+        }
+
+        /* Drop whatever the snapshot loaded and parse the XML file */
+        qWarning() << Q_FUNC_INFO << "Unable to load the snapshot of" << fileName;
+        m_doc->clearContents();
+    }
+
     QXmlStreamReader *doc = QLCFile::getXMLReader(fileName);
     if (doc == NULL || doc->device() == NULL || doc->hasError())
     {
@@ -1456,29 +1558,7 @@ QFile::FileError App::saveXML(const QString& fileName)
     doc.writeStartDocument();
     doc.writeDTD(QString("<!DOCTYPE %1>").arg(KXMLQLCWorkspace));
 
-    doc.writeStartElement(KXMLQLCWorkspace);
-    doc.writeAttribute("xmlns", QString("%1%2").arg(KXMLQLCplusNamespace).arg(KXMLQLCWorkspace));
-    /* Currently active window */
-    QWidget* widget = m_tab->currentWidget();
-    if (widget != NULL)
-        doc.writeAttribute(KXMLQLCWorkspaceWindow, QString(widget->metaObject()->className()));
-
-    doc.writeStartElement(KXMLQLCCreator);
-    doc.writeTextElement(KXMLQLCCreatorName, APPNAME);
-    doc.writeTextElement(KXMLQLCCreatorVersion, APPVERSION);
-    doc.writeTextElement(KXMLQLCCreatorAuthor, QLCFile::currentUserName());
-    doc.writeEndElement(); // close KXMLQLCCreator
-
-    /* Write engine components to the XML document */
-    m_doc->saveXML(&doc);
-
-    /* Write virtual console to the XML document */
-    VirtualConsole::instance()->saveXML(&doc);
-
-    /* Write Simple Desk to the XML document */
-    SimpleDesk::instance()->saveXML(&doc);
-
-    doc.writeEndElement(); // close KXMLQLCWorkspace
+    saveWorkspaceXML(&doc, true);
 
     /* End the document and close all the open elements */
     doc.writeEndDocument();
@@ -1497,6 +1577,15 @@ QFile::FileError App::saveXML(const QString& fileName)
         return file.error();
     }
 
+    /* Write the binary snapshot next to the workspace file, if enabled */
+    QSettings settings;
+    if (settings.value(SETTINGS_SNAPSHOT, false).toBool() == true)
+        saveSnapshot(fileName);
+
+    /* Everything is safe on disk, the autosave is not needed anymore */
+    if (m_autosave != NULL)
+        m_autosave->discard();
+
     /* Set the file name for the current Doc instance and
        set it also in an unmodified state. */
     setFileName(fileName);
@@ -1505,6 +1594,57 @@ QFile::FileError App::saveXML(const QString& fileName)
     return QFile::NoError;
 }
 
+void App::saveWorkspaceXML(QXmlStreamWriter *doc, bool saveEngine)
+{
+    doc->writeStartElement(KXMLQLCWorkspace);
+    doc->writeAttribute("xmlns", QString("%1%2").arg(KXMLQLCplusNamespace).arg(KXMLQLCWorkspace));
+    /* Currently active window */
+    QWidget* widget = m_tab->currentWidget();
+    if (widget != NULL)
+        doc->writeAttribute(KXMLQLCWorkspaceWindow, QString(widget->metaObject()->className()));
+
+    doc->writeStartElement(KXMLQLCCreator);
+    doc->writeTextElement(KXMLQLCCreatorName, APPNAME);
+    doc->writeTextElement(KXMLQLCCreatorVersion, APPVERSION);
+    doc->writeTextElement(KXMLQLCCreatorAuthor, QLCFile::currentUserName());
+    doc->writeEndElement(); // close KXMLQLCCreator
+
+    /* Write engine components to the XML document */
+    if (saveEngine == true)
+        m_doc->saveXML(doc);
+
+    /* Write virtual console to the XML document */
+    VirtualConsole::instance()->saveXML(doc);
+
+    /* Write Simple Desk to the XML document */
+    SimpleDesk::instance()->saveXML(doc);
+
+    doc->writeEndElement(); // close KXMLQLCWorkspace
+}
+
+bool App::saveSnapshot(const QString& fileName)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    QXmlStreamWriter doc(&buffer);
+    doc.setCodec("UTF-8");
+    saveWorkspaceXML(&doc, false);
+    buffer.close();
+
+    DocSnapshot snapshot;
+    m_doc->saveSnapshot(&snapshot);
+    snapshot.setWorkspaceXML(buffer.data());
+
+    if (snapshot.save(fileName) == false)
+    {
+        qWarning() << Q_FUNC_INFO << "Unable to save the snapshot of" << fileName;
+        return false;
+    }
+
+    return true;
+}
+
 void App::slotLoadDocFromMemory(QString xmlData)
 {
     if (xmlData.isEmpty())
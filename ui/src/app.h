@@ -31,6 +31,7 @@
 #include "doc.h"
 
 class QProgressDialog;
+class DocAutosave;
 class QMessageBox;
 class QToolButton;
 class QFileDialog;
@@ -86,6 +87,8 @@ public:
     void startup();
     void enableOverscan();
     void disableGUI();
+    /** Print the time spent in each startup stage */
+    void enableStartupProfile();
 
 private:
     void init();
@@ -102,6 +105,7 @@ private:
     QDir m_workingDirectory;
     bool m_overscan;
     bool m_noGui;
+    bool m_startupProfile;
 
     /*********************************************************************
      * Progress dialog
@@ -131,8 +135,13 @@ private slots:
 private:
     void initDoc();
 
+    /** Start the background autosave, if enabled in the settings,
+     *  offering to recover the previous session first */
+    void initAutosave(const QString& userDir);
+
 private:
     Doc* m_doc;
+    DocAutosave *m_autosave;
 
     /*********************************************************************
      * Main operating mode
@@ -259,6 +268,20 @@ public:
      */
     QFile::FileError saveXML(const QString& fileName);
 
+private:
+    /**
+     * Write the workspace XML document. When $saveEngine is false the
+     * Engine element is omitted, since the binary snapshot stores it
+     * on its own.
+     */
+    void saveWorkspaceXML(QXmlStreamWriter *doc, bool saveEngine);
+
+    /**
+     * Write the binary snapshot of the workspace file $fileName,
+     * which must have been saved already.
+     */
+    bool saveSnapshot(const QString& fileName);
+
 public slots:
     void slotLoadDocFromMemory(QString xmlData);
 
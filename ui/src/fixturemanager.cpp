@@ -1313,7 +1313,7 @@ void FixtureManager::removeFixture()
             so it's rather safe to reset the fixture's address space here. */
         Fixture* fxi = m_doc->fixture(id);
         Q_ASSERT(fxi != NULL);
-        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses(true);
         int universe = fxi->universe();
         if (universe < ua.count())
             ua[universe]->reset(fxi->address(), fxi->channels());
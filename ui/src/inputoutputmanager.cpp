@@ -39,6 +39,7 @@
 #include "inputoutputmanager.h"
 #include "inputoutputmap.h"
 #include "outputpatch.h"
+#include "universe.h"
 #include "inputpatch.h"
 #include "apputil.h"
 #include "doc.h"
@@ -252,6 +253,15 @@ void InputOutputManager::updateItem(QListWidgetItem* item, quint32 universe)
         item->setData(Qt::UserRole + 4, fp->outputName());
     else
         item->setData(Qt::UserRole + 4, KOutputNone);
+
+    Universe *uni = m_ioMap->universe(universe);
+    if (uni != NULL)
+    {
+        if (uni->isDormant())
+            item->setToolTip(tr("Dormant, %1 bytes allocated").arg(uni->memoryUsage()));
+        else
+            item->setToolTip(tr("Active, %1 bytes allocated").arg(uni->memoryUsage()));
+    }
 }
 
 void InputOutputManager::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
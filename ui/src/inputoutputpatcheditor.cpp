@@ -191,6 +191,11 @@ void InputOutputPatchEditor::setupMappingPage()
     connect(m_configureButton, SIGNAL(clicked()),
             this, SLOT(slotConfigureInputClicked()));
 
+    /* Feedback rate limit */
+    m_feedbackIntervalSpin->setValue(m_ioMap->feedbackInterval(m_universe));
+    connect(m_feedbackIntervalSpin, SIGNAL(valueChanged(int)),
+            this, SLOT(slotFeedbackIntervalChanged(int)));
+
     /* Double click acts as edit button click */
     connect(m_mapTree, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)),
             this, SLOT(slotConfigureInputClicked()));
@@ -386,6 +391,19 @@ void InputOutputPatchEditor::slotMapCurrentItemChanged(QTreeWidgetItem* item)
         configurable = m_ioMap->canConfigurePlugin(plugin);
     }
 
+    /* Output frame timing, shared by all the universes */
+    info += QString("<BR><B>%1:</B> %2 ms (%3: %4 ms)")
+            .arg(tr("Frame skew"))
+            .arg(m_ioMap->frameSkew() / 1000.0, 0, 'f', 2)
+            .arg(tr("max"))
+            .arg(m_ioMap->maxFrameSkew() / 1000.0, 0, 'f', 2);
+
+    /* Contention on the universes lock */
+    info += QString("<BR><B>%1:</B> %2 (%3 ms)")
+            .arg(tr("Universe lock waits"))
+            .arg(m_ioMap->universeLockWaits())
+            .arg(m_ioMap->universeLockWaitTime() / 1000.0, 0, 'f', 2);
+
     /* Display information for the selected plugin or input */
     m_infoBrowser->setText(info);
 
@@ -540,6 +558,12 @@ void InputOutputPatchEditor::slotPluginConfigurationChanged(const QString& plugi
     fillMappingTree();
 }
 
+void InputOutputPatchEditor::slotFeedbackIntervalChanged(int ms)
+{
+    m_ioMap->setFeedbackInterval(m_universe, uint(ms));
+    m_doc->setModified();
+}
+
 void InputOutputPatchEditor::slotHotpluggingChanged(bool checked)
 {
     QSettings settings;
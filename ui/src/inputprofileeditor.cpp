@@ -90,9 +90,10 @@ InputProfileEditor::InputProfileEditor(QWidget* parent, QLCInputProfile* profile
     connect(m_upperSpin, SIGNAL(valueChanged(int)),
             this, SLOT(slotUpperValueSpinChanged(int)));
 
-    /* Listen to input data */
+    /* Listen to input data, including the channels nothing subscribed to */
     connect(m_ioMap, SIGNAL(inputValueChanged(quint32, quint32, uchar, const QString&)),
             this, SLOT(slotInputValueChanged(quint32, quint32, uchar, const QString&)));
+    m_ioMap->setInputMonitor(true);
 
     if (profile == NULL)
     {
@@ -155,6 +156,8 @@ InputProfileEditor::~InputProfileEditor()
     QSettings settings;
     settings.setValue(SETTINGS_GEOMETRY, saveGeometry());
 
+    m_ioMap->setInputMonitor(false);
+
     delete m_profile;
 }
 
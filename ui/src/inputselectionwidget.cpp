@@ -60,6 +60,8 @@ InputSelectionWidget::InputSelectionWidget(Doc *doc, QWidget *parent)
 
 InputSelectionWidget::~InputSelectionWidget()
 {
+    if (m_autoDetectInputButton->isChecked())
+        m_doc->inputOutputMap()->setInputMonitor(false);
 }
 
 void InputSelectionWidget::setKeyInputVisibility(bool visible)
@@ -150,6 +152,8 @@ void InputSelectionWidget::slotAutoDetectInputToggled(bool checked)
                    SIGNAL(inputValueChanged(quint32,quint32,uchar)),
                    this, SLOT(slotInputValueChanged(quint32,quint32)));
     }
+    // any channel can be detected, not just the subscribed ones
+    m_doc->inputOutputMap()->setInputMonitor(checked);
     emit autoDetectToggled(checked);
 }
 
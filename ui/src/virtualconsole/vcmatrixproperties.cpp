@@ -117,6 +117,9 @@ VCMatrixProperties::VCMatrixProperties(VCMatrix* matrix, Doc* doc)
 
 VCMatrixProperties::~VCMatrixProperties()
 {
+    if (m_autoDetectInputButton->isChecked())
+        m_doc->inputOutputMap()->setInputMonitor(false);
+
     foreach (VCMatrixControl* control, m_controls)
         delete control;
 
@@ -175,6 +178,7 @@ void VCMatrixProperties::slotAutoDetectSliderInputToggled(bool checked)
         disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
                    this, SLOT(slotSliderInputValueChanged(quint32,quint32)));
     }
+    m_doc->inputOutputMap()->setInputMonitor(checked);
 }
 
 void VCMatrixProperties::slotSliderInputValueChanged(quint32 universe, quint32 channel)
@@ -232,6 +232,8 @@ VCPropertiesEditor::VCPropertiesEditor(QWidget* parent, const VCProperties& prop
 
 VCPropertiesEditor::~VCPropertiesEditor()
 {
+    if (m_autoDetectGrandMasterInputButton->isChecked())
+        m_ioMap->setInputMonitor(false);
 }
 
 VCProperties VCPropertiesEditor::properties() const
@@ -363,6 +365,7 @@ void VCPropertiesEditor::slotAutoDetectGrandMasterInputToggled(bool checked)
         disconnect(m_ioMap, SIGNAL(inputValueChanged(quint32,quint32,uchar)),
                    this, SLOT(slotGrandMasterInputValueChanged(quint32,quint32)));
     }
+    m_ioMap->setInputMonitor(checked);
 }
 
 void VCPropertiesEditor::slotGrandMasterInputValueChanged(quint32 universe,
@@ -96,6 +96,7 @@ VCSlider::VCSlider(QWidget *parent, Doc *doc)
     , m_levelHighLimit(UCHAR_MAX)
     , m_levelValueChanged(false)
     , m_levelValue(0)
+    , m_levelChannelsChanged(true)
     , m_monitorEnabled(false)
     , m_monitorValue(0)
     , m_playbackFunction(Function::invalidId())
@@ -210,6 +211,10 @@ VCSlider::VCSlider(QWidget *parent, Doc *doc)
        they no longer point to an existing fixture->channel */
     connect(m_doc, SIGNAL(fixtureRemoved(quint32)),
             this, SLOT(slotFixtureRemoved(quint32)));
+    connect(m_doc, SIGNAL(fixtureAdded(quint32)),
+            this, SLOT(slotFixtureChanged(quint32)));
+    connect(m_doc, SIGNAL(fixtureChanged(quint32)),
+            this, SLOT(slotFixtureChanged(quint32)));
 }
 
 VCSlider::~VCSlider()
@@ -267,6 +272,7 @@ bool VCSlider::copyFrom(const VCWidget* widget)
     setLevelLowLimit(slider->levelLowLimit());
     setLevelHighLimit(slider->levelHighLimit());
     m_levelChannels = slider->m_levelChannels;
+    m_levelChannelsChanged = true;
 
     /* Copy playback stuff */
     m_playbackFunction = slider->m_playbackFunction;
@@ -552,22 +558,29 @@ void VCSlider::addLevelChannel(quint32 fixture, quint32 channel)
 {
     LevelChannel lch(fixture, channel);
 
+    QMutexLocker locker(&m_levelValueMutex);
     if (m_levelChannels.contains(lch) == false)
     {
         m_levelChannels.append(lch);
         std::sort(m_levelChannels.begin(), m_levelChannels.end());
+        m_levelChannelsChanged = true;
     }
 }
 
 void VCSlider::removeLevelChannel(quint32 fixture, quint32 channel)
 {
     LevelChannel lch(fixture, channel);
-    m_levelChannels.removeAll(lch);
+
+    QMutexLocker locker(&m_levelValueMutex);
+    if (m_levelChannels.removeAll(lch) > 0)
+        m_levelChannelsChanged = true;
 }
 
 void VCSlider::clearLevelChannels()
 {
+    QMutexLocker locker(&m_levelValueMutex);
     m_levelChannels.clear();
+    m_levelChannelsChanged = true;
 }
 
 QList <VCSlider::LevelChannel> VCSlider::levelChannels()
@@ -651,6 +664,7 @@ uchar VCSlider::levelValue() const
 
 void VCSlider::slotFixtureRemoved(quint32 fxi_id)
 {
+    QMutexLocker locker(&m_levelValueMutex);
     QMutableListIterator <LevelChannel> it(m_levelChannels);
     while (it.hasNext() == true)
     {
@@ -658,6 +672,15 @@ void VCSlider::slotFixtureRemoved(quint32 fxi_id)
         if (it.value().fixture == fxi_id)
             it.remove();
     }
+    m_levelChannelsChanged = true;
+}
+
+void VCSlider::slotFixtureChanged(quint32 fxi_id)
+{
+    Q_UNUSED(fxi_id);
+
+    QMutexLocker locker(&m_levelValueMutex);
+    m_levelChannelsChanged = true;
 }
 
 void VCSlider::slotMonitorDMXValueChanged(int value)
@@ -1056,13 +1079,58 @@ void VCSlider::writeDMX(MasterTimer *timer, QList<Universe *> universes)
         writeDMXPlayback(timer, universes);
 }
 
+bool VCSlider::levelTargetLessThan(const VCSlider::LevelChannelTarget &a,
+                                   const VCSlider::LevelChannelTarget &b)
+{
+    return a.universe < b.universe;
+}
+
+void VCSlider::compileLevelChannels()
+{
+    m_levelTargets.clear();
+
+    foreach (LevelChannel lch, m_levelChannels)
+    {
+        Fixture *fxi = m_doc->fixture(lch.fixture);
+        if (fxi == NULL)
+            continue;
+
+        const QLCChannel *qlcch = fxi->channel(lch.channel);
+        if (qlcch == NULL)
+            continue;
+
+        LevelChannelTarget target;
+        target.universe = fxi->universe();
+        target.channel = FadeChannel(m_doc, lch.fixture, lch.channel);
+        if (target.channel.universe() == Universe::invalid())
+            continue;
+
+        target.colour = qlcch->colour();
+        // request to autoremove LTP channels when set
+        target.autoRemove = (qlcch->group() != QLCChannel::Intensity);
+
+        m_levelTargets.append(target);
+    }
+
+    // group the channels by universe, so that faders are looked up once
+    std::stable_sort(m_levelTargets.begin(), m_levelTargets.end(), levelTargetLessThan);
+
+    m_levelChannelsChanged = false;
+}
+
 void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
 
     QMutexLocker locker(&m_levelValueMutex);
 
-    uchar modLevel = m_levelValue;
+    // nothing to do until the level changes
+    if (m_levelValueChanged == false)
+        return;
+
+    if (m_levelChannelsChanged)
+        compileLevelChannels();
+
     int r = 0, g = 0, b = 0, c = 0, m = 0, y = 0;
 
     if (m_cngType == ClickAndGoWidget::RGB)
@@ -1095,24 +1163,23 @@ void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
         }
     }
 
-    if (m_levelValueChanged)
-    {
-        QListIterator <LevelChannel> it(m_levelChannels);
-        while (it.hasNext() == true)
-        {
-            LevelChannel lch(it.next());
-            Fixture *fxi = m_doc->fixture(lch.fixture);
-            if (fxi == NULL)
-                continue;
+    quint32 faderUniverse = Universe::invalid();
+    QSharedPointer<GenericFader> fader;
 
-            quint32 universe = fxi->universe();
+    foreach (const LevelChannelTarget &target, m_levelTargets)
+    {
+        if (target.universe >= quint32(universes.count()))
+            continue;
 
-            QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
+        if (target.universe != faderUniverse)
+        {
+            faderUniverse = target.universe;
+            fader = m_fadersMap.value(faderUniverse, QSharedPointer<GenericFader>());
             if (fader.isNull())
             {
-                fader = universes[universe]->requestFader(m_monitorEnabled ? Universe::Override : Universe::Auto);
+                fader = universes[faderUniverse]->requestFader(m_monitorEnabled ? Universe::Override : Universe::Auto);
                 fader->adjustIntensity(intensity());
-                m_fadersMap[universe] = fader;
+                m_fadersMap[faderUniverse] = fader;
                 if (m_monitorEnabled)
                 {
                     qDebug() << "VC slider monitor enabled";
@@ -1121,56 +1188,47 @@ void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
                             this, SLOT(slotUniverseWritten(quint32,QByteArray)));
                 }
             }
+        }
 
-            FadeChannel *fc = fader->getChannelFader(m_doc, universes[universe], lch.fixture, lch.channel);
-            if (fc->universe() == Universe::invalid())
-            {
-                fader->remove(fc);
-                continue;
-            }
+        FadeChannel *fc = fader->getChannelFader(target.channel, universes[faderUniverse]);
 
-            int chType = fc->flags();
-            const QLCChannel *qlcch = fxi->channel(lch.channel);
-            if (qlcch == NULL)
-                continue;
+        // set override flag if needed
+        if (m_isOverriding)
+            fc->addFlag(FadeChannel::Override);
 
-            // set override flag if needed
-            if (m_isOverriding)
-                fc->addFlag(FadeChannel::Override);
+        if (target.autoRemove)
+            fc->addFlag(FadeChannel::Autoremove);
 
-            // request to autoremove LTP channels when set
-            if (qlcch->group() != QLCChannel::Intensity)
-                fc->addFlag(FadeChannel::Autoremove);
+        uchar modLevel = m_levelValue;
 
-            if (chType & FadeChannel::Intensity)
+        if (fc->flags() & FadeChannel::Intensity)
+        {
+            if (m_cngType == ClickAndGoWidget::RGB)
             {
-                if (m_cngType == ClickAndGoWidget::RGB)
-                {
-                    if (qlcch->colour() == QLCChannel::Red)
-                        modLevel = uchar(r);
-                    else if (qlcch->colour() == QLCChannel::Green)
-                        modLevel = uchar(g);
-                    else if (qlcch->colour() == QLCChannel::Blue)
-                        modLevel = uchar(b);
-                }
-                else if (m_cngType == ClickAndGoWidget::CMY)
-                {
-                    if (qlcch->colour() == QLCChannel::Cyan)
-                        modLevel = uchar(c);
-                    else if (qlcch->colour() == QLCChannel::Magenta)
-                        modLevel = uchar(m);
-                    else if (qlcch->colour() == QLCChannel::Yellow)
-                        modLevel = uchar(y);
-                }
+                if (target.colour == QLCChannel::Red)
+                    modLevel = uchar(r);
+                else if (target.colour == QLCChannel::Green)
+                    modLevel = uchar(g);
+                else if (target.colour == QLCChannel::Blue)
+                    modLevel = uchar(b);
+            }
+            else if (m_cngType == ClickAndGoWidget::CMY)
+            {
+                if (target.colour == QLCChannel::Cyan)
+                    modLevel = uchar(c);
+                else if (target.colour == QLCChannel::Magenta)
+                    modLevel = uchar(m);
+                else if (target.colour == QLCChannel::Yellow)
+                    modLevel = uchar(y);
             }
+        }
 
-            fc->setStart(fc->current());
-            fc->setTarget(modLevel);
-            fc->setReady(false);
-            fc->setElapsed(0);
+        fc->setStart(fc->current());
+        fc->setTarget(modLevel);
+        fc->setReady(false);
+        fc->setElapsed(0);
 
-            //qDebug() << "VC Slider write channel" << fc->target();
-        }
+        //qDebug() << "VC Slider write channel" << fc->target();
     }
     m_levelValueChanged = false;
 }
@@ -26,8 +26,10 @@
 
 #include "clickandgoslider.h"
 #include "clickandgowidget.h"
+#include "fadechannel.h"
 #include "knobwidget.h"
 #include "dmxsource.h"
+#include "qlcchannel.h"
 #include "vcwidget.h"
 
 class QXmlStreamReader;
@@ -337,6 +339,10 @@ protected slots:
     /** Removes all level channels related to removed fixture */
     void slotFixtureRemoved(quint32 fxi_id);
 
+    /** Invalidates the resolved level channels when a fixture
+     *  is added or changes its address, universe or mode */
+    void slotFixtureChanged(quint32 fxi_id);
+
     /** Slot called when the DMX levels of the controlled channels
      *  has changed */
     void slotMonitorDMXValueChanged(int value);
@@ -352,6 +358,26 @@ protected:
     bool m_levelValueChanged;
     uchar m_levelValue;
 
+    /** A level channel resolved to its universe and fader channel,
+     *  so that no Fixture lookup is needed when writing DMX */
+    typedef struct
+    {
+        quint32 universe;
+        FadeChannel channel;
+        QLCChannel::PrimaryColour colour;
+        bool autoRemove;
+    } LevelChannelTarget;
+
+    /** Sorting function for LevelChannelTarget, by universe */
+    static bool levelTargetLessThan(const LevelChannelTarget &a,
+                                    const LevelChannelTarget &b);
+
+    /** Level channels resolved by compileLevelChannels, sorted by universe */
+    QList <LevelChannelTarget> m_levelTargets;
+
+    /** Flag raised when m_levelTargets needs to be rebuilt */
+    bool m_levelChannelsChanged;
+
     bool m_monitorEnabled;
     uchar m_monitorValue;
 
@@ -430,6 +456,10 @@ protected:
     /** writeDMX for Level mode */
     void writeDMXLevel(MasterTimer *timer, QList<Universe*> universes);
 
+    /** Resolve m_levelChannels into m_levelTargets.
+     *  Must be called with m_levelValueMutex locked */
+    void compileLevelChannels();
+
     /** writeDMX for Playback mode */
     void writeDMXPlayback(MasterTimer *timer, QList<Universe*> universes);
 
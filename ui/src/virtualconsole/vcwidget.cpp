@@ -99,6 +99,14 @@ VCWidget::VCWidget(QWidget* parent, Doc* doc)
 
 VCWidget::~VCWidget()
 {
+    /* The Virtual Console might be already gone when widgets
+       are deleted by their QWidget parents */
+    VirtualConsole *vc = VirtualConsole::instance();
+    if (vc != NULL)
+    {
+        foreach (QSharedPointer<QLCInputSource> src, m_inputs)
+            vc->unsubscribeInput(this, src->universe(), src->channel());
+    }
 }
 
 /*****************************************************************************
@@ -582,11 +590,11 @@ bool VCWidget::checkInputSource(quint32 universe, quint32 channel,
 
 void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quint8 id)
 {
+    VirtualConsole *vc = VirtualConsole::instance();
+
     // Connect when the first valid input source is set
     if (m_inputs.isEmpty() == true && !source.isNull() && source->isValid() == true)
     {
-        connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         connect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                 this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
@@ -594,8 +602,11 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Clear previous source
     if (m_inputs.contains(id))
     {
-        disconnect(m_inputs.value(id).data(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
+        QSharedPointer<QLCInputSource> const& prev = m_inputs.value(id);
+        disconnect(prev.data(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
                 this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+        if (vc != NULL)
+            vc->unsubscribeInput(this, prev->universe(), prev->channel());
         m_inputs.remove(id);
     }
 
@@ -603,6 +614,9 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     if (!source.isNull() && source->isValid() == true)
     {
         m_inputs.insert(id, source);
+        // external input events are routed by the Virtual Console
+        if (vc != NULL)
+            vc->subscribeInput(this, source->universe(), source->channel());
         // now check if the source is defined in the associated universe
         // profile and if it has specific settings
         InputPatch *ip = m_doc->inputOutputMap()->inputPatch(source->universe());
@@ -649,8 +663,6 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Disconnect when there are no more input sources present
     if (m_inputs.isEmpty() == true)
     {
-        disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                   this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         disconnect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                    this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
@@ -708,6 +720,23 @@ void VCWidget::sendFeedback(int value, QSharedPointer<QLCInputSource> src)
     m_doc->inputOutputMap()->sendFeedBack(src->universe(), src->channel(), value, chName);
 }
 
+void VCWidget::dispatchInputValue(quint32 universe, quint32 channel, uchar value)
+{
+    slotInputValueChanged(universe, channel, value);
+}
+
+bool VCWidget::inputNeedsEveryValue(quint32 universe, quint32 channel) const
+{
+    foreach (QSharedPointer<QLCInputSource> src, m_inputs)
+    {
+        if (src->universe() == universe && (src->channel() & 0xFFFF) == channel &&
+            src->needsUpdate())
+            return true;
+    }
+
+    return false;
+}
+
 void VCWidget::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
 {
     Q_UNUSED(universe);
@@ -450,6 +450,20 @@ public:
      */
     virtual void updateFeedback() = 0;
 
+    /**
+     * Deliver an external input event routed by the Virtual Console
+     * to this widget. Widgets are supposed to receive it through
+     * slotInputValueChanged.
+     */
+    void dispatchInputValue(quint32 universe, quint32 channel, uchar value);
+
+    /**
+     * Check if an input source of this widget on $universe and $channel
+     * (page bits excluded) needs every single value, like relative
+     * and encoder sources do, so its events can't be coalesced.
+     */
+    bool inputNeedsEveryValue(quint32 universe, quint32 channel) const;
+
 protected slots:
     /**
      * Slot that receives external input data. Overwrite in subclasses to
@@ -36,6 +36,7 @@
 #include <QMenuBar>
 #include <QToolBar>
 #include <QString>
+#include <QTimer>
 #include <QDebug>
 #include <QMenu>
 #include <QList>
@@ -74,6 +75,9 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
     , m_doc(doc)
     , m_latestWidgetId(0)
 
+    , m_grandMasterInputUniverse(InputOutputMap::invalidUniverse())
+    , m_grandMasterInputChannel(QLCChannel::invalid())
+
     , m_editAction(EditNone)
     , m_toolbar(NULL)
 
@@ -135,6 +139,10 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
     , m_scrollArea(NULL)
     , m_contents(NULL)
 
+    , m_inputFlushTimer(NULL)
+    , m_coalescedInputEvents(0)
+    , m_droppedInputEvents(0)
+
     , m_liveEdit(false)
 {
     Q_ASSERT(s_instance == NULL);
@@ -154,6 +162,15 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
     initMenuBar();
     initContents();
 
+    // Route external input to the subscribed widgets, once per UI frame
+    m_inputFlushTimer = new QTimer(this);
+    m_inputFlushTimer->setSingleShot(true);
+    m_inputFlushTimer->setInterval(0);
+    connect(m_inputFlushTimer, SIGNAL(timeout()),
+            this, SLOT(slotFlushInputEvents()));
+    connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
+            this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+
     // Propagate mode changes to all widgets
     connect(m_doc, SIGNAL(modeChanged(Doc::Mode)),
             this, SLOT(slotModeChanged(Doc::Mode)));
@@ -202,6 +219,28 @@ VCProperties VirtualConsole::properties() const
     return m_properties;
 }
 
+void VirtualConsole::updateGrandMasterInput()
+{
+    quint32 universe = m_properties.grandMasterInputUniverse();
+    quint32 channel = m_properties.grandMasterInputChannel();
+
+    if (universe == m_grandMasterInputUniverse && channel == m_grandMasterInputChannel)
+        return;
+
+    /* The grand master slider listens to the InputOutputMap directly,
+       so only the channel subscription is needed */
+    InputOutputMap *ioMap = m_doc->inputOutputMap();
+    if (m_grandMasterInputUniverse != InputOutputMap::invalidUniverse() &&
+        m_grandMasterInputChannel != QLCChannel::invalid())
+        ioMap->unsubscribeInputChannel(m_grandMasterInputUniverse, m_grandMasterInputChannel);
+
+    m_grandMasterInputUniverse = universe;
+    m_grandMasterInputChannel = channel;
+
+    if (universe != InputOutputMap::invalidUniverse() && channel != QLCChannel::invalid())
+        ioMap->subscribeInputChannel(universe, channel);
+}
+
 /*****************************************************************************
  * Selected widget
  *****************************************************************************/
@@ -1003,6 +1042,7 @@ void VirtualConsole::slotToolsSettings()
     if (vcpe.exec() == QDialog::Accepted)
     {
         m_properties = vcpe.properties();
+        updateGrandMasterInput();
         contents()->resize(m_properties.size());
         m_doc->inputOutputMap()->setGrandMasterChannelMode(m_properties.grandMasterChannelMode());
         m_doc->inputOutputMap()->setGrandMasterValueMode(m_properties.grandMasterValueMode());
@@ -1529,6 +1569,7 @@ void VirtualConsole::resetContents()
     m_properties.setGrandMasterChannelMode(GrandMaster::Intensity);
     m_properties.setGrandMasterValueMode(GrandMaster::Reduce);
     m_properties.setGrandMasterInputSource(InputOutputMap::invalidUniverse(), QLCChannel::invalid());
+    updateGrandMasterInput();
 }
 
 void VirtualConsole::addWidgetInMap(VCWidget* widget)
@@ -1594,6 +1635,152 @@ void VirtualConsole::initContents()
     resetContents();
 }
 
+/*****************************************************************************
+ * External input routing
+ *****************************************************************************/
+
+quint64 VirtualConsole::inputRoutingKey(quint32 universe, quint32 channel)
+{
+    return (quint64(universe) << 32) | (channel & 0xFFFF);
+}
+
+void VirtualConsole::subscribeInput(VCWidget *widget, quint32 universe, quint32 channel)
+{
+    Q_ASSERT(widget != NULL);
+
+    m_inputSubscribers[inputRoutingKey(universe, channel)].append(widget);
+    m_doc->inputOutputMap()->subscribeInputChannel(universe, channel);
+}
+
+void VirtualConsole::unsubscribeInput(VCWidget *widget, quint32 universe, quint32 channel)
+{
+    quint64 key = inputRoutingKey(universe, channel);
+    QHash <quint64, QList<VCWidget *> >::iterator it = m_inputSubscribers.find(key);
+    if (it == m_inputSubscribers.end())
+        return;
+
+    if (it.value().removeOne(widget))
+        m_doc->inputOutputMap()->unsubscribeInputChannel(universe, channel);
+    if (it.value().isEmpty())
+        m_inputSubscribers.erase(it);
+}
+
+void VirtualConsole::flushInputEvents()
+{
+    m_inputFlushTimer->stop();
+
+    /* Swap out the pending events first, since widgets might
+       subscribe/unsubscribe or generate new events while processing them */
+    QHash <quint64, uchar> pending;
+    QList <quint64> keys;
+    pending.swap(m_pendingInputs);
+    keys.swap(m_pendingInputKeys);
+
+    foreach (quint64 key, keys)
+        dispatchInputEvent(key, pending.value(key));
+}
+
+quint64 VirtualConsole::coalescedInputEvents() const
+{
+    return m_coalescedInputEvents;
+}
+
+quint64 VirtualConsole::droppedInputEvents() const
+{
+    return m_droppedInputEvents;
+}
+
+void VirtualConsole::dispatchInputEvent(quint64 key, uchar value)
+{
+    /* Take a copy of the list, as it might change during the dispatch */
+    QList<VCWidget *> widgets = m_inputSubscribers.value(key);
+    quint32 universe = quint32(key >> 32);
+    quint32 channel = quint32(key & 0xFFFF);
+
+    for (int i = 0; i < widgets.count(); i++)
+    {
+        VCWidget *widget = widgets.at(i);
+
+        // skip widgets subscribed more than once to the same channel
+        if (widgets.indexOf(widget) < i)
+            continue;
+
+        // the widget might have been removed by a previous dispatch
+        if (m_inputSubscribers.value(key).contains(widget) == false)
+            continue;
+
+        widget->dispatchInputValue(universe, channel, value);
+    }
+}
+
+void VirtualConsole::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    quint64 key = inputRoutingKey(universe, channel);
+
+    QHash <quint64, QList<VCWidget *> >::const_iterator sub = m_inputSubscribers.constFind(key);
+    if (sub == m_inputSubscribers.constEnd())
+    {
+        m_droppedInputEvents++;
+        return;
+    }
+
+    QHash <quint64, uchar>::iterator it = m_pendingInputs.find(key);
+
+    // Relative and encoder sources count every single step
+    foreach (VCWidget *widget, sub.value())
+    {
+        if (widget->inputNeedsEveryValue(universe, channel & 0xFFFF) == false)
+            continue;
+
+        if (it != m_pendingInputs.end())
+        {
+            uchar previous = it.value();
+            m_pendingInputs.erase(it);
+            m_pendingInputKeys.removeOne(key);
+            dispatchInputEvent(key, previous);
+        }
+        dispatchInputEvent(key, value);
+        return;
+    }
+    if (it == m_pendingInputs.end())
+    {
+        m_pendingInputs.insert(key, value);
+        m_pendingInputKeys.append(key);
+        if (m_inputFlushTimer->isActive() == false)
+            m_inputFlushTimer->start();
+        return;
+    }
+
+    if (it.value() == value)
+    {
+        m_coalescedInputEvents++;
+        return;
+    }
+
+    // Every ON/OFF change must pass through, like InputPatch does
+    if (it.value() == 0 || value == 0)
+    {
+        uchar previous = it.value();
+        m_pendingInputs.erase(it);
+        m_pendingInputKeys.removeOne(key);
+        dispatchInputEvent(key, previous);
+
+        m_pendingInputs.insert(key, value);
+        m_pendingInputKeys.append(key);
+        if (m_inputFlushTimer->isActive() == false)
+            m_inputFlushTimer->start();
+        return;
+    }
+
+    it.value() = value;
+    m_coalescedInputEvents++;
+}
+
+void VirtualConsole::slotFlushInputEvents()
+{
+    flushInputEvents();
+}
+
 /*****************************************************************************
  * Key press handler
  *****************************************************************************/
@@ -1887,6 +2074,7 @@ void VirtualConsole::postLoad()
     m_doc->inputOutputMap()->setGrandMasterValue(255);
     m_doc->inputOutputMap()->setGrandMasterValueMode(m_properties.grandMasterValueMode());
     m_doc->inputOutputMap()->setGrandMasterChannelMode(m_properties.grandMasterChannelMode());
+    updateGrandMasterInput();
 
     /* Go through widgets, check IDs and register */
     /* widgets to the map */
@@ -25,6 +25,7 @@
 #include <QWidget>
 #include <QFrame>
 #include <QList>
+#include <QHash>
 
 #include "vcproperties.h"
 #include "doc.h"
@@ -39,6 +40,7 @@ class VCDockArea;
 class QKeyEvent;
 class QToolBar;
 class VCWidget;
+class QTimer;
 class VCFrame;
 class QAction;
 class KeyBind;
@@ -84,9 +86,18 @@ public:
     /** Get Virtual Console properties (read-only) */
     VCProperties properties() const;
 
+private:
+    /** Subscribe the grand master input channel of the current
+     *  properties, dropping the previous subscription */
+    void updateGrandMasterInput();
+
 private:
     VCProperties m_properties;
 
+    /** The grand master input channel currently subscribed */
+    quint32 m_grandMasterInputUniverse;
+    quint32 m_grandMasterInputChannel;
+
     /*********************************************************************
      * Selected widgets
      *********************************************************************/
@@ -340,6 +351,61 @@ protected:
     VCFrame* m_contents;
     QHash <quint32, VCWidget *> m_widgetsMap;
 
+    /*********************************************************************
+     * External input routing
+     *********************************************************************/
+public:
+    /**
+     * Subscribe $widget to external input events coming from the given
+     * $universe and $channel. The page bits of $channel are ignored, since
+     * widgets filter pages by themselves.
+     * A widget can subscribe the same channel more than once (e.g. with
+     * different input source IDs) and it will receive each event only once.
+     */
+    void subscribeInput(VCWidget *widget, quint32 universe, quint32 channel);
+
+    /** Remove one subscription of $widget from $universe and $channel */
+    void unsubscribeInput(VCWidget *widget, quint32 universe, quint32 channel);
+
+    /** Deliver all the pending input events to the subscribed widgets */
+    void flushInputEvents();
+
+    /** Get the number of input events superseded before being delivered */
+    quint64 coalescedInputEvents() const;
+
+    /** Get the number of input events dropped because nobody subscribed them */
+    quint64 droppedInputEvents() const;
+
+protected:
+    /** Build the routing key of a universe/channel pair */
+    static quint64 inputRoutingKey(quint32 universe, quint32 channel);
+
+    /** Deliver a single input event to the widgets subscribed to $key */
+    void dispatchInputEvent(quint64 key, uchar value);
+
+protected slots:
+    /** Collect an input event from the InputOutputMap */
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value);
+
+    /** Deliver the input events collected in the current UI frame */
+    void slotFlushInputEvents();
+
+protected:
+    /** Map of universe/channel keys to the widgets listening to them */
+    QHash <quint64, QList<VCWidget *> > m_inputSubscribers;
+
+    /** Latest value of each key received in the current UI frame */
+    QHash <quint64, uchar> m_pendingInputs;
+
+    /** Keys of m_pendingInputs, in order of arrival */
+    QList <quint64> m_pendingInputKeys;
+
+    /** Single shot timer delivering the pending events */
+    QTimer *m_inputFlushTimer;
+
+    quint64 m_coalescedInputEvents;
+    quint64 m_droppedInputEvents;
+
     /*********************************************************************
      * Key press handler
      *********************************************************************/
@@ -667,6 +667,63 @@ void VCButton_Test::input()
     m_doc->masterTimer()->stop();
 }
 
+void VCButton_Test::inputRouting()
+{
+    QWidget w;
+    VirtualConsole *vc = VirtualConsole::instance();
+
+    Scene* sc = new Scene(m_doc);
+    sc->setValue(0, 0, 255);
+    m_doc->addFunction(sc);
+
+    VCButton btn(&w, m_doc);
+    btn.setFunction(sc->id());
+    btn.setAction(VCButton::Flash);
+    btn.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(0, 3)));
+    QCOMPARE(vc->m_inputSubscribers.count(), 1);
+
+    m_doc->setMode(Doc::Operate);
+
+    // Nobody listens to this channel
+    vc->slotInputValueChanged(0, 4, 255);
+    QCOMPARE(vc->droppedInputEvents(), quint64(1));
+    QCOMPARE(vc->m_pendingInputs.count(), 0);
+
+    // Events are delivered only on flush
+    vc->slotInputValueChanged(0, 3, 100);
+    QCOMPARE(btn.state(), VCButton::Inactive);
+    vc->slotInputValueChanged(0, 3, 200);
+    QCOMPARE(vc->coalescedInputEvents(), quint64(1));
+    vc->flushInputEvents();
+    QCOMPARE(btn.state(), VCButton::Active);
+
+    // ON/OFF changes are never coalesced
+    vc->slotInputValueChanged(0, 3, 0);
+    vc->slotInputValueChanged(0, 3, 255);
+    QCOMPARE(btn.state(), VCButton::Inactive);
+    vc->flushInputEvents();
+    QCOMPARE(btn.state(), VCButton::Active);
+    QCOMPARE(vc->coalescedInputEvents(), quint64(1));
+
+    vc->slotInputValueChanged(0, 3, 0);
+    QTest::qWait(10);
+    QCOMPARE(btn.state(), VCButton::Inactive);
+
+    // Sources that need every value are delivered right away
+    QSharedPointer<QLCInputSource> extra(new QLCInputSource(0, 5));
+    extra->setSendExtraPressRelease(true);
+    btn.setInputSource(extra, 1);
+    quint64 coalesced = vc->coalescedInputEvents();
+    vc->slotInputValueChanged(0, 5, 255);
+    vc->slotInputValueChanged(0, 5, 127);
+    QCOMPARE(vc->m_pendingInputs.count(), 0);
+    QCOMPARE(vc->coalescedInputEvents(), coalesced);
+    btn.setInputSource(QSharedPointer<QLCInputSource>(), 1);
+
+    btn.setInputSource(QSharedPointer<QLCInputSource>());
+    QCOMPARE(vc->m_inputSubscribers.count(), 0);
+}
+
 void VCButton_Test::paint()
 {
     QWidget w;
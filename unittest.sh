@@ -117,6 +117,33 @@ done
 
 fi
 
+#############################################################################
+# QML UI tests
+#############################################################################
+
+if [ "$TARGET" == "qmlui" ]; then
+
+TESTDIR=qmlui/test
+TESTS=$(find ${TESTDIR} -maxdepth 1 -mindepth 1 -type d)
+for test in ${TESTS}
+do
+    # Isolate just the test name
+    test=$(echo ${test} | sed 's/qmlui\/test\///')
+
+    $SLEEPCMD
+    # Execute the test
+    pushd ${TESTDIR}/${test}
+    $TESTPREFIX ./test.sh
+    RESULT=${?}
+    popd
+    if [ ${RESULT} != 0 ]; then
+        echo "${RESULT} QML UI unit tests failed. Please fix before commit."
+        exit ${RESULT}
+    fi
+done
+
+fi
+
 #############################################################################
 # Enttec wing tests
 #############################################################################
@@ -177,6 +204,66 @@ if [ $RESULT != 0 ]; then
 fi
 popd
 
+#############################################################################
+# E1.31 tests
+#############################################################################
+
+$SLEEPCMD
+pushd plugins/E1.31/test
+$TESTPREFIX ./test.sh
+RESULT=$?
+if [ $RESULT != 0 ]; then
+	echo "${RESULT} E1.31 unit tests failed. Please fix before commit."
+	exit $RESULT
+fi
+popd
+
+#############################################################################
+# Shared memory tests
+#############################################################################
+
+if [[ "$OSTYPE" == "linux-gnu"* ]]; then
+  $SLEEPCMD
+  pushd plugins/shm/test
+  $TESTPREFIX ./test.sh
+  RESULT=$?
+  if [ $RESULT != 0 ]; then
+    echo "${RESULT} Shared memory unit tests failed. Please fix before commit."
+    exit $RESULT
+  fi
+  popd
+
+  $SLEEPCMD
+  pushd plugins/spi/test
+  $TESTPREFIX ./test.sh
+  RESULT=$?
+  if [ $RESULT != 0 ]; then
+    echo "${RESULT} SPI unit tests failed. Please fix before commit."
+    exit $RESULT
+  fi
+  popd
+
+  $SLEEPCMD
+  pushd plugins/gpio/test
+  $TESTPREFIX ./test.sh
+  RESULT=$?
+  if [ $RESULT != 0 ]; then
+    echo "${RESULT} GPIO unit tests failed. Please fix before commit."
+    exit $RESULT
+  fi
+  popd
+
+  $SLEEPCMD
+  pushd plugins/hid/test
+  $TESTPREFIX ./test.sh
+  RESULT=$?
+  if [ $RESULT != 0 ]; then
+    echo "${RESULT} HID unit tests failed. Please fix before commit."
+    exit $RESULT
+  fi
+  popd
+fi
+
 #############################################################################
 # Final judgment
 #############################################################################
@@ -18,28 +18,15 @@
 */
 
 var websocket;
+// set to true to receive the widget updates as binary frames
+var wsBinaryProtocol = false;
+var wsUpdateTypes = [ "", "BUTTON", "SLIDER", "AUDIOTRIGGERS", "CUE", "CLOCK", "FRAME" ];
+
 function sendCMD(cmd) {
  websocket.send("QLC+CMD|" + cmd);
 }
 
-window.onload = function() {
- var url = "ws://" + window.location.host + "/qlcplusWS";
- websocket = new WebSocket(url);
- websocket.onopen = function(ev) {
-  //alert(\"Websocket open!\");
- };
-
- websocket.onclose = function(ev) {
-  alert("QLC+ connection lost!");
- };
-
- websocket.onerror = function(ev) {
-  alert("QLC+ connection error!");
- };
-
- websocket.onmessage = function(ev) {
-  //console.log(ev.data);
-  var msgParams = ev.data.split("|");
+function wsHandleMessage(msgParams) {
   if (msgParams[1] === "BUTTON") {
     wsSetButtonState(msgParams[0], msgParams[2]);
   }
@@ -62,6 +49,63 @@ window.onload = function() {
   else if (msgParams[0] === "ALERT") {
     alert(msgParams[1]);
   }
+}
+
+// Binary update: type (1 byte), ID (4 bytes), signed value (4 bytes),
+// text length (1 byte), UTF-8 text. Integers are big endian
+function wsHandleBinaryUpdates(buffer) {
+  var view = new DataView(buffer);
+  var pos = 0;
+  while (pos + 10 <= view.byteLength) {
+    var type = view.getUint8(pos);
+    var id = view.getUint32(pos + 1);
+    var value = view.getInt32(pos + 5);
+    var textLen = view.getUint8(pos + 9);
+    var bytes = new Uint8Array(buffer, pos + 10, textLen);
+    var text = decodeURIComponent(escape(String.fromCharCode.apply(null, bytes)));
+    pos += 10 + textLen;
+    if (type < wsUpdateTypes.length) {
+      wsHandleMessage([ String(id), wsUpdateTypes[type], String(value), text ]);
+    }
+  }
+}
+
+window.onload = function() {
+ var url = "ws://" + window.location.host + "/qlcplusWS";
+ websocket = new WebSocket(url);
+ websocket.binaryType = "arraybuffer";
+ websocket.onopen = function(ev) {
+  //alert(\"Websocket open!\");
+  if (wsBinaryProtocol) {
+    websocket.send("QLC+PROTO|BINARY");
+  }
+  // receive the text updates of a flush in a single frame
+  websocket.send("QLC+PROTO|BATCH");
+  // the page may be a cached copy: ask for the current state of the widgets
+  if (typeof initVirtualConsole === "function") {
+    websocket.send("QLC+PROTO|SYNC");
+  }
+ };
+
+ websocket.onclose = function(ev) {
+  alert("QLC+ connection lost!");
+ };
+
+ websocket.onerror = function(ev) {
+  alert("QLC+ connection error!");
+ };
+
+ websocket.onmessage = function(ev) {
+  //console.log(ev.data);
+  if (ev.data instanceof ArrayBuffer) {
+    wsHandleBinaryUpdates(ev.data);
+    return;
+  }
+  // widget updates are batched in a single frame, one per line
+  var msgList = ev.data.split("\n");
+  for (var i = 0; i < msgList.length; i++) {
+    wsHandleMessage(msgList[i].split("|"));
+  }
  };
  initVirtualConsole();
 };
@@ -376,6 +376,14 @@ void QHttpConnection::webSocketWrite(WebSocketOpCode opCode, QByteArray data)
         m_socket->write(data);
 }
 
+qint64 QHttpConnection::bytesToWrite() const
+{
+    if (m_socket == NULL)
+        return 0;
+
+    return m_socket->bytesToWrite();
+}
+
 /**
      Here's the RFC 6455 Framing specs. The table of the law
 
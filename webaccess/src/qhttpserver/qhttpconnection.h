@@ -100,6 +100,8 @@ public:
 
     QHttpConnection *enableWebSocket(bool enable);
     void webSocketWrite(WebSocketOpCode opCode, QByteArray data);
+    /// Number of bytes still waiting to be sent on the socket
+    qint64 bytesToWrite() const;
 
 Q_SIGNALS:
     void webSocketDataReady(QHttpConnection *conn, QString data);
@@ -17,9 +17,12 @@
   limitations under the License.
 */
 
-#include <QDebug>
+#include <QCryptographicHash>
+#include <QFileInfo>
 #include <QProcess>
 #include <QSettings>
+#include <QDebug>
+#include <QTimer>
 
 #include "webaccess.h"
 
@@ -34,6 +37,7 @@
 #include "outputpatch.h"
 #include "inputpatch.h"
 #include "simpledesk.h"
+#include "universe.h"
 #include "qlcconfig.h"
 #include "webaccess.h"
 #include "vccuelist.h"
@@ -58,6 +62,18 @@
 #define DEFAULT_PORT_NUMBER    9999
 #define AUTOSTART_PROJECT_NAME "autostart.qxw"
 
+/** Interval at which the coalesced widget updates are sent */
+#define WEBSOCKET_FLUSH_INTERVAL    20
+/** A client with more than this amount of unsent bytes is considered busy */
+#define WEBSOCKET_MAX_PENDING_BYTES (64 * 1024)
+
+/** Tick of the DMX monitor timer and limits of the requested frame rate */
+#define MONITOR_TICK_INTERVAL       10
+#define MONITOR_MIN_RATE            1
+#define MONITOR_MAX_RATE            50
+/** First byte of a DMX monitor binary frame, not used by widget updates */
+#define MONITOR_FRAME_MARKER        0x80
+
 WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, SimpleDesk *sdInstance,
                      int portNumber, bool enableAuth, QString passwdFile, QObject *parent) :
     QObject(parent)
@@ -66,6 +82,7 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, SimpleDesk *sdInstanc
   , m_sd(sdInstance)
   , m_auth(NULL)
   , m_pendingProjectLoaded(false)
+  , m_vcPageValid(false)
 {
     Q_ASSERT(m_doc != NULL);
     Q_ASSERT(m_vc != NULL);
@@ -92,6 +109,32 @@ WebAccess::WebAccess(Doc *doc, VirtualConsole *vcInstance, SimpleDesk *sdInstanc
 
     connect(m_vc, SIGNAL(loaded()),
             this, SLOT(slotVCLoaded()));
+    // any VC edit marks the document as modified
+    connect(m_doc, SIGNAL(modified(bool)),
+            this, SLOT(slotInvalidateVCHTML()));
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(WEBSOCKET_FLUSH_INTERVAL);
+    connect(m_flushTimer, SIGNAL(timeout()),
+            this, SLOT(slotFlushWebSocketUpdates()));
+
+    m_monitorTimer = new QTimer(this);
+    m_monitorTimer->setSingleShot(true);
+    m_monitorTimer->setInterval(MONITOR_TICK_INTERVAL);
+    connect(m_monitorTimer, SIGNAL(timeout()),
+            this, SLOT(slotMonitorTimeout()));
+    m_monitorClock.start();
+
+    m_webSocketHandlers["QLC+CMD"] = &WebAccess::handleCMDCommand;
+    m_webSocketHandlers["QLC+IO"] = &WebAccess::handleIOCommand;
+    m_webSocketHandlers["QLC+AUTH"] = &WebAccess::handleAuthCommand;
+#if defined(Q_WS_X11) || defined(Q_OS_LINUX)
+    m_webSocketHandlers["QLC+SYS"] = &WebAccess::handleSystemCommand;
+#endif
+    m_webSocketHandlers["QLC+API"] = &WebAccess::handleAPICommand;
+    m_webSocketHandlers["QLC+PROTO"] = &WebAccess::handleProtocolCommand;
+    m_webSocketHandlers["CH"] = &WebAccess::handleChannelCommand;
 }
 
 WebAccess::~WebAccess()
@@ -140,6 +183,11 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
             // Allocate user for WS on heap so it doesn't go out of scope
             conn->userData = new WebAccessUser(user);
             m_webSocketsList.append(conn);
+
+            WebSocketClient client;
+            client.binary = false;
+            client.batched = false;
+            m_webSocketClients.insert(conn, client);
         }
 
         resp->writeHead(101);
@@ -246,27 +294,27 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
   #endif
     else if (reqUrl.endsWith(".png"))
     {
-        if (sendFile(resp, QString(":%1").arg(reqUrl), "image/png") == true)
+        if (sendFile(req, resp, QString(":%1").arg(reqUrl), "image/png") == true)
             return;
     }
     else if (reqUrl.endsWith(".css"))
     {
         QString clUri = reqUrl.mid(1);
-        if (sendFile(resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
+        if (sendFile(req, resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
                      .arg(QDir::separator()).arg(clUri), "text/css") == true)
             return;
     }
     else if (reqUrl.endsWith(".js"))
     {
         QString clUri = reqUrl.mid(1);
-        if (sendFile(resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
+        if (sendFile(req, resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
                      .arg(QDir::separator()).arg(clUri), "text/javascript") == true)
             return;
     }
     else if (reqUrl.endsWith(".html"))
     {
         QString clUri = reqUrl.mid(1);
-        if (sendFile(resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
+        if (sendFile(req, resp, QString("%1%2%3").arg(QLCFile::systemDirectory(WEBFILESDIR).path())
                      .arg(QDir::separator()).arg(clUri), "text/html") == true)
             return;
     }
@@ -279,7 +327,16 @@ void WebAccess::slotHandleRequest(QHttpRequest *req, QHttpResponse *resp)
         return;
     }
     else
-        content = getVCHTML();
+    {
+        if (m_vcPageValid == false)
+        {
+            m_vcPage.data = getVCHTML().toUtf8();
+            prepareAsset(m_vcPage, true);
+            m_vcPageValid = true;
+        }
+        sendAsset(req, resp, m_vcPage, "text/html");
+        return;
+    }
 
     // Prepare the message we're going to send
     QByteArray contentArray = content.toUtf8();
@@ -303,387 +360,395 @@ void WebAccess::slotHandleWebSocketRequest(QHttpConnection *conn, QString data)
     qDebug() << "[websocketDataHandler]" << data;
 
     QStringList cmdList = data.split("|");
-    if (cmdList.isEmpty())
+    if (cmdList.isEmpty() || cmdList[0] == "POLL")
         return;
 
-    if(cmdList[0] == "QLC+CMD")
+    WebSocketHandler handler = m_webSocketHandlers.value(cmdList[0], NULL);
+    if (handler != NULL)
     {
-        if (cmdList.count() < 2)
-            return;
+        (this->*handler)(conn, user, cmdList);
+        return;
+    }
+
+    if (data.contains("|") == false)
+        return;
+
+    handleWidgetCommand(conn, user, cmdList);
+}
 
-        if(cmdList[1] == "opMode")
-            emit toggleDocMode();
+void WebAccess::handleCMDCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    Q_UNUSED(conn)
+    Q_UNUSED(user)
 
+    if (cmdList.count() < 2)
         return;
-    }
-    else if (cmdList[0] == "QLC+IO")
-    {
-        if(m_auth && user && user->level < SUPER_ADMIN_LEVEL)
-            return;
 
-        if (cmdList.count() < 3)
-            return;
+    if(cmdList[1] == "opMode")
+        emit toggleDocMode();
+}
 
-        int universe = cmdList[2].toInt();
+void WebAccess::handleIOCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    Q_UNUSED(conn)
 
-        if (cmdList[1] == "INPUT")
-        {
-            m_doc->inputOutputMap()->setInputPatch(universe, cmdList[3], "", cmdList[4].toUInt());
-            m_doc->inputOutputMap()->saveDefaults();
-        }
-        else if (cmdList[1] == "OUTPUT")
+    if(m_auth && user && user->level < SUPER_ADMIN_LEVEL)
+        return;
+
+    if (cmdList.count() < 3)
+        return;
+
+    int universe = cmdList[2].toInt();
+
+    if (cmdList[1] == "INPUT")
+    {
+        m_doc->inputOutputMap()->setInputPatch(universe, cmdList[3], "", cmdList[4].toUInt());
+        m_doc->inputOutputMap()->saveDefaults();
+    }
+    else if (cmdList[1] == "OUTPUT")
+    {
+        m_doc->inputOutputMap()->setOutputPatch(universe, cmdList[3], "", cmdList[4].toUInt(), false);
+        m_doc->inputOutputMap()->saveDefaults();
+    }
+    else if (cmdList[1] == "FB")
+    {
+        m_doc->inputOutputMap()->setOutputPatch(universe, cmdList[3], "", cmdList[4].toUInt(), true);
+        m_doc->inputOutputMap()->saveDefaults();
+    }
+    else if (cmdList[1] == "PROFILE")
+    {
+        InputPatch *inPatch = m_doc->inputOutputMap()->inputPatch(universe);
+        if (inPatch != NULL)
         {
-            m_doc->inputOutputMap()->setOutputPatch(universe, cmdList[3], "", cmdList[4].toUInt(), false);
+            m_doc->inputOutputMap()->setInputPatch(universe, inPatch->pluginName(), "", inPatch->input(), cmdList[3]);
             m_doc->inputOutputMap()->saveDefaults();
         }
-        else if (cmdList[1] == "FB")
+    }
+    else if (cmdList[1] == "PASSTHROUGH")
+    {
+        quint32 uniIdx = cmdList[2].toUInt();
+        if (cmdList[3] == "true")
+            m_doc->inputOutputMap()->setUniversePassthrough(uniIdx, true);
+        else
+            m_doc->inputOutputMap()->setUniversePassthrough(uniIdx, false);
+        m_doc->inputOutputMap()->saveDefaults();
+    }
+    else if (cmdList[1] == "AUDIOIN")
+    {
+        QSettings settings;
+        if (cmdList[2] == "__qlcplusdefault__")
+            settings.remove(SETTINGS_AUDIO_INPUT_DEVICE);
+        else
         {
-            m_doc->inputOutputMap()->setOutputPatch(universe, cmdList[3], "", cmdList[4].toUInt(), true);
-            m_doc->inputOutputMap()->saveDefaults();
+            settings.setValue(SETTINGS_AUDIO_INPUT_DEVICE, cmdList[2]);
+            m_doc->destroyAudioCapture();
         }
-        else if (cmdList[1] == "PROFILE")
+    }
+    else if (cmdList[1] == "AUDIOOUT")
+    {
+        QSettings settings;
+        if (cmdList[2] == "__qlcplusdefault__")
+            settings.remove(SETTINGS_AUDIO_OUTPUT_DEVICE);
+        else
+            settings.setValue(SETTINGS_AUDIO_OUTPUT_DEVICE, cmdList[2]);
+    }
+    else
+        qDebug() << "[webaccess] Command" << cmdList[1] << "not supported!";
+}
+
+void WebAccess::handleAuthCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    if (m_auth == NULL)
+        return;
+
+    if(user && user->level < SUPER_ADMIN_LEVEL)
+        return;
+
+    if (cmdList.count() < 2)
+        return;
+
+    if (cmdList.at(1) == "ADD_USER")
+    {
+        QString username = cmdList.at(2);
+        QString password = cmdList.at(3);
+        int level = cmdList.at(4).toInt();
+        if(username.isEmpty() || password.isEmpty())
         {
-            InputPatch *inPatch = m_doc->inputOutputMap()->inputPatch(universe);
-            if (inPatch != NULL)
-            {
-                m_doc->inputOutputMap()->setInputPatch(universe, inPatch->pluginName(), "", inPatch->input(), cmdList[3]);
-                m_doc->inputOutputMap()->saveDefaults();
-            }
+            QString wsMessage = QString("ALERT|" + tr("Username and password are required fields."));
+            conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
+            return;
         }
-        else if (cmdList[1] == "PASSTHROUGH")
+        if(level <= 0)
         {
-            quint32 uniIdx = cmdList[2].toUInt();
-            if (cmdList[3] == "true")
-                m_doc->inputOutputMap()->setUniversePassthrough(uniIdx, true);
-            else
-                m_doc->inputOutputMap()->setUniversePassthrough(uniIdx, false);
-            m_doc->inputOutputMap()->saveDefaults();
+            QString wsMessage = QString("ALERT|" + tr("User level has to be a positive integer."));
+            conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
+            return;
         }
-        else if (cmdList[1] == "AUDIOIN")
+
+        m_auth->addUser(username, password, (WebAccessUserLevel)level);
+    }
+    else if (cmdList.at(1) == "DEL_USER")
+    {
+        QString username = cmdList.at(2);
+        if(! username.isEmpty())
+            m_auth->deleteUser(username);
+    }
+    else if (cmdList.at(1) == "SET_USER_LEVEL")
+    {
+        QString username = cmdList.at(2);
+        int level = cmdList.at(3).toInt();
+        if(username.isEmpty())
         {
-            QSettings settings;
-            if (cmdList[2] == "__qlcplusdefault__")
-                settings.remove(SETTINGS_AUDIO_INPUT_DEVICE);
-            else
-            {
-                settings.setValue(SETTINGS_AUDIO_INPUT_DEVICE, cmdList[2]);
-                m_doc->destroyAudioCapture();
-            }
+            QString wsMessage = QString("ALERT|" + tr("Username is required."));
+            conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
+            return;
         }
-        else if (cmdList[1] == "AUDIOOUT")
+        if(level <= 0)
         {
-            QSettings settings;
-            if (cmdList[2] == "__qlcplusdefault__")
-                settings.remove(SETTINGS_AUDIO_OUTPUT_DEVICE);
-            else
-                settings.setValue(SETTINGS_AUDIO_OUTPUT_DEVICE, cmdList[2]);
+            QString wsMessage = QString("ALERT|" + tr("User level has to be a positive integer."));
+            conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
+            return;
         }
-        else
-            qDebug() << "[webaccess] Command" << cmdList[1] << "not supported!";
 
-        return;
+        m_auth->setUserLevel(username, (WebAccessUserLevel)level);
     }
-    else if(cmdList[0] == "QLC+AUTH" && m_auth)
-    {
-        if(user && user->level < SUPER_ADMIN_LEVEL)
-            return;
+    else
+        qDebug() << "[webaccess] Command" << cmdList[1] << "not supported!";
 
-        if (cmdList.at(1) == "ADD_USER")
-        {
-            QString username = cmdList.at(2);
-            QString password = cmdList.at(3);
-            int level = cmdList.at(4).toInt();
-            if(username.isEmpty() || password.isEmpty())
-            {
-                QString wsMessage = QString("ALERT|" + tr("Username and password are required fields."));
-                conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
-                return;
-            }
-            if(level <= 0)
-            {
-                QString wsMessage = QString("ALERT|" + tr("User level has to be a positive integer."));
-                conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
-                return;
-            }
+    if(! m_auth->savePasswordsFile())
+    {
+        QString wsMessage = QString("ALERT|" + tr("Error while saving passwords file."));
+        conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
+        return;
+    }
+}
 
-            m_auth->addUser(username, password, (WebAccessUserLevel)level);
-        }
-        else if (cmdList.at(1) == "DEL_USER")
-        {
-            QString username = cmdList.at(2);
-            if(! username.isEmpty())
-                m_auth->deleteUser(username);
-        }
-        else if (cmdList.at(1) == "SET_USER_LEVEL")
-        {
-            QString username = cmdList.at(2);
-            int level = cmdList.at(3).toInt();
-            if(username.isEmpty())
-            {
-                QString wsMessage = QString("ALERT|" + tr("Username is required."));
-                conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
-                return;
-            }
-            if(level <= 0)
-            {
-                QString wsMessage = QString("ALERT|" + tr("User level has to be a positive integer."));
-                conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
-                return;
-            }
+#if defined(Q_WS_X11) || defined(Q_OS_LINUX)
+void WebAccess::handleSystemCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    if(m_auth && user && user->level < SUPER_ADMIN_LEVEL)
+        return;
 
-            m_auth->setUserLevel(username, (WebAccessUserLevel)level);
-        }
-        else
-            qDebug() << "[webaccess] Command" << cmdList[1] << "not supported!";
+    if (cmdList.count() < 2)
+        return;
 
-        if(! m_auth->savePasswordsFile())
+    if (cmdList.at(1) == "NETWORK")
+    {
+        if (m_netConfig->updateNetworkFile(cmdList) == true)
         {
-            QString wsMessage = QString("ALERT|" + tr("Error while saving passwords file."));
+            QString wsMessage = QString("ALERT|" + tr("Network configuration changed. Reboot to apply the changes."));
             conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
             return;
         }
+        else
+            qDebug() << "[webaccess] Error writing network configuration file!";
+
+        return;
     }
-#if defined(Q_WS_X11) || defined(Q_OS_LINUX)
-    else if(cmdList[0] == "QLC+SYS")
+    else if (cmdList.at(1) == "AUTOSTART")
     {
-        if(m_auth && user && user->level < SUPER_ADMIN_LEVEL)
+        if (cmdList.count() < 3)
             return;
 
-        if (cmdList.at(1) == "NETWORK")
-        {
-            if (m_netConfig->updateNetworkFile(cmdList) == true)
-            {
-                QString wsMessage = QString("ALERT|" + tr("Network configuration changed. Reboot to apply the changes."));
-                conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
-                return;
-            }
-            else
-                qDebug() << "[webaccess] Error writing network configuration file!";
+        QString asName = QString("%1/%2/%3").arg(getenv("HOME")).arg(USERQLCPLUSDIR).arg(AUTOSTART_PROJECT_NAME);
+        if (cmdList.at(2) == "none")
+            QFile::remove(asName);
+        else
+            emit storeAutostartProject(asName);
+        QString wsMessage = QString("ALERT|" + tr("Autostart configuration changed"));
+        conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
+        return;
+    }
+    else if (cmdList.at(1) == "REBOOT")
+    {
+        QProcess *rebootProcess = new QProcess();
+        rebootProcess->start("reboot", QStringList());
+    }
+    else if (cmdList.at(1) == "HALT")
+    {
+        QProcess *haltProcess = new QProcess();
+        haltProcess->start("halt", QStringList());
+    }
+}
+#endif
 
-            return;
-        }
-        else if (cmdList.at(1) == "AUTOSTART")
-        {
-            if (cmdList.count() < 3)
-                return;
+void WebAccess::handleAPICommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    if(m_auth && user && user->level < VC_ONLY_LEVEL)
+        return;
 
-            QString asName = QString("%1/%2/%3").arg(getenv("HOME")).arg(USERQLCPLUSDIR).arg(AUTOSTART_PROJECT_NAME);
-            if (cmdList.at(2) == "none")
-                QFile::remove(asName);
-            else
-                emit storeAutostartProject(asName);
-            QString wsMessage = QString("ALERT|" + tr("Autostart configuration changed"));
-            conn->webSocketWrite(QHttpConnection::TextFrame, wsMessage.toUtf8());
-            return;
-        }
-        else if (cmdList.at(1) == "REBOOT")
-        {
-            QProcess *rebootProcess = new QProcess();
-            rebootProcess->start("reboot", QStringList());
-        }
-        else if (cmdList.at(1) == "HALT")
+    if (cmdList.count() < 2)
+        return;
+
+    QString apiCmd = cmdList[1];
+    // compose the basic API reply messages
+    QString wsAPIMessage = QString("QLC+API|%1|").arg(apiCmd);
+
+    if (apiCmd == "isProjectLoaded")
+    {
+        if (m_pendingProjectLoaded)
         {
-            QProcess *haltProcess = new QProcess();
-            haltProcess->start("halt", QStringList());
+            wsAPIMessage.append("true");
+            m_pendingProjectLoaded = false;
         }
+        else
+            wsAPIMessage.append("false");
     }
-#endif
-    else if (cmdList[0] == "QLC+API")
+    else if (apiCmd == "getFunctionsNumber")
+    {
+        wsAPIMessage.append(QString::number(m_doc->functions().count()));
+    }
+    else if (apiCmd == "getFunctionsList")
+    {
+        foreach(Function *f, m_doc->functions())
+            wsAPIMessage.append(QString("%1|%2|").arg(f->id()).arg(f->name()));
+        // remove trailing separator
+        wsAPIMessage.truncate(wsAPIMessage.length() - 1);
+    }
+    else if (apiCmd == "getFunctionType")
     {
-        if(m_auth && user && user->level < VC_ONLY_LEVEL)
+        if (cmdList.count() < 3)
             return;
 
-        if (cmdList.count() < 2)
+        quint32 fID = cmdList[2].toUInt();
+        Function *f = m_doc->function(fID);
+        if (f != NULL)
+            wsAPIMessage.append(m_doc->function(fID)->typeString());
+        else
+            wsAPIMessage.append(Function::typeToString(Function::Undefined));
+    }
+    else if (apiCmd == "getFunctionStatus")
+    {
+        if (cmdList.count() < 3)
             return;
 
-        QString apiCmd = cmdList[1];
-        // compose the basic API reply messages
-        QString wsAPIMessage = QString("QLC+API|%1|").arg(apiCmd);
-
-        if (apiCmd == "isProjectLoaded")
-        {
-            if (m_pendingProjectLoaded)
-            {
-                wsAPIMessage.append("true");
-                m_pendingProjectLoaded = false;
-            }
-            else
-                wsAPIMessage.append("false");
-        }
-        else if (apiCmd == "getFunctionsNumber")
-        {
-            wsAPIMessage.append(QString::number(m_doc->functions().count()));
-        }
-        else if (apiCmd == "getFunctionsList")
+        quint32 fID = cmdList[2].toUInt();
+        Function *f = m_doc->function(fID);
+        if (f != NULL)
         {
-            foreach(Function *f, m_doc->functions())
-                wsAPIMessage.append(QString("%1|%2|").arg(f->id()).arg(f->name()));
-            // remove trailing separator
-            wsAPIMessage.truncate(wsAPIMessage.length() - 1);
-        }
-        else if (apiCmd == "getFunctionType")
-        {
-            if (cmdList.count() < 3)
-                return;
-
-            quint32 fID = cmdList[2].toUInt();
-            Function *f = m_doc->function(fID);
-            if (f != NULL)
-                wsAPIMessage.append(m_doc->function(fID)->typeString());
-            else
-                wsAPIMessage.append(Function::typeToString(Function::Undefined));
-        }
-        else if (apiCmd == "getFunctionStatus")
-        {
-            if (cmdList.count() < 3)
-                return;
-
-            quint32 fID = cmdList[2].toUInt();
-            Function *f = m_doc->function(fID);
-            if (f != NULL)
-            {
-                if (f->isRunning())
-                    wsAPIMessage.append("Running");
-                else
-                    wsAPIMessage.append("Stopped");
-            }
+            if (f->isRunning())
+                wsAPIMessage.append("Running");
             else
-                wsAPIMessage.append(Function::typeToString(Function::Undefined));
+                wsAPIMessage.append("Stopped");
         }
-        else if (apiCmd == "setFunctionStatus") 
+        else
+            wsAPIMessage.append(Function::typeToString(Function::Undefined));
+    }
+    else if (apiCmd == "setFunctionStatus") 
 	{
-            if (cmdList.count() < 4)
-                return;
+        if (cmdList.count() < 4)
+            return;
 
-            quint32 fID = cmdList[2].toUInt();
-            quint32 newStatus = cmdList[3].toUInt();
-            Function *f = m_doc->function(fID);
+        quint32 fID = cmdList[2].toUInt();
+        quint32 newStatus = cmdList[3].toUInt();
+        Function *f = m_doc->function(fID);
 
-            if (f != NULL)
-            {
-                if (!f->isRunning() && newStatus)
-                    f->start(m_doc->masterTimer(), FunctionParent::master());
-                else if (f->isRunning() && !newStatus)
-                    f->stop(FunctionParent::master());
-            }
-            return;
-        }
-        else if (apiCmd == "getWidgetsNumber")
-        {
-            VCFrame *mainFrame = m_vc->contents();
-            QList<VCWidget *> chList = mainFrame->findChildren<VCWidget*>();
-            wsAPIMessage.append(QString::number(chList.count()));
-        }
-        else if (apiCmd == "getWidgetsList")
+        if (f != NULL)
         {
-            VCFrame *mainFrame = m_vc->contents();
-            foreach(VCWidget *widget, mainFrame->findChildren<VCWidget*>())
-                wsAPIMessage.append(QString("%1|%2|").arg(widget->id()).arg(widget->caption()));
-            // remove trailing separator
-            wsAPIMessage.truncate(wsAPIMessage.length() - 1);
+            if (!f->isRunning() && newStatus)
+                f->start(m_doc->masterTimer(), FunctionParent::master());
+            else if (f->isRunning() && !newStatus)
+                f->stop(FunctionParent::master());
         }
-        else if (apiCmd == "getWidgetType")
-        {
-            if (cmdList.count() < 3)
-                return;
+        return;
+    }
+    else if (apiCmd == "getWidgetsNumber")
+    {
+        VCFrame *mainFrame = m_vc->contents();
+        QList<VCWidget *> chList = mainFrame->findChildren<VCWidget*>();
+        wsAPIMessage.append(QString::number(chList.count()));
+    }
+    else if (apiCmd == "getWidgetsList")
+    {
+        VCFrame *mainFrame = m_vc->contents();
+        foreach(VCWidget *widget, mainFrame->findChildren<VCWidget*>())
+            wsAPIMessage.append(QString("%1|%2|").arg(widget->id()).arg(widget->caption()));
+        // remove trailing separator
+        wsAPIMessage.truncate(wsAPIMessage.length() - 1);
+    }
+    else if (apiCmd == "getWidgetType")
+    {
+        if (cmdList.count() < 3)
+            return;
 
-            quint32 wID = cmdList[2].toUInt();
-            VCWidget *widget = m_vc->widget(wID);
-            if (widget != NULL)
-                wsAPIMessage.append(widget->typeToString(widget->type()));
-            else
-                wsAPIMessage.append(widget->typeToString(VCWidget::UnknownWidget));
-        }
-        else if (apiCmd == "getWidgetStatus")
-        {
-            if (cmdList.count() < 3)
-                return;
+        quint32 wID = cmdList[2].toUInt();
+        VCWidget *widget = m_vc->widget(wID);
+        if (widget != NULL)
+            wsAPIMessage.append(widget->typeToString(widget->type()));
+        else
+            wsAPIMessage.append(widget->typeToString(VCWidget::UnknownWidget));
+    }
+    else if (apiCmd == "getWidgetStatus")
+    {
+        if (cmdList.count() < 3)
+            return;
 
-            quint32 wID = cmdList[2].toUInt();
-            VCWidget *widget = m_vc->widget(wID);
-            if (widget != NULL)
+        quint32 wID = cmdList[2].toUInt();
+        VCWidget *widget = m_vc->widget(wID);
+        if (widget != NULL)
+        {
+            switch(widget->type())
             {
-                switch(widget->type())
+                case VCWidget::ButtonWidget:
                 {
-                    case VCWidget::ButtonWidget:
-                    {
-                        VCButton *button = qobject_cast<VCButton*>(widget);
-                        if (button->state() == VCButton::Active)
-                            wsAPIMessage.append("255");
-                        else if (button->state() == VCButton::Monitoring)
-                            wsAPIMessage.append("127");
-                        else
-                            wsAPIMessage.append("0");
-                    }
-                    break;
-                    case VCWidget::SliderWidget:
-                    {
-                        VCSlider *slider = qobject_cast<VCSlider*>(widget);
-                        wsAPIMessage.append(QString::number(slider->sliderValue()));
-                    }
-                    break;
-                    case VCWidget::CueListWidget:
-                    {
-                        VCCueList *cue = qobject_cast<VCCueList*>(widget);
-                        quint32 chaserID = cue->chaserID();
-                        Function *f = m_doc->function(chaserID);
-                        if (f != NULL && f->isRunning())
-                            wsAPIMessage.append(QString("PLAY|%2|").arg(cue->getCurrentIndex()));
-                        else
-                            wsAPIMessage.append("STOP");
-                    }
-                    break;
+                    VCButton *button = qobject_cast<VCButton*>(widget);
+                    if (button->state() == VCButton::Active)
+                        wsAPIMessage.append("255");
+                    else if (button->state() == VCButton::Monitoring)
+                        wsAPIMessage.append("127");
+                    else
+                        wsAPIMessage.append("0");
+                }
+                break;
+                case VCWidget::SliderWidget:
+                {
+                    VCSlider *slider = qobject_cast<VCSlider*>(widget);
+                    wsAPIMessage.append(QString::number(slider->sliderValue()));
+                }
+                break;
+                case VCWidget::CueListWidget:
+                {
+                    VCCueList *cue = qobject_cast<VCCueList*>(widget);
+                    quint32 chaserID = cue->chaserID();
+                    Function *f = m_doc->function(chaserID);
+                    if (f != NULL && f->isRunning())
+                        wsAPIMessage.append(QString("PLAY|%2|").arg(cue->getCurrentIndex()));
+                    else
+                        wsAPIMessage.append("STOP");
                 }
+                break;
             }
         }
-        else if (apiCmd == "getChannelsValues")
-        {
-            if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
-                return;
+    }
+    else if (apiCmd == "getChannelsValues")
+    {
+        if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
+            return;
 
-            if (cmdList.count() < 4)
-                return;
+        if (cmdList.count() < 4)
+            return;
 
-            quint32 universe = cmdList[2].toUInt() - 1;
-            int startAddr = cmdList[3].toInt() - 1;
-            int count = 1;
-            if (cmdList.count() == 5)
-                count = cmdList[4].toInt();
+        quint32 universe = cmdList[2].toUInt() - 1;
+        int startAddr = cmdList[3].toInt() - 1;
+        int count = 1;
+        if (cmdList.count() == 5)
+            count = cmdList[4].toInt();
 
-            wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(m_doc, m_sd, universe, startAddr, count));
-        }
-        else if (apiCmd == "sdResetChannel")
-        {
-            if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
-                return;
-
-            if (cmdList.count() < 3)
-                return;
-
-            quint32 chNum = cmdList[2].toUInt() - 1;
-            m_sd->resetChannel(chNum);
-            wsAPIMessage = "QLC+API|getChannelsValues|";
-            wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(
-                                m_doc, m_sd, m_sd->getCurrentUniverseIndex(),
-                                (m_sd->getCurrentPage() - 1) * m_sd->getSlidersNumber(), m_sd->getSlidersNumber()));
-        }
-        else if (apiCmd == "sdResetUniverse")
-        {
-            if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
-                return;
-
-            m_sd->resetUniverse();
-            wsAPIMessage = "QLC+API|getChannelsValues|";
-            wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(
-                                m_doc, m_sd, m_sd->getCurrentUniverseIndex(),
-                                0, m_sd->getSlidersNumber()));
-        }
-        //qDebug() << "Simple desk channels:" << wsAPIMessage;
+        wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(m_doc, m_sd, universe, startAddr, count));
+    }
+    else if (apiCmd == "subscribeChannels")
+    {
+        if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
+            return;
 
-        conn->webSocketWrite(QHttpConnection::TextFrame, wsAPIMessage.toUtf8());
-        return;
+        wsAPIMessage.append(subscribeMonitor(conn, cmdList) ? "OK" : "ERROR");
+    }
+    else if (apiCmd == "unsubscribeChannels")
+    {
+        unsubscribeMonitor(conn);
+        wsAPIMessage.append("OK");
     }
-    else if(cmdList[0] == "CH")
+    else if (apiCmd == "sdResetChannel")
     {
         if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
             return;
@@ -691,18 +756,83 @@ void WebAccess::slotHandleWebSocketRequest(QHttpConnection *conn, QString data)
         if (cmdList.count() < 3)
             return;
 
-        uint absAddress = cmdList[1].toInt() - 1;
-        int value = cmdList[2].toInt();
-        m_sd->setAbsoluteChannelValue(absAddress, uchar(value));
+        quint32 chNum = cmdList[2].toUInt() - 1;
+        m_sd->resetChannel(chNum);
+        wsAPIMessage = "QLC+API|getChannelsValues|";
+        wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(
+                            m_doc, m_sd, m_sd->getCurrentUniverseIndex(),
+                            (m_sd->getCurrentPage() - 1) * m_sd->getSlidersNumber(), m_sd->getSlidersNumber()));
+    }
+    else if (apiCmd == "sdResetUniverse")
+    {
+        if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
+            return;
+
+        m_sd->resetUniverse();
+        wsAPIMessage = "QLC+API|getChannelsValues|";
+        wsAPIMessage.append(WebAccessSimpleDesk::getChannelsMessage(
+                            m_doc, m_sd, m_sd->getCurrentUniverseIndex(),
+                            0, m_sd->getSlidersNumber()));
+    }
+    //qDebug() << "Simple desk channels:" << wsAPIMessage;
+
+    conn->webSocketWrite(QHttpConnection::TextFrame, wsAPIMessage.toUtf8());
+}
+
+void WebAccess::handleChannelCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    Q_UNUSED(conn)
 
+    if(m_auth && user && user->level < SIMPLE_DESK_AND_VC_LEVEL)
         return;
-    }
-    else if(cmdList[0] == "POLL")
+
+    if (cmdList.count() < 3)
         return;
 
-    if (data.contains("|") == false)
+    uint absAddress = cmdList[1].toInt() - 1;
+    int value = cmdList[2].toInt();
+    m_sd->setAbsoluteChannelValue(absAddress, uchar(value));
+}
+
+void WebAccess::handleProtocolCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    Q_UNUSED(user)
+
+    if (cmdList.count() < 2 || m_webSocketClients.contains(conn) == false)
         return;
 
+    /** QLC+PROTO|BINARY switches the widget updates sent to this
+     *  connection to binary frames. QLC+PROTO|TEXT switches back.
+     *  QLC+PROTO|BATCH joins the text updates of a flush in a single
+     *  frame, one per line. QLC+PROTO|NOBATCH switches back to one
+     *  update per frame, which is the default.
+     *  QLC+PROTO|SYNC requests the current state of all the widgets */
+    WebSocketClient &client = m_webSocketClients[conn];
+    if (cmdList[1] == "SYNC")
+    {
+        enqueueWidgetsState(client.backlog);
+        m_flushTimer->start();
+        return;
+    }
+    else if (cmdList[1] == "BINARY")
+        client.binary = true;
+    else if (cmdList[1] == "TEXT")
+        client.binary = false;
+    else if (cmdList[1] == "BATCH")
+        client.batched = true;
+    else if (cmdList[1] == "NOBATCH")
+        client.batched = false;
+    else
+        return;
+
+    conn->webSocketWrite(QHttpConnection::TextFrame,
+                         QString("QLC+PROTO|%1").arg(cmdList[1]).toUtf8());
+}
+
+void WebAccess::handleWidgetCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList)
+{
+    Q_UNUSED(conn)
+
     if(m_auth && user && user->level < VC_ONLY_LEVEL)
         return;
 
@@ -795,34 +925,611 @@ void WebAccess::slotHandleWebSocketClose(QHttpConnection *conn)
     }
 
     m_webSocketsList.removeOne(conn);
+    m_webSocketClients.remove(conn);
+    unsubscribeMonitor(conn);
 }
 
-bool WebAccess::sendFile(QHttpResponse *response, QString filename, QString contentType)
+bool WebAccess::sendFile(QHttpRequest *req, QHttpResponse *response, QString filename, QString contentType)
 {
-    QFile resFile(filename);
-    if (resFile.open(QIODevice::ReadOnly))
+    QDateTime lastModified = QFileInfo(filename).lastModified();
+    QHash<QString, WebAsset>::const_iterator it = m_assetCache.constFind(filename);
+
+    if (it == m_assetCache.constEnd() || it.value().lastModified != lastModified)
     {
-        QByteArray resContent = resFile.readAll();
-        qDebug() << "Resource file length:" << resContent.length();
+        QFile resFile(filename);
+        if (resFile.open(QIODevice::ReadOnly) == false)
+        {
+            qDebug() << "Failed to open file:" << filename;
+            m_assetCache.remove(filename);
+            return false;
+        }
+
+        WebAsset asset;
+        asset.data = resFile.readAll();
+        asset.lastModified = lastModified;
         resFile.close();
 
-        response->setHeader("Content-Type", contentType);
-        response->setHeader("Content-Length", QString::number(resContent.size()));
-        response->writeHead(200);
-        response->end(resContent);
+        qDebug() << "Resource file length:" << asset.data.length();
 
-        return true;
+        // images are compressed already
+        prepareAsset(asset, contentType.startsWith("text/"));
+        it = m_assetCache.insert(filename, asset);
     }
-    else
-        qDebug() << "Failed to open file:" << filename;
 
-    return false;
+    sendAsset(req, response, it.value(), contentType);
+
+    return true;
 }
 
-void WebAccess::sendWebSocketMessage(QByteArray message)
+void WebAccess::sendAsset(QHttpRequest *req, QHttpResponse *resp,
+                          const WebAsset &asset, QString contentType)
 {
-    foreach(QHttpConnection *conn, m_webSocketsList)
-        conn->webSocketWrite(QHttpConnection::TextFrame, message);
+    resp->setHeader("ETag", asset.eTag);
+    resp->setHeader("Cache-Control", "no-cache");
+
+    if (req->header("if-none-match").contains(asset.eTag))
+    {
+        resp->setHeader("Content-Length", "0");
+        resp->writeHead(304);
+        resp->end(QByteArray());
+        return;
+    }
+
+    bool gzip = asset.gzipData.isEmpty() == false &&
+                req->header("accept-encoding").contains("gzip");
+
+    resp->setHeader("Content-Type", contentType);
+    if (gzip)
+    {
+        resp->setHeader("Content-Encoding", "gzip");
+        resp->setHeader("Vary", "Accept-Encoding");
+    }
+    resp->setHeader("Content-Length", QString::number(gzip ? asset.gzipData.size() : asset.data.size()));
+    resp->writeHead(200);
+    resp->end(gzip ? asset.gzipData : asset.data);
+}
+
+void WebAccess::prepareAsset(WebAsset &asset, bool compress)
+{
+    asset.eTag = QString("\"%1\"").arg(QString(
+                QCryptographicHash::hash(asset.data, QCryptographicHash::Md5).toHex().left(16)));
+    asset.gzipData.clear();
+
+    if (compress == false || asset.data.size() < 256)
+        return;
+
+    QByteArray gzipData = gzipEncode(asset.data);
+    if (gzipData.size() < asset.data.size())
+        asset.gzipData = gzipData;
+}
+
+static quint32 crc32(const QByteArray &data)
+{
+    static quint32 table[256];
+    static bool tableReady = false;
+
+    if (tableReady == false)
+    {
+        for (quint32 i = 0; i < 256; i++)
+        {
+            quint32 c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    quint32 crc = 0xFFFFFFFF;
+    for (int i = 0; i < data.size(); i++)
+        crc = table[(crc ^ quint8(data.at(i))) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+QByteArray WebAccess::gzipEncode(const QByteArray &data)
+{
+    /** qCompress produces a zlib stream prefixed by the 4 bytes of the
+     *  uncompressed size. Strip the size, the 2 bytes zlib header and
+     *  the adler32 trailer to get the raw deflate data and wrap it
+     *  into a gzip member (RFC 1952) */
+    QByteArray zlibData = qCompress(data, 9);
+    if (zlibData.size() < 10)
+        return QByteArray();
+
+    static const char gzipHeader[10] = { 0x1F, char(0x8B), 0x08, 0, 0, 0, 0, 0, 0x02, char(0xFF) };
+    quint32 crc = crc32(data);
+    quint32 size = data.size();
+
+    QByteArray gzipData(gzipHeader, sizeof(gzipHeader));
+    gzipData.append(zlibData.constData() + 6, zlibData.size() - 10);
+    for (int i = 0; i < 4; i++)
+        gzipData.append(char(crc >> (i * 8)));
+    for (int i = 0; i < 4; i++)
+        gzipData.append(char(size >> (i * 8)));
+
+    return gzipData;
+}
+
+void WebAccess::queueWebSocketUpdate(quint8 type, quint32 id, qint32 value, const QString &text)
+{
+    if (m_webSocketClients.isEmpty())
+        return;
+
+    WebUpdate update;
+    update.type = type;
+    update.id = id;
+    update.value = value;
+    update.text = text;
+
+    enqueueUpdate(m_pendingUpdates, update);
+
+    if (m_flushTimer->isActive() == false)
+        m_flushTimer->start();
+}
+
+void WebAccess::enqueueUpdate(WebUpdateQueue &queue, const WebUpdate &update)
+{
+    quint64 key = (quint64(update.type) << 32) | update.id;
+    QHash<quint64, int>::const_iterator it = queue.index.constFind(key);
+
+    if (it != queue.index.constEnd())
+    {
+        WebUpdate &queued = queue.updates[it.value()];
+
+        // Every ON/OFF change must pass through
+        if ((queued.value == 0) == (update.value == 0))
+        {
+            queued = update;
+            return;
+        }
+    }
+
+    queue.index.insert(key, queue.updates.count());
+    queue.updates.append(update);
+}
+
+void WebAccess::enqueueWidgetsState(WebUpdateQueue &queue)
+{
+    VCFrame *mainFrame = m_vc->contents();
+    if (mainFrame == NULL)
+        return;
+
+    WebUpdate update;
+
+    foreach(VCWidget *widget, mainFrame->findChildren<VCWidget*>())
+    {
+        update.id = widget->id();
+        update.text = QString();
+
+        switch(widget->type())
+        {
+            case VCWidget::ButtonWidget:
+            {
+                VCButton *button = qobject_cast<VCButton*>(widget);
+                update.type = ButtonUpdate;
+                if (button->state() == VCButton::Active)
+                    update.value = 255;
+                else if (button->state() == VCButton::Monitoring)
+                    update.value = 127;
+                else
+                    update.value = 0;
+            }
+            break;
+            case VCWidget::SliderWidget:
+            {
+                VCSlider *slider = qobject_cast<VCSlider*>(widget);
+                update.type = SliderUpdate;
+                update.value = slider->sliderValue();
+                update.text = slider->topLabelText();
+            }
+            break;
+            case VCWidget::CueListWidget:
+            {
+                VCCueList *cue = qobject_cast<VCCueList*>(widget);
+                Function *f = m_doc->function(cue->chaserID());
+                update.type = CueUpdate;
+                update.value = (f != NULL && f->isRunning()) ? cue->getCurrentIndex() : -1;
+            }
+            break;
+            case VCWidget::FrameWidget:
+            case VCWidget::SoloFrameWidget:
+            {
+                VCFrame *frame = qobject_cast<VCFrame*>(widget);
+                if (frame->multipageMode() == false)
+                    continue;
+                update.type = FrameUpdate;
+                update.value = frame->currentPage();
+            }
+            break;
+            default:
+                continue;
+        }
+
+        enqueueUpdate(queue, update);
+    }
+}
+
+QList<QByteArray> WebAccess::encodeTextUpdates(const QVector<WebUpdate> &updates)
+{
+    QList<QByteArray> messages;
+
+    for (int i = 0; i < updates.count(); i++)
+    {
+        const WebUpdate &update = updates.at(i);
+        QByteArray msg = QByteArray::number(update.id);
+
+        switch (update.type)
+        {
+            case ButtonUpdate: msg.append("|BUTTON|"); break;
+            case SliderUpdate: msg.append("|SLIDER|"); break;
+            case AudioTriggersUpdate: msg.append("|AUDIOTRIGGERS|"); break;
+            case CueUpdate: msg.append("|CUE|"); break;
+            case ClockUpdate: msg.append("|CLOCK|"); break;
+            case FrameUpdate: msg.append("|FRAME|"); break;
+            default: continue;
+        }
+
+        msg.append(QByteArray::number(update.value));
+
+        // <ID>|SLIDER|<SLIDER VALUE>|<DISPLAY VALUE>
+        if (update.type == SliderUpdate)
+            msg.append('|').append(update.text.toUtf8());
+
+        messages.append(msg);
+    }
+
+    return messages;
+}
+
+QByteArray WebAccess::encodeBinaryUpdates(const QVector<WebUpdate> &updates)
+{
+    /** Each update is encoded as:
+     *  type (1 byte), widget ID (4 bytes), signed value (4 bytes),
+     *  text length (1 byte), UTF-8 text. Integers are big endian */
+    QByteArray data;
+
+    for (int i = 0; i < updates.count(); i++)
+    {
+        const WebUpdate &update = updates.at(i);
+        QByteArray text = update.text.toUtf8().left(255);
+
+        data.append(char(update.type));
+        data.append(char(update.id >> 24)).append(char(update.id >> 16));
+        data.append(char(update.id >> 8)).append(char(update.id));
+        data.append(char(update.value >> 24)).append(char(update.value >> 16));
+        data.append(char(update.value >> 8)).append(char(update.value));
+        data.append(char(text.length()));
+        data.append(text);
+    }
+
+    return data;
+}
+
+void WebAccess::writeWebSocketFrames(QHttpConnection *conn, bool binary, const QByteArray &data)
+{
+    /** QHttpConnection encodes the payload length on 16 bits.
+     *  Text batches are split on a message boundary, binary
+     *  batches on an update boundary */
+    const int maxLength = 0xFFFF;
+    QHttpConnection::WebSocketOpCode opCode = binary ? QHttpConnection::BinaryFrame :
+                                                       QHttpConnection::TextFrame;
+    int pos = 0;
+
+    while (data.length() - pos > maxLength)
+    {
+        int len = maxLength;
+
+        if (binary)
+        {
+            int p = pos;
+            while (p < data.length() && p + 10 + quint8(data.at(p + 9)) - pos <= maxLength)
+                p += 10 + quint8(data.at(p + 9));
+            len = p - pos;
+        }
+        else
+        {
+            int nl = data.lastIndexOf('\n', pos + maxLength);
+            if (nl > pos)
+                len = nl - pos;
+        }
+
+        conn->webSocketWrite(opCode, data.mid(pos, len));
+        pos += len;
+        if (binary == false && pos < data.length() && data.at(pos) == '\n')
+            pos++;
+    }
+
+    if (pos == 0)
+        conn->webSocketWrite(opCode, data);
+    else if (pos < data.length())
+        conn->webSocketWrite(opCode, data.mid(pos));
+}
+
+void WebAccess::writeTextUpdates(QHttpConnection *conn, const WebSocketClient &client,
+                                 const QList<QByteArray> &messages)
+{
+    if (client.batched)
+    {
+        QByteArray data;
+        for (int i = 0; i < messages.count(); i++)
+        {
+            if (i > 0)
+                data.append('\n');
+            data.append(messages.at(i));
+        }
+        writeWebSocketFrames(conn, false, data);
+        return;
+    }
+
+    foreach (QByteArray msg, messages)
+        conn->webSocketWrite(QHttpConnection::TextFrame, msg);
+}
+
+void WebAccess::slotFlushWebSocketUpdates()
+{
+    QByteArray binaryFrame;
+    QList<QByteArray> textMessages;
+
+    QHash<QHttpConnection *, WebSocketClient>::iterator it = m_webSocketClients.begin();
+    for (; it != m_webSocketClients.end(); ++it)
+    {
+        QHttpConnection *conn = it.key();
+        WebSocketClient &client = it.value();
+
+        /** A client that hasn't drained the previous frames yet
+         *  (e.g. a phone on a weak Wi-Fi) keeps its own coalesced
+         *  backlog, so it never holds more than one update per widget */
+        if (conn->bytesToWrite() > WEBSOCKET_MAX_PENDING_BYTES)
+        {
+            for (int i = 0; i < m_pendingUpdates.updates.count(); i++)
+                enqueueUpdate(client.backlog, m_pendingUpdates.updates.at(i));
+            continue;
+        }
+
+        if (client.backlog.updates.isEmpty() == false)
+        {
+            for (int i = 0; i < m_pendingUpdates.updates.count(); i++)
+                enqueueUpdate(client.backlog, m_pendingUpdates.updates.at(i));
+
+            if (client.binary)
+                writeWebSocketFrames(conn, true, encodeBinaryUpdates(client.backlog.updates));
+            else
+                writeTextUpdates(conn, client, encodeTextUpdates(client.backlog.updates));
+            client.backlog.updates.clear();
+            client.backlog.index.clear();
+            continue;
+        }
+
+        if (m_pendingUpdates.updates.isEmpty())
+            continue;
+
+        // the common case: all clients share the same encoded frame
+        if (client.binary)
+        {
+            if (binaryFrame.isEmpty())
+                binaryFrame = encodeBinaryUpdates(m_pendingUpdates.updates);
+            writeWebSocketFrames(conn, true, binaryFrame);
+        }
+        else
+        {
+            if (textMessages.isEmpty())
+                textMessages = encodeTextUpdates(m_pendingUpdates.updates);
+            writeTextUpdates(conn, client, textMessages);
+        }
+    }
+
+    m_pendingUpdates.updates.clear();
+    m_pendingUpdates.index.clear();
+
+    /** Keep ticking while some client still has a backlog to send */
+    it = m_webSocketClients.begin();
+    for (; it != m_webSocketClients.end(); ++it)
+    {
+        if (it.value().backlog.updates.isEmpty() == false)
+        {
+            m_flushTimer->start();
+            break;
+        }
+    }
+}
+
+/*********************************************************************
+ * DMX monitor
+ *********************************************************************/
+
+bool WebAccess::subscribeMonitor(QHttpConnection *conn, const QStringList &cmdList)
+{
+    // QLC+API|subscribeChannels|<rate>|<universe>|<address>|<count>|...
+    if (cmdList.count() < 6 || (cmdList.count() - 3) % 3 != 0)
+        return false;
+
+    MonitorSubscription sub;
+    int rate = qBound(MONITOR_MIN_RATE, cmdList[2].toInt(), MONITOR_MAX_RATE);
+    sub.interval = 1000 / rate;
+    sub.lastSent = 0;
+
+    for (int i = 3; i < cmdList.count(); i += 3)
+    {
+        MonitorRange range;
+        // indices start from 1, like getChannelsValues
+        range.universe = cmdList[i].toUInt() - 1;
+        range.start = cmdList[i + 1].toInt() - 1;
+        range.count = cmdList[i + 2].toInt();
+
+        if (range.universe >= m_doc->inputOutputMap()->universesCount() ||
+            range.start < 0 || range.count <= 0 || range.start + range.count > 512)
+            return false;
+
+        sub.ranges.append(range);
+        sub.dirty.insert(range.universe);
+    }
+
+    if (m_monitors.isEmpty())
+        connect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
+                this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+
+    // seed the universes not monitored yet with their current values,
+    // otherwise the first frame would show zeroes until they are written
+    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    foreach(const MonitorRange &range, sub.ranges)
+    {
+        if (m_monitorUniverses.contains(range.universe) == false)
+            m_monitorUniverses[range.universe] = *ua.at(range.universe)->postGMValues();
+    }
+    m_doc->inputOutputMap()->releaseUniverses(false);
+
+    // a new subscription starts with a full frame
+    m_monitors.insert(conn, sub);
+    m_monitorTimer->start();
+
+    return true;
+}
+
+void WebAccess::unsubscribeMonitor(QHttpConnection *conn)
+{
+    if (m_monitors.remove(conn) == 0)
+        return;
+
+    if (m_monitors.isEmpty())
+    {
+        disconnect(m_doc->inputOutputMap(), SIGNAL(universeWritten(quint32,QByteArray)),
+                   this, SLOT(slotUniverseWritten(quint32,QByteArray)));
+        m_monitorUniverses.clear();
+    }
+}
+
+void WebAccess::slotUniverseWritten(quint32 idx, const QByteArray &data)
+{
+    bool monitored = false;
+
+    QHash<QHttpConnection *, MonitorSubscription>::iterator it = m_monitors.begin();
+    for (; it != m_monitors.end(); ++it)
+    {
+        MonitorSubscription &sub = it.value();
+        foreach(const MonitorRange &range, sub.ranges)
+        {
+            if (range.universe == idx)
+            {
+                sub.dirty.insert(idx);
+                monitored = true;
+                break;
+            }
+        }
+    }
+
+    if (monitored == false)
+        return;
+
+    // implicitly shared, no copy is made here
+    m_monitorUniverses[idx] = data;
+
+    if (m_monitorTimer->isActive() == false)
+        m_monitorTimer->start();
+}
+
+void WebAccess::slotMonitorTimeout()
+{
+    qint64 now = m_monitorClock.elapsed();
+    bool pending = false;
+
+    QHash<QHttpConnection *, MonitorSubscription>::iterator it = m_monitors.begin();
+    for (; it != m_monitors.end(); ++it)
+    {
+        QHttpConnection *conn = it.key();
+        MonitorSubscription &sub = it.value();
+
+        if (sub.dirty.isEmpty())
+            continue;
+
+        /** Wait for the client rate and for a busy client to drain
+         *  its socket. Changes keep accumulating in the meantime */
+        if (now - sub.lastSent < sub.interval ||
+            conn->bytesToWrite() > WEBSOCKET_MAX_PENDING_BYTES)
+        {
+            pending = true;
+            continue;
+        }
+
+        foreach(const QByteArray &frame, encodeMonitorFrames(sub))
+            conn->webSocketWrite(QHttpConnection::BinaryFrame, frame);
+
+        sub.lastSent = now;
+        sub.dirty.clear();
+    }
+
+    if (pending)
+        m_monitorTimer->start();
+}
+
+QList<QByteArray> WebAccess::encodeMonitorFrames(MonitorSubscription &sub)
+{
+    /** A frame is the marker byte followed by blocks of changed channels:
+     *  universe (2 bytes), address (2 bytes), count (2 bytes), values.
+     *  Universe and address start from 1. Integers are big endian.
+     *  Unchanged gaps shorter than a block header are sent as values */
+    const int maxGap = 6;
+    QList<QByteArray> frames;
+    QByteArray frame(1, char(MONITOR_FRAME_MARKER));
+
+    for (int r = 0; r < sub.ranges.count(); r++)
+    {
+        MonitorRange &range = sub.ranges[r];
+        if (sub.dirty.contains(range.universe) == false)
+            continue;
+
+        QByteArray data = m_monitorUniverses.value(range.universe);
+        QByteArray &sent = range.sentValues;
+        bool keyFrame = sent.isEmpty();
+
+        if (keyFrame)
+            sent.fill(0, range.count);
+
+        int i = range.start;
+        int end = range.start + range.count;
+
+        while (i < end)
+        {
+            uchar value = i < data.size() ? uchar(data.at(i)) : 0;
+            if (keyFrame == false && uchar(sent.at(i - range.start)) == value)
+            {
+                i++;
+                continue;
+            }
+
+            // extend the block until a long enough unchanged gap is found
+            int blockStart = i;
+            int lastChanged = i;
+            for (; i < end && i - lastChanged <= maxGap; i++)
+            {
+                value = i < data.size() ? uchar(data.at(i)) : 0;
+                if (keyFrame || uchar(sent.at(i - range.start)) != value)
+                    lastChanged = i;
+                sent[i - range.start] = char(value);
+            }
+            int count = lastChanged - blockStart + 1;
+            i = lastChanged + 1;
+
+            if (frame.size() + 6 + count > 0xFFFF)
+            {
+                frames.append(frame);
+                frame = QByteArray(1, char(MONITOR_FRAME_MARKER));
+            }
+
+            quint16 uni = range.universe + 1;
+            quint16 addr = blockStart + 1;
+            frame.append(char(uni >> 8)).append(char(uni & 0xFF));
+            frame.append(char(addr >> 8)).append(char(addr & 0xFF));
+            frame.append(char(count >> 8)).append(char(count & 0xFF));
+            for (int c = blockStart; c < blockStart + count; c++)
+                frame.append(sent.at(c - range.start));
+        }
+    }
+
+    if (frame.size() > 1)
+        frames.append(frame);
+
+    return frames;
 }
 
 QString WebAccess::getWidgetHTML(VCWidget *widget)
@@ -845,10 +1552,8 @@ void WebAccess::slotFramePageChanged(int pageNum)
     if (frame == NULL)
         return;
 
-    QString wsMessage = QString("%1|FRAME|%2").arg(frame->id()).arg(pageNum);
-    QByteArray ba = wsMessage.toUtf8();
-
-    sendWebSocketMessage(ba);
+    slotInvalidateVCHTML();
+    queueWebSocketUpdate(FrameUpdate, frame->id(), pageNum);
 }
 
 QString WebAccess::getFrameHTML(VCFrame *frame)
@@ -894,7 +1599,7 @@ QString WebAccess::getFrameHTML(VCFrame *frame)
             m_JScode += "framesCurrentPage[" + QString::number(frame->id()) + "] = " + QString::number(frame->currentPage()) + ";\n";
             m_JScode += "framesTotalPages[" + QString::number(frame->id()) + "] = " + QString::number(frame->totalPagesNumber()) + ";\n\n";
             connect(frame, SIGNAL(pageChanged(int)),
-                    this, SLOT(slotFramePageChanged(int)));
+                    this, SLOT(slotFramePageChanged(int)), Qt::UniqueConnection);
         }
     }
 
@@ -946,7 +1651,7 @@ QString WebAccess::getSoloFrameHTML(VCSoloFrame *frame)
             m_JScode += "framesCurrentPage[" + QString::number(frame->id()) + "] = " + QString::number(frame->currentPage()) + ";\n";
             m_JScode += "framesTotalPages[" + QString::number(frame->id()) + "] = " + QString::number(frame->totalPagesNumber()) + ";\n\n";
             connect(frame, SIGNAL(pageChanged(int)),
-                    this, SLOT(slotFramePageChanged(int)));
+                    this, SLOT(slotFramePageChanged(int)), Qt::UniqueConnection);
         }
     }
 
@@ -963,15 +1668,12 @@ void WebAccess::slotButtonStateChanged(int state)
 
     qDebug() << "Button state changed" << state;
 
-    QString wsMessage = QString::number(btn->id());
     if (state == VCButton::Active)
-        wsMessage.append("|BUTTON|255");
+        queueWebSocketUpdate(ButtonUpdate, btn->id(), 255);
     else if (state == VCButton::Monitoring)
-        wsMessage.append("|BUTTON|127");
+        queueWebSocketUpdate(ButtonUpdate, btn->id(), 127);
     else
-        wsMessage.append("|BUTTON|0");
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+        queueWebSocketUpdate(ButtonUpdate, btn->id(), 0);
 }
 
 QString WebAccess::getButtonHTML(VCButton *btn)
@@ -997,7 +1699,7 @@ QString WebAccess::getButtonHTML(VCButton *btn)
             btn->caption() + "</a>\n</div>\n";
 
     connect(btn, SIGNAL(stateChanged(int)),
-            this, SLOT(slotButtonStateChanged(int)));
+            this, SLOT(slotButtonStateChanged(int)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1008,10 +1710,7 @@ void WebAccess::slotSliderValueChanged(QString val)
     if (slider == NULL)
         return;
 
-    // <ID>|SLIDER|<SLIDER VALUE>|<DISPLAY VALUE>
-    QString wsMessage = QString("%1|SLIDER|%2|%3").arg(slider->id()).arg(slider->sliderValue()).arg(val);
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWebSocketUpdate(SliderUpdate, slider->id(), slider->sliderValue(), val);
 }
 
 QString WebAccess::getSliderHTML(VCSlider *slider)
@@ -1051,7 +1750,7 @@ QString WebAccess::getSliderHTML(VCSlider *slider)
             "</div>\n";
 
     connect(slider, SIGNAL(valueChanged(QString)),
-            this, SLOT(slotSliderValueChanged(QString)));
+            this, SLOT(slotSliderValueChanged(QString)), Qt::UniqueConnection);
     return str;
 }
 
@@ -1078,9 +1777,7 @@ void WebAccess::slotAudioTriggersToggled(bool toggle)
 
     qDebug() << "AudioTriggers state changed " << toggle;
 
-    QString wsMessage = QString("%1|AUDIOTRIGGERS|%2").arg(triggers->id()).arg(toggle ? 255 : 0);
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWebSocketUpdate(AudioTriggersUpdate, triggers->id(), toggle ? 255 : 0);
 }
 
 QString WebAccess::getAudioTriggersHTML(VCAudioTriggers *triggers)
@@ -1105,7 +1802,7 @@ QString WebAccess::getAudioTriggersHTML(VCAudioTriggers *triggers)
     str += "</div></div>\n";
 
     connect(triggers, SIGNAL(captureEnabled(bool)),
-            this, SLOT(slotAudioTriggersToggled(bool)));
+            this, SLOT(slotAudioTriggersToggled(bool)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1116,9 +1813,7 @@ void WebAccess::slotCueIndexChanged(int idx)
     if (cue == NULL)
         return;
 
-    QString wsMessage = QString("%1|CUE|%2").arg(cue->id()).arg(idx);
-
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWebSocketUpdate(CueUpdate, cue->id(), idx);
 }
 
 QString WebAccess::getCueListHTML(VCCueList *cue)
@@ -1255,7 +1950,7 @@ QString WebAccess::getCueListHTML(VCCueList *cue)
     str += "</div>\n";
 
     connect(cue, SIGNAL(stepChanged(int)),
-            this, SLOT(slotCueIndexChanged(int)));
+            this, SLOT(slotCueIndexChanged(int)), Qt::UniqueConnection);
 
     return str;
 }
@@ -1266,8 +1961,7 @@ void WebAccess::slotClockTimeChanged(quint32 time)
     if (clock == NULL)
         return;
 
-    QString wsMessage = QString("%1|CLOCK|%2").arg(clock->id()).arg(time);
-    sendWebSocketMessage(wsMessage.toUtf8());
+    queueWebSocketUpdate(ClockUpdate, clock->id(), time);
 }
 
 QString WebAccess::getClockHTML(VCClock *clock)
@@ -1285,7 +1979,7 @@ QString WebAccess::getClockHTML(VCClock *clock)
         str += "oncontextmenu=\"javascript:controlWatch(";
         str += QString::number(clock->id()) + ", 'R'); return false;\"";
         connect(clock, SIGNAL(timeChanged(quint32)),
-                this, SLOT(slotClockTimeChanged(quint32)));
+                this, SLOT(slotClockTimeChanged(quint32)), Qt::UniqueConnection);
     }
     else
     {
@@ -1461,4 +2155,10 @@ QString WebAccess::getSimpleDeskHTML()
 void WebAccess::slotVCLoaded()
 {
     m_pendingProjectLoaded = true;
+    slotInvalidateVCHTML();
+}
+
+void WebAccess::slotInvalidateVCHTML()
+{
+    m_vcPageValid = false;
 }
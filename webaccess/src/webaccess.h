@@ -20,13 +20,19 @@
 #ifndef WEBACCESS_H
 #define WEBACCESS_H
 
+#include <QElapsedTimer>
+#include <QDateTime>
 #include <QObject>
+#include <QSet>
+#include <QVector>
+#include <QHash>
 
 #if defined(Q_WS_X11) || defined(Q_OS_LINUX)
 class WebAccessNetwork;
 #endif
 
 class WebAccessAuth;
+struct WebAccessUser;
 
 class VCAudioTriggers;
 class VirtualConsole;
@@ -45,6 +51,7 @@ class QHttpServer;
 class QHttpRequest;
 class QHttpResponse;
 class QHttpConnection;
+class QTimer;
 
 class WebAccess : public QObject
 {
@@ -57,8 +64,7 @@ public:
     ~WebAccess();
 
 private:
-    bool sendFile(QHttpResponse *response, QString filename, QString contentType);
-    void sendWebSocketMessage(QByteArray message);
+    bool sendFile(QHttpRequest *req, QHttpResponse *response, QString filename, QString contentType);
 
     QString getWidgetHTML(VCWidget *widget);
     QString getFrameHTML(VCFrame *frame);
@@ -81,6 +87,8 @@ protected slots:
     void slotHandleWebSocketClose(QHttpConnection *conn);
 
     void slotVCLoaded();
+    void slotInvalidateVCHTML();
+    void slotFlushWebSocketUpdates();
     void slotButtonStateChanged(int state);
     void slotSliderValueChanged(QString val);
     void slotAudioTriggersToggled(bool toggle);
@@ -106,6 +114,180 @@ protected:
 
     bool m_pendingProjectLoaded;
 
+    /*********************************************************************
+     * Resources cache
+     *********************************************************************/
+protected:
+    typedef struct
+    {
+        QByteArray data;
+        /** gzip encoded data. Empty if compression doesn't pay off */
+        QByteArray gzipData;
+        QString eTag;
+        QDateTime lastModified;
+    } WebAsset;
+
+    /** Compute the ETag of $asset and, when $compress is true,
+     *  its gzip encoded variant */
+    static void prepareAsset(WebAsset &asset, bool compress);
+    static QByteArray gzipEncode(const QByteArray &data);
+
+    /** Reply to $req with $asset, answering 304 if the client already
+     *  has it and sending the gzip variant when the client accepts it */
+    void sendAsset(QHttpRequest *req, QHttpResponse *resp,
+                   const WebAsset &asset, QString contentType);
+
+protected:
+    /** Files served so far, by path. An entry is reloaded when
+     *  the file modification time changes */
+    QHash<QString, WebAsset> m_assetCache;
+
+    /** The Virtual Console page, valid until the VC or its pages change */
+    WebAsset m_vcPage;
+    bool m_vcPageValid;
+
+    /*********************************************************************
+     * WebSocket commands
+     *********************************************************************/
+protected:
+    typedef void (WebAccess::*WebSocketHandler)(QHttpConnection *conn, WebAccessUser *user,
+                                                const QStringList &cmdList);
+
+    void handleCMDCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+    void handleIOCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+    void handleAuthCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+#if defined(Q_WS_X11) || defined(Q_OS_LINUX)
+    void handleSystemCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+#endif
+    void handleAPICommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+    void handleChannelCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+    void handleProtocolCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+    void handleWidgetCommand(QHttpConnection *conn, WebAccessUser *user, const QStringList &cmdList);
+
+protected:
+    /** Map of a message prefix (e.g. "QLC+API") to the method handling it.
+     *  Messages without a known prefix are widget commands */
+    QHash<QString, WebSocketHandler> m_webSocketHandlers;
+
+    /*********************************************************************
+     * WebSocket outbound updates
+     *********************************************************************/
+public:
+    /** Type of a widget update pushed to the clients.
+     *  The values are used as-is in the binary protocol */
+    enum WebUpdateType
+    {
+        ButtonUpdate = 1,
+        SliderUpdate,
+        AudioTriggersUpdate,
+        CueUpdate,
+        ClockUpdate,
+        FrameUpdate
+    };
+
+protected:
+    typedef struct
+    {
+        quint8 type;
+        quint32 id;
+        qint32 value;
+        QString text;
+    } WebUpdate;
+
+    /** A list of widget updates, where a newer update of the same
+     *  widget replaces the older one at its original position, unless
+     *  it switches the widget between zero and non-zero: such a
+     *  transition (e.g. a flash button press and release) is always
+     *  queued, so that the clients never miss it */
+    typedef struct
+    {
+        QVector<WebUpdate> updates;
+        QHash<quint64, int> index;
+    } WebUpdateQueue;
+
+    /** Per-connection state of an open WebSocket */
+    typedef struct
+    {
+        bool binary;
+        /** True when the client asked to receive several text
+         *  updates in one frame, separated by a new line */
+        bool batched;
+        /** Updates held back while the connection is still busy
+         *  sending the previous ones */
+        WebUpdateQueue backlog;
+    } WebSocketClient;
+
+    /** Queue an update of a widget. Updates are coalesced and sent
+     *  to all the clients on the next flush tick */
+    void queueWebSocketUpdate(quint8 type, quint32 id, qint32 value,
+                              const QString &text = QString());
+
+    static void enqueueUpdate(WebUpdateQueue &queue, const WebUpdate &update);
+
+    /** Queue the current state of all the VC widgets into $queue,
+     *  so that a client showing a cached page gets up to date */
+    void enqueueWidgetsState(WebUpdateQueue &queue);
+    static QList<QByteArray> encodeTextUpdates(const QVector<WebUpdate> &updates);
+    static QByteArray encodeBinaryUpdates(const QVector<WebUpdate> &updates);
+
+    /** Write $data to $conn, splitting it into more frames if it
+     *  exceeds the maximum frame size supported by QHttpConnection */
+    void writeWebSocketFrames(QHttpConnection *conn, bool binary, const QByteArray &data);
+
+    /** Write the text $messages to $conn, one per frame, or joined
+     *  in as few frames as possible if the client asked for it */
+    void writeTextUpdates(QHttpConnection *conn, const WebSocketClient &client,
+                          const QList<QByteArray> &messages);
+
+protected:
+    QHash<QHttpConnection *, WebSocketClient> m_webSocketClients;
+    WebUpdateQueue m_pendingUpdates;
+    QTimer *m_flushTimer;
+
+    /*********************************************************************
+     * DMX monitor
+     *********************************************************************/
+protected:
+    typedef struct
+    {
+        quint32 universe;
+        int start;
+        int count;
+        /** Values of the range last sent to the client. Kept per range,
+         *  so that overlapping ranges don't affect each other's deltas */
+        QByteArray sentValues;
+    } MonitorRange;
+
+    typedef struct
+    {
+        QList<MonitorRange> ranges;
+        /** Minimum time between two frames, in milliseconds */
+        int interval;
+        qint64 lastSent;
+        /** Universes written since the last frame */
+        QSet<quint32> dirty;
+    } MonitorSubscription;
+
+    /** Handle QLC+API|subscribeChannels|<rate>|<universe>|<address>|<count>|...
+     *  Returns false if the command arguments are invalid */
+    bool subscribeMonitor(QHttpConnection *conn, const QStringList &cmdList);
+    void unsubscribeMonitor(QHttpConnection *conn);
+
+    /** Encode the values of $sub that changed since the last frame.
+     *  Frames are split so that none exceeds the maximum frame size */
+    QList<QByteArray> encodeMonitorFrames(MonitorSubscription &sub);
+
+protected slots:
+    void slotUniverseWritten(quint32 idx, const QByteArray &data);
+    void slotMonitorTimeout();
+
+protected:
+    QHash<QHttpConnection *, MonitorSubscription> m_monitors;
+    /** Latest output data of the monitored universes */
+    QHash<quint32, QByteArray> m_monitorUniverses;
+    QTimer *m_monitorTimer;
+    QElapsedTimer m_monitorClock;
+
 signals:
     void toggleDocMode();
     void loadProject(QString xmlData);